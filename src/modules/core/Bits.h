@@ -6,6 +6,9 @@
 
 #include "core/String.h"
 #include <stdint.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace core {
 
@@ -14,6 +17,26 @@ constexpr uint32_t bits(uint32_t x, uint8_t offset, uint8_t len) {
 	return tmp & ((1u << len) - 1u);
 }
 
+/**
+ * @return The index of the lowest set bit - the value must not be @c 0
+ */
+inline int countTrailingZeros(uint64_t x) {
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return (int)idx;
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	while ((x & 1u) == 0u) {
+		x >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
 template<typename TYPE>
 core::String toBitString(TYPE val) {
 	size_t l = sizeof(val) * 8;
@@ -13,6 +13,8 @@
 #include "core/StringUtil.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ParallelFor.h"
 #include "math/Octree.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
@@ -23,7 +25,6 @@
 #include <glm/gtx/color_space.hpp>
 
 #include <SDL.h>
-#include <random>
 #include <stdio.h>
 
 namespace core {
@@ -256,61 +257,230 @@ static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA
 	return (int)n;
 }
 
-static inline float getDistance(const glm::vec4 &p1, const glm::vec4 &p2) {
-	return glm::length(p1 - p2);
-}
-
-static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::DynamicArray<glm::vec4> centers;
-	centers.resize(maxTargetBufColors);
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<> dis(0, (int)inputBufColors - 1);
-	for (int i = 0; i < (int)maxTargetBufColors; i++) {
-		centers[i] = core::Color::fromRGBA(inputBuf[dis(gen)]);
-	}
-
-	bool changed = true;
-	while (changed) {
-		changed = false;
-		core::DynamicArray<core::DynamicArray<glm::vec4>> clusters(maxTargetBufColors);
-		for (size_t i = 0; i < inputBufColors; ++i) {
-			const glm::vec4 point = core::Color::fromRGBA(inputBuf[i]);
-			int closest = 0;
-			float closestDistance = getDistance(point, centers[0]);
-			for (int i = 1; i < (int)maxTargetBufColors; i++) {
-				float d = getDistance(point, centers[i]);
-				if (d < closestDistance) {
-					closest = i;
-					closestDistance = d;
-				}
+struct KMeansColor {
+	RGBA color;
+	uint32_t count;
+};
+
+static inline uint8_t kmeansChannel(const RGBA &c, int axis) {
+	switch (axis) {
+	case 0:
+		return c.r;
+	case 1:
+		return c.g;
+	case 2:
+		return c.b;
+	default:
+		return c.a;
+	}
+}
+
+/**
+ * @brief Weighted median cut over the unique colors - the boxes are ranges in the color array that are sorted and split
+ * in place. Gives the deterministic seeds for the k-means refinement.
+ */
+static int kmeansMedianCutSeeds(core::Buffer<KMeansColor> &colors, int k, core::Buffer<glm::ivec4> &centers) {
+	struct Box {
+		size_t start;
+		size_t end;
+		uint64_t weight;
+		int axis;
+		int range;
+	};
+	auto makeBox = [&colors](size_t start, size_t end) {
+		Box box{start, end, 0u, 0, 0};
+		glm::ivec4 mins(255);
+		glm::ivec4 maxs(0);
+		for (size_t i = start; i < end; ++i) {
+			const RGBA c = colors[i].color;
+			const glm::ivec4 v(c.r, c.g, c.b, c.a);
+			mins = glm::min(mins, v);
+			maxs = glm::max(maxs, v);
+			box.weight += colors[i].count;
+		}
+		const glm::ivec4 ranges = maxs - mins;
+		for (int axis = 0; axis < 4; ++axis) {
+			if (ranges[axis] > box.range) {
+				box.range = ranges[axis];
+				box.axis = axis;
 			}
-			clusters[closest].push_back(point);
 		}
-		for (int i = 0; i < (int)maxTargetBufColors; i++) {
-			if (clusters[i].empty()) {
+		return box;
+	};
+
+	core::DynamicArray<Box> boxes;
+	boxes.reserve(k);
+	boxes.push_back(makeBox(0, colors.size()));
+	while ((int)boxes.size() < k) {
+		// split the box with the most pixels relative to its extent - ties resolve to the lower index
+		int best = -1;
+		uint64_t bestScore = 0u;
+		for (int i = 0; i < (int)boxes.size(); ++i) {
+			const Box &box = boxes[i];
+			if (box.end - box.start < 2) {
 				continue;
 			}
-			glm::vec4 newCenter(0.0f);
-			for (const glm::vec4 &point : clusters[i]) {
-				newCenter += point;
+			const uint64_t score = box.weight * (uint64_t)(box.range + 1);
+			if (score > bestScore) {
+				bestScore = score;
+				best = i;
+			}
+		}
+		if (best == -1) {
+			break;
+		}
+		const Box box = boxes[best];
+		const int axis = box.axis;
+		// the colors are unique - sorting by the full value on equal channels keeps the order deterministic
+		core::sort(colors.begin() + box.start, colors.begin() + box.end,
+				   [axis](const KMeansColor &lhs, const KMeansColor &rhs) {
+					   const uint8_t l = kmeansChannel(lhs.color, axis);
+					   const uint8_t r = kmeansChannel(rhs.color, axis);
+					   if (l != r) {
+						   return l < r;
+					   }
+					   return lhs.color.rgba < rhs.color.rgba;
+				   });
+		const uint64_t half = box.weight / 2u;
+		uint64_t accumulated = 0u;
+		size_t split = box.start + 1;
+		for (size_t i = box.start; i < box.end - 1; ++i) {
+			accumulated += colors[i].count;
+			split = i + 1;
+			if (accumulated >= half) {
+				break;
+			}
+		}
+		boxes[best] = makeBox(box.start, split);
+		boxes.push_back(makeBox(split, box.end));
+	}
+
+	centers.resize(boxes.size());
+	for (size_t i = 0; i < boxes.size(); ++i) {
+		const Box &box = boxes[i];
+		glm::u64vec4 sum(0u);
+		for (size_t j = box.start; j < box.end; ++j) {
+			const RGBA c = colors[j].color;
+			sum += glm::u64vec4(c.r, c.g, c.b, c.a) * (uint64_t)colors[j].count;
+		}
+		centers[i] = glm::ivec4((sum + box.weight / 2u) / box.weight);
+	}
+	return (int)boxes.size();
+}
+
+/**
+ * @brief Upper bound for the refinement passes - the median cut seeds are usually stable after a few passes anyway
+ */
+static constexpr int KMeansMaxIterations = 16;
+/**
+ * @brief Unique colors per task of the parallel assignment step
+ */
+static constexpr int KMeansAssignGrain = 1024;
+
+static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors,
+						  ThreadPool *pool) {
+	// reduce the input to the unique colors and their counts - the pixels of the input images share a lot of colors
+	core::Buffer<uint32_t> sorted;
+	sorted.resize(inputBufColors);
+	for (size_t i = 0; i < inputBufColors; ++i) {
+		sorted[i] = inputBuf[i].rgba;
+	}
+	core::sort(sorted.begin(), sorted.end(), core::Less<uint32_t>());
+	core::Buffer<KMeansColor> colors;
+	for (size_t i = 0; i < inputBufColors;) {
+		size_t j = i + 1;
+		while (j < inputBufColors && sorted[j] == sorted[i]) {
+			++j;
+		}
+		colors.push_back(KMeansColor{RGBA(sorted[i]), (uint32_t)(j - i)});
+		i = j;
+	}
+	const size_t colorCount = colors.size();
+	if (colorCount <= maxTargetBufColors) {
+		for (size_t i = 0; i < colorCount; ++i) {
+			targetBuf[i] = colors[i].color;
+		}
+		for (size_t i = colorCount; i < maxTargetBufColors; ++i) {
+			targetBuf[i] = RGBA(0xFFFFFFFFU);
+		}
+		return (int)colorCount;
+	}
+
+	core::Buffer<glm::ivec4> centers;
+	const int k = kmeansMedianCutSeeds(colors, (int)maxTargetBufColors, centers);
+
+	core::Buffer<int> assignment;
+	assignment.resize(colorCount);
+	for (size_t i = 0; i < colorCount; ++i) {
+		assignment[i] = -1;
+	}
+	core::Buffer<glm::u64vec4> sums;
+	core::Buffer<uint64_t> weights;
+	sums.resize(k);
+	weights.resize(k);
+	for (int iteration = 0; iteration < KMeansMaxIterations; ++iteration) {
+		AtomicBool changed{false};
+		// every color only depends on the centers - the ranges can be assigned concurrently
+		auto assign = [&](int start, int end) {
+			bool rangeChanged = false;
+			for (int i = start; i < end; ++i) {
+				const RGBA c = colors[i].color;
+				const glm::ivec4 v(c.r, c.g, c.b, c.a);
+				// integer squared distances - no sqrt and ties resolve to the lower index
+				int closest = 0;
+				int closestDistance = INT32_MAX;
+				for (int j = 0; j < k; ++j) {
+					const glm::ivec4 delta = v - centers[j];
+					const int d = delta.r * delta.r + delta.g * delta.g + delta.b * delta.b + delta.a * delta.a;
+					if (d < closestDistance) {
+						closestDistance = d;
+						closest = j;
+					}
+				}
+				if (assignment[i] != closest) {
+					assignment[i] = closest;
+					rangeChanged = true;
+				}
 			}
-			newCenter /= clusters[i].size();
-			if (getDistance(newCenter, centers[i]) > 0.0001f) {
-				centers[i] = newCenter;
+			if (rangeChanged) {
 				changed = true;
 			}
+		};
+		if (pool != nullptr) {
+			parallel_for(*pool, 0, (int)colorCount, KMeansAssignGrain, assign);
+		} else {
+			assign(0, (int)colorCount);
+		}
+		if (!changed) {
+			break;
+		}
+		for (int j = 0; j < k; ++j) {
+			sums[j] = glm::u64vec4(0u);
+			weights[j] = 0u;
+		}
+		for (size_t i = 0; i < colorCount; ++i) {
+			const RGBA c = colors[i].color;
+			const uint64_t w = colors[i].count;
+			sums[assignment[i]] += glm::u64vec4(c.r, c.g, c.b, c.a) * w;
+			weights[assignment[i]] += w;
+		}
+		for (int j = 0; j < k; ++j) {
+			const uint64_t w = weights[j];
+			if (w == 0u) {
+				// empty clusters keep their seed
+				continue;
+			}
+			centers[j] = glm::ivec4((sums[j] + w / 2u) / w);
 		}
 	}
 
-	size_t n = 0;
-	for (const glm::vec4 &c : centers) {
-		targetBuf[n++] = core::Color::getRGBA(c);
+	for (int i = 0; i < k; ++i) {
+		targetBuf[i] = RGBA(centers[i].r, centers[i].g, centers[i].b, centers[i].a);
 	}
-	for (size_t i = n; i < maxTargetBufColors; ++i) {
+	for (size_t i = k; i < maxTargetBufColors; ++i) {
 		targetBuf[i] = RGBA(0xFFFFFFFFU);
 	}
-	return (int)n;
+	return k;
 }
 
 static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
@@ -441,7 +611,8 @@ void Color::quantize(RGBA *buf, size_t bufSize, int bitsPerChannel) {
 	}
 }
 
-int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors, ColorReductionType type) {
+int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors, ColorReductionType type,
+					ThreadPool *pool) {
 	if (inputBufColors <= maxTargetBufColors) {
 		size_t n;
 		for (n = 0; n < inputBufColors; ++n) {
@@ -456,7 +627,7 @@ int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inpu
 	case ColorReductionType::Wu:
 		return quantizeWu(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
 	case ColorReductionType::KMeans:
-		return quantizeKMeans(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+		return quantizeKMeans(targetBuf, maxTargetBufColors, inputBuf, inputBufColors, pool);
 	case ColorReductionType::Octree:
 		return quantizeOctree(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
 	default:
@@ -552,7 +723,11 @@ float Color::getDistance(const glm::vec4 &color, float hue, float saturation, fl
 	float csaturation;
 	float cbrightness;
 	core::Color::getHSB(color, chue, csaturation, cbrightness);
+	return getDistance(chue, csaturation, cbrightness, hue, saturation, brightness);
+}
 
+float Color::getDistance(float chue, float csaturation, float cbrightness, float hue, float saturation,
+						 float brightness) {
 	const float weightHue = 0.8f;
 	const float weightSaturation = 0.1f;
 	const float weightValue = 0.1f;
@@ -12,6 +12,8 @@
 
 namespace core {
 
+class ThreadPool;
+
 class Color {
 public:
 	static const uint32_t magnitude = 255;
@@ -49,6 +51,11 @@ public:
 	static float getDistance(RGBA rgba, RGBA rgba2);
 	static float getDistance(const glm::vec4& color, float hue, float saturation, float brightness);
 	static float getDistance(RGBA color, float hue, float saturation, float brightness);
+	/**
+	 * @brief The weighted distance of two colors in the HSB color space
+	 */
+	static float getDistance(float chue, float csaturation, float cbrightness, float hue, float saturation,
+							 float brightness);
 
 	/**
 	 * @brief Get the nearest matching color index from the list
@@ -98,9 +105,11 @@ public:
 	static const char* toColorReductionTypeString(Color::ColorReductionType type);
 
 	/**
+	 * @param pool Optional pool to distribute the per color work of the reduction types that support it (KMeans)
+	 * over. The result is the same with and without a pool.
 	 * @return @c -1 on error or the amount of @code colors <= maxTargetBufColors @endcode
 	 */
-	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, ColorReductionType type = ColorReductionType::MedianCut);
+	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, ColorReductionType type = ColorReductionType::MedianCut, ThreadPool *pool = nullptr);
 	static void quantize(RGBA *buf, size_t bufSize, int bitsPerChannel);
 
 	static glm::vec4 fromRGBA(const RGBA rgba);
@@ -55,6 +55,7 @@ constexpr const char *AppHomePath = "app_homepath";
 constexpr const char *VoxelPalette = "palette";
 constexpr const char *VoxelCreatePalette = "voxformat_createpalette";
 constexpr const char *VoxformatMergequads = "voxformat_mergequads";
+constexpr const char *VoxformatGreedyMerge = "voxformat_greedymerge";
 constexpr const char *VoxformatMarchingCubes = "voxformat_marchingcubes";
 constexpr const char *VoxformatReusevertices = "voxformat_reusevertices";
 constexpr const char *VoxformatAmbientocclusion = "voxformat_ambientocclusion";
@@ -75,5 +76,6 @@ constexpr const char *VoxformatQBTMergeCompounds = "voxformat_qbtmergecompounds"
 constexpr const char *VoxformatVOXCreateLayers = "voxformat_voxcreatelayers";
 constexpr const char *VoxformatVOXCreateGroups = "voxformat_voxcreategroups";
 constexpr const char *VoxformatQBSaveLeftHanded = "voxformat_qbsavelefthanded";
+constexpr const char *VoxformatVENGIParallelZip = "voxformat_vengiparallelzip";
 
 }
@@ -1,8 +1,13 @@
 #include "app/benchmark/AbstractBenchmark.h"
 #include "core/collection/Map.h"
+#include "core/collection/FlatMap.h"
+#include "core/collection/DynamicArray.h"
 #include "core/Assert.h"
+#include "core/GLM.h"
+#include "core/String.h"
 #include <unordered_map>
 #include <map>
+#include <vector>
 
 class MapBenchmark: public app::AbstractBenchmark {
 };
@@ -53,8 +58,109 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+BENCHMARK_DEFINE_F(MapBenchmark, compareToFlatMapCore) (benchmark::State& state) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (auto _ : state) {
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+			int64_t value;
+			const bool found = map.get(i, value);
+			if (!found || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+// similar to the position map that is used to voxelize meshes
+template<class MAP>
+static void insertIVec3(benchmark::State& state, MAP &map) {
+	const int n = (int)state.range(0);
+	for (int i = 0; i < n; ++i) {
+		const glm::ivec3 p(i % 97, (i / 97) % 89, i / (97 * 89));
+		map.put(p, i);
+	}
+	for (int i = 0; i < n; ++i) {
+		const glm::ivec3 p(i % 97, (i / 97) % 89, i / (97 * 89));
+		auto iter = map.find(p);
+		if (iter == map.end() || iter->value != i) {
+			state.SkipWithError("Failed!");
+			break;
+		}
+	}
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, insertIVec3MapCore) (benchmark::State& state) {
+	for (auto _ : state) {
+		core::Map<glm::ivec3, int, 64, glm::hash<glm::ivec3>> map((int)state.range(0));
+		insertIVec3(state, map);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, insertIVec3FlatMapCore) (benchmark::State& state) {
+	for (auto _ : state) {
+		core::FlatMap<glm::ivec3, int, glm::hash<glm::ivec3>> map;
+		insertIVec3(state, map);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+class DynamicArrayBenchmark: public app::AbstractBenchmark {
+};
+
+// same size as a mesh vertex
+struct DynamicArrayVertex {
+	float x, y, z;
+	uint8_t info[4];
+};
+
+template<class ARRAY>
+static void pushBack(benchmark::State& state) {
+	for (auto _ : state) {
+		ARRAY array;
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			array.push_back(typename ARRAY::value_type());
+		}
+		benchmark::DoNotOptimize(array.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(DynamicArrayBenchmark, pushBackLinear) (benchmark::State& state) {
+	pushBack<core::DynamicArray<DynamicArrayVertex, 32, core::DynamicArrayGrowth::Linear>>(state);
+}
+
+BENCHMARK_DEFINE_F(DynamicArrayBenchmark, pushBackGeometric) (benchmark::State& state) {
+	pushBack<core::DynamicArray<DynamicArrayVertex, 32, core::DynamicArrayGrowth::Geometric>>(state);
+}
+
+BENCHMARK_DEFINE_F(DynamicArrayBenchmark, pushBackVectorStd) (benchmark::State& state) {
+	pushBack<std::vector<DynamicArrayVertex>>(state);
+}
+
+BENCHMARK_DEFINE_F(DynamicArrayBenchmark, pushBackStringLinear) (benchmark::State& state) {
+	pushBack<core::DynamicArray<core::String, 32, core::DynamicArrayGrowth::Linear>>(state);
+}
+
+BENCHMARK_DEFINE_F(DynamicArrayBenchmark, pushBackStringGeometric) (benchmark::State& state) {
+	pushBack<core::DynamicArray<core::String, 32, core::DynamicArrayGrowth::Geometric>>(state);
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, compareToFlatMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, insertIVec3MapCore)->RangeMultiplier(8)->Range(512, 1 << 15);
+BENCHMARK_REGISTER_F(MapBenchmark, insertIVec3FlatMapCore)->RangeMultiplier(8)->Range(512, 1 << 15);
+
+BENCHMARK_REGISTER_F(DynamicArrayBenchmark, pushBackLinear)->RangeMultiplier(8)->Range(512, 1 << 15);
+BENCHMARK_REGISTER_F(DynamicArrayBenchmark, pushBackGeometric)->RangeMultiplier(8)->Range(512, 1 << 15);
+BENCHMARK_REGISTER_F(DynamicArrayBenchmark, pushBackVectorStd)->RangeMultiplier(8)->Range(512, 1 << 15);
+BENCHMARK_REGISTER_F(DynamicArrayBenchmark, pushBackStringLinear)->RangeMultiplier(8)->Range(512, 1 << 15);
+BENCHMARK_REGISTER_F(DynamicArrayBenchmark, pushBackStringGeometric)->RangeMultiplier(8)->Range(512, 1 << 15);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ArrayLength.h"
+#include "core/Color.h"
+#include "core/collection/Buffer.h"
+
+/**
+ * @brief The range argument is the amount of input pixels - they are reduced to a palette of 256 colors
+ */
+class ColorBenchmark : public app::AbstractBenchmark {
+protected:
+	core::Buffer<core::RGBA> _pixels;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int64_t n = state.range(0);
+		_pixels.resize((size_t)n);
+		uint32_t seed = 42u;
+		for (int64_t i = 0; i < n; ++i) {
+			seed = seed * 1664525u + 1013904223u;
+			// a limited amount of unique colors like in a texture
+			_pixels[i] = core::RGBA((seed >> 8) & 0xF8, (seed >> 16) & 0xF8, (seed >> 24) & 0xF8, 255);
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(ColorBenchmark, QuantizeKMeans)(benchmark::State &state) {
+	core::RGBA targetBuf[256];
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(core::Color::quantize(targetBuf, lengthof(targetBuf), _pixels.data(), _pixels.size(),
+													   core::Color::ColorReductionType::KMeans));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(ColorBenchmark, QuantizeMedianCut)(benchmark::State &state) {
+	core::RGBA targetBuf[256];
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(core::Color::quantize(targetBuf, lengthof(targetBuf), _pixels.data(), _pixels.size(),
+													   core::Color::ColorReductionType::MedianCut));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(ColorBenchmark, QuantizeKMeans)->RangeMultiplier(8)->Range(4096, 262144);
+BENCHMARK_REGISTER_F(ColorBenchmark, QuantizeMedianCut)->RangeMultiplier(8)->Range(4096, 262144);
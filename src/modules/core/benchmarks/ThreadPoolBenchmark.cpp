@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ParallelFor.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/collection/DynamicArray.h"
+#include <future>
+
+/**
+ * @brief The first range argument is the amount of worker threads, the second one the amount of tasks or elements
+ */
+class ThreadPoolBenchmark : public app::AbstractBenchmark {
+protected:
+	// a few hundred nanoseconds of work to get fine grained tasks
+	static uint32_t work(uint32_t seed) {
+		for (int i = 0; i < 64; ++i) {
+			seed = seed * 1664525u + 1013904223u;
+		}
+		return seed;
+	}
+};
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, EnqueueFutures)(benchmark::State &state) {
+	core::ThreadPool pool((size_t)state.range(0));
+	pool.init();
+	const int tasks = (int)state.range(1);
+	core::AtomicInt sum{0};
+	for (auto _ : state) {
+		core::DynamicArray<std::future<void>> futures;
+		futures.reserve(tasks);
+		for (int i = 0; i < tasks; ++i) {
+			futures.emplace_back(pool.enqueue([&sum, i]() { sum.increment((int)(work(i) & 1u)); }));
+		}
+		for (std::future<void> &future : futures) {
+			future.wait();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, TaskGroup)(benchmark::State &state) {
+	core::ThreadPool pool((size_t)state.range(0));
+	pool.init();
+	const int tasks = (int)state.range(1);
+	core::AtomicInt sum{0};
+	for (auto _ : state) {
+		core::TaskGroup group(pool);
+		for (int i = 0; i < tasks; ++i) {
+			group.run([&sum, i]() { sum.increment((int)(work(i) & 1u)); });
+		}
+		group.wait();
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+// tasks that are spawned from the workers end up in their own queues and are stolen by the others
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, NestedTaskGroup)(benchmark::State &state) {
+	core::ThreadPool pool((size_t)state.range(0));
+	pool.init();
+	const int tasks = (int)state.range(1);
+	const int outer = 16;
+	core::AtomicInt sum{0};
+	for (auto _ : state) {
+		core::TaskGroup group(pool);
+		for (int o = 0; o < outer; ++o) {
+			group.run([&]() {
+				core::TaskGroup inner(pool);
+				for (int i = 0; i < tasks / outer; ++i) {
+					inner.run([&sum, i]() { sum.increment((int)(work(i) & 1u)); });
+				}
+				inner.wait();
+			});
+		}
+		group.wait();
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, ParallelFor)(benchmark::State &state) {
+	core::ThreadPool pool((size_t)state.range(0));
+	pool.init();
+	const int elements = (int)state.range(1);
+	core::DynamicArray<uint32_t> values;
+	values.resize(elements);
+	for (auto _ : state) {
+		core::parallel_for(pool, 0, elements, 64, [&](int start, int end) {
+			for (int i = start; i < end; ++i) {
+				values[i] = work(i);
+			}
+		});
+		benchmark::DoNotOptimize(values.data());
+	}
+	state.SetItemsProcessed(state.iterations() * elements);
+}
+
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, EnqueueFutures)->RangeMultiplier(2)->Ranges({{1, 8}, {10000, 10000}});
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, TaskGroup)->RangeMultiplier(2)->Ranges({{1, 8}, {10000, 10000}});
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, NestedTaskGroup)->RangeMultiplier(2)->Ranges({{1, 8}, {10000, 10000}});
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, ParallelFor)->RangeMultiplier(2)->Ranges({{1, 8}, {100000, 100000}});
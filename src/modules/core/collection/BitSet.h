@@ -2,6 +2,8 @@
  * @file
  */
 
+#pragma once
+
 #include "core/Assert.h"
 #include "core/StandardLib.h"
 #include <limits.h>
@@ -11,20 +11,34 @@
 #include <cstdint> // intptr_t - not available in stdint.h
 #include <new>
 #include <initializer_list>
+#include <type_traits>
 
 namespace core {
 
+/**
+ * @brief The strategy a @c DynamicArray uses to grow its capacity once it is exceeded
+ */
+enum class DynamicArrayGrowth {
+	/** allocate new slots given by the @c INCREASE template parameter - O(n²) copies for n insertions */
+	Linear,
+	/** double the capacity - amortized constant time insertions */
+	Geometric
+};
+
 /**
  * @brief Dynamically growing continuous storage buffer
  *
  * @note This array does not have an upper size limit. Each time the capacity is reached, it will
- * allocate new slots given by the @c INCREASE template parameter.
+ * grow according to the @c GROWTH template parameter. The capacity is always a multiple of the
+ * @c INCREASE template parameter.
+ *
+ * @note Trivially copyable types are relocated with a memcpy when the buffer grows.
  *
  * @note Use a fixed size array to prevent memory allocations - where possible
  * @sa Array
  * @ingroup Collections
  */
-template<class TYPE, size_t INCREASE = 32u>
+template<class TYPE, size_t INCREASE = 32u, DynamicArrayGrowth GROWTH = DynamicArrayGrowth::Geometric>
 class DynamicArray {
 private:
 	TYPE* _buffer = nullptr;
@@ -36,18 +50,32 @@ private:
 		return (size_t)((val + len) & ~len);
 	}
 
+	void reallocate(size_t capacity) {
+		_capacity = capacity;
+		TYPE* newBuffer = (TYPE*)core_aligned_malloc(_capacity * sizeof(TYPE));
+		if constexpr (std::is_trivially_copyable<TYPE>::value) {
+			if (_size > 0u) {
+				core_memcpy((void*)newBuffer, (const void*)_buffer, _size * sizeof(TYPE));
+			}
+		} else {
+			for (size_t i = 0u; i < _size; ++i) {
+				new ((void*)&newBuffer[i]) TYPE(core::move(_buffer[i]));
+				_buffer[i].~TYPE();
+			}
+		}
+		core_aligned_free(_buffer);
+		_buffer = newBuffer;
+	}
+
 	void checkBufferSize(size_t newSize) {
 		if (_capacity >= newSize) {
 			return;
 		}
-		_capacity = align(newSize);
-		TYPE* newBuffer = (TYPE*)core_aligned_malloc(_capacity * sizeof(TYPE));
-		for (size_t i = 0u; i < _size; ++i) {
-			new ((void*)&newBuffer[i]) TYPE(core::move(_buffer[i]));
-			_buffer[i].~TYPE();
+		size_t capacity = align(newSize);
+		if constexpr (GROWTH == DynamicArrayGrowth::Geometric) {
+			capacity = core_max(capacity, align(_capacity * 2u));
 		}
-		core_aligned_free(_buffer);
-		_buffer = newBuffer;
+		reallocate(capacity);
 	}
 public:
 	using value_type = TYPE;
@@ -334,8 +362,14 @@ public:
 		return _buffer[_size - 1u];
 	}
 
+	/**
+	 * @note Unlike the automatic growth, this allocates exactly the needed (aligned) capacity
+	 */
 	void reserve(size_t size) {
-		checkBufferSize(size);
+		if (_capacity >= size) {
+			return;
+		}
+		reallocate(align(size));
 	}
 
 	void insert(size_t size, TYPE type) {
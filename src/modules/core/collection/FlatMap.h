@@ -0,0 +1,402 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/collection/Map.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <initializer_list>
+
+namespace core {
+
+/**
+ * @brief Open addressing hash map with robin hood probing
+ *
+ * Unlike @c Map there is no fixed bucket count and no fixed capacity. All entries live in one continuous
+ * buffer and the table is rehashed to the double size once the load factor exceeds 7/8. This keeps the
+ * probe sequences short even for millions of entries.
+ *
+ * @note Inserting or removing entries invalidates iterators and pointers to entries.
+ * @sa Map
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class FlatMap {
+public:
+	using value_type = VALUETYPE;
+	using key_type = KEYTYPE;
+
+	struct KeyValue {
+		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
+				key(_key), value(_value) {
+		}
+
+		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
+				key(_key), value(core::forward<VALUETYPE>(_value)) {
+		}
+
+		KEYTYPE key;
+		VALUETYPE value;
+	};
+private:
+	/**
+	 * probe distance + 1 of the entry in a slot - @c 0 marks an empty slot
+	 */
+	using Distance = uint8_t;
+	static constexpr Distance MaxDistance = 255u;
+	static constexpr size_t MinCapacity = 16u;
+
+	KeyValue *_entries = nullptr;
+	Distance *_distances = nullptr;
+	// always a power of two
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	int _shift = 64;
+	HASHER _hasher;
+
+	inline size_t homeSlot(const KEYTYPE& key) const {
+		// fibonacci hashing - spreads the bits of hashers that just return the key value
+		const uint64_t hash = (uint64_t)_hasher(key) * UINT64_C(11400714819323198485);
+		return (size_t)(hash >> _shift);
+	}
+
+	inline size_t nextSlot(size_t idx) const {
+		return (idx + 1u) & (_capacity - 1u);
+	}
+
+	static inline void swapEntries(KeyValue &a, KeyValue &b) {
+		KeyValue tmp(core::move(a));
+		a = core::move(b);
+		b = core::move(tmp);
+	}
+
+	size_t findSlot(const KEYTYPE& key) const {
+		if (_size == 0u) {
+			return _capacity;
+		}
+		size_t idx = homeSlot(key);
+		for (Distance dist = 1u;; ++dist) {
+			const Distance d = _distances[idx];
+			if (d < dist) {
+				// either empty or an entry that is closer to its home slot - the key can't be stored after this
+				return _capacity;
+			}
+			if (d == dist && COMPARE()(_entries[idx].key, key)) {
+				return idx;
+			}
+			idx = nextSlot(idx);
+		}
+	}
+
+	void rehash(size_t capacity) {
+		KeyValue *oldEntries = _entries;
+		Distance *oldDistances = _distances;
+		const size_t oldCapacity = _capacity;
+
+		_capacity = capacity;
+		_shift = 64;
+		for (size_t c = _capacity; c > 1u; c >>= 1u) {
+			--_shift;
+		}
+		_entries = (KeyValue *)core_malloc(_capacity * sizeof(KeyValue));
+		_distances = (Distance *)core_malloc(_capacity * sizeof(Distance));
+		core_memset(_distances, 0, _capacity * sizeof(Distance));
+		_size = 0u;
+
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (oldDistances[i] == 0u) {
+				continue;
+			}
+			insertNew(core::move(oldEntries[i]));
+			oldEntries[i].~KeyValue();
+		}
+		core_free(oldEntries);
+		core_free(oldDistances);
+	}
+
+	void grow() {
+		rehash(_capacity == 0u ? MinCapacity : _capacity * 2u);
+	}
+
+	inline bool exceedsLoadFactor(size_t size) const {
+		return size * 8u > _capacity * 7u;
+	}
+
+	/**
+	 * @brief Robin hood insertion - the key must not yet be part of the map
+	 */
+	void insertNew(KeyValue&& entry) {
+		if (exceedsLoadFactor(_size + 1u)) {
+			grow();
+		}
+		KeyValue carry(core::move(entry));
+		size_t idx = homeSlot(carry.key);
+		Distance dist = 1u;
+		for (;;) {
+			if (_distances[idx] == 0u) {
+				new ((void *)&_entries[idx]) KeyValue(core::move(carry));
+				_distances[idx] = dist;
+				++_size;
+				return;
+			}
+			if (_distances[idx] < dist) {
+				swapEntries(carry, _entries[idx]);
+				core::exchange(dist, _distances[idx]);
+			}
+			idx = nextSlot(idx);
+			if (++dist == MaxDistance) {
+				// very unlikely with a sane hash function - but the distance must fit into the slot metadata
+				grow();
+				insertNew(core::move(carry));
+				return;
+			}
+		}
+	}
+
+	void eraseSlot(size_t idx) {
+		_entries[idx].~KeyValue();
+		// backward shift deletion - no tombstones needed
+		size_t next = nextSlot(idx);
+		while (_distances[next] > 1u) {
+			new ((void *)&_entries[idx]) KeyValue(core::move(_entries[next]));
+			_entries[next].~KeyValue();
+			_distances[idx] = _distances[next] - 1u;
+			idx = next;
+			next = nextSlot(next);
+		}
+		_distances[idx] = 0u;
+		--_size;
+	}
+
+	void copyFrom(const FlatMap& other) {
+		reserve(other._size);
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+	void release() {
+		clear();
+		core_free(_entries);
+		core_free(_distances);
+		_entries = nullptr;
+		_distances = nullptr;
+		_capacity = 0u;
+		_shift = 64;
+	}
+public:
+	FlatMap(std::initializer_list<KeyValue> other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+	/**
+	 * @param[in] initialSize The amount of entries the map can hold before it is rehashed the first time
+	 */
+	FlatMap(size_t initialSize = 0u) {
+		reserve(initialSize);
+	}
+
+	FlatMap(const FlatMap& other) {
+		copyFrom(other);
+	}
+
+	FlatMap(FlatMap&& other) noexcept {
+		_entries = other._entries;
+		_distances = other._distances;
+		_capacity = other._capacity;
+		_size = other._size;
+		_shift = other._shift;
+		_hasher = other._hasher;
+		other._entries = nullptr;
+		other._distances = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		other._shift = 64;
+	}
+
+	~FlatMap() {
+		release();
+	}
+
+	FlatMap &operator=(FlatMap &&other) noexcept {
+		if (this != &other) {
+			release();
+			_entries = other._entries;
+			_distances = other._distances;
+			_capacity = other._capacity;
+			_size = other._size;
+			_shift = other._shift;
+			_hasher = other._hasher;
+			other._entries = nullptr;
+			other._distances = nullptr;
+			other._capacity = 0u;
+			other._size = 0u;
+			other._shift = 64;
+		}
+		return *this;
+	}
+
+	FlatMap& operator=(const FlatMap& other) {
+		if (this != &other) {
+			clear();
+			copyFrom(other);
+		}
+		return *this;
+	}
+
+	class iterator {
+	private:
+		const FlatMap* _map;
+		size_t _slot;
+
+		void skipEmpty() {
+			while (_slot < _map->_capacity && _map->_distances[_slot] == 0u) {
+				++_slot;
+			}
+		}
+	public:
+		constexpr iterator() :
+			_map(nullptr), _slot(0) {
+		}
+
+		iterator(const FlatMap* map, size_t slot) :
+				_map(map), _slot(slot) {
+			skipEmpty();
+		}
+
+		inline KeyValue* operator*() const {
+			return &_map->_entries[_slot];
+		}
+
+		iterator& operator++() {
+			++_slot;
+			skipEmpty();
+			return *this;
+		}
+
+		inline KeyValue* operator->() const {
+			return &_map->_entries[_slot];
+		}
+
+		inline bool operator!=(const iterator& rhs) const {
+			return _slot != rhs._slot;
+		}
+
+		inline bool operator==(const iterator& rhs) const {
+			return _slot == rhs._slot;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @return The amount of slots - the map is rehashed before all of them are used
+	 */
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Make sure that the given amount of entries can be stored without rehashing
+	 */
+	void reserve(size_t size) {
+		if (size == 0u || !exceedsLoadFactor(size)) {
+			return;
+		}
+		size_t capacity = _capacity == 0u ? MinCapacity : _capacity;
+		while (size * 8u > capacity * 7u) {
+			capacity *= 2u;
+		}
+		rehash(capacity);
+	}
+
+	bool get(const KEYTYPE& key, VALUETYPE& value) const {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		value = _entries[idx].value;
+		return true;
+	}
+
+	bool hasKey(const KEYTYPE& key) const {
+		return findSlot(key) != _capacity;
+	}
+
+	iterator find(const KEYTYPE& key) const {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return end();
+		}
+		return iterator(this, idx);
+	}
+
+	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
+		const size_t idx = findSlot(key);
+		if (idx != _capacity) {
+			_entries[idx].value = core::forward<VALUETYPE>(value);
+			return;
+		}
+		insertNew(KeyValue(key, core::forward<VALUETYPE>(value)));
+	}
+
+	void put(const KEYTYPE& key, const VALUETYPE& value) {
+		const size_t idx = findSlot(key);
+		if (idx != _capacity) {
+			_entries[idx].value = value;
+			return;
+		}
+		insertNew(KeyValue(key, value));
+	}
+
+	iterator begin() const {
+		return iterator(this, 0u);
+	}
+
+	iterator end() const {
+		return iterator(this, _capacity);
+	}
+
+	/**
+	 * @note Keeps the capacity
+	 */
+	void clear() {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				_entries[i].~KeyValue();
+				_distances[i] = 0u;
+			}
+		}
+		_size = 0u;
+	}
+
+	inline void erase(const iterator& iter) {
+		remove(iter->key);
+	}
+
+	bool remove(const KEYTYPE& key) {
+		const size_t idx = findSlot(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		eraseSlot(idx);
+		return true;
+	}
+};
+
+}
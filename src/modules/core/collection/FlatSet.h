@@ -0,0 +1,45 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/FlatMap.h"
+
+namespace core {
+
+/**
+ * @brief Set on top of the open addressing @c FlatMap
+ * @sa Set
+ * @ingroup Collections
+ */
+template<class T, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class FlatSet : public FlatMap<T, bool, HASHER, COMPARE> {
+private:
+	using Super = FlatMap<T, bool, HASHER, COMPARE>;
+public:
+	FlatSet(size_t initialSize = 0u) : Super(initialSize) {
+	}
+
+	bool insert(const T& key) {
+		if (has(key)) {
+			return false;
+		}
+		this->put(key, true);
+		return true;
+	}
+
+	template<class ITER>
+	void insert(ITER first, ITER last) {
+		while (first != last) {
+			this->put(*first, true);
+			++first;
+		}
+	}
+
+	inline bool has(const T& key) const {
+		return this->hasKey(key);
+	}
+};
+
+}
@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/concurrent/ThreadPool.h"
+
+namespace core {
+
+/**
+ * @brief Executes @c func(start, end) for consecutive sub ranges of @c [begin, end) with at most @c grain elements
+ *
+ * The calling thread works on the range, too. Some pool tasks pull the remaining sub ranges from a shared counter
+ * until all of them are handed out - a slow sub range doesn't stall the others. This is fine to be used from a
+ * worker of the pool.
+ *
+ * @note The sub ranges are executed in any order and concurrently - use the start of the sub range to store the
+ * results if the order matters.
+ */
+template<class F>
+void parallel_for(ThreadPool &pool, int begin, int end, int grain, F &&func) {
+	if (end <= begin) {
+		return;
+	}
+	grain = core_max(1, grain);
+	const int ranges = (end - begin - 1) / grain + 1;
+	if (ranges == 1 || pool.size() == 0) {
+		func(begin, end);
+		return;
+	}
+	core::AtomicInt next{0};
+	auto work = [&]() {
+		for (;;) {
+			const int range = next.increment();
+			if (range >= ranges) {
+				break;
+			}
+			const int start = begin + range * grain;
+			func(start, core_min(end, start + grain));
+		}
+	};
+	TaskGroup group(pool);
+	const int helpers = core_min((int)pool.size(), ranges - 1);
+	for (int i = 0; i < helpers; ++i) {
+		group.run(work);
+	}
+	work();
+	group.wait();
+}
+
+} // namespace core
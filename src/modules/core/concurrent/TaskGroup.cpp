@@ -0,0 +1,33 @@
+/**
+ * @file
+ */
+
+#include "TaskGroup.h"
+
+namespace core {
+
+void TaskGroup::done() {
+	// the waiting thread might destroy the group as soon as it sees no pending tasks - so the counter is only
+	// modified while the lock is held, and wait() acquires the lock before returning
+	core::ScopedLock lock(_lock);
+	if (_pending.decrement() == 1) {
+		_condition.notify_all();
+	}
+}
+
+void TaskGroup::wait() {
+	while (_pending > 0) {
+		if (_pool.runPendingTask()) {
+			continue;
+		}
+		// the remaining tasks of this group are executed by other threads - sleep a bit, but check the pool for
+		// new tasks from time to time
+		core::ScopedLock lock(_lock);
+		if (_pending > 0) {
+			_condition.waitTimeout(_lock, 1);
+		}
+	}
+	core::ScopedLock lock(_lock);
+}
+
+} // namespace core
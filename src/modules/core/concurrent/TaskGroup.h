@@ -0,0 +1,65 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+
+namespace core {
+
+/**
+ * @brief Fork/join helper for the tasks of a ThreadPool
+ *
+ * Tasks are added with run() and wait() blocks until all of them are done. The waiting thread executes queued tasks
+ * of the pool in the meantime - so it's fine to use a task group from inside a worker of the same pool.
+ *
+ * @code
+ * core::TaskGroup group(threadPool);
+ * group.run([&]() { ... });
+ * group.run([&]() { ... });
+ * group.wait();
+ * @endcode
+ */
+class TaskGroup : public core::NonCopyable {
+private:
+	ThreadPool &_pool;
+	core::AtomicInt _pending{0};
+	core_trace_mutex(core::Lock, _lock, "TaskGroup");
+	core::ConditionVariable _condition;
+
+	void done();
+
+public:
+	explicit TaskGroup(ThreadPool &pool) : _pool(pool) {
+	}
+	~TaskGroup() {
+		wait();
+	}
+
+	/**
+	 * @brief Executes the functor on the pool - or in the calling thread if the pool is stopped
+	 */
+	template<class F>
+	void run(F &&f) {
+		_pending.increment();
+		std::function<void()> task = [this, func = core::forward<F>(f)]() mutable {
+			func();
+			done();
+		};
+		if (!_pool.schedule(core::move(task))) {
+			task();
+		}
+	}
+
+	/**
+	 * @brief Blocks until all tasks of this group are done and helps executing queued tasks of the pool meanwhile
+	 */
+	void wait();
+};
+
+} // namespace core
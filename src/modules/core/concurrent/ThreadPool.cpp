@@ -5,22 +5,167 @@
 #include "ThreadPool.h"
 #include "core/StringUtil.h"
 #include "core/Trace.h"
+#include "core/Common.h"
 #include "core/Log.h"
 #include "core/concurrent/Concurrency.h"
 
 namespace core {
 
+static thread_local const ThreadPool *_currentPool = nullptr;
+static thread_local size_t _currentWorker = 0;
+
+/**
+ * @brief Ring buffer of tasks - the owning worker takes the tasks from the back, all others from the front
+ */
+struct ThreadPool::TaskQueue {
+	core_trace_mutex(core::Lock, mutex, "ThreadPoolTaskQueue");
+	// the capacity is always a power of two
+	core::DynamicArray<std::function<void()>> tasks;
+	size_t head = 0;
+	size_t count = 0;
+
+	void reserve(size_t n) {
+		if (n <= tasks.size()) {
+			return;
+		}
+		size_t capacity = core_max((size_t)32, tasks.size());
+		while (capacity < n) {
+			capacity *= 2;
+		}
+		core::DynamicArray<std::function<void()>> newTasks;
+		newTasks.resize(capacity);
+		for (size_t i = 0; i < count; ++i) {
+			newTasks[i] = core::move(tasks[(head + i) & (tasks.size() - 1)]);
+		}
+		tasks = core::move(newTasks);
+		head = 0;
+	}
+
+	void push(std::function<void()> &&task) {
+		if (count == tasks.size()) {
+			reserve(count + 1);
+		}
+		tasks[(head + count) & (tasks.size() - 1)] = core::move(task);
+		++count;
+	}
+
+	bool popBack(std::function<void()> &task) {
+		if (count == 0) {
+			return false;
+		}
+		--count;
+		task = core::move(tasks[(head + count) & (tasks.size() - 1)]);
+		return true;
+	}
+
+	bool popFront(std::function<void()> &task) {
+		if (count == 0) {
+			return false;
+		}
+		task = core::move(tasks[head]);
+		head = (head + 1) & (tasks.size() - 1);
+		--count;
+		return true;
+	}
+
+	size_t clear() {
+		const size_t removed = count;
+		std::function<void()> task;
+		while (popFront(task)) {
+		}
+		return removed;
+	}
+};
+
 ThreadPool::ThreadPool(size_t threads, const char *name) :
 		_threads(threads), _name(name) {
 	if (_name == nullptr) {
 		_name = "ThreadPool";
 	}
+	_queues = new TaskQueue[_threads + 1];
+}
+
+void ThreadPool::reserve(size_t n) {
+	TaskQueue &queue = _queues[_threads];
+	core::ScopedLock lock(queue.mutex);
+	queue.reserve(n);
+}
+
+bool ThreadPool::schedule(std::function<void()> &&task) {
+	if (_stop) {
+		return false;
+	}
+	TaskQueue &queue = isWorkerThread() ? _queues[_currentWorker] : _queues[_threads];
+	{
+		core::ScopedLock lock(queue.mutex);
+		if (_stop) {
+			return false;
+		}
+		queue.push(core::move(task));
+	}
+	_pending.increment();
+	// only pay for the lock if a worker might be waiting - a worker that goes to sleep after this check sees the
+	// new pending task before it waits
+	if (_sleeping > 0) {
+		core::ScopedLock lock(_queueMutex);
+		_queueCondition.notify_one();
+	}
+	return true;
+}
+
+bool ThreadPool::popTask(std::function<void()> &task) {
+	if (_pending <= 0) {
+		return false;
+	}
+	const bool worker = isWorkerThread();
+	if (worker) {
+		TaskQueue &own = _queues[_currentWorker];
+		core::ScopedLock lock(own.mutex);
+		if (own.popBack(task)) {
+			_pending.decrement();
+			return true;
+		}
+	}
+	{
+		TaskQueue &shared = _queues[_threads];
+		core::ScopedLock lock(shared.mutex);
+		if (shared.popFront(task)) {
+			_pending.decrement();
+			return true;
+		}
+	}
+	// steal the oldest task of another worker - start with the next worker to spread the thieves
+	const size_t start = worker ? _currentWorker + 1 : 0;
+	for (size_t i = 0; i < _threads; ++i) {
+		const size_t victim = (start + i) % _threads;
+		if (worker && victim == _currentWorker) {
+			continue;
+		}
+		TaskQueue &queue = _queues[victim];
+		core::ScopedLock lock(queue.mutex);
+		if (queue.popFront(task)) {
+			_pending.decrement();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ThreadPool::runPendingTask() {
+	std::function<void()> task;
+	if (!popTask(task)) {
+		return false;
+	}
+	core_trace_scoped(ThreadPoolHelper);
+	task();
+	return true;
 }
 
 void ThreadPool::abort() {
-	core::ScopedLock lock(_queueMutex);
-	while (!_tasks.empty()) {
-		_tasks.pop();
+	for (size_t i = 0; i <= _threads; ++i) {
+		TaskQueue &queue = _queues[i];
+		core::ScopedLock lock(queue.mutex);
+		_pending.decrement((int)queue.clear());
 	}
 }
 
@@ -41,28 +186,31 @@ void ThreadPool::init() {
 				Log::debug("Failed to set thread name for pool thread %i", (int)i);
 			}
 			core_trace_thread(n.c_str());
+			_currentPool = this;
+			_currentWorker = i;
 			for (;;) {
 				std::function<void()> task;
-				{
+				if (!this->popTask(task)) {
 					core::ScopedLock lock(this->_queueMutex);
+					this->_sleeping.increment();
 					if (!this->_stop) {
 						this->_queueCondition.wait(this->_queueMutex, [this] {
 							// predicate must return false if the waiting should continue
 							if (this->_stop) {
 								return true;
 							}
-							if (!this->_tasks.empty()) {
+							if (this->_pending > 0) {
 								return true;
 							}
 							return false;
 						});
 					}
-					if (this->_stop && (this->_force || this->_tasks.empty())) {
+					this->_sleeping.decrement();
+					if (this->_stop && (this->_force || this->_pending <= 0)) {
 						Log::debug("Shutdown worker thread for %i", (int)i);
 						break;
 					}
-					task = core::move(this->_tasks.front());
-					this->_tasks.pop();
+					continue;
 				}
 
 				core_trace_begin_frame(n.c_str());
@@ -76,8 +224,13 @@ void ThreadPool::init() {
 	}
 }
 
+bool ThreadPool::isWorkerThread() const {
+	return _currentPool == this;
+}
+
 ThreadPool::~ThreadPool() {
 	shutdown();
+	delete[] _queues;
 }
 
 void ThreadPool::shutdown(bool wait) {
@@ -85,8 +238,11 @@ void ThreadPool::shutdown(bool wait) {
 		return;
 	}
 	_force = !wait;
-	_stop = true;
-	_queueCondition.notify_all();
+	{
+		core::ScopedLock lock(_queueMutex);
+		_stop = true;
+		_queueCondition.notify_all();
+	}
 	for (std::thread &worker : _workers) {
 		worker.join();
 	}
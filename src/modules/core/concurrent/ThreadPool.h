@@ -31,7 +31,6 @@
 #include <future>
 #include <functional>
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Queue.h"
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ConditionVariable.h"
@@ -40,6 +39,17 @@
 
 namespace core {
 
+/**
+ * @brief Work stealing thread pool
+ *
+ * Every worker has its own task queue. Tasks that are enqueued from a worker go into the queue of that worker and
+ * are executed in last in first out order by it. All other tasks go into a shared queue. Idle workers first look
+ * into their own queue, then into the shared queue and finally steal the oldest task from the queue of another
+ * worker.
+ *
+ * @sa TaskGroup
+ * @sa parallel_for()
+ */
 class ThreadPool final {
 public:
 	explicit ThreadPool(size_t, const char *name = nullptr);
@@ -51,7 +61,27 @@ public:
 	template<class F, class ... Args>
 	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+	/**
+	 * @brief Enqueue a task without the overhead of a future
+	 * @return @c false if the pool is stopped - the task is not moved in this case
+	 */
+	bool schedule(std::function<void()> &&task);
+
+	/**
+	 * @brief Executes one of the queued tasks in the calling thread
+	 *
+	 * Use this to help out while waiting for other tasks of the pool instead of blocking - this also avoids the
+	 * dead lock if all workers are waiting for tasks that are still queued.
+	 * @return @c false if there was no queued task
+	 */
+	bool runPendingTask();
+
 	size_t size() const;
+	/**
+	 * @return @c true if the calling thread is one of the workers of this pool. Waiting for the
+	 * futures of this pool from inside a task could dead lock if all workers are busy.
+	 */
+	bool isWorkerThread() const;
 	void init();
 	/**
 	 * @brief Remove queued and not yet executed tasks
@@ -62,12 +92,20 @@ public:
 
 	void reserve(size_t n);
 private:
+	struct TaskQueue;
+
+	bool popTask(std::function<void()> &task);
+
 	const size_t _threads;
 	const char *_name;
 	// need to keep track of threads so we can join them
 	core::DynamicArray<std::thread> _workers;
-	// the task queue
-	core::Queue<std::function<void()> > _tasks core_thread_guarded_by(_queueMutex);
+	// one queue per worker - the last one is the shared queue for tasks from other threads
+	TaskQueue *_queues = nullptr;
+	// the amount of queued tasks over all queues
+	core::AtomicInt _pending { 0 };
+	// the amount of workers that are waiting for the condition
+	core::AtomicInt _sleeping { 0 };
 
 	// synchronization
 	core_trace_mutex(core::Lock, _queueMutex, "ThreadPoolQueue");
@@ -76,11 +114,6 @@ private:
 	core::AtomicBool _force { false };
 };
 
-inline void ThreadPool::reserve(size_t n) {
-	core::ScopedLock lock(_queueMutex);
-	_tasks.reserve(n);
-}
-
 // add new work item to the pool
 template<class F, class ... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args)
@@ -93,14 +126,9 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
 	core::SharedPtr<std::packaged_task<return_type()> > task = core::make_shared<std::packaged_task<return_type()> >(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
 
 	std::future<return_type> res = task->get_future();
-	{
-		core::ScopedLock lock(_queueMutex);
-		if (_stop) {
-			return std::future<return_type>();
-		}
-		_tasks.emplace([task]() {(*task.get())();});
+	if (!schedule([task]() {(*task.get())();})) {
+		return std::future<return_type>();
 	}
-	_queueCondition.notify_one();
 	return res;
 }
 
@@ -22,4 +22,10 @@ TEST(BitsTest, extract1011) {
 	EXPECT_EQ(5u, bits(input, 1, 3));
 }
 
+TEST(BitsTest, countTrailingZeros) {
+	EXPECT_EQ(0, countTrailingZeros(1u));
+	EXPECT_EQ(3, countTrailingZeros(0b1000u));
+	EXPECT_EQ(63, countTrailingZeros(1ull << 63));
+}
+
 }
@@ -8,6 +8,7 @@
 #include "core/ArrayLength.h"
 #include "core/StringUtil.h"
 #include "core/collection/BufferView.h"
+#include "core/concurrent/ThreadPool.h"
 #include <SDL_endian.h>
 
 namespace core {
@@ -119,6 +120,56 @@ TEST(ColorTest, testQuantize) {
 	EXPECT_EQ(256, n) << "Failed with k-means.\n" << core::BufferView<RGBA>(targetBuf, n) << "\n" << core::BufferView<RGBA>(buf, lengthof(buf));
 }
 
+TEST(ColorTest, testQuantizeKMeansReproducible) {
+	// a gradient with more unique colors than the target palette can hold
+	core::RGBA buf[64 * 64];
+	for (int y = 0; y < 64; ++y) {
+		for (int x = 0; x < 64; ++x) {
+			buf[y * 64 + x] = core::RGBA(x * 4, y * 4, (x + y) * 2, 255);
+		}
+	}
+	core::RGBA targetBuf1[32];
+	core::RGBA targetBuf2[32];
+	const int n1 = core::Color::quantize(targetBuf1, lengthof(targetBuf1), buf, lengthof(buf), core::Color::ColorReductionType::KMeans);
+	const int n2 = core::Color::quantize(targetBuf2, lengthof(targetBuf2), buf, lengthof(buf), core::Color::ColorReductionType::KMeans);
+	ASSERT_GT(n1, 0);
+	ASSERT_EQ(n1, n2);
+	for (int i = 0; i < n1; ++i) {
+		EXPECT_EQ(targetBuf1[i], targetBuf2[i]) << "color " << i << " differs";
+	}
+}
+
+TEST(ColorTest, testQuantizeKMeansPool) {
+	// enough unique colors to split the assignment step into several tasks
+	core::RGBA buf[64 * 64];
+	for (int y = 0; y < 64; ++y) {
+		for (int x = 0; x < 64; ++x) {
+			buf[y * 64 + x] = core::RGBA(x * 4, y * 4, (x + y) * 2, 255);
+		}
+	}
+	core::ThreadPool pool(3);
+	pool.init();
+	core::RGBA targetBuf1[32];
+	core::RGBA targetBuf2[32];
+	const int n1 = core::Color::quantize(targetBuf1, lengthof(targetBuf1), buf, lengthof(buf), core::Color::ColorReductionType::KMeans);
+	const int n2 = core::Color::quantize(targetBuf2, lengthof(targetBuf2), buf, lengthof(buf), core::Color::ColorReductionType::KMeans, &pool);
+	ASSERT_GT(n1, 0);
+	ASSERT_EQ(n1, n2);
+	for (int i = 0; i < n1; ++i) {
+		EXPECT_EQ(targetBuf1[i], targetBuf2[i]) << "color " << i << " differs";
+	}
+}
+
+TEST(ColorTest, testQuantizeKMeansFewUniqueColors) {
+	const core::RGBA buf[] = {core::RGBA(255, 0, 0), core::RGBA(0, 255, 0), core::RGBA(255, 0, 0), core::RGBA(0, 0, 255)};
+	core::RGBA targetBuf[3];
+	const int n = core::Color::quantize(targetBuf, lengthof(targetBuf), buf, lengthof(buf), core::Color::ColorReductionType::KMeans);
+	ASSERT_EQ(3, n);
+	EXPECT_EQ(core::RGBA(255, 0, 0), targetBuf[0]);
+	EXPECT_EQ(core::RGBA(0, 255, 0), targetBuf[1]);
+	EXPECT_EQ(core::RGBA(0, 0, 255), targetBuf[2]);
+}
+
 TEST(ColorTest, testClosestMatchExact) {
 	const glm::vec4 color(0.5f, 0.5f, 0.5f, 1.0f);
 	const std::vector<glm::vec4>& colors {
@@ -20,8 +20,8 @@ struct DynamicArrayStruct {
 	int _bar;
 };
 
-template<size_t SIZE>
-::std::ostream& operator<<(::std::ostream& ostream, const DynamicArray<DynamicArrayStruct, SIZE>& v) {
+template<size_t SIZE, DynamicArrayGrowth GROWTH>
+::std::ostream& operator<<(::std::ostream& ostream, const DynamicArray<DynamicArrayStruct, SIZE, GROWTH>& v) {
 	int idx = 0;
 	for (auto i = v.begin(); i != v.end();) {
 		ostream << "'";
@@ -120,6 +120,38 @@ TEST(DynamicArrayTest, testTriggerResize) {
 	EXPECT_EQ(4u, array.capacity()) << array;
 }
 
+TEST(DynamicArrayTest, testGeometricGrowth) {
+	DynamicArray<int> array;
+	for (int i = 0; i < 1000; ++i) {
+		array.push_back(i);
+	}
+	EXPECT_EQ(1024u, array.capacity());
+	for (int i = 0; i < 1000; ++i) {
+		ASSERT_EQ(i, array[i]);
+	}
+}
+
+TEST(DynamicArrayTest, testLinearGrowth) {
+	DynamicArray<DynamicArrayStruct, 32, DynamicArrayGrowth::Linear> array;
+	for (int i = 0; i < 128; ++i) {
+		array.push_back(DynamicArrayStruct("", i));
+	}
+	EXPECT_EQ(128u, array.capacity()) << array;
+	array.push_back(DynamicArrayStruct("", 128));
+	EXPECT_EQ(160u, array.capacity()) << array;
+	for (int i = 0; i < 129; ++i) {
+		ASSERT_EQ(i, array[i]._bar) << array;
+	}
+}
+
+TEST(DynamicArrayTest, testReserveExact) {
+	DynamicArray<int> array;
+	array.reserve(64);
+	EXPECT_EQ(64u, array.capacity());
+	array.reserve(65);
+	EXPECT_EQ(96u, array.capacity());
+}
+
 TEST(DynamicArrayTest, testResize) {
 	DynamicArray<DynamicArrayStruct, 2> array;
 	array.push_back(DynamicArrayStruct("", 1));
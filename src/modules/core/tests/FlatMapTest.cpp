@@ -0,0 +1,137 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/FlatMap.h"
+#include "core/collection/FlatSet.h"
+#include "core/String.h"
+
+namespace core {
+
+TEST(FlatMapTest, testPutGet) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	map.put(1, 1);
+	map.put(1, 2);
+	map.put(2, 1);
+	map.put(3, 1337);
+	int64_t value;
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.get(2, value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(3, value));
+	EXPECT_EQ(1337, value);
+	EXPECT_FALSE(map.get(4, value));
+	EXPECT_EQ(3u, map.size());
+}
+
+TEST(FlatMapTest, testRehash) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	EXPECT_EQ(0u, map.capacity());
+	for (int64_t i = 0; i < 100000; ++i) {
+		map.put(i, i * 2);
+	}
+	EXPECT_EQ(100000u, map.size());
+	EXPECT_GE(map.capacity() * 7u, map.size() * 8u);
+	int64_t value = 0;
+	for (int64_t i = 0; i < 100000; ++i) {
+		ASSERT_TRUE(map.get(i, value)) << i;
+		EXPECT_EQ(i * 2, value);
+	}
+}
+
+TEST(FlatMapTest, testReserve) {
+	core::FlatMap<int, int> map(1000);
+	const size_t capacity = map.capacity();
+	EXPECT_GE(capacity, 1000u);
+	for (int i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(FlatMapTest, testRemove) {
+	core::FlatMap<int, int> map;
+	for (int i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	for (int i = 0; i < 1024; i += 2) {
+		EXPECT_TRUE(map.remove(i));
+	}
+	EXPECT_FALSE(map.remove(0));
+	EXPECT_EQ(512u, map.size());
+	for (int i = 0; i < 1024; ++i) {
+		EXPECT_EQ(i % 2 == 1, map.hasKey(i)) << i;
+	}
+	auto iter = map.find(1);
+	ASSERT_NE(map.end(), iter);
+	map.erase(iter);
+	EXPECT_FALSE(map.hasKey(1));
+	EXPECT_EQ(511u, map.size());
+}
+
+TEST(FlatMapTest, testClear) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 16; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(16u, map.size());
+	EXPECT_FALSE(map.empty());
+	map.clear();
+	EXPECT_EQ(0u, map.size());
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(FlatMapTest, testIterator) {
+	core::FlatMap<int, int> map;
+	EXPECT_EQ(map.begin(), map.end());
+	EXPECT_EQ(map.end(), map.find(42));
+	for (int i = 0; i < 100; ++i) {
+		map.put(i, i + 1);
+	}
+	int n = 0;
+	int sum = 0;
+	for (const auto &entry : map) {
+		EXPECT_EQ(entry->key + 1, entry->value);
+		sum += entry->key;
+		++n;
+	}
+	EXPECT_EQ(100, n);
+	EXPECT_EQ(4950, sum);
+}
+
+TEST(FlatMapTest, testStringValues) {
+	core::FlatMap<core::String, core::String, core::StringHash> map;
+	for (int i = 0; i < 200; ++i) {
+		map.put(core::String::format("key%i", i), core::String::format("value%i", i));
+	}
+	for (int i = 0; i < 200; i += 3) {
+		map.remove(core::String::format("key%i", i));
+	}
+	core::FlatMap<core::String, core::String, core::StringHash> copy(map);
+	core::FlatMap<core::String, core::String, core::StringHash> moved(core::move(map));
+	EXPECT_TRUE(map.empty());
+	for (int i = 0; i < 200; ++i) {
+		core::String value;
+		const bool expected = i % 3 != 0;
+		EXPECT_EQ(expected, copy.get(core::String::format("key%i", i), value)) << i;
+		EXPECT_EQ(expected, moved.get(core::String::format("key%i", i), value)) << i;
+		if (expected) {
+			EXPECT_EQ(core::String::format("value%i", i), value);
+		}
+	}
+}
+
+TEST(FlatMapTest, testSet) {
+	core::FlatSet<int> set;
+	EXPECT_TRUE(set.insert(1));
+	EXPECT_FALSE(set.insert(1));
+	EXPECT_TRUE(set.insert(2));
+	EXPECT_TRUE(set.has(1));
+	EXPECT_FALSE(set.has(3));
+	EXPECT_EQ(2u, set.size());
+}
+
+}
@@ -5,6 +5,9 @@
 #include <gtest/gtest.h>
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/ParallelFor.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/collection/DynamicArray.h"
 
 namespace core {
 
@@ -42,4 +45,112 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testIsWorkerThread) {
+	core::ThreadPool pool(1);
+	core::ThreadPool other(1);
+	pool.init();
+	other.init();
+	EXPECT_FALSE(pool.isWorkerThread());
+	EXPECT_TRUE(pool.enqueue([&pool] () { return pool.isWorkerThread(); }).get());
+	EXPECT_FALSE(pool.enqueue([&other] () { return other.isWorkerThread(); }).get());
+}
+
+TEST_F(ThreadPoolTest, testAbort) {
+	core::ThreadPool pool(1);
+	pool.init();
+	core::AtomicBool started{false};
+	core::AtomicBool release{false};
+	auto blocker = pool.enqueue([&] () {
+		started = true;
+		while (!release) {
+			std::this_thread::yield();
+		}
+	});
+	while (!started) {
+		std::this_thread::yield();
+	}
+	for (int i = 0; i < 100; ++i) {
+		pool.enqueue([this] () {
+			++_count;
+		});
+	}
+	pool.abort();
+	release = true;
+	blocker.get();
+	pool.shutdown(true);
+	EXPECT_EQ(0, _count);
+}
+
+TEST_F(ThreadPoolTest, testTaskGroup) {
+	core::ThreadPool pool(2);
+	pool.init();
+	core::TaskGroup group(pool);
+	for (int i = 0; i < 1000; ++i) {
+		group.run([this] () {
+			++_count;
+		});
+	}
+	group.wait();
+	EXPECT_EQ(1000, _count);
+}
+
+TEST_F(ThreadPoolTest, testTaskGroupNested) {
+	// every worker waits for tasks that are queued behind it - this would dead lock with blocking waits
+	core::ThreadPool pool(2);
+	pool.init();
+	core::TaskGroup group(pool);
+	for (int i = 0; i < 8; ++i) {
+		group.run([this, &pool] () {
+			core::TaskGroup inner(pool);
+			for (int j = 0; j < 8; ++j) {
+				inner.run([this] () {
+					++_count;
+				});
+			}
+			inner.wait();
+		});
+	}
+	group.wait();
+	EXPECT_EQ(64, _count);
+}
+
+TEST_F(ThreadPoolTest, testParallelFor) {
+	core::ThreadPool pool(3);
+	pool.init();
+	core::DynamicArray<int> values;
+	values.resize(1000);
+	for (int i = 0; i < 1000; ++i) {
+		values[i] = 0;
+	}
+	core::parallel_for(pool, 5, 995, 7, [&] (int start, int end) {
+		EXPECT_LE(end - start, 7);
+		for (int i = start; i < end; ++i) {
+			++values[i];
+		}
+	});
+	for (int i = 0; i < 1000; ++i) {
+		EXPECT_EQ(i >= 5 && i < 995 ? 1 : 0, values[i]) << "index " << i;
+	}
+}
+
+TEST_F(ThreadPoolTest, testParallelForNested) {
+	core::ThreadPool pool(2);
+	pool.init();
+	core::parallel_for(pool, 0, 16, 1, [&] (int, int) {
+		core::parallel_for(pool, 0, 100, 10, [&] (int start, int end) {
+			_count.increment(end - start);
+		});
+	});
+	EXPECT_EQ(1600, _count);
+}
+
+TEST_F(ThreadPoolTest, testParallelForWithoutWorkers) {
+	core::ThreadPool pool(0);
+	pool.init();
+	core::parallel_for(pool, 0, 100, 10, [&] (int start, int end) {
+		_count.increment(end - start);
+	});
+	EXPECT_EQ(100, _count);
+}
+
 }
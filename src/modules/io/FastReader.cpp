@@ -0,0 +1,69 @@
+/**
+ * @file
+ */
+
+#include "FastReader.h"
+#include "core/Log.h"
+#include "io/Stream.h"
+
+namespace io {
+
+FastReader::FastReader(const uint8_t *buf, size_t size) : _buf(buf), _size(size) {
+}
+
+FastReader::FastReader(SeekableReadStream &stream, int64_t size) {
+	const int64_t remaining = stream.remaining();
+	if (size < 0 || size > remaining) {
+		size = remaining;
+	}
+	if (size <= 0) {
+		return;
+	}
+	const int64_t pos = stream.pos();
+	if (const uint8_t *data = stream.data()) {
+		_buf = data + pos;
+		_size = (size_t)size;
+		return;
+	}
+	_ownBuf = (uint8_t *)core_malloc((size_t)size);
+	const int read = stream.read(_ownBuf, (size_t)size);
+	stream.seek(pos);
+	if (read != (int)size) {
+		Log::error("Failed to read %i bytes from the stream", (int)size);
+		return;
+	}
+	_buf = _ownBuf;
+	_size = (size_t)size;
+}
+
+FastReader::~FastReader() {
+	core_free(_ownBuf);
+}
+
+bool FastReader::readString(int length, char *strbuff, bool terminated) {
+	for (int i = 0; i < length; ++i) {
+		uint8_t chr;
+		if (readUInt8(chr) != 0) {
+			return false;
+		}
+		strbuff[i] = (char)chr;
+		if (terminated && chr == '\0') {
+			break;
+		}
+	}
+	return true;
+}
+
+int FastReader::readUInt32Array(uint32_t *vals, size_t n) {
+	if (read(vals, n * sizeof(uint32_t)) != 0) {
+		return -1;
+	}
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	for (size_t i = 0; i < n; ++i) {
+		vals[i] = SDL_Swap32(vals[i]);
+	}
+#endif
+	return 0;
+}
+
+} // namespace io
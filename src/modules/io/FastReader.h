@@ -0,0 +1,196 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/StandardLib.h"
+#include <SDL_endian.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace io {
+
+class SeekableReadStream;
+
+/**
+ * @brief Non-virtual reader for the primitive types of a block of memory
+ *
+ * The @c ReadStream methods end up in a virtual read() call for every single value. Loaders that decode a value
+ * per voxel can wrap the voxel data into this reader instead - all reads are inlined and bounds checked against
+ * the block. The return values match the @c ReadStream methods: @c 0 on success and @c -1 if there are not enough
+ * bytes left.
+ *
+ * All multi byte values are little endian unless the method name ends with @c BE.
+ *
+ * @ingroup IO
+ * @see ReadStream
+ */
+class FastReader : public core::NonCopyable {
+private:
+	const uint8_t *_buf = nullptr;
+	uint8_t *_ownBuf = nullptr;
+	size_t _size = 0;
+	size_t _pos = 0;
+
+	template<class T>
+	inline int readRaw(T &val) {
+		if (_size - _pos < sizeof(T)) {
+			return -1;
+		}
+		// fixed size - the compiler turns this into a single load
+		memcpy(&val, _buf + _pos, sizeof(T));
+		_pos += sizeof(T);
+		return 0;
+	}
+
+public:
+	FastReader(const uint8_t *buf, size_t size);
+	/**
+	 * @brief Wraps the next @c size bytes of the stream (or all remaining bytes if @c size is negative)
+	 *
+	 * Streams that support direct access (see SeekableReadStream::data()) are not copied.
+	 * @note The position of the stream is not changed - use @c stream.skip(reader.pos()) to continue after the
+	 * bytes that were consumed by the reader
+	 */
+	FastReader(SeekableReadStream &stream, int64_t size = -1);
+	~FastReader();
+
+	inline size_t size() const {
+		return _size;
+	}
+	inline size_t pos() const {
+		return _pos;
+	}
+	inline size_t remaining() const {
+		return _size - _pos;
+	}
+	inline bool eos() const {
+		return _pos >= _size;
+	}
+
+	/**
+	 * @return @c -1 if the given amount of bytes is not available - the position isn't changed in this case
+	 */
+	inline int skip(size_t bytes) {
+		if (remaining() < bytes) {
+			return -1;
+		}
+		_pos += bytes;
+		return 0;
+	}
+
+	/**
+	 * @brief Returns the next @c bytes bytes without copying them and advances the position
+	 * @return @c nullptr if not enough bytes are left
+	 */
+	inline const uint8_t *readDirect(size_t bytes) {
+		if (remaining() < bytes) {
+			return nullptr;
+		}
+		const uint8_t *ptr = _buf + _pos;
+		_pos += bytes;
+		return ptr;
+	}
+
+	inline int read(void *dataPtr, size_t dataSize) {
+		const uint8_t *ptr = readDirect(dataSize);
+		if (ptr == nullptr) {
+			return -1;
+		}
+		core_memcpy(dataPtr, ptr, dataSize);
+		return 0;
+	}
+
+	inline int readUInt8(uint8_t &val) {
+		if (_pos >= _size) {
+			return -1;
+		}
+		val = _buf[_pos++];
+		return 0;
+	}
+
+	inline int readInt8(int8_t &val) {
+		uint8_t v;
+		if (readUInt8(v) != 0) {
+			return -1;
+		}
+		val = (int8_t)v;
+		return 0;
+	}
+
+	inline int readUInt16(uint16_t &val) {
+		if (readRaw(val) != 0) {
+			return -1;
+		}
+		val = SDL_SwapLE16(val);
+		return 0;
+	}
+
+	inline int readInt16(int16_t &val) {
+		uint16_t v;
+		if (readUInt16(v) != 0) {
+			return -1;
+		}
+		val = (int16_t)v;
+		return 0;
+	}
+
+	inline int readUInt32(uint32_t &val) {
+		if (readRaw(val) != 0) {
+			return -1;
+		}
+		val = SDL_SwapLE32(val);
+		return 0;
+	}
+
+	inline int readInt32(int32_t &val) {
+		uint32_t v;
+		if (readUInt32(v) != 0) {
+			return -1;
+		}
+		val = (int32_t)v;
+		return 0;
+	}
+
+	inline int readUInt32BE(uint32_t &val) {
+		if (readRaw(val) != 0) {
+			return -1;
+		}
+		val = SDL_SwapBE32(val);
+		return 0;
+	}
+
+	inline int readFloat(float &val) {
+		uint32_t v;
+		if (readUInt32(v) != 0) {
+			return -1;
+		}
+		memcpy(&val, &v, sizeof(val));
+		return 0;
+	}
+
+	inline bool readBool() {
+		uint8_t v;
+		if (readUInt8(v) != 0) {
+			return false;
+		}
+		return v != 0;
+	}
+
+	/**
+	 * @brief Same as ReadStream::readString()
+	 */
+	bool readString(int length, char *strbuff, bool terminated);
+
+	/**
+	 * @brief Reads @c n little endian values. The values are copied in one go and only swapped on big endian
+	 * hosts.
+	 * @return @c -1 if not all values are available - nothing is read in this case
+	 */
+	int readUInt32Array(uint32_t *vals, size_t n);
+};
+
+} // namespace io
@@ -0,0 +1,136 @@
+/**
+ * @file
+ */
+
+#include "MappedFileReadStream.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "io/File.h"
+#include "io/FileStream.h"
+#include <SDL_platform.h>
+
+#if defined(__LINUX__) || defined(__MACOSX__)
+#define IO_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace io {
+
+MappedFileReadStream::MappedFileReadStream(const FilePtr &file) : _file(file) {
+	if (!_file || !_file->validHandle()) {
+		return;
+	}
+	if (map()) {
+		return;
+	}
+	// fall back to reading the whole file at once
+	FileStream stream(_file);
+	const int64_t size = stream.size();
+	if (size <= 0) {
+		return;
+	}
+	uint8_t *buf = (uint8_t *)core_malloc(size);
+	if (stream.read(buf, size) != (int)size) {
+		Log::error("Failed to read %i bytes from %s", (int)size, _file->name().c_str());
+		core_free(buf);
+		return;
+	}
+	_buf = buf;
+	_size = size;
+}
+
+MappedFileReadStream::~MappedFileReadStream() {
+	unmap();
+}
+
+bool MappedFileReadStream::map() {
+#ifdef IO_HAVE_MMAP
+	const int fd = open(_file->name().c_str(), O_RDONLY);
+	if (fd == -1) {
+		Log::debug("Failed to open %s for mapping", _file->name().c_str());
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+	void *addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+	if (addr == MAP_FAILED) {
+		Log::debug("Failed to map %s", _file->name().c_str());
+		return false;
+	}
+	madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+	_buf = (const uint8_t *)addr;
+	_size = (int64_t)st.st_size;
+	_mapped = true;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void MappedFileReadStream::unmap() {
+	if (_buf == nullptr) {
+		return;
+	}
+#ifdef IO_HAVE_MMAP
+	if (_mapped) {
+		munmap((void *)_buf, (size_t)_size);
+	} else {
+		core_free((void *)_buf);
+	}
+#else
+	core_free((void *)_buf);
+#endif
+	_buf = nullptr;
+	_size = 0;
+	_pos = 0;
+	_mapped = false;
+}
+
+bool MappedFileReadStream::valid() const {
+	return _file && _file->validHandle();
+}
+
+int MappedFileReadStream::read(void *dataPtr, size_t dataSize) {
+	const int64_t rem = remaining();
+	if (rem <= 0) {
+		return 0;
+	}
+	if (dataSize > (size_t)rem) {
+		dataSize = (size_t)rem;
+	}
+	core_memcpy(dataPtr, &_buf[_pos], dataSize);
+	_pos += (int64_t)dataSize;
+	return (int)dataSize;
+}
+
+int64_t MappedFileReadStream::seek(int64_t position, int whence) {
+	switch (whence) {
+	case SEEK_SET:
+		_pos = position;
+		break;
+	case SEEK_CUR:
+		_pos += position;
+		break;
+	case SEEK_END:
+		_pos = _size + position;
+		break;
+	default:
+		return -1;
+	}
+	if (_pos < 0) {
+		_pos = 0;
+	} else if (_pos > _size) {
+		_pos = _size;
+	}
+	return _pos;
+}
+
+} // namespace io
@@ -0,0 +1,76 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/SharedPtr.h"
+#include "io/Stream.h"
+
+namespace io {
+
+class File;
+typedef core::SharedPtr<File> FilePtr;
+
+/**
+ * @brief Read only stream that maps the whole file into memory
+ *
+ * Reading is just a memcpy from the mapping instead of a syscall for every few bytes - and the loaders can use
+ * data() or readDirect() to decode straight from the mapped pages. The kernel is told that the file is read
+ * sequentially to get a bigger read ahead.
+ *
+ * On platforms without @c mmap the file content is read into memory with one call instead.
+ *
+ * @note The file must not be modified while it's mapped
+ * @ingroup IO
+ * @see FileStream
+ * @see MemoryReadStream
+ */
+class MappedFileReadStream : public SeekableReadStream {
+private:
+	FilePtr _file;
+	const uint8_t *_buf = nullptr;
+	int64_t _size = 0;
+	int64_t _pos = 0;
+	bool _mapped = false;
+
+	bool map();
+	void unmap();
+
+public:
+	MappedFileReadStream(const FilePtr &file);
+	virtual ~MappedFileReadStream();
+
+	/**
+	 * @return @c false if the file could not get opened
+	 */
+	bool valid() const;
+	/**
+	 * @return @c true if the file is memory mapped and not read into a buffer
+	 */
+	bool mapped() const;
+
+	int64_t size() const override;
+	int64_t pos() const override;
+	int read(void *dataPtr, size_t dataSize) override;
+	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	const uint8_t *data() const override;
+};
+
+inline bool MappedFileReadStream::mapped() const {
+	return _mapped;
+}
+
+inline int64_t MappedFileReadStream::size() const {
+	return _size;
+}
+
+inline int64_t MappedFileReadStream::pos() const {
+	return _pos;
+}
+
+inline const uint8_t *MappedFileReadStream::data() const {
+	return _buf;
+}
+
+} // namespace io
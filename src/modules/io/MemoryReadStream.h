@@ -29,8 +29,13 @@ public:
 	int64_t pos() const override;
 	int read(void *dataPtr, size_t dataSize) override;
 	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	const uint8_t *data() const override;
 };
 
+inline const uint8_t *MemoryReadStream::data() const {
+	return _ownBuf ? _ownBuf : _buf;
+}
+
 inline int64_t MemoryReadStream::size() const {
 	return _size;
 }
@@ -0,0 +1,138 @@
+/**
+ * @file
+ */
+
+#include "ParallelZipReadStream.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/external/miniz.h"
+
+namespace io {
+
+struct ParallelZipReadStream::Block {
+	explicit Block(core::ThreadPool &pool) : group(pool) {
+	}
+	~Block() {
+		group.wait();
+		core_free(in);
+		core_free(out);
+	}
+	core::TaskGroup group;
+	uint8_t *in = nullptr;
+	size_t inSize = 0u;
+	uint8_t *out = nullptr;
+	size_t outSize = 0u;
+	bool ok = false;
+};
+
+ParallelZipReadStream::ParallelZipReadStream(io::SeekableReadStream &readStream, core::ThreadPool &pool)
+	: _pool(pool), _readStream(readStream), _maxBlocksInFlight(core_max(pool.size() * 2, (size_t)2)) {
+}
+
+ParallelZipReadStream::~ParallelZipReadStream() {
+	delete _current;
+	for (Block *block : _blocks) {
+		delete block;
+	}
+}
+
+bool ParallelZipReadStream::readAhead() {
+	while (!_inputDone && _blocks.size() < _maxBlocksInFlight) {
+		uint32_t uncompressedSize;
+		if (_readStream.readUInt32(uncompressedSize) != 0) {
+			Log::error("Failed to read the block header");
+			return false;
+		}
+		if (uncompressedSize == 0u) {
+			_inputDone = true;
+			break;
+		}
+		uint32_t compressedSize;
+		if (_readStream.readUInt32(compressedSize) != 0) {
+			Log::error("Failed to read the block header");
+			return false;
+		}
+		if (uncompressedSize > MaxBlockSize || (int64_t)compressedSize > _readStream.remaining()) {
+			Log::error("Invalid block size %u (compressed: %u)", uncompressedSize, compressedSize);
+			return false;
+		}
+		Block *block = new Block(_pool);
+		block->inSize = compressedSize;
+		block->in = (uint8_t *)core_malloc(compressedSize);
+		block->outSize = uncompressedSize;
+		block->out = (uint8_t *)core_malloc(uncompressedSize);
+		_blocks.push_back(block);
+		if (_readStream.read(block->in, compressedSize) != (int)compressedSize) {
+			Log::error("Failed to read a block of %u bytes", compressedSize);
+			return false;
+		}
+		block->group.run([block]() {
+			mz_ulong outSize = (mz_ulong)block->outSize;
+			block->ok = mz_uncompress(block->out, &outSize, block->in, (mz_ulong)block->inSize) == MZ_OK &&
+						(size_t)outSize == block->outSize;
+		});
+	}
+	return true;
+}
+
+bool ParallelZipReadStream::nextBlock() {
+	delete _current;
+	_current = nullptr;
+	_currentPos = 0u;
+	if (!readAhead()) {
+		return false;
+	}
+	if (_blocks.empty()) {
+		return true;
+	}
+	_current = _blocks[0];
+	_blocks.erase(0);
+	// keep the pool busy while the data of this block is consumed
+	if (!readAhead()) {
+		return false;
+	}
+	_current->group.wait();
+	if (!_current->ok) {
+		Log::error("Failed to uncompress a block of %i bytes", (int)_current->inSize);
+		return false;
+	}
+	return true;
+}
+
+bool ParallelZipReadStream::eos() const {
+	if (_error) {
+		return true;
+	}
+	if (_current != nullptr && _currentPos < _current->outSize) {
+		return false;
+	}
+	return _inputDone && _blocks.empty();
+}
+
+int ParallelZipReadStream::read(void *dataPtr, size_t dataSize) {
+	if (_error) {
+		return -1;
+	}
+	uint8_t *target = (uint8_t *)dataPtr;
+	size_t read = 0u;
+	while (read < dataSize) {
+		if (_current == nullptr || _currentPos >= _current->outSize) {
+			if (!nextBlock()) {
+				_error = true;
+				return -1;
+			}
+			if (_current == nullptr) {
+				// end of the stream
+				break;
+			}
+		}
+		const size_t n = core_min(dataSize - read, _current->outSize - _currentPos);
+		core_memcpy(target + read, _current->out + _currentPos, n);
+		_currentPos += n;
+		read += n;
+	}
+	return (int)read;
+}
+
+} // namespace io
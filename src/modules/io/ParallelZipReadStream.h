@@ -0,0 +1,62 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stream.h"
+#include "core/collection/DynamicArray.h"
+
+namespace core {
+class ThreadPool;
+}
+
+namespace io {
+
+/**
+ * @brief Reads the block container that is written by @c ParallelZipWriteStream
+ *
+ * The compressed blocks are read ahead from the input stream and inflated in parallel on the thread pool.
+ *
+ * @see ParallelZipWriteStream
+ * @see ZipReadStream
+ * @ingroup IO
+ */
+class ParallelZipReadStream : public io::ReadStream {
+public:
+	/**
+	 * The max allowed uncompressed size of a block - protects against broken input data
+	 */
+	static constexpr uint32_t MaxBlockSize = 64 * 1024 * 1024;
+
+private:
+	struct Block;
+	core::ThreadPool &_pool;
+	io::SeekableReadStream &_readStream;
+	const size_t _maxBlocksInFlight;
+	core::DynamicArray<Block *> _blocks;
+	// the block that is currently read from
+	Block *_current = nullptr;
+	size_t _currentPos = 0u;
+	bool _inputDone = false;
+	bool _error = false;
+
+	bool readAhead();
+	bool nextBlock();
+
+public:
+	ParallelZipReadStream(io::SeekableReadStream &readStream, core::ThreadPool &pool);
+	virtual ~ParallelZipReadStream();
+
+	/**
+	 * @return The amount of read bytes or @c -1 on error. This is less than @c dataSize if the end of the
+	 * compressed stream was reached.
+	 */
+	int read(void *dataPtr, size_t dataSize) override;
+	/**
+	 * @return @c true if all blocks were read
+	 */
+	bool eos() const override;
+};
+
+} // namespace io
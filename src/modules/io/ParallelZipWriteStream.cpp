@@ -0,0 +1,134 @@
+/**
+ * @file
+ */
+
+#include "ParallelZipWriteStream.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/TaskGroup.h"
+#include "core/external/miniz.h"
+
+namespace io {
+
+struct ParallelZipWriteStream::Block {
+	explicit Block(core::ThreadPool &pool) : group(pool) {
+	}
+	~Block() {
+		group.wait();
+		core_free(in);
+		core_free(out);
+	}
+	core::TaskGroup group;
+	uint8_t *in = nullptr;
+	size_t inSize = 0u;
+	uint8_t *out = nullptr;
+	size_t outSize = 0u;
+	bool ok = false;
+};
+
+ParallelZipWriteStream::ParallelZipWriteStream(io::WriteStream &outStream, core::ThreadPool &pool, int level,
+											   size_t blockSize)
+	: _pool(pool), _outStream(outStream), _level(level), _blockSize(core_max(blockSize, (size_t)1024)),
+	  _maxBlocksInFlight(core_max(pool.size() * 2, (size_t)2)) {
+}
+
+ParallelZipWriteStream::~ParallelZipWriteStream() {
+	ParallelZipWriteStream::flush();
+	for (Block *block : _blocks) {
+		delete block;
+	}
+	core_free(_current);
+}
+
+void ParallelZipWriteStream::scheduleBlock() {
+	Block *block = new Block(_pool);
+	block->in = _current;
+	block->inSize = _currentSize;
+	_current = nullptr;
+	_currentSize = 0u;
+	const int level = _level;
+	block->group.run([block, level]() {
+		mz_ulong outSize = mz_compressBound((mz_ulong)block->inSize);
+		block->out = (uint8_t *)core_malloc(outSize);
+		block->ok = mz_compress2(block->out, &outSize, block->in, (mz_ulong)block->inSize, level) == MZ_OK;
+		block->outSize = (size_t)outSize;
+	});
+	_blocks.push_back(block);
+}
+
+bool ParallelZipWriteStream::writeBlock(Block *block) {
+	block->group.wait();
+	if (!block->ok) {
+		Log::error("Failed to compress a block of %i bytes", (int)block->inSize);
+		return false;
+	}
+	if (!_outStream.writeUInt32((uint32_t)block->inSize) || !_outStream.writeUInt32((uint32_t)block->outSize)) {
+		return false;
+	}
+	if (_outStream.write(block->out, block->outSize) != (int)block->outSize) {
+		return false;
+	}
+	_pos += 8 + (int64_t)block->outSize;
+	return true;
+}
+
+int ParallelZipWriteStream::write(const void *buf, size_t size) {
+	if (_error || _finished) {
+		return -1;
+	}
+	const uint8_t *src = (const uint8_t *)buf;
+	size_t remaining = size;
+	while (remaining > 0u) {
+		if (_current == nullptr) {
+			_current = (uint8_t *)core_malloc(_blockSize);
+		}
+		const size_t n = core_min(remaining, _blockSize - _currentSize);
+		core_memcpy(_current + _currentSize, src, n);
+		_currentSize += n;
+		src += n;
+		remaining -= n;
+		if (_currentSize < _blockSize) {
+			break;
+		}
+		scheduleBlock();
+		while (_blocks.size() > _maxBlocksInFlight) {
+			Block *block = _blocks[0];
+			_blocks.erase(0);
+			const bool ok = writeBlock(block);
+			delete block;
+			if (!ok) {
+				_error = true;
+				return -1;
+			}
+		}
+	}
+	return (int)size;
+}
+
+bool ParallelZipWriteStream::flush() {
+	if (_finished) {
+		return !_error;
+	}
+	_finished = true;
+	if (_currentSize > 0u) {
+		scheduleBlock();
+	}
+	for (Block *block : _blocks) {
+		if (!_error && !writeBlock(block)) {
+			_error = true;
+		}
+		delete block;
+	}
+	_blocks.clear();
+	if (_error) {
+		return false;
+	}
+	if (!_outStream.writeUInt32(0u)) {
+		_error = true;
+		return false;
+	}
+	_pos += 4;
+	return true;
+}
+
+} // namespace io
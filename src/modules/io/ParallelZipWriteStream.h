@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Stream.h"
+#include "core/collection/DynamicArray.h"
+
+namespace core {
+class ThreadPool;
+}
+
+namespace io {
+
+/**
+ * @brief Compresses the written data in independent blocks on a thread pool
+ *
+ * The data is split into blocks of @c blockSize bytes that are deflated on their own (like pigz does) - so the
+ * compression of several blocks can run in parallel and the reader can inflate them in parallel, too. Only a few
+ * blocks are kept in flight; the compressed blocks are written to the output stream in order.
+ *
+ * The container is not compatible with a single zlib stream - it has to be read with @c ParallelZipReadStream:
+ * @code
+ * uint32 uncompressed size of the block (0 terminates the stream)
+ * uint32 compressed size of the block
+ * zlib data of the block
+ * @endcode
+ *
+ * @see ParallelZipReadStream
+ * @see ZipWriteStream
+ * @ingroup IO
+ */
+class ParallelZipWriteStream : public io::WriteStream {
+public:
+	static constexpr size_t DefaultBlockSize = 1024 * 1024;
+
+private:
+	struct Block;
+	core::ThreadPool &_pool;
+	io::WriteStream &_outStream;
+	const int _level;
+	const size_t _blockSize;
+	const size_t _maxBlocksInFlight;
+	uint8_t *_current = nullptr;
+	size_t _currentSize = 0;
+	core::DynamicArray<Block *> _blocks;
+	int64_t _pos = 0;
+	bool _error = false;
+	bool _finished = false;
+
+	void scheduleBlock();
+	bool writeBlock(Block *block);
+
+public:
+	/**
+	 * @param outStream The buffer that receives the writes for the compressed data.
+	 * @param level The compression level (0 is no compression, 1 is the best speed, 9 is the best compression).
+	 */
+	ParallelZipWriteStream(io::WriteStream &outStream, core::ThreadPool &pool, int level = 6,
+						   size_t blockSize = DefaultBlockSize);
+	virtual ~ParallelZipWriteStream();
+
+	/**
+	 * @return @c -1 on error - otherwise the size of the given buffer. The data is compressed and written to the
+	 * output stream once a block is full.
+	 */
+	int write(const void *buf, size_t size) override;
+	/**
+	 * @brief Returns the compressed written bytes that went into the given output stream
+	 */
+	int64_t size() const;
+
+	/**
+	 * @brief Compresses the pending data and writes the end of the stream. Nothing can be written afterwards.
+	 *
+	 * @note This method is automatically called in the destructor
+	 */
+	bool flush() override;
+};
+
+inline int64_t ParallelZipWriteStream::size() const {
+	return _pos;
+}
+
+} // namespace io
@@ -586,4 +586,14 @@ int64_t SeekableReadStream::skip(int64_t delta) {
 	return seek(delta, SEEK_CUR);
 }
 
+const uint8_t *SeekableReadStream::readDirect(size_t dataSize) {
+	const uint8_t *buf = data();
+	if (buf == nullptr || remaining() < (int64_t)dataSize) {
+		return nullptr;
+	}
+	buf += pos();
+	skip((int64_t)dataSize);
+	return buf;
+}
+
 } // namespace io
@@ -178,6 +178,22 @@ public:
 		return pos() >= size();
 	}
 
+	/**
+	 * @brief Direct access to the bytes of streams that keep all of their data in memory
+	 * @return The first byte of the stream or @c nullptr if the stream has to be read with read()
+	 * @sa readDirect()
+	 */
+	virtual const uint8_t *data() const {
+		return nullptr;
+	}
+
+	/**
+	 * @brief Returns the next @c dataSize bytes of the stream without copying them and advances the position
+	 * @return @c nullptr if the stream doesn't support direct access (see data()) or if there are not enough
+	 * bytes left - the position isn't changed in this case
+	 */
+	const uint8_t *readDirect(size_t dataSize);
+
 	/**
 	 * @note doesn't advance the stream position
 	 * @return -1 on error - 0 on success
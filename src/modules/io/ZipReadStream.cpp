@@ -59,6 +59,18 @@ int64_t ZipReadStream::skip(int64_t delta) {
 }
 
 int ZipReadStream::read(void *buf, size_t size) {
+	const int n = readSome(buf, size);
+	if (n >= 0 && (size_t)n < size) {
+		Log::debug("attempting to read past the end of the stream");
+		return -1;
+	}
+	return n;
+}
+
+int ZipReadStream::readSome(void *buf, size_t size) {
+	if (_eos) {
+		return 0;
+	}
 	uint8_t *targetPtr = (uint8_t *)buf;
 	const size_t originalSize = size;
 	while (size > 0) {
@@ -99,8 +111,7 @@ int ZipReadStream::read(void *buf, size_t size) {
 		if (retval == MZ_STREAM_END) {
 			_eos = true;
 			if (size > 0) {
-				Log::debug("attempting to read past the end of the stream");
-				return -1;
+				return (int)(originalSize - size);
 			}
 		}
 	}
@@ -36,9 +36,18 @@ public:
 	 *
 	 * @param dataPtr The target data buffer
 	 * @param dataSize The size of the target data buffer
-	 * @return The amount of read bytes or @c -1 on error
+	 * @return The amount of read bytes or @c -1 on error. Trying to read past the end of the compressed stream is an
+	 * error, too.
+	 * @sa readSome()
 	 */
 	int read(void *dataPtr, size_t dataSize) override;
+	/**
+	 * @brief Like read() but for data of unknown size - reading past the end of the compressed stream is not an error
+	 *
+	 * @return The amount of read bytes or @c -1 on error. This is less than @c dataSize if the end of the
+	 * compressed stream was reached and @c 0 after that.
+	 */
+	int readSome(void *dataPtr, size_t dataSize);
 	/**
 	 * @return @c true if the end of the compressed stream was found
 	 */
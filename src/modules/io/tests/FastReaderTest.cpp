@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#include "io/FastReader.h"
+#include "io/BufferedReadWriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class FastReaderTest : public testing::Test {};
+
+TEST_F(FastReaderTest, testPrimitives) {
+	BufferedReadWriteStream stream;
+	stream.writeUInt8(1);
+	stream.writeInt16(-2);
+	stream.writeUInt32(0xdeadbeef);
+	stream.writeUInt32BE(0xdeadbeef);
+	stream.writeFloat(1.5f);
+	stream.writeInt32(-7);
+	stream.seek(0);
+
+	FastReader reader(stream);
+	EXPECT_EQ((size_t)stream.size(), reader.size());
+	uint8_t u8;
+	ASSERT_EQ(0, reader.readUInt8(u8));
+	EXPECT_EQ(1u, u8);
+	int16_t i16;
+	ASSERT_EQ(0, reader.readInt16(i16));
+	EXPECT_EQ(-2, i16);
+	uint32_t u32;
+	ASSERT_EQ(0, reader.readUInt32(u32));
+	EXPECT_EQ(0xdeadbeef, u32);
+	ASSERT_EQ(0, reader.readUInt32BE(u32));
+	EXPECT_EQ(0xdeadbeef, u32);
+	float f;
+	ASSERT_EQ(0, reader.readFloat(f));
+	EXPECT_FLOAT_EQ(1.5f, f);
+	int32_t i32;
+	ASSERT_EQ(0, reader.readInt32(i32));
+	EXPECT_EQ(-7, i32);
+	EXPECT_TRUE(reader.eos());
+	EXPECT_EQ(-1, reader.readUInt8(u8));
+	EXPECT_EQ(-1, reader.readUInt32(u32));
+	// the stream position is not changed
+	EXPECT_EQ(0, stream.pos());
+}
+
+TEST_F(FastReaderTest, testBoundsCheck) {
+	const uint8_t buf[] = {1, 2, 3};
+	FastReader reader(buf, sizeof(buf));
+	uint16_t u16;
+	ASSERT_EQ(0, reader.readUInt16(u16));
+	EXPECT_EQ(0x0201, u16);
+	uint32_t u32;
+	EXPECT_EQ(-1, reader.readUInt32(u32));
+	EXPECT_EQ(2u, reader.pos());
+	EXPECT_EQ(nullptr, reader.readDirect(2));
+	EXPECT_EQ(-1, reader.skip(2));
+	EXPECT_EQ(0, reader.skip(1));
+	EXPECT_TRUE(reader.eos());
+}
+
+TEST_F(FastReaderTest, testArrays) {
+	BufferedReadWriteStream stream;
+	for (uint32_t i = 0; i < 37; ++i) {
+		stream.writeUInt32(i * 0x01020304u);
+	}
+	stream.seek(0);
+	FastReader reader(stream, 37 * 4);
+	uint32_t vals[37];
+	ASSERT_EQ(0, reader.readUInt32Array(vals, 37));
+	for (uint32_t i = 0; i < 37; ++i) {
+		EXPECT_EQ(i * 0x01020304u, vals[i]);
+	}
+	EXPECT_EQ(-1, reader.readUInt32Array(vals, 1));
+}
+
+} // namespace io
@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#include "io/MappedFileReadStream.h"
+#include "core/FourCC.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class MappedFileReadStreamTest : public testing::Test {
+protected:
+	io::Filesystem _fs;
+
+public:
+	void SetUp() override {
+		_fs.init("test", "test");
+	}
+
+	void TearDown() override {
+		_fs.shutdown();
+	}
+};
+
+TEST_F(MappedFileReadStreamTest, testInvalidFile) {
+	const FilePtr file;
+	MappedFileReadStream stream(file);
+	EXPECT_FALSE(stream.valid());
+	EXPECT_TRUE(stream.empty());
+	EXPECT_TRUE(stream.eos());
+	EXPECT_EQ(nullptr, stream.data());
+	int8_t val = 0;
+	EXPECT_EQ(-1, stream.readInt8(val));
+}
+
+TEST_F(MappedFileReadStreamTest, testRead) {
+	const FilePtr &file = _fs.open("iotest.txt");
+	ASSERT_TRUE(file->exists());
+	MappedFileReadStream stream(file);
+	ASSERT_TRUE(stream.valid());
+	EXPECT_EQ((int64_t)file->length(), stream.size());
+	ASSERT_NE(nullptr, stream.data());
+
+	uint32_t magic;
+	EXPECT_EQ(0, stream.peekUInt32(magic));
+	EXPECT_EQ(0, stream.pos());
+	EXPECT_EQ(FourCC('W', 'i', 'n', 'd'), magic);
+
+	// compare with the content that is read by the file stream
+	FileStream fileStream(file);
+	while (!fileStream.eos()) {
+		uint8_t expected;
+		uint8_t actual;
+		ASSERT_EQ(0, fileStream.readUInt8(expected));
+		ASSERT_EQ(0, stream.readUInt8(actual));
+		ASSERT_EQ(expected, actual);
+	}
+	EXPECT_TRUE(stream.eos());
+	uint8_t byte;
+	EXPECT_EQ(-1, stream.readUInt8(byte));
+}
+
+TEST_F(MappedFileReadStreamTest, testReadDirect) {
+	const FilePtr &file = _fs.open("iotest.txt");
+	MappedFileReadStream stream(file);
+	ASSERT_TRUE(stream.valid());
+	const uint8_t *bytes = stream.readDirect(4);
+	ASSERT_NE(nullptr, bytes);
+	EXPECT_EQ(bytes, stream.data());
+	EXPECT_EQ('W', bytes[0]);
+	EXPECT_EQ(4, stream.pos());
+	EXPECT_EQ(nullptr, stream.readDirect((size_t)stream.size()));
+	EXPECT_EQ(4, stream.pos());
+	EXPECT_EQ(stream.size(), stream.seek(0, SEEK_END));
+	EXPECT_EQ(0, stream.seek(-stream.size() - 1, SEEK_END));
+}
+
+} // namespace io
@@ -38,4 +38,19 @@ TEST_F(MemoryReadStreamTest, testSeekStream) {
 	EXPECT_EQ(1u, byte);
 }
 
+TEST_F(MemoryReadStreamTest, testCopyFromStream) {
+	const char buf[6] { 0, 1, 2, 3, 4, 5 };
+	MemoryReadStream source(buf, sizeof(buf));
+	source.seek(1);
+	MemoryReadStream stream(source, 4);
+	EXPECT_EQ(4, stream.size());
+	EXPECT_EQ(5, source.pos());
+	uint8_t byte;
+	EXPECT_EQ(0, stream.readUInt8(byte));
+	EXPECT_EQ(1u, byte);
+	EXPECT_EQ(3, stream.seek(3));
+	EXPECT_EQ(0, stream.readUInt8(byte));
+	EXPECT_EQ(4u, byte);
+}
+
 } // namespace io
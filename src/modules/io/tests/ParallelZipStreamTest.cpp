@@ -0,0 +1,101 @@
+/**
+ * @file
+ */
+
+#include "core/concurrent/ThreadPool.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/ParallelZipReadStream.h"
+#include "io/ParallelZipWriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class ParallelZipStreamTest : public testing::Test {
+protected:
+	// small blocks to get a lot of them
+	static constexpr size_t BlockSize = 4096;
+	static constexpr int Values = 100000;
+
+	void write(core::ThreadPool &pool, BufferedReadWriteStream &stream) {
+		ParallelZipWriteStream w(stream, pool, 6, BlockSize);
+		for (int i = 0; i < Values; ++i) {
+			ASSERT_TRUE(w.writeInt32(i / 7)) << "unexpected write failure for step: " << i;
+		}
+		ASSERT_TRUE(w.flush());
+		EXPECT_EQ(stream.size(), w.size());
+		EXPECT_FALSE(w.writeInt32(0));
+	}
+};
+
+TEST_F(ParallelZipStreamTest, testWriteRead) {
+	core::ThreadPool pool(2);
+	pool.init();
+	BufferedReadWriteStream stream;
+	write(pool, stream);
+	EXPECT_LT(stream.size(), (int64_t)(Values * sizeof(int32_t)));
+	stream.seek(0);
+	ParallelZipReadStream r(stream, pool);
+	for (int i = 0; i < Values; ++i) {
+		int32_t n;
+		ASSERT_EQ(0, r.readInt32(n)) << "unexpected read failure for step: " << i;
+		ASSERT_EQ(i / 7, n) << "unexpected extracted value for step: " << i;
+	}
+	EXPECT_TRUE(r.eos());
+	EXPECT_TRUE(stream.eos());
+	int32_t n;
+	EXPECT_EQ(-1, r.readInt32(n));
+}
+
+TEST_F(ParallelZipStreamTest, testBulkRead) {
+	core::ThreadPool pool(3);
+	pool.init();
+	BufferedReadWriteStream stream;
+	write(pool, stream);
+	stream.seek(0);
+	ParallelZipReadStream r(stream, pool);
+	int32_t *values = new int32_t[Values + 1];
+	// more than available
+	EXPECT_EQ((int)(Values * sizeof(int32_t)), r.read(values, (Values + 1) * sizeof(int32_t)));
+	for (int i = 0; i < Values; ++i) {
+		ASSERT_EQ(i / 7, values[i]);
+	}
+	delete[] values;
+}
+
+TEST_F(ParallelZipStreamTest, testEmpty) {
+	core::ThreadPool pool(1);
+	pool.init();
+	BufferedReadWriteStream stream;
+	{
+		ParallelZipWriteStream w(stream, pool);
+	}
+	EXPECT_EQ(4, stream.size());
+	stream.seek(0);
+	ParallelZipReadStream r(stream, pool);
+	uint8_t buf[4];
+	EXPECT_EQ(0, r.read(buf, sizeof(buf)));
+	EXPECT_TRUE(r.eos());
+}
+
+TEST_F(ParallelZipStreamTest, testTruncated) {
+	core::ThreadPool pool(2);
+	pool.init();
+	BufferedReadWriteStream stream;
+	write(pool, stream);
+	BufferedReadWriteStream truncated;
+	truncated.write(stream.getBuffer(), stream.size() / 2);
+	truncated.seek(0);
+	ParallelZipReadStream r(truncated, pool);
+	int32_t n = 0;
+	int i = 0;
+	for (; i < Values; ++i) {
+		if (r.readInt32(n) != 0) {
+			break;
+		}
+		ASSERT_EQ(i / 7, n);
+	}
+	EXPECT_LT(i, Values);
+	EXPECT_TRUE(r.eos());
+}
+
+} // namespace io
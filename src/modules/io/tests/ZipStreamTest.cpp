@@ -90,4 +90,40 @@ TEST_F(ZipStreamTest, testZipStreamNoSize) {
 	}
 }
 
+TEST_F(ZipStreamTest, testReadSomePastEnd) {
+	BufferedReadWriteStream stream(1024);
+	{
+		ZipWriteStream w(stream);
+		for (int i = 0; i < 64; ++i) {
+			ASSERT_TRUE(w.writeInt32(i));
+		}
+		ASSERT_TRUE(w.flush());
+	}
+	const int size = (int)stream.size();
+	stream.seek(0);
+	ZipReadStream r(stream, size);
+	uint8_t buf[1024];
+	ASSERT_EQ(64 * (int)sizeof(int32_t), r.readSome(buf, sizeof(buf)));
+	ASSERT_TRUE(r.eos());
+	ASSERT_EQ(0, r.readSome(buf, sizeof(buf)));
+	int32_t n;
+	ASSERT_EQ(-1, r.readInt32(n));
+}
+
+TEST_F(ZipStreamTest, testReadPastEnd) {
+	BufferedReadWriteStream stream(1024);
+	{
+		ZipWriteStream w(stream);
+		for (int i = 0; i < 64; ++i) {
+			ASSERT_TRUE(w.writeInt32(i));
+		}
+		ASSERT_TRUE(w.flush());
+	}
+	const int size = (int)stream.size();
+	stream.seek(0);
+	ZipReadStream r(stream, size);
+	uint8_t buf[1024];
+	ASSERT_EQ(-1, r.read(buf, sizeof(buf)));
+}
+
 } // namespace io
@@ -10,6 +10,7 @@
 #include "core/StringUtil.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
+#include "voxel/PaletteKdTree.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxelutil/VolumeMerger.h"
@@ -523,12 +524,20 @@ voxel::Palette SceneGraph::mergePalettes(bool removeUnused, int emptyIndex) cons
 			palette.removeGlow(i);
 		}
 		for (const SceneGraphNode &node : *this) {
-			core::Array<bool, voxel::PaletteMaxColors> used;
+			using UsedColors = core::Array<bool, voxel::PaletteMaxColors>;
+			UsedColors used;
 			if (removeUnused) {
 				used.fill(false);
-				voxelutil::visitVolume(*node.volume(), [&used] (int, int, int, const voxel::Voxel &voxel) {
-					used[voxel.getColor()] = true;
-				});
+				auto visitor = [](UsedColors &slabUsed, int, int, int, const voxel::Voxel &voxel) {
+					slabUsed[voxel.getColor()] = true;
+				};
+				auto reducer = [](UsedColors &target, const UsedColors &slabUsed) {
+					for (size_t i = 0; i < target.size(); ++i) {
+						target[i] |= slabUsed[i];
+					}
+				};
+				const voxel::RawVolume &volume = *node.volume();
+				voxelutil::visitVolumeParallel(volume, volume.region(), used, visitor, reducer);
 			} else {
 				used.fill(true);
 			}
@@ -583,6 +592,7 @@ SceneGraph::MergedVolumePalette SceneGraph::merge(bool transform) const {
 	}
 
 	voxel::RawVolume* merged = new voxel::RawVolume(mergedRegion);
+	const voxel::PaletteKdTree paletteTree(palette);
 	for (size_t i = 0; i < nodes.size(); ++i) {
 		const SceneGraphNode* node = nodes[i];
 		const voxel::Region& sourceRegion = node->region();
@@ -595,12 +605,12 @@ SceneGraph::MergedVolumePalette SceneGraph::merge(bool transform) const {
 			// TODO: rotation
 		}
 
-		voxelutil::mergeVolumes(merged, node->volume(), destRegion, sourceRegion, [node, &palette] (voxel::Voxel& voxel) {
+		voxelutil::mergeVolumes(merged, node->volume(), destRegion, sourceRegion, [node, &paletteTree] (voxel::Voxel& voxel) {
 			if (isAir(voxel.getMaterial())) {
 				return false;
 			}
 			const core::RGBA color = node->palette().color(voxel.getColor());
-			const uint8_t index = palette.getClosestMatch(color);
+			const uint8_t index = paletteTree.getClosestMatch(color);
 			voxel.setColor(index);
 			return true;
 		});
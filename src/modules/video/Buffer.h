@@ -63,6 +63,11 @@ public:
 	 */
 	void destroyVertexArray();
 	bool update(int32_t idx, const void* data, size_t size, bool orphaning = false);
+	/**
+	 * @brief Updates a part of the buffer without reallocating it
+	 * @note The range must be inside of the size that was given to the last @c update() call
+	 */
+	bool updateSubData(int32_t idx, size_t offset, const void* data, size_t size);
 
 	/**
 	 * @return -1 on error - otherwise the index [0,n) of the created buffer (not the Id)
@@ -3,7 +3,7 @@
  */
 
 #include "CubicSurfaceExtractor.h"
-#include "core/Common.h"
+#include "core/Bits.h"
 #include "ChunkMesh.h"
 #include "Voxel.h"
 #include "VoxelVertex.h"
@@ -12,9 +12,12 @@
 #include "core/Enum.h"
 #include "core/StandardLib.h"
 #include "core/NonCopyable.h"
+#include "core/ScopedPtr.h"
 #include "Region.h"
 #include "core/Trace.h"
 #include "Face.h"
+#include "PagedVolume.h"
+#include "RawVolume.h"
 #include <glm/vec3.hpp>
 #include <list>
 #include <vector>
@@ -234,10 +237,251 @@ CORE_FORCE_INLINE bool isQuadFlipped(const VoxelVertex& v00, const VoxelVertex&
 	return v00.ambientOcclusion + v11.ambientOcclusion > v01.ambientOcclusion + v10.ambientOcclusion;
 }
 
-static void meshify(Mesh* result, bool mergeQuads, bool ambientOcclusion, QuadListVector& vecListQuads) {
+/**
+ * @brief The 2d grid of one slice of quads that are facing into the same direction. Every row of the
+ * grid is a bitmask of 64 bit words that marks the occupied cells. This allows us to find the next quad
+ * as well as checking whole spans of cells for being occupied with a few word operations.
+ *
+ * The quads are stored with their vertices sorted by corners - see @c QuadCorner
+ */
+class QuadSliceMask : public core::NonCopyable {
+private:
+	int _width;
+	int _height;
+	int _words;
+	std::vector<uint64_t> _bits;
+	std::vector<Quad> _quads;
+
+	inline uint64_t *row(int v) {
+		return &_bits[v * _words];
+	}
+
+	inline const uint64_t *row(int v) const {
+		return &_bits[v * _words];
+	}
+
+public:
+	QuadSliceMask(int width, int height)
+		: _width(width), _height(height), _words((width + 63) / 64), _bits(_words * height, 0u),
+		  _quads(width * height, Quad(0, 0, 0, 0)) {
+	}
+
+	inline int width() const {
+		return _width;
+	}
+
+	inline int height() const {
+		return _height;
+	}
+
+	inline void set(int u, int v, const Quad &quad) {
+		core_assert_msg(u >= 0 && u < _width && v >= 0 && v < _height, "Mask access is out-of-range.");
+		row(v)[u / 64] |= (uint64_t)1 << (u % 64);
+		_quads[v * _width + u] = quad;
+	}
+
+	inline void unset(int u, int v) {
+		row(v)[u / 64] &= ~((uint64_t)1 << (u % 64));
+	}
+
+	inline bool isSet(int u, int v) const {
+		return (row(v)[u / 64] & ((uint64_t)1 << (u % 64))) != 0u;
+	}
+
+	inline const Quad &quad(int u, int v) const {
+		return _quads[v * _width + u];
+	}
+
+	/**
+	 * @return @c true if all cells in the given inclusive range of the row are occupied
+	 */
+	bool isSpanSet(int u0, int u1, int v) const {
+		const uint64_t *bits = row(v);
+		for (int word = u0 / 64; word <= u1 / 64; ++word) {
+			const int from = core_max(u0, word * 64) % 64;
+			const int to = core_min(u1, word * 64 + 63) % 64;
+			const uint64_t upper = to == 63 ? ~(uint64_t)0 : (((uint64_t)1 << (to + 1)) - 1u);
+			const uint64_t mask = upper & ~(((uint64_t)1 << from) - 1u);
+			if ((bits[word] & mask) != mask) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @return The first occupied cell in the given row that is not smaller than @c u or @c -1 if there is none
+	 */
+	int next(int u, int v) const {
+		if (u >= _width) {
+			return -1;
+		}
+		const uint64_t *bits = row(v);
+		int word = u / 64;
+		uint64_t val = bits[word] & (~(uint64_t)0 << (u % 64));
+		for (;;) {
+			if (val != 0u) {
+				return word * 64 + core::countTrailingZeros(val);
+			}
+			if (++word >= _words) {
+				return -1;
+			}
+			val = bits[word];
+		}
+	}
+};
+
+/**
+ * @brief The corners of a quad in the 2d space of a slice
+ */
+enum QuadCorner { CornerLowerLeft, CornerLowerRight, CornerUpperRight, CornerUpperLeft, CornerMax };
+
+template<class FUNC>
+static inline bool isSameQuad(const Quad &q1, const Quad &q2, const VertexArray &vv, FUNC &&equal) {
+	for (int i = 0; i < CornerMax; ++i) {
+		if (!equal(vv[q1.vertices[i]], vv[q2.vertices[i]])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Maps the vertex slots of the given quad to the corners in the slice plane
+ * @return The lower corner of the quad
+ */
+static glm::ivec3 quadCorners(const Quad &quad, const VertexArray &vv, int uAxis, int vAxis, QuadCorner *slots) {
+	glm::ivec3 mins(vv[quad.vertices[0]].position);
+	for (int i = 1; i < CornerMax; ++i) {
+		mins = glm::min(mins, glm::ivec3(vv[quad.vertices[i]].position));
+	}
+	for (int i = 0; i < CornerMax; ++i) {
+		const glm::ivec3 pos(vv[quad.vertices[i]].position);
+		const bool upperU = pos[uAxis] > mins[uAxis];
+		const bool upperV = pos[vAxis] > mins[vAxis];
+		slots[i] = upperV ? (upperU ? CornerUpperRight : CornerUpperLeft) : (upperU ? CornerLowerRight : CornerLowerLeft);
+	}
+	return mins;
+}
+
+/**
+ * @brief Merge the quads of a slice by walking the bitmask rows. Each quad is visited once to grow
+ * a rectangle into the positive u direction first, and the whole span is then grown into the positive
+ * v direction. The merge conditions are the same as in @c mergeQuads(): the vertices of the quads must
+ * be equal for the given function and neighbouring quads must share their edge vertices.
+ */
+template<class FUNC>
+static void greedyMerge(QuadSliceMask &mask, int v0, int vEndMax, const VertexArray &vv, FUNC &&equal, QuadList &out) {
+	for (int v = v0; v <= vEndMax; ++v) {
+		for (int u = mask.next(0, v); u != -1; u = mask.next(u + 1, v)) {
+			const Quad &seed = mask.quad(u, v);
+			mask.unset(u, v);
+			int uEnd = u;
+			while (uEnd + 1 < mask.width() && mask.isSet(uEnd + 1, v)) {
+				const Quad &left = mask.quad(uEnd, v);
+				const Quad &right = mask.quad(uEnd + 1, v);
+				if (left.vertices[CornerLowerRight] != right.vertices[CornerLowerLeft] ||
+					left.vertices[CornerUpperRight] != right.vertices[CornerUpperLeft]) {
+					break;
+				}
+				if (!isSameQuad(seed, right, vv, equal)) {
+					break;
+				}
+				++uEnd;
+				mask.unset(uEnd, v);
+			}
+			int vEnd = v;
+			while (vEnd + 1 <= vEndMax && mask.isSpanSet(u, uEnd, vEnd + 1)) {
+				bool mergeable = true;
+				for (int su = u; su <= uEnd; ++su) {
+					const Quad &below = mask.quad(su, vEnd);
+					const Quad &above = mask.quad(su, vEnd + 1);
+					if (below.vertices[CornerUpperLeft] != above.vertices[CornerLowerLeft] ||
+						below.vertices[CornerUpperRight] != above.vertices[CornerLowerRight]) {
+						mergeable = false;
+						break;
+					}
+					if (su > u) {
+						const Quad &left = mask.quad(su - 1, vEnd + 1);
+						if (left.vertices[CornerLowerRight] != above.vertices[CornerLowerLeft] ||
+							left.vertices[CornerUpperRight] != above.vertices[CornerUpperLeft]) {
+							mergeable = false;
+							break;
+						}
+					}
+					if (!isSameQuad(seed, above, vv, equal)) {
+						mergeable = false;
+						break;
+					}
+				}
+				if (!mergeable) {
+					break;
+				}
+				++vEnd;
+				for (int su = u; su <= uEnd; ++su) {
+					mask.unset(su, vEnd);
+				}
+			}
+			out.emplace_back(seed.vertices[CornerLowerLeft], mask.quad(uEnd, v).vertices[CornerLowerRight],
+							 mask.quad(uEnd, vEnd).vertices[CornerUpperRight], mask.quad(u, vEnd).vertices[CornerUpperLeft]);
+			u = uEnd;
+		}
+	}
+}
+
+/**
+ * @brief Replaces the quads of each slice with the greedy merged quads. This is linear in the amount of
+ * quads of a slice - while @c performQuadMerging() compares the quads pairwise and needs several passes.
+ *
+ * @param[in] uAxis The axis of the slice plane that is mapped to the columns of the mask
+ * @param[in] vAxis The axis of the slice plane that is mapped to the rows of the mask
+ */
+static void performGreedyQuadMerging(QuadListVector &vecListQuads, QuadSliceMask &mask, int uAxis, int vAxis,
+									 const Mesh *meshCurrent, const glm::ivec3 &translate, bool ambientOcclusion) {
+	core_trace_scoped(PerformGreedyQuadMerging);
+	auto *equal = isSameVertex;
+	if (!ambientOcclusion) {
+		equal = isSameColor;
+	}
+	const VertexArray &vv = meshCurrent->getVertexVector();
+	QuadList merged;
+	for (QuadList &listQuads : vecListQuads) {
+		if (listQuads.size() <= 1) {
+			continue;
+		}
+		QuadCorner slots[CornerMax];
+		int vMin = mask.height();
+		int vMax = -1;
+		for (const Quad &quad : listQuads) {
+			const glm::ivec3 mins = quadCorners(quad, vv, uAxis, vAxis, slots);
+			Quad sorted(0, 0, 0, 0);
+			for (int i = 0; i < CornerMax; ++i) {
+				sorted.vertices[slots[i]] = quad.vertices[i];
+			}
+			const int u = mins[uAxis] - translate[uAxis];
+			const int v = mins[vAxis] - translate[vAxis];
+			mask.set(u, v, sorted);
+			vMin = core_min(vMin, v);
+			vMax = core_max(vMax, v);
+		}
+		merged.clear();
+		greedyMerge(mask, vMin, vMax, vv, equal, merged);
+		listQuads.clear();
+		for (const Quad &quad : merged) {
+			listQuads.emplace_back(quad.vertices[slots[0]], quad.vertices[slots[1]], quad.vertices[slots[2]],
+								   quad.vertices[slots[3]]);
+		}
+	}
+}
+
+static void meshify(Mesh* result, bool mergeQuads, bool greedyMerge, bool ambientOcclusion, QuadListVector& vecListQuads,
+		QuadSliceMask *mask, int uAxis, int vAxis, const glm::ivec3& translate) {
 	core_trace_scoped(GenerateMeshify);
+	if (mergeQuads && greedyMerge) {
+		performGreedyQuadMerging(vecListQuads, *mask, uAxis, vAxis, result, translate, ambientOcclusion);
+	}
 	for (QuadList& listQuads : vecListQuads) {
-		if (mergeQuads) {
+		if (mergeQuads && !greedyMerge) {
 			core_trace_scoped(MergeQuads);
 			// Repeatedly call this function until it returns
 			// false to indicate nothing more can be done.
@@ -305,7 +549,8 @@ static IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t
 	return 0; //Should never happen.
 }
 
-void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion) {
+template<class VOLUME>
+static void extractCubicMeshT(const VOLUME* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool greedyMerge) {
 	core_trace_scoped(ExtractCubicMesh);
 
 	result->clear();
@@ -345,7 +590,7 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 	vecQuadsT[core::enumVal(FaceNames::NegativeZ)].resize(zSize);
 	vecQuadsT[core::enumVal(FaceNames::PositiveZ)].resize(zSize);
 
-	voxel::RawVolume::Sampler volumeSampler(volData);
+	typename VOLUME::Sampler volumeSampler(volData);
 
 	{
 	core_trace_scoped(QuadGeneration);
@@ -634,11 +879,21 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 
 	{
 		core_trace_scoped(GenerateMesh);
-		for (QuadListVector& vecListQuads : vecQuads) {
-			meshify(&result->mesh[0], mergeQuads, ambientOcclusion, vecListQuads);
+		// the slice plane axes for each face direction - the masks are only needed for the greedy merging
+		const int uAxes[] = {1, 0, 0, 1, 0, 0};
+		const int vAxes[] = {2, 2, 1, 2, 2, 1};
+		const int sizes[] = {xSize, ySize, zSize};
+		core::ScopedPtr<QuadSliceMask> masks[3];
+		if (mergeQuads && greedyMerge) {
+			for (int axis = 0; axis < 3; ++axis) {
+				masks[axis] = new QuadSliceMask(sizes[uAxes[axis]], sizes[vAxes[axis]]);
+			}
 		}
-		for (QuadListVector& vecListQuads : vecQuadsT) {
-			meshify(&result->mesh[1], mergeQuads, ambientOcclusion, vecListQuads);
+		for (int i = 0; i < core::enumVal(FaceNames::Max); ++i) {
+			meshify(&result->mesh[0], mergeQuads, greedyMerge, ambientOcclusion, vecQuads[i], masks[i % 3], uAxes[i], vAxes[i], translate);
+		}
+		for (int i = 0; i < core::enumVal(FaceNames::Max); ++i) {
+			meshify(&result->mesh[1], mergeQuads, greedyMerge, ambientOcclusion, vecQuadsT[i], masks[i % 3], uAxes[i], vAxes[i], translate);
 		}
 	}
 
@@ -646,4 +901,12 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 	result->compressIndices();
 }
 
+void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool greedyMerge) {
+	extractCubicMeshT(volData, region, result, translate, mergeQuads, reuseVertices, ambientOcclusion, greedyMerge);
+}
+
+void extractCubicMesh(const voxel::PagedVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion, bool greedyMerge) {
+	extractCubicMeshT(volData, region, result, translate, mergeQuads, reuseVertices, ambientOcclusion, greedyMerge);
+}
+
 }
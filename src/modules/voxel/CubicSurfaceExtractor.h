@@ -9,6 +9,7 @@
 namespace voxel {
 
 class RawVolume;
+class PagedVolume;
 class Region;
 struct ChunkMesh;
 class Palette;
@@ -98,8 +99,21 @@ class Palette;
  * @li It leaves the user in control of memory allocation and would allow them to implement e.g. a mesh pooling system.
  * @li The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
  * @li The user could provide a custom mesh class, e.g a thin wrapper around an openGL VBO to allow direct writing into this structure.
+ *
+ * @par Quad merging
+ *
+ * If @c mergeQuads is active, quads in the same plane that are facing into the same direction and that have the same vertex
+ * attributes (color, flags and - if @c ambientOcclusion is active - the ambient occlusion values) are merged into bigger quads.
+ * The @c greedyMerge mode puts the quads of each slice into a 2d grid with 64 bit occupancy masks per row and merges them
+ * greedily in one pass. The legacy mode compares the quads of a slice pairwise until nothing can get merged anymore - this
+ * is quadratic in the amount of quads per slice.
+ */
+void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true, bool greedyMerge = true);
+/**
+ * @brief Extract the mesh from a sparse volume - chunks without voxels don't need to be allocated
+ * @sa PagedVolume
  */
-void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true);
+void extractCubicMesh(const voxel::PagedVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true, bool greedyMerge = true);
 
 }
 
@@ -0,0 +1,459 @@
+/**
+ * @file
+ */
+
+#include "PagedVolume.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/common.hpp>
+#include <limits>
+
+namespace voxel {
+
+static inline glm::ivec3 toChunkPos(const glm::ivec3 &local) {
+	return glm::ivec3(local.x >> PagedVolume::ChunkBitShift, local.y >> PagedVolume::ChunkBitShift,
+					  local.z >> PagedVolume::ChunkBitShift);
+}
+
+static inline glm::ivec3 toPosInChunk(const glm::ivec3 &local) {
+	return glm::ivec3(local.x & PagedVolume::ChunkMask, local.y & PagedVolume::ChunkMask,
+					  local.z & PagedVolume::ChunkMask);
+}
+
+// the flags are part of the voxel data, too
+static inline bool isSameVoxel(const Voxel &a, const Voxel &b) {
+	return a.isSame(b) && a.getFlags() == b.getFlags();
+}
+
+Voxel PagedVolume::Chunk::runVoxel(int idx) const {
+	// find the first run that ends after the index
+	int low = 0;
+	int high = _runs - 1;
+	while (low < high) {
+		const int mid = (low + high) / 2;
+		if (_runEnds[mid] <= idx) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return _runVoxels[low];
+}
+
+PagedVolume::PagedVolume(const Region &region) : _region(region) {
+	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
+	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
+	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
+	clear();
+}
+
+PagedVolume::~PagedVolume() {
+	clear();
+}
+
+void PagedVolume::setBorderValue(const Voxel &voxel) {
+	_borderVoxel = voxel;
+}
+
+void PagedVolume::freeChunkData(Chunk *c) {
+	core_free(c->_data);
+	c->_data = nullptr;
+	// the voxels of the runs are part of the same allocation
+	core_free(c->_runEnds);
+	c->_runEnds = nullptr;
+	c->_runVoxels = nullptr;
+	c->_runs = 0;
+}
+
+void PagedVolume::compressChunk(Chunk *c) {
+	if (c->_data == nullptr) {
+		return;
+	}
+	int runs = 1;
+	for (int i = 1; i < ChunkVoxels; ++i) {
+		if (!isSameVoxel(c->_data[i], c->_data[i - 1])) {
+			++runs;
+		}
+	}
+	if (runs == 1) {
+		c->_uniform = c->_data[0];
+		freeChunkData(c);
+		return;
+	}
+	const size_t runBytes = (size_t)runs * (sizeof(uint16_t) + sizeof(Voxel));
+	if (runBytes >= ChunkVoxels * sizeof(Voxel)) {
+		// noise - keep the voxel data
+		return;
+	}
+	uint8_t *buf = (uint8_t *)core_malloc(runBytes);
+	uint16_t *runEnds = (uint16_t *)buf;
+	Voxel *runVoxels = (Voxel *)(buf + runs * sizeof(uint16_t));
+	int run = 0;
+	for (int i = 1; i < ChunkVoxels; ++i) {
+		if (!isSameVoxel(c->_data[i], c->_data[i - 1])) {
+			runEnds[run] = (uint16_t)i;
+			runVoxels[run] = c->_data[i - 1];
+			++run;
+		}
+	}
+	runEnds[run] = (uint16_t)ChunkVoxels;
+	runVoxels[run] = c->_data[ChunkVoxels - 1];
+	core_free(c->_data);
+	c->_data = nullptr;
+	c->_runEnds = runEnds;
+	c->_runVoxels = runVoxels;
+	c->_runs = runs;
+}
+
+void PagedVolume::unpackChunk(Chunk *c) {
+	if (c->_data != nullptr) {
+		return;
+	}
+	Voxel *data = (Voxel *)core_malloc(ChunkVoxels * sizeof(Voxel));
+	if (c->_runEnds != nullptr) {
+		int start = 0;
+		for (int run = 0; run < c->_runs; ++run) {
+			const int end = c->_runEnds[run];
+			for (int i = start; i < end; ++i) {
+				data[i] = c->_runVoxels[run];
+			}
+			start = end;
+		}
+		freeChunkData(c);
+	} else {
+		for (int i = 0; i < ChunkVoxels; ++i) {
+			data[i] = c->_uniform;
+		}
+	}
+	c->_data = data;
+}
+
+void PagedVolume::touchChunk(Chunk *c) {
+	if (c->_lastUse == _useCounter && _useCounter != 0u) {
+		// still the chunk that was modified last
+		return;
+	}
+	c->_lastUse = ++_useCounter;
+	for (Chunk *hot : _hotChunks) {
+		if (hot == c) {
+			return;
+		}
+	}
+	_hotChunks.push_back(c);
+	if ((int)_hotChunks.size() <= _maxHotChunks) {
+		return;
+	}
+	size_t coldest = 0;
+	for (size_t i = 1; i < _hotChunks.size(); ++i) {
+		if (_hotChunks[i]->_lastUse < _hotChunks[coldest]->_lastUse) {
+			coldest = i;
+		}
+	}
+	compressChunk(_hotChunks[coldest]);
+	_hotChunks.erase(coldest);
+}
+
+void PagedVolume::setCompression(bool compression, int hotChunks) {
+	_maxHotChunks = core_max(1, hotChunks);
+	_compression = compression;
+	_hotChunks.clear();
+	if (_compression) {
+		compact();
+		return;
+	}
+	for (const auto &entry : _chunks) {
+		if (entry->value->isCompressed()) {
+			unpackChunk(entry->value);
+		}
+	}
+}
+
+void PagedVolume::clear() {
+	for (const auto &entry : _chunks) {
+		freeChunkData(entry->value);
+		delete entry->value;
+	}
+	_chunks.clear();
+	_hotChunks.clear();
+	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
+	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
+	_boundsValid = false;
+}
+
+size_t PagedVolume::allocatedChunkCount() const {
+	size_t n = 0u;
+	for (const auto &entry : _chunks) {
+		if (entry->value->_data != nullptr) {
+			++n;
+		}
+	}
+	return n;
+}
+
+size_t PagedVolume::compressedChunkCount() const {
+	size_t n = 0u;
+	for (const auto &entry : _chunks) {
+		if (entry->value->isCompressed()) {
+			++n;
+		}
+	}
+	return n;
+}
+
+size_t PagedVolume::memoryUsage() const {
+	size_t bytes = 0u;
+	for (const auto &entry : _chunks) {
+		const Chunk *c = entry->value;
+		bytes += sizeof(Chunk);
+		if (c->_data != nullptr) {
+			bytes += ChunkVoxels * sizeof(Voxel);
+		} else if (c->_runEnds != nullptr) {
+			bytes += (size_t)c->_runs * (sizeof(uint16_t) + sizeof(Voxel));
+		}
+	}
+	return bytes;
+}
+
+Voxel PagedVolume::voxel(int32_t x, int32_t y, int32_t z) const {
+	if (!_region.containsPoint(x, y, z)) {
+		return _borderVoxel;
+	}
+	const glm::ivec3 local = glm::ivec3(x, y, z) - _region.getLowerCorner();
+	const glm::ivec3 posInChunk = toPosInChunk(local);
+	return chunk(toChunkPos(local))->voxel(posInChunk.x, posInChunk.y, posInChunk.z);
+}
+
+bool PagedVolume::setVoxel(int32_t x, int32_t y, int32_t z, const Voxel &voxel) {
+	return setVoxel(glm::ivec3(x, y, z), voxel);
+}
+
+bool PagedVolume::setVoxel(const glm::ivec3 &pos, const Voxel &voxel) {
+	const bool inside = _region.containsPoint(pos);
+	core_assert_msg(inside, "Position is outside valid region %i:%i:%i (mins[%i:%i:%i], maxs[%i:%i:%i])",
+			pos.x, pos.y, pos.z, _region.getLowerX(), _region.getLowerY(), _region.getLowerZ(),
+			_region.getUpperX(), _region.getUpperY(), _region.getUpperZ());
+	if (!inside) {
+		return false;
+	}
+	const glm::ivec3 local = pos - _region.getLowerCorner();
+	const glm::ivec3 chunkPos = toChunkPos(local);
+	const glm::ivec3 posInChunk = toPosInChunk(local);
+	const int index = Chunk::index(posInChunk.x, posInChunk.y, posInChunk.z);
+
+	Chunk *c;
+	auto iter = _chunks.find(chunkPos);
+	if (iter == _chunks.end()) {
+		if (_emptyChunk._uniform.isSame(voxel)) {
+			return false;
+		}
+		c = new Chunk();
+		c->_uniform = _emptyChunk._uniform;
+		_chunks.put(chunkPos, c);
+	} else {
+		c = iter->value;
+	}
+
+	if (c->_data == nullptr) {
+		if (c->voxel(posInChunk.x, posInChunk.y, posInChunk.z).isSame(voxel)) {
+			return false;
+		}
+		unpackChunk(c);
+	} else if (c->_data[index].isSame(voxel)) {
+		return false;
+	}
+	c->_data[index] = voxel;
+	if (_compression) {
+		touchChunk(c);
+	}
+	_mins = (glm::min)(_mins, pos);
+	_maxs = (glm::max)(_maxs, pos);
+	_boundsValid = true;
+	return true;
+}
+
+void PagedVolume::compact() {
+	core::DynamicArray<glm::ivec3> emptyChunks;
+	for (const auto &entry : _chunks) {
+		Chunk *c = entry->value;
+		if (_compression) {
+			compressChunk(c);
+		} else if (c->_data != nullptr) {
+			const Voxel first = c->_data[0];
+			bool uniform = true;
+			for (int i = 1; i < ChunkVoxels; ++i) {
+				if (!c->_data[i].isSame(first)) {
+					uniform = false;
+					break;
+				}
+			}
+			if (!uniform) {
+				continue;
+			}
+			core_free(c->_data);
+			c->_data = nullptr;
+			c->_uniform = first;
+		}
+		if (c->isUniform() && c->_uniform.isSame(_emptyChunk._uniform)) {
+			emptyChunks.push_back(entry->key);
+		}
+	}
+	_hotChunks.clear();
+	for (const glm::ivec3 &chunkPos : emptyChunks) {
+		auto iter = _chunks.find(chunkPos);
+		delete iter->value;
+		_chunks.erase(iter);
+	}
+}
+
+void PagedVolume::copyInto(RawVolume &target) const {
+	const glm::ivec3 &lower = _region.getLowerCorner();
+	for (const auto &entry : _chunks) {
+		const Chunk *c = entry->value;
+		const glm::ivec3 chunkLower = lower + entry->key * ChunkSideLength;
+		Region region(chunkLower, chunkLower + ChunkMask);
+		region.cropTo(_region);
+		region.cropTo(target.region());
+		if (!region.isValid()) {
+			continue;
+		}
+		const glm::ivec3 &mins = region.getLowerCorner();
+		const glm::ivec3 &maxs = region.getUpperCorner();
+		for (int32_t z = mins.z; z <= maxs.z; ++z) {
+			for (int32_t y = mins.y; y <= maxs.y; ++y) {
+				for (int32_t x = mins.x; x <= maxs.x; ++x) {
+					const Voxel voxel = c->voxel(x - chunkLower.x, y - chunkLower.y, z - chunkLower.z);
+					if (isAir(voxel.getMaterial())) {
+						continue;
+					}
+					target.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+}
+
+void PagedVolume::copyChunkFrom(const RawVolume &source, const glm::ivec3 &chunkPos, const Region &region) {
+	Chunk *c = nullptr;
+	auto iter = _chunks.find(chunkPos);
+	if (iter != _chunks.end()) {
+		c = iter->value;
+	}
+	const glm::ivec3 chunkLower = _region.getLowerCorner() + chunkPos * ChunkSideLength;
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	bool modified = false;
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			for (int32_t x = mins.x; x <= maxs.x; ++x) {
+				const Voxel &voxel = source.voxel(x, y, z);
+				const int index = Chunk::index(x - chunkLower.x, y - chunkLower.y, z - chunkLower.z);
+				if (c == nullptr) {
+					if (isSameVoxel(_emptyChunk._uniform, voxel)) {
+						continue;
+					}
+					c = new Chunk();
+					c->_uniform = _emptyChunk._uniform;
+					_chunks.put(chunkPos, c);
+				}
+				if (c->_data == nullptr) {
+					if (isSameVoxel(c->voxel(x - chunkLower.x, y - chunkLower.y, z - chunkLower.z), voxel)) {
+						continue;
+					}
+					unpackChunk(c);
+				} else if (isSameVoxel(c->_data[index], voxel)) {
+					continue;
+				}
+				c->_data[index] = voxel;
+				const glm::ivec3 pos(x, y, z);
+				_mins = (glm::min)(_mins, pos);
+				_maxs = (glm::max)(_maxs, pos);
+				modified = true;
+			}
+		}
+	}
+	if (modified) {
+		_boundsValid = true;
+		if (_compression) {
+			touchChunk(c);
+		}
+	}
+}
+
+void PagedVolume::copyFrom(const RawVolume &source, const Region &region) {
+	Region copyRegion = region;
+	copyRegion.cropTo(_region);
+	copyRegion.cropTo(source.region());
+	if (!copyRegion.isValid()) {
+		return;
+	}
+	const glm::ivec3 &lower = _region.getLowerCorner();
+	const glm::ivec3 chunkMins = toChunkPos(copyRegion.getLowerCorner() - lower);
+	const glm::ivec3 chunkMaxs = toChunkPos(copyRegion.getUpperCorner() - lower);
+	for (int32_t cz = chunkMins.z; cz <= chunkMaxs.z; ++cz) {
+		for (int32_t cy = chunkMins.y; cy <= chunkMaxs.y; ++cy) {
+			for (int32_t cx = chunkMins.x; cx <= chunkMaxs.x; ++cx) {
+				const glm::ivec3 chunkPos(cx, cy, cz);
+				const glm::ivec3 chunkLower = lower + chunkPos * ChunkSideLength;
+				Region chunkRegion(chunkLower, chunkLower + ChunkMask);
+				chunkRegion.cropTo(copyRegion);
+				copyChunkFrom(source, chunkPos, chunkRegion);
+			}
+		}
+	}
+}
+
+PagedVolume::Sampler::Sampler(const PagedVolume *volume) : _volume(const_cast<PagedVolume *>(volume)) {
+}
+
+PagedVolume::Sampler::Sampler(const PagedVolume &volume) : _volume(const_cast<PagedVolume *>(&volume)) {
+}
+
+bool PagedVolume::Sampler::setPosition(int32_t x, int32_t y, int32_t z) {
+	_posInVolume = glm::ivec3(x, y, z);
+	const Region &region = _volume->region();
+	if (!region.containsPoint(x, y, z)) {
+		_chunk = nullptr;
+		return false;
+	}
+	const glm::ivec3 local = _posInVolume - region.getLowerCorner();
+	const glm::ivec3 chunkPos = toChunkPos(local);
+	_posInChunk = toPosInChunk(local);
+	// chunks at the upper end of the region are not fully inside the volume
+	const glm::ivec3 chunkLower = chunkPos * ChunkSideLength;
+	_chunkUpper = (glm::min)(glm::ivec3(ChunkMask), region.getUpperCorner() - region.getLowerCorner() - chunkLower);
+	_chunk = _volume->chunk(chunkPos);
+	return true;
+}
+
+void PagedVolume::Sampler::move(int dx, int dy, int dz) {
+	_posInVolume.x += dx;
+	_posInVolume.y += dy;
+	_posInVolume.z += dz;
+	if (_chunk != nullptr) {
+		const int x = _posInChunk.x + dx;
+		const int y = _posInChunk.y + dy;
+		const int z = _posInChunk.z + dz;
+		if ((uint32_t)x <= (uint32_t)_chunkUpper.x && (uint32_t)y <= (uint32_t)_chunkUpper.y &&
+			(uint32_t)z <= (uint32_t)_chunkUpper.z) {
+			_posInChunk = glm::ivec3(x, y, z);
+			return;
+		}
+	}
+	setPosition(_posInVolume);
+}
+
+bool PagedVolume::Sampler::setVoxel(const Voxel &voxel) {
+	if (_chunk == nullptr) {
+		return false;
+	}
+	if (!_volume->setVoxel(_posInVolume, voxel)) {
+		return false;
+	}
+	// the chunk might have been created or its data allocated
+	setPosition(_posInVolume);
+	return true;
+}
+
+} // namespace voxel
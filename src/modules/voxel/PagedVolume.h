@@ -0,0 +1,532 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Voxel.h"
+#include "Region.h"
+#include "core/GLM.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include <glm/vec3.hpp>
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Sparse volume implementation which stores the voxels in fixed size chunks
+ *
+ * Unlike the @c RawVolume the memory doesn't scale with the size of the region, but with the amount of
+ * chunks that contain voxels. Chunks that were never touched are not stored at all and read as air.
+ * Chunks that are filled with one voxel only (see @c compact()) store this single voxel instead of the
+ * full voxel data.
+ *
+ * With @c setCompression() the chunks are run length compressed. Compressed chunks are read without unpacking them.
+ * Only a few hot chunks that were modified last keep their uncompressed voxel data - a chunk that drops out of this
+ * list is compressed again. This keeps editing fast while big but simple volumes (terrain, schematics) only need a
+ * fraction of the memory.
+ *
+ * The api mirrors the @c RawVolume - including the @c Sampler - so the templated algorithms like
+ * @c voxelutil::visitVolume() or the surface extraction can work with both volume types.
+ *
+ * @sa RawVolume
+ */
+class PagedVolume : public core::NonCopyable {
+public:
+	static constexpr int ChunkBitShift = 5;
+	static constexpr int ChunkSideLength = 1 << ChunkBitShift;
+	static constexpr int ChunkMask = ChunkSideLength - 1;
+	static constexpr int ChunkVoxels = ChunkSideLength * ChunkSideLength * ChunkSideLength;
+
+	/**
+	 * The amount of chunks that are kept uncompressed if the compression is active
+	 */
+	static constexpr int DefaultHotChunks = 16;
+
+	/**
+	 * @brief A cube of @c ChunkSideLength voxels. The voxel data is only allocated if the chunk is not uniform.
+	 */
+	class Chunk {
+	private:
+		friend class PagedVolume;
+		Voxel *_data = nullptr;
+		Voxel _uniform;
+		/**
+		 * The exclusive end index of each run followed by the voxels of the runs - @c nullptr if not compressed
+		 */
+		uint16_t *_runEnds = nullptr;
+		Voxel *_runVoxels = nullptr;
+		int _runs = 0;
+		/**
+		 * The value of the use counter of the volume when the chunk was modified the last time
+		 */
+		uint32_t _lastUse = 0u;
+
+		Voxel runVoxel(int idx) const;
+
+	public:
+		static inline int index(int x, int y, int z) {
+			return x + (y << ChunkBitShift) + (z << (ChunkBitShift * 2));
+		}
+
+		inline bool isUniform() const {
+			return _data == nullptr && _runEnds == nullptr;
+		}
+
+		inline bool isCompressed() const {
+			return _runEnds != nullptr;
+		}
+
+		inline Voxel voxel(int x, int y, int z) const {
+			if (_data != nullptr) {
+				return _data[index(x, y, z)];
+			}
+			if (_runEnds != nullptr) {
+				return runVoxel(index(x, y, z));
+			}
+			return _uniform;
+		}
+	};
+
+	class Sampler {
+	public:
+		Sampler(const PagedVolume &volume);
+		Sampler(const PagedVolume *volume);
+
+		/**
+		 * @note The voxels are returned by value - see @c PagedVolume::voxel()
+		 */
+		Voxel voxel() const;
+		const Region &region() const;
+
+		bool currentPositionValid() const;
+
+		bool setPosition(const glm::ivec3 &pos);
+		bool setPosition(int32_t x, int32_t y, int32_t z);
+		/**
+		 * @return @c true if the voxel was placed, @c false if it was already the same voxel or the position is
+		 * outside the volume
+		 */
+		bool setVoxel(const Voxel &voxel);
+		const glm::ivec3 &position() const;
+
+		void movePositiveX(uint32_t offset = 1);
+		void movePositiveY(uint32_t offset = 1);
+		void movePositiveZ(uint32_t offset = 1);
+
+		void moveNegativeX(uint32_t offset = 1);
+		void moveNegativeY(uint32_t offset = 1);
+		void moveNegativeZ(uint32_t offset = 1);
+
+		Voxel peekVoxel1nx1ny1nz() const;
+		Voxel peekVoxel1nx1ny0pz() const;
+		Voxel peekVoxel1nx1ny1pz() const;
+		Voxel peekVoxel1nx0py1nz() const;
+		Voxel peekVoxel1nx0py0pz() const;
+		Voxel peekVoxel1nx0py1pz() const;
+		Voxel peekVoxel1nx1py1nz() const;
+		Voxel peekVoxel1nx1py0pz() const;
+		Voxel peekVoxel1nx1py1pz() const;
+
+		Voxel peekVoxel0px1ny1nz() const;
+		Voxel peekVoxel0px1ny0pz() const;
+		Voxel peekVoxel0px1ny1pz() const;
+		Voxel peekVoxel0px0py1nz() const;
+		Voxel peekVoxel0px0py0pz() const;
+		Voxel peekVoxel0px0py1pz() const;
+		Voxel peekVoxel0px1py1nz() const;
+		Voxel peekVoxel0px1py0pz() const;
+		Voxel peekVoxel0px1py1pz() const;
+
+		Voxel peekVoxel1px1ny1nz() const;
+		Voxel peekVoxel1px1ny0pz() const;
+		Voxel peekVoxel1px1ny1pz() const;
+		Voxel peekVoxel1px0py1nz() const;
+		Voxel peekVoxel1px0py0pz() const;
+		Voxel peekVoxel1px0py1pz() const;
+		Voxel peekVoxel1px1py1nz() const;
+		Voxel peekVoxel1px1py0pz() const;
+		Voxel peekVoxel1px1py1pz() const;
+
+	private:
+		/**
+		 * @brief Looks into the current chunk if possible - and falls back to the volume lookup otherwise
+		 */
+		Voxel peek(int dx, int dy, int dz) const;
+		void move(int dx, int dy, int dz);
+
+		PagedVolume *_volume;
+
+		// The current position in the volume
+		glm::ivec3 _posInVolume{0, 0, 0};
+		// The current position in the current chunk
+		glm::ivec3 _posInChunk{0, 0, 0};
+		// The max position in the current chunk that is still inside the region of the volume
+		glm::ivec3 _chunkUpper{-1, -1, -1};
+
+		/** @c nullptr if the current position is outside the volume */
+		const Chunk *_chunk = nullptr;
+	};
+
+	PagedVolume(const Region &region);
+	~PagedVolume();
+
+	/**
+	 * @brief The border value is returned whenever an attempt is made to read a voxel which
+	 * is outside the extents of the volume.
+	 */
+	const Voxel &borderValue() const;
+	void setBorderValue(const Voxel &voxel);
+
+	/**
+	 * @return A Region representing the extent of the volume.
+	 */
+	const Region &region() const;
+
+	int32_t width() const;
+	int32_t height() const;
+	int32_t depth() const;
+
+	/**
+	 * the vector that describes the mins value of an aabb where a voxel is set in this volume
+	 * deleting a voxel afterwards might lead to invalid results
+	 */
+	glm::ivec3 mins() const;
+	/**
+	 * the vector that describes the maxs value of an aabb where a voxel is set in this volume
+	 * deleting a voxel afterwards might lead to invalid results
+	 */
+	glm::ivec3 maxs() const;
+
+	/**
+	 * Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+	 * @note Unlike the @c RawVolume the voxel is returned by value - modifying the volume might compress the chunk
+	 * and release the voxel data that a reference would point into
+	 */
+	Voxel voxel(int32_t x, int32_t y, int32_t z) const;
+	inline Voxel voxel(const glm::ivec3 &pos) const {
+		return voxel(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * @return @c true if the voxel was placed, @c false if it was already the same voxel
+	 */
+	bool setVoxel(int32_t x, int32_t y, int32_t z, const Voxel &voxel);
+	bool setVoxel(const glm::ivec3 &pos, const Voxel &voxel);
+
+	/**
+	 * @brief Release all chunks
+	 */
+	void clear();
+
+	/**
+	 * @brief Release the voxel data of all chunks that only contain one voxel and drop chunks
+	 * that only contain air. If the compression is active, all other chunks are compressed.
+	 */
+	void compact();
+
+	/**
+	 * @brief Activates the run length compression of the chunks
+	 * @param hotChunks The amount of chunks that were modified last and are kept uncompressed
+	 * @note Disabling the compression unpacks all chunks again
+	 */
+	void setCompression(bool compression, int hotChunks = DefaultHotChunks);
+	inline bool compression() const {
+		return _compression;
+	}
+
+	/**
+	 * @brief Copy all voxels that are inside the region of the given volume into it
+	 */
+	void copyInto(RawVolume &target) const;
+
+	/**
+	 * @brief Copy the voxels of the given region of the source volume into this volume
+	 * @note Unlike calling @c setVoxel() for each voxel, each chunk is only looked up once
+	 */
+	void copyFrom(const RawVolume &source, const Region &region);
+
+	/**
+	 * @return The amount of chunks that are stored
+	 */
+	inline size_t chunkCount() const {
+		return _chunks.size();
+	}
+
+	/**
+	 * @return The amount of chunks with allocated voxel data - each of them uses @c ChunkVoxels voxels
+	 */
+	size_t allocatedChunkCount() const;
+
+	/**
+	 * @return The amount of run length compressed chunks
+	 */
+	size_t compressedChunkCount() const;
+
+	/**
+	 * @return The amount of bytes that are used for the voxel data of the chunks
+	 */
+	size_t memoryUsage() const;
+
+	/**
+	 * @brief Shift the region of the volume by the given coordinates
+	 */
+	void translate(const glm::ivec3 &t) {
+		_region.shift(t.x, t.y, t.z);
+		_mins += t;
+		_maxs += t;
+	}
+
+private:
+	using ChunkMap = core::FlatMap<glm::ivec3, Chunk *, glm::hash<glm::ivec3>>;
+
+	/**
+	 * @return The chunk for the given chunk coordinates - or the shared air chunk if there is none
+	 */
+	const Chunk *chunk(const glm::ivec3 &chunkPos) const;
+
+	/**
+	 * @brief Compresses the voxel data of the chunk or releases it if the chunk is uniform
+	 */
+	static void compressChunk(Chunk *c);
+	/**
+	 * @brief Makes sure the chunk has uncompressed voxel data that can be modified
+	 */
+	void unpackChunk(Chunk *c);
+	static void freeChunkData(Chunk *c);
+	void copyChunkFrom(const RawVolume &source, const glm::ivec3 &chunkPos, const Region &region);
+	/**
+	 * @brief Marks the chunk as modified and compresses the least recently modified chunk if there are too many
+	 * hot chunks
+	 */
+	void touchChunk(Chunk *c);
+
+	Region _region;
+	Voxel _borderVoxel;
+	// returned for every position that is inside the region but in a chunk that doesn't exist
+	Chunk _emptyChunk;
+	ChunkMap _chunks;
+
+	bool _compression = false;
+	int _maxHotChunks = DefaultHotChunks;
+	uint32_t _useCounter = 0u;
+	// the uncompressed chunks if the compression is active
+	core::DynamicArray<Chunk *> _hotChunks;
+
+	glm::ivec3 _mins;
+	glm::ivec3 _maxs;
+	bool _boundsValid = false;
+};
+
+inline const Region &PagedVolume::region() const {
+	return _region;
+}
+
+inline const Voxel &PagedVolume::borderValue() const {
+	return _borderVoxel;
+}
+
+inline int32_t PagedVolume::width() const {
+	return _region.getWidthInVoxels();
+}
+
+inline int32_t PagedVolume::height() const {
+	return _region.getHeightInVoxels();
+}
+
+inline int32_t PagedVolume::depth() const {
+	return _region.getDepthInVoxels();
+}
+
+inline glm::ivec3 PagedVolume::mins() const {
+	if (!_boundsValid) {
+		return _region.getLowerCorner();
+	}
+	return _mins;
+}
+
+inline glm::ivec3 PagedVolume::maxs() const {
+	if (!_boundsValid) {
+		return _region.getUpperCorner();
+	}
+	return _maxs;
+}
+
+inline const PagedVolume::Chunk *PagedVolume::chunk(const glm::ivec3 &chunkPos) const {
+	auto iter = _chunks.find(chunkPos);
+	if (iter == _chunks.end()) {
+		return &_emptyChunk;
+	}
+	return iter->value;
+}
+
+inline const Region &PagedVolume::Sampler::region() const {
+	return _volume->region();
+}
+
+inline const glm::ivec3 &PagedVolume::Sampler::position() const {
+	return _posInVolume;
+}
+
+inline bool PagedVolume::Sampler::currentPositionValid() const {
+	return _chunk != nullptr;
+}
+
+inline bool PagedVolume::Sampler::setPosition(const glm::ivec3 &pos) {
+	return setPosition(pos.x, pos.y, pos.z);
+}
+
+inline Voxel PagedVolume::Sampler::voxel() const {
+	if (_chunk == nullptr) {
+		return _volume->borderValue();
+	}
+	return _chunk->voxel(_posInChunk.x, _posInChunk.y, _posInChunk.z);
+}
+
+inline Voxel PagedVolume::Sampler::peek(int dx, int dy, int dz) const {
+	const int x = _posInChunk.x + dx;
+	const int y = _posInChunk.y + dy;
+	const int z = _posInChunk.z + dz;
+	if (_chunk != nullptr && (uint32_t)x <= (uint32_t)_chunkUpper.x && (uint32_t)y <= (uint32_t)_chunkUpper.y &&
+		(uint32_t)z <= (uint32_t)_chunkUpper.z) {
+		return _chunk->voxel(x, y, z);
+	}
+	return _volume->voxel(_posInVolume.x + dx, _posInVolume.y + dy, _posInVolume.z + dz);
+}
+
+inline void PagedVolume::Sampler::movePositiveX(uint32_t offset) {
+	move((int)offset, 0, 0);
+}
+
+inline void PagedVolume::Sampler::movePositiveY(uint32_t offset) {
+	move(0, (int)offset, 0);
+}
+
+inline void PagedVolume::Sampler::movePositiveZ(uint32_t offset) {
+	move(0, 0, (int)offset);
+}
+
+inline void PagedVolume::Sampler::moveNegativeX(uint32_t offset) {
+	move(-(int)offset, 0, 0);
+}
+
+inline void PagedVolume::Sampler::moveNegativeY(uint32_t offset) {
+	move(0, -(int)offset, 0);
+}
+
+inline void PagedVolume::Sampler::moveNegativeZ(uint32_t offset) {
+	move(0, 0, -(int)offset);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1ny1nz() const {
+	return peek(-1, -1, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1ny0pz() const {
+	return peek(-1, -1, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1ny1pz() const {
+	return peek(-1, -1, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx0py1nz() const {
+	return peek(-1, 0, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx0py0pz() const {
+	return peek(-1, 0, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx0py1pz() const {
+	return peek(-1, 0, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1py1nz() const {
+	return peek(-1, 1, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1py0pz() const {
+	return peek(-1, 1, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1py1pz() const {
+	return peek(-1, 1, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px1ny1nz() const {
+	return peek(0, -1, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px1ny0pz() const {
+	return peek(0, -1, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px1ny1pz() const {
+	return peek(0, -1, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px0py1nz() const {
+	return peek(0, 0, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px0py0pz() const {
+	return voxel();
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px0py1pz() const {
+	return peek(0, 0, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px1py1nz() const {
+	return peek(0, 1, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px1py0pz() const {
+	return peek(0, 1, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel0px1py1pz() const {
+	return peek(0, 1, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px1ny1nz() const {
+	return peek(1, -1, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px1ny0pz() const {
+	return peek(1, -1, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px1ny1pz() const {
+	return peek(1, -1, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px0py1nz() const {
+	return peek(1, 0, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px0py0pz() const {
+	return peek(1, 0, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px0py1pz() const {
+	return peek(1, 0, 1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px1py1nz() const {
+	return peek(1, 1, -1);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px1py0pz() const {
+	return peek(1, 1, 0);
+}
+
+inline Voxel PagedVolume::Sampler::peekVoxel1px1py1pz() const {
+	return peek(1, 1, 1);
+}
+
+} // namespace voxel
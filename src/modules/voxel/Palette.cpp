@@ -59,14 +59,16 @@ void Palette::reduce(uint8_t targetColors) {
 	core::Color::ColorReductionType reductionType = core::Color::toColorReductionType(core::Var::getSafe(cfg::CoreColorReduction)->strVal().c_str());
 	PaletteColorArray oldcolors;
 	core_memcpy(oldcolors, _colors, sizeof(PaletteColorArray));
-	_colorCount = core::Color::quantize(_colors, targetColors, oldcolors, _colorCount, reductionType);
+	_colorCount = core::Color::quantize(_colors, targetColors, oldcolors, _colorCount, reductionType,
+										 &app::App::getInstance()->threadPool());
 	markDirty();
 }
 
 void Palette::quantize(const core::RGBA *inputColors, const size_t inputColorCount) {
 	Log::debug("quantize %i _colors", (int)inputColorCount);
 	core::Color::ColorReductionType reductionType = core::Color::toColorReductionType(core::Var::getSafe(cfg::CoreColorReduction)->strVal().c_str());
-	_colorCount = core::Color::quantize(_colors, lengthof(_colors), inputColors, inputColorCount, reductionType);
+	_colorCount = core::Color::quantize(_colors, lengthof(_colors), inputColors, inputColorCount, reductionType,
+										 &app::App::getInstance()->threadPool());
 	markDirty();
 }
 
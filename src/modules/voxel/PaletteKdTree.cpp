@@ -0,0 +1,125 @@
+/**
+ * @file
+ */
+
+#include "PaletteKdTree.h"
+#include "core/Algorithm.h"
+#include "core/Color.h"
+#include <float.h>
+
+namespace voxel {
+
+PaletteKdTree::PaletteKdTree(const Palette &palette) : _exactMatches(palette.size()) {
+	_colorCount = (int)palette.size();
+	const PaletteColorArray &colors = palette.colors();
+	Entry entries[PaletteMaxColors];
+	for (int i = 0; i < _colorCount; ++i) {
+		const core::RGBA rgba = colors[i];
+		if (!_exactMatches.hasKey(rgba.rgba)) {
+			_exactMatches.put(rgba.rgba, (uint8_t)i);
+		}
+		if (rgba.a == 0) {
+			if (_transparentIndex == -1) {
+				_transparentIndex = i;
+			}
+			continue;
+		}
+		Entry &entry = entries[_nodeCount++];
+		core::Color::getHSB(core::Color::fromRGBA(rgba), entry.hsb[0], entry.hsb[1], entry.hsb[2]);
+		entry.colorIndex = (uint8_t)i;
+	}
+	build(entries, 0, _nodeCount);
+}
+
+void PaletteKdTree::build(Entry *entries, int start, int end) {
+	if (start >= end) {
+		return;
+	}
+	// split on the axis with the biggest extent
+	float mins[3]{FLT_MAX, FLT_MAX, FLT_MAX};
+	float maxs[3]{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+	for (int i = start; i < end; ++i) {
+		for (int a = 0; a < 3; ++a) {
+			mins[a] = core_min(mins[a], entries[i].hsb[a]);
+			maxs[a] = core_max(maxs[a], entries[i].hsb[a]);
+		}
+	}
+	uint8_t axis = 0;
+	for (uint8_t a = 1; a < 3; ++a) {
+		if (maxs[a] - mins[a] > maxs[axis] - mins[axis]) {
+			axis = a;
+		}
+	}
+	core::sort(entries + start, entries + end, [axis](const Entry &lhs, const Entry &rhs) {
+		if (lhs.hsb[axis] != rhs.hsb[axis]) {
+			return lhs.hsb[axis] < rhs.hsb[axis];
+		}
+		return lhs.colorIndex < rhs.colorIndex;
+	});
+	const int mid = (start + end) / 2;
+	_nodes[mid].entry = entries[mid];
+	_nodes[mid].axis = axis;
+	build(entries, start, mid);
+	build(entries, mid + 1, end);
+}
+
+void PaletteKdTree::search(int start, int end, const float *hsb, float &minDistance, int &minIndex) const {
+	if (start >= end) {
+		return;
+	}
+	const int mid = (start + end) / 2;
+	const Node &node = _nodes[mid];
+	const float *nodeHsb = node.entry.hsb;
+	const float distance = core::Color::getDistance(nodeHsb[0], nodeHsb[1], nodeHsb[2], hsb[0], hsb[1], hsb[2]);
+	// on equal distances the lowest palette index wins - just like for the linear search
+	if (distance < minDistance || (distance == minDistance && (int)node.entry.colorIndex < minIndex)) {
+		minDistance = distance;
+		minIndex = node.entry.colorIndex;
+	}
+	const uint8_t axis = node.axis;
+	const bool nearLeft = hsb[axis] < nodeHsb[axis];
+	if (nearLeft) {
+		search(start, mid, hsb, minDistance, minIndex);
+	} else {
+		search(mid + 1, end, hsb, minDistance, minIndex);
+	}
+	// the distance to the split plane is computed with the same function to get a lower bound that is exact
+	// for the float calculations, too
+	float splitHsb[3]{hsb[0], hsb[1], hsb[2]};
+	splitHsb[axis] = nodeHsb[axis];
+	const float planeDistance =
+		core::Color::getDistance(splitHsb[0], splitHsb[1], splitHsb[2], hsb[0], hsb[1], hsb[2]);
+	if (planeDistance > minDistance) {
+		return;
+	}
+	if (nearLeft) {
+		search(mid + 1, end, hsb, minDistance, minIndex);
+	} else {
+		search(start, mid, hsb, minDistance, minIndex);
+	}
+}
+
+int PaletteKdTree::getClosestMatch(const core::RGBA rgba, float *distance) const {
+	if (_colorCount == 0) {
+		return -1;
+	}
+	uint8_t exactIndex;
+	if (_exactMatches.get(rgba.rgba, exactIndex)) {
+		return exactIndex;
+	}
+	if (rgba.a == 0) {
+		return _transparentIndex;
+	}
+
+	float hsb[3];
+	core::Color::getHSB(core::Color::fromRGBA(rgba), hsb[0], hsb[1], hsb[2]);
+	float minDistance = FLT_MAX;
+	int minIndex = -1;
+	search(0, _nodeCount, hsb, minDistance, minIndex);
+	if (distance) {
+		*distance = minDistance;
+	}
+	return minIndex;
+}
+
+} // namespace voxel
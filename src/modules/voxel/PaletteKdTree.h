@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+#include "core/collection/FlatMap.h"
+#include "voxel/Palette.h"
+
+namespace voxel {
+
+/**
+ * @brief Accelerates the closest color lookups for a palette
+ *
+ * The opaque palette colors are put into a k-d tree in the HSB color space. The search uses the same weighted
+ * distance as Palette::getClosestMatch() and also returns the lowest palette index if several colors have the
+ * same distance - the results are the same.
+ *
+ * @note The tree is built once and not updated if the palette is modified afterwards. It's read-only after the
+ * construction and can be used from several threads.
+ */
+class PaletteKdTree {
+private:
+	struct Entry {
+		float hsb[3];
+		uint8_t colorIndex;
+	};
+	struct Node {
+		Entry entry;
+		// the axis the children are split on
+		uint8_t axis;
+	};
+	// balanced tree - the node of a range is stored at the center of the range, the children are the ranges
+	// left and right of it
+	Node _nodes[PaletteMaxColors];
+	int _nodeCount = 0;
+	int _colorCount = 0;
+	int _transparentIndex = -1;
+	// the first palette index of each color
+	core::FlatMap<uint32_t, uint8_t> _exactMatches;
+
+	void build(Entry *entries, int start, int end);
+	void search(int start, int end, const float *hsb, float &minDistance, int &minIndex) const;
+
+public:
+	PaletteKdTree(const Palette &palette);
+
+	/**
+	 * @return The palette index of the closest color or @c -1 if there is none
+	 * @sa Palette::getClosestMatch()
+	 */
+	int getClosestMatch(const core::RGBA rgba, float *distance = nullptr) const;
+};
+
+} // namespace voxel
@@ -5,23 +5,31 @@
 #pragma once
 
 #include "core/Color.h"
-#include "core/collection/Map.h"
+#include "core/ScopedPtr.h"
+#include "core/collection/FlatMap.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
+#include "voxel/PaletteKdTree.h"
 
 namespace voxel {
 
 class PaletteLookup {
 private:
 	voxel::Palette _palette;
-	core::Map<core::RGBA, uint8_t, 521> _paletteMap;
+	core::FlatMap<core::RGBA, uint8_t> _paletteMap;
+	// built on the first lookup - the palette is not expected to change after that
+	core::ScopedPtr<PaletteKdTree> _tree;
+	size_t _maxSize;
 public:
-	PaletteLookup(const voxel::Palette &palette, int maxSize = 32768) : _palette(palette), _paletteMap(maxSize) {
+	/**
+	 * @param maxSize The max amount of colors that are cached
+	 */
+	PaletteLookup(const voxel::Palette &palette, int maxSize = 32768) : _palette(palette), _maxSize(maxSize) {
 		if (_palette.colorCount() <= 0) {
 			_palette.nippon();
 		}
 	}
-	PaletteLookup(int maxSize = 32768) : _paletteMap(maxSize) {
+	PaletteLookup(int maxSize = 32768) : _maxSize(maxSize) {
 		_palette.nippon();
 	}
 
@@ -49,8 +57,11 @@ public:
 	uint8_t findClosestIndex(core::RGBA rgba) {
 		uint8_t paletteIndex = 0;
 		if (!_paletteMap.get(rgba, paletteIndex)) {
-			paletteIndex = _palette.getClosestMatch(rgba);
-			if (_paletteMap.size() < _paletteMap.capacity()) {
+			if (!_tree) {
+				_tree = new PaletteKdTree(_palette);
+			}
+			paletteIndex = _tree->getClosestMatch(rgba);
+			if (_paletteMap.size() < _maxSize) {
 				_paletteMap.put(rgba, paletteIndex);
 			}
 		}
@@ -29,6 +29,9 @@ RawVolume::RawVolume(const RawVolume* copy) :
 	_maxs = copy->_maxs;
 	_boundsValid = copy->_boundsValid;
 	_borderVoxel = copy->_borderVoxel;
+	_bricks = copy->_bricks;
+	_brickVoxels = copy->_brickVoxels;
+	_solidVoxels = copy->_solidVoxels;
 	core_memcpy((void*)_data, (void*)copy->_data, size);
 }
 
@@ -41,6 +44,9 @@ RawVolume::RawVolume(const RawVolume& copy) :
 	_maxs = copy._maxs;
 	_boundsValid = copy._boundsValid;
 	_borderVoxel = copy._borderVoxel;
+	_bricks = copy._bricks;
+	_brickVoxels = copy._brickVoxels;
+	_solidVoxels = copy._solidVoxels;
 	core_memcpy((void*)_data, (void*)copy._data, size);
 }
 
@@ -91,6 +97,7 @@ RawVolume::RawVolume(const RawVolume &src, const core::DynamicArray<Region> &reg
 			}
 		}
 	}
+	updateBricks();
 }
 
 RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir) : _region(region) {
@@ -104,14 +111,11 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 		_mins = src._mins;
 		_maxs = src._maxs;
 		_boundsValid = src._boundsValid;
+		_bricks = src._bricks;
+		_brickVoxels = src._brickVoxels;
+		_solidVoxels = src._solidVoxels;
 		core_memcpy((void *)_data, (void *)src._data, size);
-		if (onlyAir) {
-			*onlyAir = false;
-		}
 	} else {
-		if (onlyAir) {
-			*onlyAir = true;
-		}
 		_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
 		_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
 		_boundsValid = false;
@@ -136,13 +140,13 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 					const int tgtindex = tgtStrideLocal + tgtZPos * tgtZStride;
 					const int srcindex = srcStrideLocal + srcZPos * srcZStride;
 					_data[tgtindex] = src._data[srcindex];
-					if (onlyAir && !voxel::isAir(_data[tgtindex].getMaterial())) {
-						*onlyAir = false;
-						onlyAir = nullptr;
-					}
 				}
 			}
 		}
+		updateBricks();
+	}
+	if (onlyAir) {
+		*onlyAir = isEmpty();
 	}
 }
 
@@ -153,12 +157,16 @@ RawVolume::RawVolume(RawVolume&& move) noexcept {
 	_maxs = move._maxs;
 	_region = move._region;
 	_boundsValid = move._boundsValid;
+	_bricks = move._bricks;
+	_brickVoxels = core::move(move._brickVoxels);
+	_solidVoxels = move._solidVoxels;
 }
 
 RawVolume::RawVolume(const Voxel* data, const voxel::Region& region) {
 	initialise(region);
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
 	core_memcpy((void*)_data, (void*)data, size);
+	updateBricks();
 }
 
 RawVolume::RawVolume(Voxel* data, const voxel::Region& region) :
@@ -168,6 +176,7 @@ RawVolume::RawVolume(Voxel* data, const voxel::Region& region) :
 	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
 	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
 	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
+	updateBricks();
 }
 
 RawVolume::~RawVolume() {
@@ -241,6 +250,7 @@ bool RawVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
 	if (_data[index].isSame(voxel)) {
 		return false;
 	}
+	updateBrick(localXPos, localYPos, iLocalZPos, _data[index], voxel);
 	_mins = (glm::min)(_mins, pos);
 	_maxs = (glm::max)(_maxs, pos);
 	_boundsValid = true;
@@ -273,6 +283,83 @@ void RawVolume::clear() {
 	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
 	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
 	_boundsValid = false;
+	initBricks();
+}
+
+void RawVolume::initBricks() {
+	_bricks = (_region.getDimensionsInVoxels() + (BrickSize - 1)) / BrickSize;
+	_brickVoxels.clear();
+	_brickVoxels.resize((size_t)_bricks.x * _bricks.y * _bricks.z);
+	_solidVoxels = 0;
+}
+
+void RawVolume::updateBricks() {
+	initBricks();
+	const int32_t w = width();
+	const int32_t h = height();
+	const int32_t d = depth();
+	const Voxel *voxel = _data;
+	for (int32_t z = 0; z < d; ++z) {
+		for (int32_t y = 0; y < h; ++y) {
+			uint16_t *bricks = &_brickVoxels[brickIndex(0, y, z)];
+			for (int32_t x = 0; x < w; ++x, ++voxel) {
+				if (isBlocked(voxel->getMaterial())) {
+					++bricks[x / BrickSize];
+					++_solidVoxels;
+				}
+			}
+		}
+	}
+}
+
+bool RawVolume::isEmpty(const Region& region) const {
+	Region r = region;
+	if (!_region.containsRegion(region)) {
+		if (isBlocked(_borderVoxel.getMaterial())) {
+			return false;
+		}
+		r.cropTo(_region);
+		if (!r.isValid()) {
+			return true;
+		}
+	}
+	if (_solidVoxels == 0) {
+		return true;
+	}
+	const glm::ivec3 &lowerCorner = _region.getLowerCorner();
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	const glm::ivec3 mins = r.getLowerCorner() - lowerCorner;
+	const glm::ivec3 maxs = r.getUpperCorner() - lowerCorner;
+	const glm::ivec3 brickMins = mins / BrickSize;
+	const glm::ivec3 brickMaxs = maxs / BrickSize;
+	for (int32_t bz = brickMins.z; bz <= brickMaxs.z; ++bz) {
+		for (int32_t by = brickMins.y; by <= brickMaxs.y; ++by) {
+			for (int32_t bx = brickMins.x; bx <= brickMaxs.x; ++bx) {
+				const glm::ivec3 brickLower(bx * BrickSize, by * BrickSize, bz * BrickSize);
+				if (_brickVoxels[brickIndex(brickLower.x, brickLower.y, brickLower.z)] == 0u) {
+					continue;
+				}
+				const glm::ivec3 brickUpper = (glm::min)(brickLower + (BrickSize - 1), dim - 1);
+				const glm::ivec3 lower = (glm::max)(brickLower, mins);
+				const glm::ivec3 upper = (glm::min)(brickUpper, maxs);
+				if (lower == brickLower && upper == brickUpper) {
+					return false;
+				}
+				// the brick is only partially covered by the region - check the voxels
+				for (int32_t z = lower.z; z <= upper.z; ++z) {
+					for (int32_t y = lower.y; y <= upper.y; ++y) {
+						const Voxel *voxel = _data + lower.x + y * dim.x + z * dim.x * dim.y;
+						for (int32_t x = lower.x; x <= upper.x; ++x, ++voxel) {
+							if (isBlocked(voxel->getMaterial())) {
+								return false;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
 }
 
 RawVolume::Sampler::Sampler(const RawVolume* volume) :
@@ -290,6 +377,9 @@ bool RawVolume::Sampler::setVoxel(const Voxel& voxel) {
 	if (_currentPositionInvalid) {
 		return false;
 	}
+	const glm::ivec3 &lowerCorner = _volume->_region.getLowerCorner();
+	_volume->updateBrick(_posInVolume.x - lowerCorner.x, _posInVolume.y - lowerCorner.y,
+						 _posInVolume.z - lowerCorner.z, *_currentVoxel, voxel);
 	*_currentVoxel = voxel;
 	_volume->_mins = (glm::min)(_volume->_mins, _posInVolume);
 	_volume->_maxs = (glm::max)(_volume->_maxs, _posInVolume);
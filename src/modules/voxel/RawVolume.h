@@ -13,9 +13,18 @@ namespace voxel {
 
 /**
  * Simple volume implementation which stores data in a single large 3D array.
+ *
+ * The volume keeps track of the amount of solid voxels in bricks of @c BrickSize voxels. This allows to skip
+ * the empty parts of the volume without looking at the voxels - see @c isEmpty()
  */
 class RawVolume {
 public:
+	/**
+	 * @brief The edge length of the bricks that count the solid voxels. The bricks start at the lower corner of
+	 * the volume region.
+	 */
+	static constexpr int BrickSize = 8;
+
 	class Sampler {
 	public:
 		Sampler(const RawVolume& volume);
@@ -182,6 +191,26 @@ public:
 
 	void clear();
 
+	/**
+	 * @return @c true if there is no solid voxel in the volume
+	 */
+	inline bool isEmpty() const {
+		return _solidVoxels == 0;
+	}
+
+	/**
+	 * @return @c true if there is no solid voxel in the given region. Empty bricks are skipped without looking
+	 * at the voxels. Positions outside of the volume are checked against the border value.
+	 */
+	bool isEmpty(const Region& region) const;
+
+	/**
+	 * @return The amount of voxels that are not air
+	 */
+	inline int solidVoxels() const {
+		return _solidVoxels;
+	}
+
 	inline const uint8_t* data() const {
 		return (const uint8_t*)_data;
 	}
@@ -197,6 +226,28 @@ public:
 
 private:
 	void initialise(const Region& region);
+	void initBricks();
+	/**
+	 * @brief Counts the solid voxels of the whole volume data again
+	 */
+	void updateBricks();
+	inline int brickIndex(int32_t localX, int32_t localY, int32_t localZ) const {
+		return localX / BrickSize + (localY / BrickSize + (localZ / BrickSize) * _bricks.y) * _bricks.x;
+	}
+	inline void updateBrick(int32_t localX, int32_t localY, int32_t localZ, const Voxel& oldVoxel, const Voxel& newVoxel) {
+		const bool wasSolid = isBlocked(oldVoxel.getMaterial());
+		if (wasSolid == isBlocked(newVoxel.getMaterial())) {
+			return;
+		}
+		const int idx = brickIndex(localX, localY, localZ);
+		if (wasSolid) {
+			--_brickVoxels[idx];
+			--_solidVoxels;
+		} else {
+			++_brickVoxels[idx];
+			++_solidVoxels;
+		}
+	}
 
 	/** The size of the volume */
 	Region _region;
@@ -210,6 +261,12 @@ private:
 	glm::ivec3 _mins;
 	glm::ivec3 _maxs;
 	bool _boundsValid;
+
+	/** The amount of bricks for each axis */
+	glm::ivec3 _bricks{0};
+	/** The amount of solid voxels in each brick */
+	core::DynamicArray<uint16_t> _brickVoxels;
+	int _solidVoxels = 0;
 };
 
 inline const Region& RawVolume::region() const {
@@ -0,0 +1,65 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+#include "core/ScopedPtr.h"
+
+class CubicSurfaceExtractorBenchmark : public app::AbstractBenchmark {
+protected:
+	core::ScopedPtr<voxel::RawVolume> _volume;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int size = (int)state.range(0);
+		_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		// terrain like surface with a few colors - this produces big planes that can get merged
+		for (int x = 0; x < size; ++x) {
+			for (int z = 0; z < size; ++z) {
+				const int height = size / 2 + (x / 8 + z / 8) % 4;
+				for (int y = 0; y < height; ++y) {
+					_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + (y / 4) % 3));
+				}
+			}
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+
+	void extract(benchmark::State &state, bool mergeQuads, bool greedyMerge) {
+		voxel::Region region = _volume->region();
+		region.shiftUpperCorner(1, 1, 1);
+		size_t indices = 0;
+		for (auto _ : state) {
+			voxel::ChunkMesh mesh;
+			voxel::extractCubicMesh(_volume, region, &mesh, glm::ivec3(0), mergeQuads, true, true, greedyMerge);
+			indices = mesh.mesh[0].getNoOfIndices();
+		}
+		state.counters["indices"] = (double)indices;
+	}
+};
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, NoMerge)(benchmark::State &state) {
+	extract(state, false, false);
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, MergeQuads)(benchmark::State &state) {
+	extract(state, true, false);
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, GreedyMerge)(benchmark::State &state) {
+	extract(state, true, true);
+}
+
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, NoMerge)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, MergeQuads)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, GreedyMerge)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
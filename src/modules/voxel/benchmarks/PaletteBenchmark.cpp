@@ -0,0 +1,49 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/Palette.h"
+#include "voxel/PaletteKdTree.h"
+
+class PaletteBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::Palette _palette;
+
+	// a grid over the rgb cube - most of the colors are not part of the palette
+	static core::RGBA queryColor(int i) {
+		return core::RGBA((uint8_t)(i * 7), (uint8_t)(i * 13 / 5), (uint8_t)(i * 31 / 11));
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		_palette.nippon();
+	}
+};
+
+BENCHMARK_DEFINE_F(PaletteBenchmark, GetClosestMatch)(benchmark::State &state) {
+	int i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(_palette.getClosestMatch(queryColor(i++)));
+	}
+}
+
+BENCHMARK_DEFINE_F(PaletteBenchmark, KdTreeGetClosestMatch)(benchmark::State &state) {
+	const voxel::PaletteKdTree tree(_palette);
+	int i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(tree.getClosestMatch(queryColor(i++)));
+	}
+}
+
+BENCHMARK_DEFINE_F(PaletteBenchmark, KdTreeBuild)(benchmark::State &state) {
+	for (auto _ : state) {
+		const voxel::PaletteKdTree tree(_palette);
+		benchmark::DoNotOptimize(&tree);
+	}
+}
+
+BENCHMARK_REGISTER_F(PaletteBenchmark, GetClosestMatch);
+BENCHMARK_REGISTER_F(PaletteBenchmark, KdTreeGetClosestMatch);
+BENCHMARK_REGISTER_F(PaletteBenchmark, KdTreeBuild);
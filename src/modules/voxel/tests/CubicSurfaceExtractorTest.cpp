@@ -0,0 +1,158 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+#include <glm/geometric.hpp>
+
+namespace voxel {
+
+class CubicSurfaceExtractorTest : public AbstractVoxelTest {
+protected:
+	/**
+	 * @return The area of all triangles per color index of the given mesh
+	 */
+	void colorAreas(const Mesh &mesh, float *areas) const {
+		for (int i = 0; i < 256; ++i) {
+			areas[i] = 0.0f;
+		}
+		for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+			const VoxelVertex &v0 = mesh.getVertex(mesh.getIndex(i + 0));
+			const VoxelVertex &v1 = mesh.getVertex(mesh.getIndex(i + 1));
+			const VoxelVertex &v2 = mesh.getVertex(mesh.getIndex(i + 2));
+			const float area = glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position)) * 0.5f;
+			areas[v0.colorIndex] += area;
+		}
+	}
+
+	void extract(const RawVolume &v, ChunkMesh &mesh, bool mergeQuads, bool greedyMerge, bool ambientOcclusion = true) {
+		Region region = v.region();
+		region.shiftUpperCorner(1, 1, 1);
+		extractCubicMesh(&v, region, &mesh, glm::ivec3(0), mergeQuads, true, ambientOcclusion, greedyMerge);
+	}
+
+	void compareSurface(const RawVolume &v, bool ambientOcclusion) {
+		ChunkMesh unmerged;
+		ChunkMesh legacy;
+		ChunkMesh greedy;
+		extract(v, unmerged, false, false, ambientOcclusion);
+		extract(v, legacy, true, false, ambientOcclusion);
+		extract(v, greedy, true, true, ambientOcclusion);
+		for (int m = 0; m < ChunkMesh::Meshes; ++m) {
+			float unmergedAreas[256];
+			float legacyAreas[256];
+			float greedyAreas[256];
+			colorAreas(unmerged.mesh[m], unmergedAreas);
+			colorAreas(legacy.mesh[m], legacyAreas);
+			colorAreas(greedy.mesh[m], greedyAreas);
+			for (int i = 0; i < 256; ++i) {
+				EXPECT_FLOAT_EQ(unmergedAreas[i], greedyAreas[i]) << "color " << i << " in mesh " << m;
+				EXPECT_FLOAT_EQ(legacyAreas[i], greedyAreas[i]) << "color " << i << " in mesh " << m;
+			}
+			EXPECT_LE(greedy.mesh[m].getNoOfIndices(), unmerged.mesh[m].getNoOfIndices());
+		}
+	}
+};
+
+TEST_F(CubicSurfaceExtractorTest, testGreedyMergeBox) {
+	RawVolume v(Region(0, 7));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int x = 1; x <= 6; ++x) {
+		for (int y = 1; y <= 6; ++y) {
+			for (int z = 1; z <= 6; ++z) {
+				v.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	ChunkMesh legacy;
+	ChunkMesh greedy;
+	extract(v, legacy, true, false);
+	extract(v, greedy, true, true);
+	// 6 quads with two triangles each
+	EXPECT_EQ(36u, legacy.mesh[0].getNoOfIndices());
+	EXPECT_EQ(36u, greedy.mesh[0].getNoOfIndices());
+	// the corners are shared by the three faces that meet there
+	EXPECT_EQ(8u, greedy.mesh[0].getNoOfVertices());
+	EXPECT_EQ(legacy.mesh[0].getNoOfVertices(), greedy.mesh[0].getNoOfVertices());
+}
+
+TEST_F(CubicSurfaceExtractorTest, testGreedyMergeStep) {
+	// a 4x1x4 plate with a 4x1x2 step on top of one half
+	RawVolume v(Region(0, 7));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int x = 1; x <= 4; ++x) {
+		for (int z = 1; z <= 4; ++z) {
+			v.setVoxel(x, 1, z, voxel);
+			if (z <= 2) {
+				v.setVoxel(x, 2, z, voxel);
+			}
+		}
+	}
+	ChunkMesh greedy;
+	extract(v, greedy, true, true, false);
+	// bottom, both tops, riser, front, back and two quads for each of the L shaped sides
+	EXPECT_EQ(60u, greedy.mesh[0].getNoOfIndices());
+	EXPECT_EQ(16u, greedy.mesh[0].getNoOfVertices());
+
+	// the vertices along the inner edge of the step are occluded - they can't be shared with the riser anymore
+	ChunkMesh greedyAO;
+	extract(v, greedyAO, true, true, true);
+	EXPECT_EQ(90u, greedyAO.mesh[0].getNoOfIndices());
+	EXPECT_EQ(24u, greedyAO.mesh[0].getNoOfVertices());
+}
+
+TEST_F(CubicSurfaceExtractorTest, testGreedyMergeRing) {
+	// a 3x1x3 plate with a hole in the center
+	RawVolume v(Region(0, 4));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int x = 1; x <= 3; ++x) {
+		for (int z = 1; z <= 3; ++z) {
+			if (x != 2 || z != 2) {
+				v.setVoxel(x, 1, z, voxel);
+			}
+		}
+	}
+	ChunkMesh greedy;
+	extract(v, greedy, true, true);
+	// top and bottom are split into four quads around the hole, four outer and four inner sides
+	EXPECT_EQ(96u, greedy.mesh[0].getNoOfIndices());
+	EXPECT_EQ(32u, greedy.mesh[0].getNoOfVertices());
+	compareSurface(v, true);
+}
+
+TEST_F(CubicSurfaceExtractorTest, testGreedyMergeWideSlice) {
+	// wider than one 64 bit mask word
+	RawVolume v(Region(glm::ivec3(0), glm::ivec3(149, 2, 2)));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int x = 0; x < 150; ++x) {
+		v.setVoxel(x, 1, 1, voxel);
+	}
+	ChunkMesh greedy;
+	extract(v, greedy, true, true);
+	EXPECT_EQ(36u, greedy.mesh[0].getNoOfIndices());
+	compareSurface(v, true);
+}
+
+TEST_F(CubicSurfaceExtractorTest, testGreedyMergeSameSurface) {
+	RawVolume v(Region(0, 31));
+	for (int x = 0; x < 32; ++x) {
+		for (int y = 0; y < 32; ++y) {
+			for (int z = 0; z < 32; ++z) {
+				const int rnd = _random.random(0, 5);
+				if (rnd == 0) {
+					v.setVoxel(x, y, z, createVoxel(VoxelType::Transparent, 2));
+				} else if (rnd <= 2) {
+					v.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1 + rnd));
+				}
+			}
+		}
+	}
+	compareSurface(v, true);
+	compareSurface(v, false);
+}
+
+} // namespace voxel
@@ -0,0 +1,281 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/PagedVolume.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
+
+namespace voxel {
+
+class PagedVolumeTest : public AbstractVoxelTest {
+protected:
+	// not aligned to the chunk size and with a negative lower corner
+	const Region _testRegion{glm::ivec3(-13, -7, -40), glm::ivec3(37, 29, 5)};
+
+	void fillRandom(RawVolume &raw, PagedVolume &paged) {
+		const glm::ivec3 &mins = _testRegion.getLowerCorner();
+		const glm::ivec3 &maxs = _testRegion.getUpperCorner();
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					const int rnd = _random.random(0, 3);
+					if (rnd == 0) {
+						continue;
+					}
+					const Voxel voxel = createVoxel(VoxelType::Generic, rnd);
+					raw.setVoxel(x, y, z, voxel);
+					paged.setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+};
+
+TEST_F(PagedVolumeTest, testSetVoxel) {
+	PagedVolume v(_testRegion);
+	EXPECT_EQ(0u, v.chunkCount());
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	EXPECT_FALSE(v.setVoxel(0, 0, 0, createVoxel(VoxelType::Air, 0)));
+	EXPECT_EQ(0u, v.chunkCount());
+	EXPECT_TRUE(v.setVoxel(-13, -7, -40, voxel));
+	EXPECT_FALSE(v.setVoxel(-13, -7, -40, voxel));
+	EXPECT_TRUE(v.setVoxel(37, 29, 5, voxel));
+	EXPECT_EQ(2u, v.chunkCount());
+	EXPECT_EQ(2u, v.allocatedChunkCount());
+	EXPECT_TRUE(v.voxel(-13, -7, -40).isSame(voxel));
+	EXPECT_TRUE(v.voxel(37, 29, 5).isSame(voxel));
+	EXPECT_TRUE(isAir(v.voxel(0, 0, 0).getMaterial()));
+	EXPECT_EQ(glm::ivec3(-13, -7, -40), v.mins());
+	EXPECT_EQ(glm::ivec3(37, 29, 5), v.maxs());
+
+	v.setBorderValue(createVoxel(VoxelType::Generic, 2));
+	EXPECT_EQ(2, v.voxel(38, 0, 0).getColor());
+}
+
+TEST_F(PagedVolumeTest, testSamplerSetVoxel) {
+	PagedVolume v(_testRegion);
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	PagedVolume::Sampler sampler(v);
+	EXPECT_FALSE(sampler.setPosition(_testRegion.getUpperCorner() + 1));
+	EXPECT_FALSE(sampler.setVoxel(voxel));
+	ASSERT_TRUE(sampler.setPosition(3, 4, 5));
+	EXPECT_FALSE(sampler.setVoxel(createVoxel(VoxelType::Air, 0)));
+	EXPECT_EQ(0u, v.chunkCount());
+	EXPECT_TRUE(sampler.setVoxel(voxel));
+	EXPECT_FALSE(sampler.setVoxel(voxel));
+	EXPECT_TRUE(sampler.voxel().isSame(voxel));
+	EXPECT_TRUE(v.voxel(3, 4, 5).isSame(voxel));
+}
+
+TEST_F(PagedVolumeTest, testSparse) {
+	// this would need 2GB as RawVolume
+	PagedVolume v(Region(glm::ivec3(0), glm::ivec3(2047, 255, 2047)));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int i = 0; i < 2048; i += 128) {
+		v.setVoxel(i, i / 8, i, voxel);
+	}
+	EXPECT_EQ(16u, v.chunkCount());
+	EXPECT_TRUE(v.voxel(1024, 128, 1024).isSame(voxel));
+	EXPECT_TRUE(isAir(v.voxel(1024, 129, 1024).getMaterial()));
+}
+
+TEST_F(PagedVolumeTest, testCompact) {
+	PagedVolume v(Region(0, 63));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int z = 0; z < PagedVolume::ChunkSideLength; ++z) {
+		for (int y = 0; y < PagedVolume::ChunkSideLength; ++y) {
+			for (int x = 0; x < PagedVolume::ChunkSideLength; ++x) {
+				v.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	v.setVoxel(40, 40, 40, voxel);
+	v.setVoxel(40, 40, 40, Voxel());
+	EXPECT_EQ(2u, v.allocatedChunkCount());
+	v.compact();
+	EXPECT_EQ(1u, v.chunkCount());
+	EXPECT_EQ(0u, v.allocatedChunkCount());
+	EXPECT_TRUE(v.voxel(31, 31, 31).isSame(voxel));
+	EXPECT_TRUE(isAir(v.voxel(32, 31, 31).getMaterial()));
+
+	EXPECT_TRUE(v.setVoxel(0, 0, 0, Voxel()));
+	EXPECT_EQ(1u, v.allocatedChunkCount());
+	EXPECT_TRUE(isAir(v.voxel(0, 0, 0).getMaterial()));
+	EXPECT_TRUE(v.voxel(1, 0, 0).isSame(voxel));
+}
+
+TEST_F(PagedVolumeTest, testSamplerPeek) {
+	RawVolume raw(_testRegion);
+	PagedVolume paged(_testRegion);
+	fillRandom(raw, paged);
+
+	RawVolume::Sampler rawSampler(raw);
+	PagedVolume::Sampler pagedSampler(paged);
+	const glm::ivec3 &mins = _testRegion.getLowerCorner();
+	const glm::ivec3 &maxs = _testRegion.getUpperCorner();
+	for (int z = mins.z - 1; z <= maxs.z + 1; ++z) {
+		for (int x = mins.x - 1; x <= maxs.x + 1; ++x) {
+			rawSampler.setPosition(x, mins.y - 1, z);
+			pagedSampler.setPosition(x, mins.y - 1, z);
+			for (int y = mins.y - 1; y <= maxs.y + 1; ++y) {
+				ASSERT_EQ(rawSampler.position(), pagedSampler.position());
+				ASSERT_EQ(rawSampler.currentPositionValid(), pagedSampler.currentPositionValid());
+				ASSERT_TRUE(rawSampler.voxel().isSame(pagedSampler.voxel()));
+				ASSERT_TRUE(rawSampler.peekVoxel1nx1ny1nz().isSame(pagedSampler.peekVoxel1nx1ny1nz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1nx0py1pz().isSame(pagedSampler.peekVoxel1nx0py1pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px1py1nz().isSame(pagedSampler.peekVoxel0px1py1nz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px1ny0pz().isSame(pagedSampler.peekVoxel0px1ny0pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1px0py0pz().isSame(pagedSampler.peekVoxel1px0py0pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1px1py1pz().isSame(pagedSampler.peekVoxel1px1py1pz()));
+				rawSampler.movePositiveY();
+				pagedSampler.movePositiveY();
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testExtractCubicMesh) {
+	RawVolume raw(_testRegion);
+	PagedVolume paged(_testRegion);
+	fillRandom(raw, paged);
+
+	Region region = _testRegion;
+	region.shiftUpperCorner(1, 1, 1);
+	ChunkMesh rawMesh;
+	ChunkMesh pagedMesh;
+	extractCubicMesh(&raw, region, &rawMesh, glm::ivec3(0));
+	extractCubicMesh(&paged, region, &pagedMesh, glm::ivec3(0));
+	for (int m = 0; m < ChunkMesh::Meshes; ++m) {
+		EXPECT_EQ(rawMesh.mesh[m].getNoOfVertices(), pagedMesh.mesh[m].getNoOfVertices());
+		EXPECT_EQ(rawMesh.mesh[m].getNoOfIndices(), pagedMesh.mesh[m].getNoOfIndices());
+	}
+}
+
+TEST_F(PagedVolumeTest, testCopyInto) {
+	RawVolume raw(_testRegion);
+	PagedVolume paged(_testRegion);
+	fillRandom(raw, paged);
+
+	const Region cropped(glm::ivec3(-5, 0, -33), glm::ivec3(33, 20, 1));
+	RawVolume target(cropped);
+	paged.copyInto(target);
+	const glm::ivec3 &mins = cropped.getLowerCorner();
+	const glm::ivec3 &maxs = cropped.getUpperCorner();
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				ASSERT_TRUE(raw.voxel(x, y, z).isSame(target.voxel(x, y, z))) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testCopyFrom) {
+	RawVolume raw(_testRegion);
+	PagedVolume unused(_testRegion);
+	fillRandom(raw, unused);
+
+	PagedVolume paged(_testRegion);
+	paged.setCompression(true, 2);
+	paged.copyFrom(raw, _testRegion);
+	// clear a part of the volume again
+	const Region cleared(glm::ivec3(-5, 0, -33), glm::ivec3(33, 20, 1));
+	RawVolume empty(cleared);
+	paged.copyFrom(empty, cleared);
+
+	const glm::ivec3 &mins = _testRegion.getLowerCorner();
+	const glm::ivec3 &maxs = _testRegion.getUpperCorner();
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				if (cleared.containsPoint(x, y, z)) {
+					ASSERT_TRUE(isAir(paged.voxel(x, y, z).getMaterial())) << x << ":" << y << ":" << z;
+				} else {
+					ASSERT_TRUE(raw.voxel(x, y, z).isSame(paged.voxel(x, y, z))) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testCompression) {
+	// terrain like layers with a few holes
+	const Region region(glm::ivec3(0), glm::ivec3(127, 63, 127));
+	RawVolume raw(region);
+	PagedVolume paged(region);
+	paged.setCompression(true, 4);
+	for (int z = 0; z <= 127; ++z) {
+		for (int x = 0; x <= 127; ++x) {
+			const int height = 20 + (x / 16 + z / 16) % 4;
+			for (int y = 0; y <= height; ++y) {
+				if ((x * 7 + y * 3 + z * 13) % 97 == 0) {
+					continue;
+				}
+				const Voxel voxel = createVoxel(VoxelType::Generic, y < height - 3 ? 1 : 2);
+				raw.setVoxel(x, y, z, voxel);
+				paged.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	EXPECT_LE(paged.allocatedChunkCount(), 4u);
+	paged.compact();
+	EXPECT_EQ(0u, paged.allocatedChunkCount());
+	EXPECT_GT(paged.compressedChunkCount(), 0u);
+	const size_t rawBytes = paged.chunkCount() * PagedVolume::ChunkVoxels * sizeof(Voxel);
+	EXPECT_LT(paged.memoryUsage() * 5u, rawBytes);
+
+	for (int z = 0; z <= 127; ++z) {
+		for (int y = 0; y <= 63; ++y) {
+			for (int x = 0; x <= 127; ++x) {
+				ASSERT_TRUE(raw.voxel(x, y, z).isSame(paged.voxel(x, y, z))) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+
+	RawVolume::Sampler rawSampler(raw);
+	PagedVolume::Sampler pagedSampler(paged);
+	for (int z = 30; z <= 40; ++z) {
+		for (int x = 60; x <= 70; ++x) {
+			rawSampler.setPosition(x, 10, z);
+			pagedSampler.setPosition(x, 10, z);
+			for (int y = 10; y <= 30; ++y) {
+				ASSERT_TRUE(rawSampler.voxel().isSame(pagedSampler.voxel()));
+				ASSERT_TRUE(rawSampler.peekVoxel1nx1ny1nz().isSame(pagedSampler.peekVoxel1nx1ny1nz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1px1py1pz().isSame(pagedSampler.peekVoxel1px1py1pz()));
+				rawSampler.movePositiveY();
+				pagedSampler.movePositiveY();
+			}
+		}
+	}
+
+	// modify compressed chunks again
+	const Voxel voxel = createVoxel(VoxelType::Generic, 3);
+	for (int i = 0; i < 128; i += 8) {
+		raw.setVoxel(i, 40, 127 - i, voxel);
+		EXPECT_TRUE(paged.setVoxel(i, 40, 127 - i, voxel));
+		raw.setVoxel(i, 5, i, Voxel());
+		paged.setVoxel(i, 5, i, Voxel());
+	}
+	EXPECT_LE(paged.allocatedChunkCount(), 4u);
+
+	Region meshRegion = region;
+	meshRegion.shiftUpperCorner(1, 1, 1);
+	ChunkMesh rawMesh;
+	ChunkMesh pagedMesh;
+	extractCubicMesh(&raw, meshRegion, &rawMesh, glm::ivec3(0));
+	extractCubicMesh(&paged, meshRegion, &pagedMesh, glm::ivec3(0));
+	for (int m = 0; m < ChunkMesh::Meshes; ++m) {
+		EXPECT_EQ(rawMesh.mesh[m].getNoOfVertices(), pagedMesh.mesh[m].getNoOfVertices());
+		EXPECT_EQ(rawMesh.mesh[m].getNoOfIndices(), pagedMesh.mesh[m].getNoOfIndices());
+	}
+
+	paged.setCompression(false);
+	EXPECT_EQ(0u, paged.compressedChunkCount());
+	EXPECT_TRUE(paged.voxel(8, 40, 119).isSame(voxel));
+}
+
+} // namespace voxel
@@ -8,6 +8,7 @@
 #include "core/GameConfig.h"
 #include "core/Var.h"
 #include "voxel/MaterialColor.h"
+#include "voxel/PaletteKdTree.h"
 #include "voxel/PaletteLookup.h"
 
 namespace voxel {
@@ -27,6 +28,40 @@ TEST_F(PaletteTest, testPaletteLookup) {
 	EXPECT_EQ(0, pal.findClosestIndex(rgba));
 }
 
+TEST_F(PaletteTest, testPaletteKdTree) {
+	Palette palettes[4];
+	palettes[0].nippon();
+	palettes[1].quake1();
+	palettes[2].minecraft();
+	// duplicated and transparent colors
+	palettes[3].setSize(6);
+	palettes[3].color(0) = core::RGBA(255, 0, 0);
+	palettes[3].color(1) = core::RGBA(0, 0, 0, 0);
+	palettes[3].color(2) = core::RGBA(0, 255, 0);
+	palettes[3].color(3) = core::RGBA(255, 0, 0);
+	palettes[3].color(4) = core::RGBA(0, 255, 0, 128);
+	palettes[3].color(5) = core::RGBA(10, 10, 10, 0);
+	for (const Palette &pal : palettes) {
+		const PaletteKdTree tree(pal);
+		for (int i = 0; i < (int)pal.size(); ++i) {
+			const core::RGBA rgba = pal.colors()[i];
+			ASSERT_EQ(pal.getClosestMatch(rgba), tree.getClosestMatch(rgba)) << core::Color::print(rgba);
+		}
+		for (int r = 0; r < 256; r += 15) {
+			for (int g = 0; g < 256; g += 15) {
+				for (int b = 0; b < 256; b += 15) {
+					const core::RGBA rgba(r, g, b, (r + g) % 3 == 0 ? 0 : 255);
+					float expectedDistance = -1.0f;
+					float distance = -1.0f;
+					ASSERT_EQ(pal.getClosestMatch(rgba, &expectedDistance), tree.getClosestMatch(rgba, &distance))
+						<< core::Color::print(rgba);
+					ASSERT_EQ(expectedDistance, distance);
+				}
+			}
+		}
+	}
+}
+
 TEST_F(PaletteTest, testGimpPalette) {
 	Palette pal;
 	pal.nippon();
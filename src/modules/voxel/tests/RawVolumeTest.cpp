@@ -0,0 +1,68 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class RawVolumeTest: public app::AbstractTest {
+};
+
+TEST_F(RawVolumeTest, testIsEmpty) {
+	RawVolume v(Region(-4, 19));
+	EXPECT_TRUE(v.isEmpty());
+	EXPECT_TRUE(v.isEmpty(v.region()));
+	EXPECT_TRUE(v.setVoxel(9, 10, 11, createVoxel(VoxelType::Generic, 1)));
+	EXPECT_FALSE(v.isEmpty());
+	EXPECT_EQ(1, v.solidVoxels());
+	EXPECT_FALSE(v.isEmpty(v.region()));
+	EXPECT_FALSE(v.isEmpty(Region(9, 10, 11, 9, 10, 11)));
+	// same brick - but not the same voxel
+	EXPECT_TRUE(v.isEmpty(Region(8, 8, 8, 8, 8, 8)));
+	EXPECT_TRUE(v.isEmpty(Region(10, 10, 11, 19, 19, 19)));
+	EXPECT_FALSE(v.isEmpty(Region(9, 10, 11, 100, 100, 100)));
+	EXPECT_TRUE(v.isEmpty(Region(100, 100, 100, 101, 101, 101)));
+
+	EXPECT_TRUE(v.setVoxel(9, 10, 11, createVoxel(VoxelType::Air, 0)));
+	EXPECT_TRUE(v.isEmpty());
+	EXPECT_TRUE(v.isEmpty(v.region()));
+}
+
+TEST_F(RawVolumeTest, testIsEmptySampler) {
+	RawVolume v(Region(0, 15));
+	RawVolume::Sampler sampler(v);
+	sampler.setPosition(15, 15, 15);
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Generic, 1)));
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Generic, 2)));
+	EXPECT_EQ(1, v.solidVoxels());
+	EXPECT_FALSE(v.isEmpty(Region(8, 15)));
+	EXPECT_TRUE(v.isEmpty(Region(0, 14)));
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Air, 0)));
+	EXPECT_TRUE(v.isEmpty());
+}
+
+TEST_F(RawVolumeTest, testIsEmptyCopy) {
+	RawVolume v(Region(0, 31));
+	v.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(30, 30, 30, createVoxel(VoxelType::Generic, 1));
+
+	const RawVolume copy(v);
+	EXPECT_EQ(2, copy.solidVoxels());
+
+	bool onlyAir = true;
+	const RawVolume part(v, Region(2, 29), &onlyAir);
+	EXPECT_TRUE(onlyAir);
+	EXPECT_TRUE(part.isEmpty());
+
+	const RawVolume part2(v, Region(0, 15), &onlyAir);
+	EXPECT_FALSE(onlyAir);
+	EXPECT_EQ(1, part2.solidVoxels());
+
+	const RawVolume moved(core::move(RawVolume(v)));
+	EXPECT_EQ(2, moved.solidVoxels());
+	EXPECT_FALSE(moved.isEmpty(Region(24, 31)));
+}
+
+}
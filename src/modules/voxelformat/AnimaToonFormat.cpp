@@ -9,6 +9,7 @@
 #include "io/BufferedReadWriteStream.h"
 #include "io/ZipReadStream.h"
 #include "util/Base64.h"
+#include "voxel/PaletteKdTree.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
 
@@ -31,6 +32,7 @@ bool AnimaToonFormat::loadGroupsRGBA(const core::String &filename, io::SeekableR
 	}
 
 	bool error = false;
+	const voxel::PaletteKdTree paletteTree(palette);
 	core::Tokenizer tokenizer(str, " \t\n,:", "{}[]");
 	core::String name = "unknown";
 	while (tokenizer.hasNext()) {
@@ -38,7 +40,7 @@ bool AnimaToonFormat::loadGroupsRGBA(const core::String &filename, io::SeekableR
 		if (token == "SceneName") {
 			name = tokenizer.next();
 		} else if (token == "ModelSave") {
-			if (!parseJsonArray(tokenizer, [&error, &sceneGraph, &palette, &name] (const core::String &token) {
+			if (!parseJsonArray(tokenizer, [&error, &sceneGraph, &palette, &paletteTree, &name] (const core::String &token) {
 				io::BufferedReadWriteStream base64Stream;
 				if (!util::Base64::decode(base64Stream, token)) {
 					error = true;
@@ -64,7 +66,7 @@ bool AnimaToonFormat::loadGroupsRGBA(const core::String &filename, io::SeekableR
 							if (v.rgba == 0) {
 								continue;
 							}
-							const uint8_t color = palette.getClosestMatch(v.rgba);
+							const uint8_t color = paletteTree.getClosestMatch(v.rgba);
 							const voxel::Voxel voxel = voxel::createVoxel(palette, color);
 							volume->setVoxel((int)x, (int)y, (int)z, voxel);
 						}
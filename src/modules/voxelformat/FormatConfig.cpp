@@ -19,6 +19,7 @@ bool FormatConfig::init() {
 				   core::Color::toColorReductionTypeString(core::Color::ColorReductionType::MedianCut),
 				   "Controls the algorithm that is used to perform the color reduction", colorReductionValidator);
 	core::Var::get(cfg::VoxformatMergequads, "true", core::CV_NOPERSIST, "Merge similar quads to optimize the mesh", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatGreedyMerge, "true", core::CV_NOPERSIST, "Use the bitmask based greedy quad merging instead of the pairwise merging", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatMarchingCubes, "false", core::CV_NOPERSIST, "Don't export cubes, but a mesh that is polygonized by the marching cubes algorithm", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatReusevertices, "true", core::CV_NOPERSIST, "Reuse vertices or always create new ones", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatAmbientocclusion, "false", core::CV_NOPERSIST, "Extra vertices for ambient occlusion", core::Var::boolValidator);
@@ -58,6 +59,8 @@ bool FormatConfig::init() {
 				"Merge compounds on load", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatQBSaveLeftHanded, "true", core::CV_NOPERSIST,
 				"Toggle between left and right handed", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatVENGIParallelZip, "false", core::CV_NOPERSIST,
+				"Compress the vengi format in independent blocks on all cores - older versions can't load those files", core::Var::boolValidator);
 	core::Var::get(cfg::VoxelCreatePalette, "true", core::CV_NOPERSIST,
 				"Create own palette from textures or colors - not used for palette formats", core::Var::boolValidator);
 
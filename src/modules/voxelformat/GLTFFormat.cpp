@@ -14,6 +14,8 @@
 #include "engine-config.h"
 #include "image/Image.h"
 #include "io/BufferedReadWriteStream.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
 #include "io/StdStreamBuf.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -27,6 +29,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <limits.h>
+#include <sstream>
 
 #define TINYGLTF_IMPLEMENTATION
 // #define TINYGLTF_NO_FS // TODO: use our own file abstraction
@@ -38,6 +41,7 @@ namespace voxelformat {
 namespace _priv {
 
 const float FPS = 24.0f;
+const int TexcoordIndex = 0;
 
 static int addBuffer(tinygltf::Model &gltfModel, io::BufferedReadWriteStream &stream, const char *name) {
 	tinygltf::Buffer gltfBuffer;
@@ -154,6 +158,307 @@ void GLTFFormat::saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model
 	}
 }
 
+struct GLTFFormat::GltfMeshStream {
+	tinygltf::Model gltfModel;
+	core::Map<uint64_t, int> paletteMaterialIndices;
+	/**
+	 * node id to the mesh that gets a primitive for each chunk of the node
+	 */
+	core::Map<int, int> nodeMeshes;
+	core::String binFilename;
+	io::FilePtr binFile;
+	core::ScopedPtr<io::FileStream> binStream;
+};
+
+GLTFFormat::GLTFFormat() {
+}
+
+GLTFFormat::~GLTFFormat() {
+}
+
+void GLTFFormat::initModel(tinygltf::Model &gltfModel, const scenegraph::SceneGraph &sceneGraph) const {
+	const core::String &appname = app::App::getInstance()->appname();
+	const core::String &generator = core::string::format("%s " PROJECT_VERSION, appname.c_str());
+	// Define the asset. The version is required
+	gltfModel.asset.generator = generator.c_str();
+	gltfModel.asset.version = "2.0";
+	gltfModel.asset.copyright = sceneGraph.root().property("Copyright").c_str();
+}
+
+int GLTFFormat::saveMaterial(tinygltf::Model &gltfModel, core::Map<uint64_t, int> &paletteMaterialIndices,
+							 const voxel::Palette &palette, bool withColor, bool withTexCoords) const {
+	int materialId = -1;
+	if (paletteMaterialIndices.get(palette.hash(), materialId)) {
+		Log::debug("Re-use material id %i for hash %" PRIu64, materialId, palette.hash());
+		return materialId;
+	}
+	const core::String hashId = core::String::format("%" PRIu64, palette.hash());
+
+	const int imageIndex = (int)gltfModel.images.size();
+	{
+		tinygltf::Image gltfPaletteImage;
+		image::Image image("pal");
+		image.loadRGBA((const unsigned char *)palette.colors(), voxel::PaletteMaxColors, 1);
+		const core::String &pal64 = image.pngBase64();
+		gltfPaletteImage.uri = "data:image/png;base64,";
+		gltfPaletteImage.width = voxel::PaletteMaxColors;
+		gltfPaletteImage.height = 1;
+		gltfPaletteImage.component = 4;
+		gltfPaletteImage.bits = 32;
+		gltfPaletteImage.uri += pal64.c_str();
+		gltfModel.images.emplace_back(core::move(gltfPaletteImage));
+	}
+
+	const int textureIndex = (int)gltfModel.textures.size();
+	{
+		tinygltf::Texture gltfPaletteTexture;
+		gltfPaletteTexture.source = imageIndex;
+		gltfModel.textures.emplace_back(core::move(gltfPaletteTexture));
+	}
+	// TODO: save emissiveTexture
+
+	{
+		tinygltf::Material gltfMaterial;
+		if (withTexCoords) {
+			gltfMaterial.pbrMetallicRoughness.baseColorTexture.index = textureIndex;
+			gltfMaterial.pbrMetallicRoughness.baseColorTexture.texCoord = _priv::TexcoordIndex;
+		} else if (withColor) {
+			gltfMaterial.pbrMetallicRoughness.baseColorFactor = {1.0f, 1.0f, 1.0f, 1.0f};
+		}
+
+		gltfMaterial.name = hashId.c_str();
+		gltfMaterial.pbrMetallicRoughness.roughnessFactor = 1.0;
+		gltfMaterial.pbrMetallicRoughness.metallicFactor = 0.0;
+		gltfMaterial.doubleSided = false;
+
+		materialId = (int)gltfModel.materials.size();
+		gltfModel.materials.emplace_back(core::move(gltfMaterial));
+	}
+	paletteMaterialIndices.put(palette.hash(), materialId);
+	Log::debug("New material id %i for hash %" PRIu64, materialId, palette.hash());
+	return materialId;
+}
+
+bool GLTFFormat::savePrimitive(tinygltf::Model &gltfModel, tinygltf::Mesh &gltfMesh, io::SeekableWriteStream &os,
+							   int bufferIdx, const voxel::Mesh &mesh, const MeshExt &meshExt,
+							   const voxel::Palette &palette, int materialId, bool withColor,
+							   bool withTexCoords) const {
+	const int nv = (int)mesh.getNoOfVertices();
+	const int ni = (int)mesh.getNoOfIndices();
+
+	if (ni % 3 != 0) {
+		Log::error("Unexpected indices amount");
+		return false;
+	}
+
+	const voxel::VertexArray &vertices = mesh.getVertexVector();
+	const voxel::NormalArray &normals = mesh.getNormalVector();
+	const voxel::IndexArray &indices = mesh.getIndexVector();
+	const bool exportNormals = !normals.empty();
+	if (exportNormals) {
+		Log::debug("Export normals for mesh %s", meshExt.name.c_str());
+	}
+
+	const int64_t indicesOffset = os.pos();
+	unsigned int maxIndex = 0;
+	unsigned int minIndex = UINT_MAX;
+
+	for (int i = 0; i < ni; i++) {
+		const int idx = i;
+		os.writeUInt32(indices[idx]);
+
+		if (maxIndex < indices[idx]) {
+			maxIndex = indices[idx];
+		}
+
+		if (indices[idx] < minIndex) {
+			minIndex = indices[idx];
+		}
+	}
+
+	static_assert(sizeof(voxel::IndexType) == 4, "if not 4 bytes - we might need padding here");
+	const int64_t verticesOffset = os.pos();
+
+	glm::vec3 maxVertex(-FLT_MAX);
+	glm::vec3 minVertex(FLT_MAX);
+
+	const glm::vec3 &offset = mesh.getOffset();
+
+	const glm::vec3 pivotOffset = offset - meshExt.pivot * meshExt.size;
+	for (int j = 0; j < nv; j++) {
+		glm::vec3 pos = vertices[j].position;
+
+		if (meshExt.applyTransform) {
+			pos = pos + pivotOffset;
+		}
+
+		for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
+			os.writeFloat(pos[coordIndex]);
+
+			if (maxVertex[coordIndex] < pos[coordIndex]) {
+				maxVertex[coordIndex] = pos[coordIndex];
+			}
+
+			if (minVertex[coordIndex] > pos[coordIndex]) {
+				minVertex[coordIndex] = pos[coordIndex];
+			}
+		}
+
+		if (exportNormals) {
+			for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
+				os.writeFloat(normals[j][coordIndex]);
+			}
+		}
+
+		if (withTexCoords) {
+			const glm::vec2 &uv = paletteUV(vertices[j].colorIndex);
+			os.writeFloat(uv.x);
+			os.writeFloat(uv.y);
+		} else if (withColor) {
+			const glm::vec4 &color = core::Color::fromRGBA(palette.color(vertices[j].colorIndex));
+			for (int colorIdx = 0; colorIdx < glm::vec4::length(); colorIdx++) {
+				os.writeFloat(color[colorIdx]);
+			}
+		}
+	}
+
+	tinygltf::BufferView gltfIndicesBufferView;
+	gltfIndicesBufferView.buffer = bufferIdx;
+	gltfIndicesBufferView.byteOffset = indicesOffset;
+	gltfIndicesBufferView.byteLength = verticesOffset - indicesOffset;
+	gltfIndicesBufferView.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
+
+	tinygltf::BufferView gltfVerticesBufferView;
+	gltfVerticesBufferView.buffer = bufferIdx;
+	gltfVerticesBufferView.byteOffset = verticesOffset;
+	gltfVerticesBufferView.byteLength = os.pos() - verticesOffset;
+	gltfVerticesBufferView.byteStride = sizeof(glm::vec3);
+	if (exportNormals) {
+		gltfVerticesBufferView.byteStride += sizeof(glm::vec3);
+	}
+	if (withTexCoords) {
+		gltfVerticesBufferView.byteStride += sizeof(glm::vec2);
+	} else if (withColor) {
+		gltfVerticesBufferView.byteStride += sizeof(glm::vec4);
+	}
+	gltfVerticesBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
+
+	if (gltfIndicesBufferView.byteLength != ni * sizeof(uint32_t) ||
+		gltfVerticesBufferView.byteLength != nv * gltfVerticesBufferView.byteStride) {
+		Log::error("Failed to write the mesh data of %s", meshExt.name.c_str());
+		return false;
+	}
+
+	// Describe the layout of indicesBufferView, the indices of the vertices
+	tinygltf::Accessor gltfIndicesAccessor;
+	gltfIndicesAccessor.bufferView = (int)gltfModel.bufferViews.size();
+	gltfIndicesAccessor.byteOffset = 0;
+	gltfIndicesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+	gltfIndicesAccessor.count = ni;
+	gltfIndicesAccessor.type = TINYGLTF_TYPE_SCALAR;
+	gltfIndicesAccessor.maxValues.push_back(maxIndex);
+	gltfIndicesAccessor.minValues.push_back(minIndex);
+
+	// Describe the layout of verticesUvBufferView, the vertices themself
+	tinygltf::Accessor gltfVerticesAccessor;
+	gltfVerticesAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
+	gltfVerticesAccessor.byteOffset = 0;
+	gltfVerticesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+	gltfVerticesAccessor.count = nv;
+	gltfVerticesAccessor.type = TINYGLTF_TYPE_VEC3;
+	gltfVerticesAccessor.maxValues = {maxVertex[0], maxVertex[1], maxVertex[2]};
+	gltfVerticesAccessor.minValues = {minVertex[0], minVertex[1], minVertex[2]};
+
+	// Describe the layout of normals - they are followed
+	tinygltf::Accessor gltfNormalAccessor;
+	gltfNormalAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
+	gltfNormalAccessor.byteOffset = sizeof(glm::vec3);
+	gltfNormalAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+	gltfNormalAccessor.count = nv;
+	gltfNormalAccessor.type = TINYGLTF_TYPE_VEC3;
+
+	tinygltf::Accessor gltfColorAccessor;
+	if (withTexCoords) {
+		gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
+		gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		gltfColorAccessor.count = nv;
+		gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * sizeof(glm::vec3);
+		gltfColorAccessor.type = TINYGLTF_TYPE_VEC2;
+	} else if (withColor) {
+		gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
+		gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		gltfColorAccessor.count = nv;
+		gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * sizeof(glm::vec3);
+		gltfColorAccessor.type = TINYGLTF_TYPE_VEC4;
+	}
+
+	{
+		// Build the mesh meshPrimitive and add it to the mesh
+		tinygltf::Primitive gltfMeshPrimitive;
+		// The index of the accessor for the vertex indices
+		gltfMeshPrimitive.indices = (int)gltfModel.accessors.size();
+		// The index of the accessor for positions
+		gltfMeshPrimitive.attributes["POSITION"] = (int)gltfModel.accessors.size() + 1;
+		if (exportNormals) {
+			gltfMeshPrimitive.attributes["NORMAL"] = (int)gltfModel.accessors.size() + 2;
+		}
+		if (withTexCoords) {
+			const core::String &texcoordsKey = core::String::format("TEXCOORD_%i", _priv::TexcoordIndex);
+			gltfMeshPrimitive.attributes[texcoordsKey.c_str()] =
+				(int)gltfModel.accessors.size() + (exportNormals ? 3 : 2);
+		} else if (withColor) {
+			gltfMeshPrimitive.attributes["COLOR_0"] = (int)gltfModel.accessors.size() + (exportNormals ? 3 : 2);
+		}
+		gltfMeshPrimitive.material = materialId;
+		gltfMeshPrimitive.mode = TINYGLTF_MODE_TRIANGLES;
+		gltfMesh.primitives.emplace_back(core::move(gltfMeshPrimitive));
+	}
+
+	Log::debug("Index buffer view at %i", (int)gltfModel.bufferViews.size());
+	gltfModel.bufferViews.emplace_back(core::move(gltfIndicesBufferView));
+	Log::debug("vertex buffer view at %i", (int)gltfModel.bufferViews.size());
+	gltfModel.bufferViews.emplace_back(core::move(gltfVerticesBufferView));
+	gltfModel.accessors.emplace_back(core::move(gltfIndicesAccessor));
+	gltfModel.accessors.emplace_back(core::move(gltfVerticesAccessor));
+	if (exportNormals) {
+		gltfModel.accessors.emplace_back(core::move(gltfNormalAccessor));
+	}
+	if (withTexCoords || withColor) {
+		gltfModel.accessors.emplace_back(core::move(gltfColorAccessor));
+	}
+	return true;
+}
+
+void GLTFFormat::finishModel(tinygltf::Model &gltfModel, tinygltf::Scene &gltfScene,
+							 const core::Map<int, int> &nodeMapping, const scenegraph::SceneGraph &sceneGraph,
+							 bool exportAnimations) {
+	if (exportAnimations) {
+		Log::debug("Export %i animations for %i nodes", (int)sceneGraph.animations().size(), (int)nodeMapping.size());
+		gltfModel.animations.reserve(sceneGraph.animations().size());
+		for (const core::String &animationId : sceneGraph.animations()) {
+			tinygltf::Animation gltfAnimation;
+			gltfAnimation.name = animationId.c_str();
+			Log::debug("save animation: %s", animationId.c_str());
+			for (const auto &e : nodeMapping) {
+				const scenegraph::SceneGraphNode &node = sceneGraph.node(e->key);
+				saveAnimation(e->value, gltfModel, node, gltfAnimation);
+			}
+			gltfModel.animations.emplace_back(gltfAnimation);
+		}
+	} else {
+		Log::debug("No animations found");
+	}
+
+	gltfModel.scenes.emplace_back(core::move(gltfScene));
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
+		tinygltf::Camera gltfCamera = _priv::processCamera(toCameraNode(*iter));
+		if (gltfCamera.type.empty()) {
+			continue;
+		}
+		gltfModel.cameras.push_back(gltfCamera);
+	}
+}
+
 bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
 							const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream,
 							const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) {
@@ -165,12 +470,7 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 	tinygltf::Scene gltfScene;
 
 	const size_t modelNodes = meshes.size();
-	const core::String &appname = app::App::getInstance()->appname();
-	const core::String &generator = core::string::format("%s " PROJECT_VERSION, appname.c_str());
-	// Define the asset. The version is required
-	gltfModel.asset.generator = generator.c_str();
-	gltfModel.asset.version = "2.0";
-	gltfModel.asset.copyright = sceneGraph.root().property("Copyright").c_str();
+	initModel(gltfModel, sceneGraph);
 	gltfModel.accessors.reserve(modelNodes * 4 + sceneGraph.animations().size() * 4);
 
 	Stack stack;
@@ -186,58 +486,8 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 		const voxel::Palette &palette = node.palette();
 
 		int materialId = -1;
-		int texcoordIndex = 0;
 		if (node.type() == scenegraph::SceneGraphNodeType::Model) {
-			const auto palTexIter = paletteMaterialIndices.find(palette.hash());
-			if (palTexIter != paletteMaterialIndices.end()) {
-				materialId = palTexIter->second;
-				Log::debug("Re-use material id %i for hash %" PRIu64, materialId, palette.hash());
-			} else {
-				const core::String hashId = core::String::format("%" PRIu64, palette.hash());
-
-				const int imageIndex = (int)gltfModel.images.size();
-				{
-					tinygltf::Image gltfPaletteImage;
-					image::Image image("pal");
-					image.loadRGBA((const unsigned char *)palette.colors(), voxel::PaletteMaxColors, 1);
-					const core::String &pal64 = image.pngBase64();
-					gltfPaletteImage.uri = "data:image/png;base64,";
-					gltfPaletteImage.width = voxel::PaletteMaxColors;
-					gltfPaletteImage.height = 1;
-					gltfPaletteImage.component = 4;
-					gltfPaletteImage.bits = 32;
-					gltfPaletteImage.uri += pal64.c_str();
-					gltfModel.images.emplace_back(core::move(gltfPaletteImage));
-				}
-
-				const int textureIndex = (int)gltfModel.textures.size();
-				{
-					tinygltf::Texture gltfPaletteTexture;
-					gltfPaletteTexture.source = imageIndex;
-					gltfModel.textures.emplace_back(core::move(gltfPaletteTexture));
-				}
-				// TODO: save emissiveTexture
-
-				{
-					tinygltf::Material gltfMaterial;
-					if (withTexCoords) {
-						gltfMaterial.pbrMetallicRoughness.baseColorTexture.index = textureIndex;
-						gltfMaterial.pbrMetallicRoughness.baseColorTexture.texCoord = texcoordIndex;
-					} else if (withColor) {
-						gltfMaterial.pbrMetallicRoughness.baseColorFactor = {1.0f, 1.0f, 1.0f, 1.0f};
-					}
-
-					gltfMaterial.name = hashId.c_str();
-					gltfMaterial.pbrMetallicRoughness.roughnessFactor = 1.0;
-					gltfMaterial.pbrMetallicRoughness.metallicFactor = 0.0;
-					gltfMaterial.doubleSided = false;
-
-					materialId = (int)gltfModel.materials.size();
-					gltfModel.materials.emplace_back(core::move(gltfMaterial));
-				}
-				paletteMaterialIndices.put(palette.hash(), materialId);
-				Log::debug("New material id %i for hash %" PRIu64, materialId, palette.hash());
-			}
+			materialId = saveMaterial(gltfModel, paletteMaterialIndices, palette, withColor, withTexCoords);
 		}
 
 		if (meshIdxNodeMap.find(nodeId) == meshIdxNodeMap.end()) {
@@ -258,179 +508,20 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 
 			Log::debug("Exporting layer %s", meshExt.name.c_str());
 
-			const int nv = (int)mesh->getNoOfVertices();
-			const int ni = (int)mesh->getNoOfIndices();
-
-			if (ni % 3 != 0) {
-				Log::error("Unexpected indices amount");
-				return false;
-			}
-
-			const voxel::VertexArray &vertices = mesh->getVertexVector();
-			const voxel::NormalArray &normals = mesh->getNormalVector();
-			const voxel::IndexArray &indices = mesh->getIndexVector();
 			const char *objectName = meshExt.name.c_str();
-			const bool exportNormals = !normals.empty();
-			if (exportNormals) {
-				Log::debug("Export normals for mesh %i", i);
-			}
-
 			if (objectName[0] == '\0') {
 				objectName = "Noname";
 			}
 
 			tinygltf::Mesh gltfMesh;
-			const size_t expectedSize = (size_t)ni * sizeof(voxel::IndexType) + (size_t)nv * 10 * sizeof(float);
-			io::BufferedReadWriteStream os((int64_t)expectedSize);
-
 			gltfMesh.name = std::string(objectName);
 
-			unsigned int maxIndex = 0;
-			unsigned int minIndex = UINT_MAX;
-
-			for (int i = 0; i < ni; i++) {
-				const int idx = i;
-				os.writeUInt32(indices[idx]);
-
-				if (maxIndex < indices[idx]) {
-					maxIndex = indices[idx];
-				}
-
-				if (indices[idx] < minIndex) {
-					minIndex = indices[idx];
-				}
-			}
-
-			static_assert(sizeof(voxel::IndexType) == 4, "if not 4 bytes - we might need padding here");
-			const unsigned int FLOAT_BUFFER_OFFSET = os.size();
-
-			glm::vec3 maxVertex(-FLT_MAX);
-			glm::vec3 minVertex(FLT_MAX);
-
-			const glm::vec3 &offset = mesh->getOffset();
-
-			const glm::vec3 pivotOffset = offset - meshExt.pivot * meshExt.size;
-			for (int j = 0; j < nv; j++) {
-				glm::vec3 pos = vertices[j].position;
-
-				if (meshExt.applyTransform) {
-					pos = pos + pivotOffset;
-				}
-
-				for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
-					os.writeFloat(pos[coordIndex]);
-
-					if (maxVertex[coordIndex] < pos[coordIndex]) {
-						maxVertex[coordIndex] = pos[coordIndex];
-					}
-
-					if (minVertex[coordIndex] > pos[coordIndex]) {
-						minVertex[coordIndex] = pos[coordIndex];
-					}
-				}
-
-				if (exportNormals) {
-					for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
-						os.writeFloat(normals[j][coordIndex]);
-					}
-				}
-
-				if (withTexCoords) {
-					const glm::vec2 &uv = paletteUV(vertices[j].colorIndex);
-					os.writeFloat(uv.x);
-					os.writeFloat(uv.y);
-				} else if (withColor) {
-					const glm::vec4 &color = core::Color::fromRGBA(palette.color(vertices[j].colorIndex));
-					for (int colorIdx = 0; colorIdx < glm::vec4::length(); colorIdx++) {
-						os.writeFloat(color[colorIdx]);
-					}
-				}
-			}
-
-			tinygltf::BufferView gltfIndicesBufferView;
-			gltfIndicesBufferView.buffer = (int)gltfModel.buffers.size();
-			gltfIndicesBufferView.byteOffset = 0;
-			gltfIndicesBufferView.byteLength = FLOAT_BUFFER_OFFSET;
-			gltfIndicesBufferView.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
-
-			tinygltf::BufferView gltfVerticesBufferView;
-			gltfVerticesBufferView.buffer = (int)gltfModel.buffers.size();
-			gltfVerticesBufferView.byteOffset = FLOAT_BUFFER_OFFSET;
-			gltfVerticesBufferView.byteLength = os.size() - FLOAT_BUFFER_OFFSET;
-			gltfVerticesBufferView.byteStride = sizeof(glm::vec3);
-			if (exportNormals) {
-				gltfVerticesBufferView.byteStride += sizeof(glm::vec3);
-			}
-			if (withTexCoords) {
-				gltfVerticesBufferView.byteStride += sizeof(glm::vec2);
-			} else if (withColor) {
-				gltfVerticesBufferView.byteStride += sizeof(glm::vec4);
-			}
-			gltfVerticesBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
-
-			// Describe the layout of indicesBufferView, the indices of the vertices
-			tinygltf::Accessor gltfIndicesAccessor;
-			gltfIndicesAccessor.bufferView = (int)gltfModel.bufferViews.size();
-			gltfIndicesAccessor.byteOffset = 0;
-			gltfIndicesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
-			gltfIndicesAccessor.count = ni;
-			gltfIndicesAccessor.type = TINYGLTF_TYPE_SCALAR;
-			gltfIndicesAccessor.maxValues.push_back(maxIndex);
-			gltfIndicesAccessor.minValues.push_back(minIndex);
-
-			// Describe the layout of verticesUvBufferView, the vertices themself
-			tinygltf::Accessor gltfVerticesAccessor;
-			gltfVerticesAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-			gltfVerticesAccessor.byteOffset = 0;
-			gltfVerticesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
-			gltfVerticesAccessor.count = nv;
-			gltfVerticesAccessor.type = TINYGLTF_TYPE_VEC3;
-			gltfVerticesAccessor.maxValues = {maxVertex[0], maxVertex[1], maxVertex[2]};
-			gltfVerticesAccessor.minValues = {minVertex[0], minVertex[1], minVertex[2]};
-
-			// Describe the layout of normals - they are followed
-			tinygltf::Accessor gltfNormalAccessor;
-			gltfNormalAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-			gltfNormalAccessor.byteOffset = sizeof(glm::vec3);
-			gltfNormalAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
-			gltfNormalAccessor.count = nv;
-			gltfNormalAccessor.type = TINYGLTF_TYPE_VEC3;
-
-			tinygltf::Accessor gltfColorAccessor;
-			if (withTexCoords) {
-				gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-				gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
-				gltfColorAccessor.count = nv;
-				gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * sizeof(glm::vec3);
-				gltfColorAccessor.type = TINYGLTF_TYPE_VEC2;
-			} else if (withColor) {
-				gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-				gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
-				gltfColorAccessor.count = nv;
-				gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * sizeof(glm::vec3);
-				gltfColorAccessor.type = TINYGLTF_TYPE_VEC4;
-			}
-
-			{
-				// Build the mesh meshPrimitive and add it to the mesh
-				tinygltf::Primitive gltfMeshPrimitive;
-				// The index of the accessor for the vertex indices
-				gltfMeshPrimitive.indices = (int)gltfModel.accessors.size();
-				// The index of the accessor for positions
-				gltfMeshPrimitive.attributes["POSITION"] = (int)gltfModel.accessors.size() + 1;
-				if (exportNormals) {
-					gltfMeshPrimitive.attributes["NORMAL"] = (int)gltfModel.accessors.size() + 2;
-				}
-				if (withTexCoords) {
-					const core::String &texcoordsKey = core::String::format("TEXCOORD_%i", texcoordIndex);
-					gltfMeshPrimitive.attributes[texcoordsKey.c_str()] =
-						(int)gltfModel.accessors.size() + (exportNormals ? 3 : 2);
-				} else if (withColor) {
-					gltfMeshPrimitive.attributes["COLOR_0"] = (int)gltfModel.accessors.size() + (exportNormals ? 3 : 2);
-				}
-				gltfMeshPrimitive.material = materialId;
-				gltfMeshPrimitive.mode = TINYGLTF_MODE_TRIANGLES;
-				gltfMesh.primitives.emplace_back(core::move(gltfMeshPrimitive));
+			const size_t expectedSize = mesh->getNoOfIndices() * sizeof(voxel::IndexType) +
+										mesh->getNoOfVertices() * 10 * sizeof(float);
+			io::BufferedReadWriteStream os((int64_t)expectedSize);
+			if (!savePrimitive(gltfModel, gltfMesh, os, (int)gltfModel.buffers.size(), *mesh, meshExt, palette,
+							   materialId, withColor, withTexCoords)) {
+				return false;
 			}
 
 			{
@@ -448,54 +539,123 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			}
 
 			gltfModel.meshes.emplace_back(core::move(gltfMesh));
-			Log::debug("Index buffer view at %i", (int)gltfModel.bufferViews.size());
-			gltfModel.bufferViews.emplace_back(core::move(gltfIndicesBufferView));
-			Log::debug("vertex buffer view at %i", (int)gltfModel.bufferViews.size());
-			gltfModel.bufferViews.emplace_back(core::move(gltfVerticesBufferView));
-			gltfModel.accessors.emplace_back(core::move(gltfIndicesAccessor));
-			gltfModel.accessors.emplace_back(core::move(gltfVerticesAccessor));
-			if (exportNormals) {
-				gltfModel.accessors.emplace_back(core::move(gltfNormalAccessor));
-			}
-			if (withTexCoords || withColor) {
-				gltfModel.accessors.emplace_back(core::move(gltfColorAccessor));
-			}
 		}
 	}
 
-	if (exportAnimations) {
-		Log::debug("Export %i animations for %i nodes", (int)sceneGraph.animations().size(), (int)nodeMapping.size());
-		gltfModel.animations.reserve(sceneGraph.animations().size());
-		for (const core::String &animationId : sceneGraph.animations()) {
-			tinygltf::Animation gltfAnimation;
-			gltfAnimation.name = animationId.c_str();
-			Log::debug("save animation: %s", animationId.c_str());
-			for (const auto &e : nodeMapping) {
-				const scenegraph::SceneGraphNode &node = sceneGraph.node(e->key);
-				saveAnimation(e->value, gltfModel, node, gltfAnimation);
-			}
-			gltfModel.animations.emplace_back(gltfAnimation);
-		}
-	} else {
-		Log::debug("No animations found");
+	finishModel(gltfModel, gltfScene, nodeMapping, sceneGraph, exportAnimations);
+
+	io::StdOStreamBuf buf(stream);
+	std::ostream gltfStream(&buf);
+	if (!gltf.WriteGltfSceneToStream(&gltfModel, gltfStream, false, writeBinary)) {
+		Log::error("Could not save to file");
+		return false;
 	}
 
-	gltfModel.scenes.emplace_back(core::move(gltfScene));
-	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
-		tinygltf::Camera gltfCamera = _priv::processCamera(toCameraNode(*iter));
-		if (gltfCamera.type.empty()) {
+	return true;
+}
+
+bool GLTFFormat::supportsMeshStream(const core::String &filename) const {
+	// the binary container needs the json document in front of the buffer data - only the external buffer of the
+	// text format can be written while the chunks are extracted
+	return core::string::extractExtension(filename) != "glb";
+}
+
+bool GLTFFormat::beginMeshStream(MeshStream &meshStream) {
+	_meshStream = new GltfMeshStream();
+	_meshStream->binFilename = core::string::replaceExtension(meshStream.filename, "bin");
+	_meshStream->binFile = io::filesystem()->open(_meshStream->binFilename, io::FileMode::SysWrite);
+	if (!_meshStream->binFile->validHandle()) {
+		Log::error("Failed to create the gltf buffer file %s", _meshStream->binFilename.c_str());
+		_meshStream = nullptr;
+		return false;
+	}
+	_meshStream->binStream = new io::FileStream(_meshStream->binFile);
+	initModel(_meshStream->gltfModel, meshStream.sceneGraph);
+	// the indices and vertices of all chunks - the data is only written to the external file
+	_meshStream->gltfModel.buffers.emplace_back();
+	return true;
+}
+
+bool GLTFFormat::writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) {
+	tinygltf::Model &gltfModel = _meshStream->gltfModel;
+	const voxel::Palette &palette = meshStream.sceneGraph.node(meshExt.nodeId).palette();
+	const int materialId = saveMaterial(gltfModel, _meshStream->paletteMaterialIndices, palette,
+										meshStream.withColor, meshStream.withTexCoords);
+	int meshIdx = -1;
+	if (!_meshStream->nodeMeshes.get(meshExt.nodeId, meshIdx)) {
+		Log::debug("Exporting layer %s", meshExt.name.c_str());
+		const char *objectName = meshExt.name.c_str();
+		if (objectName[0] == '\0') {
+			objectName = "Noname";
+		}
+		tinygltf::Mesh gltfMesh;
+		gltfMesh.name = std::string(objectName);
+		meshIdx = (int)gltfModel.meshes.size();
+		gltfModel.meshes.emplace_back(core::move(gltfMesh));
+		_meshStream->nodeMeshes.put(meshExt.nodeId, meshIdx);
+	}
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
+		if (mesh.isEmpty()) {
 			continue;
 		}
-		gltfModel.cameras.push_back(gltfCamera);
+		if (!savePrimitive(gltfModel, gltfModel.meshes[meshIdx], *_meshStream->binStream, 0, mesh, meshExt, palette,
+						   materialId, meshStream.withColor, meshStream.withTexCoords)) {
+			return false;
+		}
 	}
+	return true;
+}
 
-	io::StdOStreamBuf buf(stream);
-	std::ostream gltfStream(&buf);
-	if (!gltf.WriteGltfSceneToStream(&gltfModel, gltfStream, false, writeBinary)) {
+bool GLTFFormat::endMeshStream(MeshStream &meshStream) {
+	const scenegraph::SceneGraph &sceneGraph = meshStream.sceneGraph;
+	tinygltf::Model &gltfModel = _meshStream->gltfModel;
+	const int64_t binSize = _meshStream->binStream->size();
+	_meshStream->binStream = nullptr;
+	_meshStream->binFile->close();
+
+	const bool exportAnimations = sceneGraph.hasAnimations();
+	tinygltf::Scene gltfScene;
+	core::Map<int, int> nodeMapping((int)sceneGraph.nodeSize());
+	Stack stack;
+	stack.emplace_back(0, -1);
+	while (!stack.empty()) {
+		const int nodeId = stack.back().first;
+		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+		tinygltf::Node gltfNode;
+		int meshIdx = -1;
+		if (_meshStream->nodeMeshes.get(nodeId, meshIdx)) {
+			gltfNode.mesh = meshIdx;
+			saveGltfNode(nodeMapping, gltfModel, gltfNode, gltfScene, node, stack, sceneGraph, meshStream.scale,
+						 exportAnimations);
+		} else {
+			saveGltfNode(nodeMapping, gltfModel, gltfNode, gltfScene, node, stack, sceneGraph, meshStream.scale,
+						 false);
+		}
+	}
+	finishModel(gltfModel, gltfScene, nodeMapping, sceneGraph, exportAnimations);
+
+	// tinygltf embeds all buffers when writing to a stream - the uri and the length of the external buffer are
+	// patched into the json document afterwards
+	tinygltf::TinyGLTF gltf;
+	std::ostringstream jsonStream;
+	if (!gltf.WriteGltfSceneToStream(&gltfModel, jsonStream, false, false)) {
+		Log::error("Could not save to file");
+		_meshStream = nullptr;
+		return false;
+	}
+	tinygltf::detail::json doc;
+	tinygltf::detail::JsonParse(doc, jsonStream.str().c_str(), jsonStream.str().size());
+	tinygltf::detail::json &gltfBuffer = doc["buffers"][0];
+	gltfBuffer["uri"] = core::string::extractFilenameWithExtension(_meshStream->binFilename).c_str();
+	gltfBuffer["byteLength"] = binSize;
+	_meshStream = nullptr;
+
+	const std::string &json = tinygltf::detail::JsonToString(doc);
+	if (meshStream.stream.write(json.c_str(), json.size()) == -1) {
 		Log::error("Could not save to file");
 		return false;
 	}
-
 	return true;
 }
 
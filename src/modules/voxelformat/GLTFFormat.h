@@ -6,6 +6,7 @@
 
 #include "MeshFormat.h"
 #include "core/Pair.h"
+#include "core/ScopedPtr.h"
 #include "core/collection/StringMap.h"
 
 namespace tinygltf {
@@ -14,6 +15,7 @@ class Node;
 struct Scene;
 struct Material;
 struct Primitive;
+struct Mesh;
 struct Accessor;
 struct Animation;
 struct AnimationChannel;
@@ -45,6 +47,31 @@ private:
 	void saveAnimation(int targetNode, tinygltf::Model &m, const scenegraph::SceneGraphNode &node,
 					   tinygltf::Animation &gltfAnimation);
 
+	void initModel(tinygltf::Model &gltfModel, const scenegraph::SceneGraph &sceneGraph) const;
+	int saveMaterial(tinygltf::Model &gltfModel, core::Map<uint64_t, int> &paletteMaterialIndices,
+					 const voxel::Palette &palette, bool withColor, bool withTexCoords) const;
+	/**
+	 * @brief Appends the indices and vertices of the given mesh to the stream and adds the buffer views, the
+	 * accessors and the primitive that reference them
+	 * @param bufferIdx The buffer that the stream data ends up in - the data is written at the current stream
+	 * position
+	 */
+	bool savePrimitive(tinygltf::Model &gltfModel, tinygltf::Mesh &gltfMesh, io::SeekableWriteStream &os,
+					   int bufferIdx, const voxel::Mesh &mesh, const MeshExt &meshExt, const voxel::Palette &palette,
+					   int materialId, bool withColor, bool withTexCoords) const;
+	/**
+	 * @brief Adds the animations, the scene and the cameras to the model
+	 */
+	void finishModel(tinygltf::Model &gltfModel, tinygltf::Scene &gltfScene, const core::Map<int, int> &nodeMapping,
+					 const scenegraph::SceneGraph &sceneGraph, bool exportAnimations);
+
+	/**
+	 * The state of the chunk by chunk export - the meshes end up in an external buffer file and only the json
+	 * document is kept in memory
+	 */
+	struct GltfMeshStream;
+	core::ScopedPtr<GltfMeshStream> _meshStream;
+
 	// importing (voxelization)
 	struct GltfVertex {
 		glm::vec3 pos{0.0f};
@@ -88,7 +115,16 @@ private:
 	bool voxelizeGroups(const core::String &filename, io::SeekableReadStream &stream,
 						scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) override;
 
+protected:
+	bool supportsMeshStream(const core::String &filename) const override;
+	bool beginMeshStream(MeshStream &meshStream) override;
+	bool writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) override;
+	bool endMeshStream(MeshStream &meshStream) override;
+
 public:
+	GLTFFormat();
+	~GLTFFormat() override;
+
 	bool saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
 					const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream,
 					const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) override;
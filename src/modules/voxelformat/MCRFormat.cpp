@@ -3,24 +3,25 @@
  */
 
 #include "MCRFormat.h"
+#include "app/App.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/StringMap.h"
+#include "core/concurrent/ParallelFor.h"
 #include "io/File.h"
 #include "io/MemoryReadStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
 #include "private/NamedBinaryTag.h"
+#include "private/NamedBinaryTagReader.h"
 #include "private/MinecraftPaletteMap.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
-#include "voxel/RawVolumeWrapper.h"
+#include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraph.h"
-#include "voxelutil/VolumeCropper.h"
-#include "voxelutil/VolumeMerger.h"
 
 #include <glm/common.hpp>
 
@@ -91,6 +92,9 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 }
 
 bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, const voxel::Palette &palette) {
+	// the stream is read sequentially - only the decoding of the chunks is done in parallel
+	core::DynamicArray<CompressedChunk> chunks;
+	chunks.reserve(SECTOR_INTS);
 	for (int i = 0; i < SECTOR_INTS; ++i) {
 		if (_offsets[i].sectorCount == 0u || _offsets[i].offset < sizeof(_offsets)) {
 			continue;
@@ -101,16 +105,50 @@ bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::Seek
 		if (stream.seek(_offsets[i].offset) == -1) {
 			continue;
 		}
-		if (!readCompressedNBT(sceneGraph, stream, i, palette)) {
-			Log::error("Failed to load minecraft chunk section %i for offset %u", i, (int)_offsets[i].offset);
+		CompressedChunk chunk;
+		chunk.sector = i;
+		if (!readCompressedNBT(stream, chunk)) {
+			Log::error("Failed to read minecraft chunk section %i for offset %u", i, (int)_offsets[i].offset);
 			return false;
 		}
+		if (!chunk.stream) {
+			continue;
+		}
+		chunks.push_back(chunk);
+	}
+
+	core::DynamicArray<voxel::RawVolume *> volumes;
+	volumes.resize(chunks.size());
+	auto parse = [&](size_t idx) { volumes[idx] = parseCompressedNBT(chunks[idx], palette); };
+
+	// the region might already get loaded from a worker of the pool (see DatFormat) - parallel_for() helps out
+	// with the queued tasks instead of blocking the worker
+	core::parallel_for(app::App::getInstance()->threadPool(), 0, (int)chunks.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			parse(i);
+		}
+	});
+
+	// add the nodes in the order of the sectors to get the same scene graph for every run
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		if (volumes[i] == nullptr) {
+			const int sector = chunks[i].sector;
+			Log::error("Failed to load minecraft chunk section %i for offset %u", sector, (int)_offsets[sector].offset);
+			for (size_t j = i + 1; j < volumes.size(); ++j) {
+				delete volumes[j];
+			}
+			return false;
+		}
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(volumes[i], true);
+		node.setPalette(palette);
+		sceneGraph.emplace(core::move(node));
 	}
 
 	return true;
 }
 
-bool MCRFormat::readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, int sector, const voxel::Palette &palette) {
+bool MCRFormat::readCompressedNBT(io::SeekableReadStream &stream, CompressedChunk &chunk) {
 	uint32_t nbtSize;
 	wrap(stream.readUInt32BE(nbtSize));
 	if (nbtSize == 0) {
@@ -133,44 +171,44 @@ bool MCRFormat::readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::Seekab
 	// the version is included in the length
 	--nbtSize;
 
-	io::ZipReadStream zipStream(stream, (int)nbtSize);
-	priv::NamedBinaryTagContext ctx;
-	ctx.stream = &zipStream;
-	const priv::NamedBinaryTag &root = priv::NamedBinaryTag::parse(ctx);
+	if (stream.remaining() < (int64_t)nbtSize) {
+		Log::error("Not enough data for the nbt chunk of sector %i", chunk.sector);
+		return false;
+	}
+	chunk.stream = core::make_shared<io::MemoryReadStream>(stream, nbtSize);
+	return chunk.stream->size() == (int64_t)nbtSize;
+}
+
+voxel::RawVolume *MCRFormat::parseCompressedNBT(const CompressedChunk &chunk, const voxel::Palette &palette) {
+	io::MemoryReadStream &stream = *chunk.stream.get();
+	io::ZipReadStream zipStream(stream, (int)stream.size());
+	priv::NamedBinaryTagReader reader;
+	if (!reader.read(zipStream)) {
+		Log::error("Could not read nbt data");
+		return nullptr;
+	}
+	const priv::NamedBinaryTagView &root = reader.root();
 	if (!root.valid()) {
 		Log::error("Could not parse nbt structure");
-		return false;
+		return nullptr;
 	}
 
-	voxel::RawVolume *volume;
 	// https://minecraft.fandom.com/wiki/Data_version
 	const int32_t dataVersion = root.get("DataVersion").int32();
 	Log::debug("Found data version %i", dataVersion);
 	if (dataVersion >= 2844) {
-		volume = parseSections(dataVersion, root, sector, palette);
-		if (volume == nullptr) {
-			return false;
-		}
-	} else {
-		volume = parseLevelCompound(dataVersion, root, sector, palette);
-		if (volume == nullptr) {
-			return false;
-		}
+		return parseSections(dataVersion, root, chunk.sector, palette);
 	}
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-	node.setVolume(volume, true);
-	node.setPalette(palette);
-	sceneGraph.emplace(core::move(node));
-	return true;
+	return parseLevelCompound(dataVersion, root, chunk.sector, palette);
 }
 
-int MCRFormat::getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const glm::ivec3 &pos) {
+int MCRFormat::getVoxel(int dataVersion, const priv::NamedBinaryTagView &data, const glm::ivec3 &pos) {
 	const uint32_t i = pos.y * MAX_SIZE * MAX_SIZE + pos.z * MAX_SIZE + pos.x;
-	if (i >= data.byteArray()->size()) {
-		Log::error("Byte array index out of bounds: %u/%i", i, (int)data.byteArray()->size());
+	if (i >= data.size()) {
+		Log::error("Byte array index out of bounds: %u/%i", i, (int)data.size());
 		return -1;
 	}
-	const int val = (int)(uint8_t)(*data.byteArray())[i];
+	const int val = (int)(uint8_t)data.byteAt(i);
 	if (val < 0) {
 		Log::error("Invalid value: %i", val);
 		return -1;
@@ -178,43 +216,33 @@ int MCRFormat::getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const
 	return val;
 }
 
-voxel::RawVolume *MCRFormat::error(SectionVolumes &volumes) {
-	for (voxel::RawVolume *v : volumes) {
-		delete v;
-	}
-	return nullptr;
+voxel::Region MCRFormat::sectionsRegion() {
+	// the section y level is stored as signed byte
+	return voxel::Region(glm::ivec3(0, -128 * MAX_SIZE, 0), glm::ivec3(MAX_SIZE - 1, 128 * MAX_SIZE - 1, MAX_SIZE - 1));
 }
 
-voxel::RawVolume* MCRFormat::finalize(SectionVolumes& volumes, int xPos, int zPos) {
-	if (volumes.empty()) {
+voxel::RawVolume* MCRFormat::finalize(const voxel::PagedVolume& volume, int xPos, int zPos) {
+	if (volume.chunkCount() == 0u) {
 		Log::error("No volumes found at %i:%i", xPos, zPos);
 		return nullptr;
 	}
-	// TODO: only merge connected y chunks - don't fill empty chunks - just a waste of memory
-	voxel::RawVolume *merged = voxelutil::merge(volumes);
-	for (voxel::RawVolume* v : volumes) {
-		delete v;
-	}
-	merged->translate(glm::ivec3(xPos * MAX_SIZE, 0, zPos * MAX_SIZE));
-	voxel::RawVolume *cropped = voxelutil::cropVolume(merged);
-	delete merged;
-	return cropped;
+	Log::debug("Chunk %i:%i used %i bytes with %i compressed chunks", xPos, zPos, (int)volume.memoryUsage(),
+			   (int)volume.compressedChunkCount());
+	// only the bounds of the set voxels are allocated - and not the whole range of sections
+	voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(volume.mins(), volume.maxs()));
+	volume.copyInto(*v);
+	v->translate(glm::ivec3(xPos * MAX_SIZE, 0, zPos * MAX_SIZE));
+	return v;
 }
 
-bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTag &data, SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal) {
+bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTagView &data, voxel::PagedVolume &volume, int sectionY, const MinecraftSectionPalette &secPal) {
 	Log::debug("Parse block states");
-	const bool hasData = data.type() == priv::TagType::LONG_ARRAY && !data.longArray()->empty();
-
-	constexpr glm::ivec3 mins(0, 0, 0);
-	constexpr glm::ivec3 maxs(MAX_SIZE - 1, MAX_SIZE - 1, MAX_SIZE - 1);
-	const voxel::Region region(mins, maxs);
-	voxel::RawVolume *v = new voxel::RawVolume(region);
-	voxel::RawVolumeWrapper wrapper(v);
+	const bool hasData = data.type() == priv::TagType::LONG_ARRAY && !data.empty();
+	const glm::ivec3 sectionOffset(0, sectionY * MAX_SIZE, 0);
 
 	if (secPal.pal.empty()) {
 		if (data.type() != priv::TagType::BYTE_ARRAY) {
 			Log::error("Unknown block data type: %i for version %i", (int)data.type(), dataVersion);
-			delete v;
 			return false;
 		}
 		glm::ivec3 sPos;
@@ -224,13 +252,12 @@ bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette,
 					const int color = getVoxel(dataVersion, data, sPos);
 					if (color < 0) {
 						Log::error("Failed to load voxel at position %i:%i:%i (dataversion: %i)", sPos.x, sPos.y, sPos.z, dataVersion);
-						delete v;
 						return false;
 					}
 					if (color) {
 						const uint8_t palColIdx = palette.getClosestMatch(secPal.mcpal.color(color));
 						const voxel::Voxel voxel = voxel::createVoxel(palette, palColIdx);
-						wrapper.setVoxel(sPos, voxel);
+						volume.setVoxel(sPos + sectionOffset, voxel);
 					}
 				}
 			}
@@ -238,21 +265,18 @@ bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette,
 	} else if (hasData) {
 		if (data.type() != priv::TagType::LONG_ARRAY) {
 			Log::error("Unknown block data type: %i for version %i", (int)data.type(), dataVersion);
-			delete v;
 			return false;
 		}
 
-		const core::DynamicArray<int64_t> &blockStates = *data.longArray();
-
 		uint8_t blocks[4096];
 		int bsCnt = 0;
 		size_t bitCnt = 0;
 		if (dataVersion < 2529) {
-			const size_t bitSize = (data.longArray()->size()) * 64 / 4096;
+			const size_t bitSize = data.size() * 64 / 4096;
 			const uint32_t bitMask = (1 << bitSize) - 1;
 			for (int i = 0; i < 4096; i++) {
 				if (bitCnt + bitSize <= 64) {
-					const uint64_t blockState = blockStates[bsCnt];
+					const uint64_t blockState = data.longAt(bsCnt);
 					const uint64_t blockIndex = (blockState >> bitCnt) & bitMask;
 					if (blockIndex < secPal.pal.size()) {
 						blocks[i] = secPal.pal[blockIndex];
@@ -265,8 +289,8 @@ bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette,
 						bsCnt++;
 					}
 				} else {
-					const uint64_t blockState1 = blockStates[bsCnt++];
-					const uint64_t blockState2 = blockStates[bsCnt];
+					const uint64_t blockState1 = data.longAt(bsCnt++);
+					const uint64_t blockState2 = data.longAt(bsCnt);
 					uint32_t blockIndex = (blockState1 >> bitCnt) & bitMask;
 					bitCnt += bitSize;
 					bitCnt -= 64;
@@ -282,7 +306,7 @@ bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette,
 			const size_t bitSize = secPal.numBits;
 			const uint32_t bitMask = (1 << bitSize) - 1;
 			for (int i = 0; i < 4096; i++) {
-				const uint64_t blockState = blockStates[bsCnt];
+				const uint64_t blockState = data.longAt(bsCnt);
 				const uint64_t blockIndex = (blockState >> bitCnt) & bitMask;
 				if (blockIndex < secPal.pal.size()) {
 					blocks[i] = secPal.pal[blockIndex];
@@ -306,29 +330,18 @@ bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette,
 					if (color) {
 						const uint8_t palColIdx = palette.getClosestMatch(secPal.mcpal.color(color));
 						const voxel::Voxel voxel = voxel::createVoxel(palette, palColIdx);
-						wrapper.setVoxel(sPos, voxel);
+						volume.setVoxel(sPos + sectionOffset, voxel);
 					}
 				}
 			}
 		}
 	}
 
-	if (wrapper.dirtyRegion().isValid()) {
-		glm::ivec3 translate;
-		translate.x = 0;
-		translate.y = sectionY * MAX_SIZE;
-		translate.z = 0;
-
-		v->translate(translate);
-		volumes.push_back(v);
-	} else {
-		delete v;
-	}
 	return true;
 }
 
-voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &pal) {
-	const priv::NamedBinaryTag &sections = root.get("sections");
+voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBinaryTagView &root, int sector, const voxel::Palette &pal) {
+	const priv::NamedBinaryTagView &sections = root.get("sections");
 	if (!sections.valid()) {
 		Log::error("Could not find 'sections' tag");
 		return nullptr;
@@ -343,20 +356,21 @@ voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBin
 
 	Log::debug("xpos: %i, zpos: %i", xPos, zPos);
 
-	const priv::NBTList &sectionsList = *sections.list();
-	Log::debug("Found %i sections", (int)sectionsList.size());
-	if (sectionsList.empty()) {
+	Log::debug("Found %i sections", (int)sections.size());
+	if (sections.empty()) {
 		Log::warn("Empty region - no sections found - version: %i", dataVersion);
 		return nullptr;
 	}
-	SectionVolumes volumes;
-	for (const priv::NamedBinaryTag &section : sectionsList) {
-		const priv::NamedBinaryTag &blockStates = section.get("block_states");
+	voxel::PagedVolume volume(sectionsRegion());
+	// many chunks are parsed in parallel - only the chunk that is currently filled keeps its raw voxel data
+	volume.setCompression(true, 1);
+	for (const priv::NamedBinaryTagView &section : sections) {
+		const priv::NamedBinaryTagView &blockStates = section.get("block_states");
 		if (!blockStates.valid()) {
 			Log::error("Could not find 'block_states'");
-			return error(volumes);
+			return nullptr;
 		}
-		const priv::NamedBinaryTag &ylvl = section.get("Y");
+		const priv::NamedBinaryTagView &ylvl = section.get("Y");
 		if (!ylvl.valid()) {
 			Log::debug("Could not find Y int in section compound");
 		}
@@ -366,28 +380,28 @@ voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBin
 		}
 		Log::debug("Y level for section compound: %i", (int)sectionY);
 
-		const priv::NamedBinaryTag &palette = blockStates.get("palette");
+		const priv::NamedBinaryTagView &palette = blockStates.get("palette");
 		if (!palette.valid()) {
 			Log::error("Could not find 'palette'");
-			return error(volumes);
+			return nullptr;
 		}
 		MinecraftSectionPalette secPal;
 		secPal.mcpal.minecraft();
 		if (!parsePaletteList(dataVersion, palette, secPal)) {
 			Log::error("Could not parse palette chunk");
-			return error(volumes);
+			return nullptr;
 		}
-		const priv::NamedBinaryTag &data = blockStates.get("data");
-		if (!parseBlockStates(dataVersion, pal, data, volumes, sectionY, secPal)) {
+		const priv::NamedBinaryTagView &data = blockStates.get("data");
+		if (!parseBlockStates(dataVersion, pal, data, volume, sectionY, secPal)) {
 			Log::error("Failed to parse 'data' tag");
-			return error(volumes);
+			return nullptr;
 		}
 	}
-	return finalize(volumes, xPos, zPos);
+	return finalize(volume, xPos, zPos);
 }
 
-voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &pal) {
-	const priv::NamedBinaryTag &levels = root.get("Level");
+voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::NamedBinaryTagView &root, int sector, const voxel::Palette &pal) {
+	const priv::NamedBinaryTagView &levels = root.get("Level");
 	if (!levels.valid()) {
 		Log::error("Could not find 'Level' tag");
 		return nullptr;
@@ -400,22 +414,22 @@ voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::Nam
 	const int32_t zPos = levels.get("zPos").int32();
 
 	if (dataVersion >= 1976) {
-		const core::String *tagStatus = root.get("Status").string();
-		if (tagStatus == nullptr) {
+		const priv::NamedBinaryTagView &tagStatus = root.get("Status");
+		if (tagStatus.type() != priv::TagType::STRING) {
 			Log::debug("Status for level node wasn't found (version: %i)", dataVersion);
-		} else if (*tagStatus != "full") {
-			Log::debug("Status for level node is not full but %s (version: %i)", tagStatus->c_str(), dataVersion);
+		} else if (tagStatus.string() != "full") {
+			Log::debug("Status for level node is not full but %s (version: %i)", tagStatus.string().c_str(), dataVersion);
 		}
 	} else if (dataVersion >= 1628) {
-		const core::String *tagStatus = levels.get("Status").string();
-		if (tagStatus == nullptr) {
+		const priv::NamedBinaryTagView &tagStatus = levels.get("Status");
+		if (tagStatus.type() != priv::TagType::STRING) {
 			Log::debug("Status for level node wasn't found (version: %i)", dataVersion);
-		} else if (*tagStatus != "postprocessed") {
-			Log::debug("Status for level node is not postprocessed but %s (version: %i)", tagStatus->c_str(), dataVersion);
+		} else if (tagStatus.string() != "postprocessed") {
+			Log::debug("Status for level node is not postprocessed but %s (version: %i)", tagStatus.string().c_str(), dataVersion);
 		}
 	}
 
-	const priv::NamedBinaryTag &sections = levels.get("Sections");
+	const priv::NamedBinaryTagView &sections = levels.get("Sections");
 	if (!sections.valid()) {
 		Log::error("Could not find 'Sections' tag");
 		return nullptr;
@@ -424,15 +438,16 @@ voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::Nam
 		Log::error("Invalid type for 'Sections' tag: %i", (int)sections.type());
 		return nullptr;
 	}
-	const priv::NBTList &sectionsList = *sections.list();
-	Log::debug("Found %i sections", (int)sectionsList.size());
-	if (sectionsList.empty()) {
+	Log::debug("Found %i sections", (int)sections.size());
+	if (sections.empty()) {
 		Log::warn("Empty region - no sections found - version: %i", dataVersion);
 		return nullptr;
 	}
-	SectionVolumes volumes;
-	for (const priv::NamedBinaryTag &section : sectionsList) {
-		const priv::NamedBinaryTag &ylvl = section.get("Y");
+	voxel::PagedVolume volume(sectionsRegion());
+	// many chunks are parsed in parallel - only the chunk that is currently filled keeps its raw voxel data
+	volume.setCompression(true, 1);
+	for (const priv::NamedBinaryTagView &section : sections) {
+		const priv::NamedBinaryTagView &ylvl = section.get("Y");
 		if (!ylvl.valid()) {
 			Log::debug("Could not find Y int in section compound");
 		}
@@ -445,39 +460,38 @@ voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::Nam
 		MinecraftSectionPalette secPal;
 		secPal.mcpal.minecraft();
 
-		const priv::NamedBinaryTag &palette = section.get("Palette");
+		const priv::NamedBinaryTagView &palette = section.get("Palette");
 		if (palette.valid()) {
 			if (!parsePaletteList(dataVersion, palette, secPal)) {
 				Log::error("Failed to parse 'Palette' tag");
-				return error(volumes);
+				return nullptr;
 			}
 		} else {
 			Log::debug("Could not find a Palette compound in section %i", dataVersion);
 		}
 
 		// TODO:"Data"(byte_array)
-		//const priv::NamedBinaryTag &data = section.get("Data");
-		const core::String &tagId = dataVersion <= 1343 ? "Blocks" : "BlockStates";
-		const priv::NamedBinaryTag &blockStates = section.get(tagId);
+		//const priv::NamedBinaryTagView &data = section.get("Data");
+		const char *tagId = dataVersion <= 1343 ? "Blocks" : "BlockStates";
+		const priv::NamedBinaryTagView &blockStates = section.get(tagId);
 		if (!blockStates.valid()) {
-			Log::debug("Could not find '%s'", tagId.c_str());
+			Log::debug("Could not find '%s'", tagId);
 			continue;
 		}
-		if (!parseBlockStates(dataVersion, pal, blockStates, volumes, sectionY, secPal)) {
-			Log::error("Failed to parse '%s' tag", tagId.c_str());
-			return error(volumes);
+		if (!parseBlockStates(dataVersion, pal, blockStates, volume, sectionY, secPal)) {
+			Log::error("Failed to parse '%s' tag", tagId);
+			return nullptr;
 		}
 	}
-	return finalize(volumes, xPos, zPos);
+	return finalize(volume, xPos, zPos);
 }
 
-bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTag &palette, MinecraftSectionPalette &sectionPal) {
+bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTagView &palette, MinecraftSectionPalette &sectionPal) {
 	if (palette.type() != priv::TagType::LIST) {
 		Log::error("Invalid type for palette: %i", (int)palette.type());
 		return false;
 	}
-	const priv::NBTList &paletteList = *palette.list();
-	const size_t paletteCount = paletteList.size();
+	const size_t paletteCount = palette.size();
 	if (paletteCount > 512u) {
 		Log::error("Palette overflow");
 		return false;
@@ -486,22 +500,15 @@ bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTag &pa
 	sectionPal.numBits = (uint32_t)glm::max(glm::ceil(glm::log2((float)paletteCount)), 4.0f);
 
 	int paletteEntry = 0;
-	for (const priv::NamedBinaryTag &block : paletteList) {
+	for (const priv::NamedBinaryTagView &block : palette) {
 		if (block.type() != priv::TagType::COMPOUND) {
 			Log::error("Invalid block type %i", (int)block.type());
 			return false;
 		}
 
-		for (const auto &entry : *block.compound()) {
-			if (entry->key != "Name") {
-				continue;
-			}
-			const priv::NamedBinaryTag &nbt = entry->value;
-			const core::String *value = nbt.string();
-			if (value == nullptr) {
-				continue;
-			}
-			sectionPal.pal[paletteEntry] = findPaletteIndex(*value);
+		const priv::NamedBinaryTagView &name = block.get("Name");
+		if (name.type() == priv::TagType::STRING) {
+			sectionPal.pal[paletteEntry] = findPaletteIndex(name.string());
 		}
 		++paletteEntry;
 	}
@@ -5,13 +5,16 @@
 #pragma once
 
 #include "Format.h"
+#include "core/SharedPtr.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
+#include "voxel/PagedVolume.h"
 #include "voxel/Palette.h"
 
 namespace io {
 class ZipReadStream;
+class MemoryReadStream;
 }
 
 
@@ -19,6 +22,7 @@ namespace voxelformat {
 
 namespace priv {
 class NamedBinaryTag;
+class NamedBinaryTagView;
 using NBTCompound = core::DynamicMap<core::String, NamedBinaryTag, 11, core::StringHash>;
 using NBTList = core::DynamicArray<NamedBinaryTag>;
 }
@@ -87,24 +91,35 @@ private:
 		voxel::Palette mcpal;
 	};
 
-	using SectionVolumes = core::DynamicArray<voxel::RawVolume *>;
+	/**
+	 * @brief Sparse volume for all sections of a chunk - only the sections with voxels are allocated
+	 */
+	static voxel::Region sectionsRegion();
+	voxel::RawVolume* finalize(const voxel::PagedVolume& volume, int xPos, int zPos);
 
-	voxel::RawVolume* error(SectionVolumes &volumes);
-	voxel::RawVolume* finalize(SectionVolumes& volumes, int xPos, int zPos);
-
-	static int getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const glm::ivec3 &pos);
+	static int getVoxel(int dataVersion, const priv::NamedBinaryTagView &data, const glm::ivec3 &pos);
 
 	// shared across versions
-	bool parsePaletteList(int dataVersion, const priv::NamedBinaryTag& palette, MinecraftSectionPalette &sectionPal);
-	bool parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTag &data, SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal);
+	bool parsePaletteList(int dataVersion, const priv::NamedBinaryTagView &palette, MinecraftSectionPalette &sectionPal);
+	bool parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTagView &data, voxel::PagedVolume &volume, int sectionY, const MinecraftSectionPalette &secPal);
 
 	// new version (>= 2844)
-	voxel::RawVolume* parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &palette);
+	voxel::RawVolume* parseSections(int dataVersion, const priv::NamedBinaryTagView &root, int sector, const voxel::Palette &palette);
 
 	// old version (< 2844)
-	voxel::RawVolume* parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &palette);
+	voxel::RawVolume* parseLevelCompound(int dataVersion, const priv::NamedBinaryTagView &root, int sector, const voxel::Palette &palette);
+
+	/**
+	 * @brief The still compressed nbt data of a chunk - read from the region file to be able to decode the
+	 * chunks in parallel
+	 */
+	struct CompressedChunk {
+		int sector = -1;
+		core::SharedPtr<io::MemoryReadStream> stream;
+	};
 
-	bool readCompressedNBT(scenegraph::SceneGraph& sceneGraph, io::SeekableReadStream &stream, int sector, const voxel::Palette &palette);
+	bool readCompressedNBT(io::SeekableReadStream &stream, CompressedChunk &chunk);
+	voxel::RawVolume *parseCompressedNBT(const CompressedChunk &chunk, const voxel::Palette &palette);
 	bool loadMinecraftRegion(scenegraph::SceneGraph& sceneGraph, io::SeekableReadStream &stream, const voxel::Palette &palette);
 
 	bool saveSections(const scenegraph::SceneGraph &sceneGraph, priv::NBTList &sections, int sector);
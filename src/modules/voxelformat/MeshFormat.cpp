@@ -14,7 +14,7 @@
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
-#include "core/concurrent/Lock.h"
+#include "core/concurrent/ParallelFor.h"
 #include "core/concurrent/ThreadPool.h"
 #include "io/FormatDescription.h"
 #include "scenegraph/SceneGraphNode.h"
@@ -25,11 +25,11 @@
 #include "voxel/RawVolume.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "scenegraph/SceneGraph.h"
+#include "voxel/PaletteKdTree.h"
 #include "voxel/PaletteLookup.h"
 #include "voxel/Mesh.h"
 #include "voxelformat/private/Tri.h"
 #include "voxelutil/VoxelUtil.h"
-#include <SDL_timer.h>
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/gtc/epsilon.hpp>
 #include <glm/geometric.hpp>
@@ -67,24 +67,6 @@ glm::vec3 MeshFormat::getScale() {
 	return {scaleX, scaleY, scaleZ};
 }
 
-void MeshFormat::subdivideTri(const Tri &tri, TriCollection &tinyTris) {
-	if (stopExecution()) {
-		return;
-	}
-	const glm::vec3 &mins = tri.mins();
-	const glm::vec3 &maxs = tri.maxs();
-	const glm::vec3 size = maxs - mins;
-	if (glm::any(glm::greaterThan(size, glm::vec3(1.0f)))) {
-		Tri out[4];
-		tri.subdivide(out);
-		for (int i = 0; i < lengthof(out); ++i) {
-			subdivideTri(out[i], tinyTris);
-		}
-		return;
-	}
-	tinyTris.push_back(tri);
-}
-
 core::RGBA MeshFormat::PosSampling::avgColor(uint8_t flattenFactor) const {
 	if (entries.size() == 1) {
 		return core::Color::flattenRGB(entries[0].color.r, entries[0].color.g, entries[0].color.b, entries[0].color.a,
@@ -94,14 +76,15 @@ core::RGBA MeshFormat::PosSampling::avgColor(uint8_t flattenFactor) const {
 	for (const PosSamplingEntry &pe : entries) {
 		sumArea += pe.area;
 	}
-	core::RGBA color(0, 0, 0, 255);
 	if (sumArea <= 0.0f) {
-		return color;
+		return core::RGBA(0, 0, 0, 255);
 	}
+	glm::vec4 color(0.0f);
 	for (const PosSamplingEntry &pe : entries) {
-		color = core::RGBA::mix(color, pe.color, pe.area / sumArea);
+		color += glm::vec4(pe.color.r, pe.color.g, pe.color.b, pe.color.a) * (pe.area / sumArea);
 	}
-	return core::Color::flattenRGB(color.r, color.g, color.b, color.a, flattenFactor);
+	const glm::u8vec4 rgba(glm::clamp(glm::round(color), 0.0f, 255.0f));
+	return core::Color::flattenRGB(rgba.r, rgba.g, rgba.b, rgba.a, flattenFactor);
 }
 
 glm::vec2 MeshFormat::paletteUV(int colorIndex) {
@@ -110,17 +93,113 @@ glm::vec2 MeshFormat::paletteUV(int colorIndex) {
 	return uv;
 }
 
-void MeshFormat::transformTris(const TriCollection &subdivided, PosMap &posMap) const {
-	Log::trace("subdivided into %i triangles", (int)subdivided.size());
-	for (const Tri &tri : subdivided) {
+void MeshFormat::transformTrisRange(const TriCollection &tris, size_t start, size_t end, PosMap &posMap) {
+	const glm::vec3 halfVoxel(0.5f);
+	for (size_t i = start; i < end; ++i) {
 		if (stopExecution()) {
 			return;
 		}
-		const float area = tri.area();
-		const glm::vec2 &uv = tri.centerUV();
-		const core::RGBA color = tri.colorAt(uv);
-		const glm::ivec3 p(glm::round(tri.center()));
-		posMap.emplace(p, {area, color});
+		const Tri &tri = tris[i];
+		// the weight of the color samples - a voxel can't be covered by more than one unit of area
+		const float area = glm::min(tri.area(), 1.0f);
+		const glm::vec3 &normal = tri.normal();
+		// the voxel at position p covers [p - 0.5, p + 0.5]
+		const glm::ivec3 mins(glm::ceil(tri.mins() - halfVoxel));
+		const glm::ivec3 maxs(glm::floor(tri.maxs() + halfVoxel));
+
+		// walk the columns of the plane the triangle is facing most and only visit the voxels of a column that
+		// are close to the triangle plane
+		const glm::vec3 absNormal = glm::abs(normal);
+		int axis = 0;
+		if (absNormal.y > absNormal[axis]) {
+			axis = 1;
+		}
+		if (absNormal.z > absNormal[axis]) {
+			axis = 2;
+		}
+		const int axisU = (axis + 1) % 3;
+		const int axisV = (axis + 2) % 3;
+		const float planeDist = glm::dot(normal, tri.vertices[0]);
+		// the depth change of the plane for half a voxel step on the other two axes
+		const float depthSlack =
+			absNormal[axis] > 0.0f ? (absNormal[axisU] + absNormal[axisV]) * 0.5f / absNormal[axis] : 0.0f;
+
+		glm::ivec3 p;
+		for (p[axisU] = mins[axisU]; p[axisU] <= maxs[axisU]; ++p[axisU]) {
+			for (p[axisV] = mins[axisV]; p[axisV] <= maxs[axisV]; ++p[axisV]) {
+				int depthMin = mins[axis];
+				int depthMax = maxs[axis];
+				if (absNormal[axis] > 0.0f) {
+					const float depth = (planeDist - normal[axisU] * (float)p[axisU] - normal[axisV] * (float)p[axisV]) /
+										normal[axis];
+					depthMin = core_max(depthMin, (int)glm::ceil(depth - depthSlack - 0.5f));
+					depthMax = core_min(depthMax, (int)glm::floor(depth + depthSlack + 0.5f));
+				}
+				for (p[axis] = depthMin; p[axis] <= depthMax; ++p[axis]) {
+					const glm::vec3 center(p);
+					if (!tri.intersectsBox(center, halfVoxel)) {
+						continue;
+					}
+					const core::RGBA color = tri.colorAtBarycentric(tri.closestPointBarycentric(center));
+					auto iter = posMap.find(p);
+					if (iter == posMap.end()) {
+						posMap.emplace(p, {area, color});
+					} else {
+						iter->value.add(area, color);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief The minimum amount of triangles that are rasterized by one task
+ */
+static constexpr size_t VoxelizeBatchSize = 4096;
+
+void MeshFormat::transformTris(const TriCollection &tris, PosMap &posMap) const {
+	Log::debug("%i triangles", (int)tris.size());
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	const size_t batchSize = core_max(VoxelizeBatchSize, tris.size() / (threadPool.size() * 4u) + 1u);
+	if (tris.size() <= batchSize) {
+		transformTrisRange(tris, 0u, tris.size(), posMap);
+		return;
+	}
+
+	// every batch is rasterized into its own map - they are merged in order afterwards to get the same result
+	// as the sequential rasterization
+	const size_t batches = (tris.size() + batchSize - 1u) / batchSize;
+	core::DynamicArray<PosMap> batchMaps;
+	batchMaps.resize(batches);
+	core::parallel_for(threadPool, 0, (int)batches, 1, [&](int first, int last) {
+		for (int batch = first; batch < last; ++batch) {
+			const size_t start = batch * batchSize;
+			const size_t end = core_min(start + batchSize, tris.size());
+			transformTrisRange(tris, start, end, batchMaps[batch]);
+		}
+	});
+
+	for (PosMap &batchMap : batchMaps) {
+		if (stopExecution()) {
+			return;
+		}
+		if (posMap.empty()) {
+			posMap = core::move(batchMap);
+			continue;
+		}
+		for (const auto &entry : batchMap) {
+			auto iter = posMap.find(entry->key);
+			if (iter == posMap.end()) {
+				posMap.emplace(entry->key, core::move(entry->value));
+				continue;
+			}
+			PosSampling &pos = iter->value;
+			for (const PosSamplingEntry &pe : entry->value.entries) {
+				pos.add(pe.area, pe.color);
+			}
+		}
+		batchMap = PosMap();
 	}
 }
 
@@ -214,21 +293,17 @@ int MeshFormat::voxelizeNode(const core::String &name, scenegraph::SceneGraph &s
 	if (axisAligned) {
 		const int maxVoxels = vdim.x * vdim.y * vdim.z;
 		Log::debug("max voxels: %i (%i:%i:%i)", maxVoxels, vdim.x, vdim.y, vdim.z);
-		PosMap posMap(maxVoxels);
+		// the map grows on demand - reserving maxVoxels entries would waste a lot of memory for sparse meshes
+		PosMap posMap(tris.size());
 		transformTrisAxisAligned(tris, posMap);
 		voxelizeTris(node, posMap, fillHollow);
 	} else {
-		TriCollection subdivided;
-		for (const Tri &tri : tris) {
-			subdivideTri(tri, subdivided);
-		}
-		if (subdivided.empty()) {
-			Log::warn("Empty volume - could not subdivide");
+		PosMap posMap(tris.size());
+		transformTris(tris, posMap);
+		if (posMap.empty()) {
+			Log::warn("Empty volume - no voxels were hit by the triangles");
 			return InvalidNodeId;
 		}
-
-		PosMap posMap((int)subdivided.size() * 3);
-		transformTris(subdivided, posMap);
 		voxelizeTris(node, posMap, fillHollow);
 	}
 
@@ -265,20 +340,49 @@ void MeshFormat::voxelizeTris(scenegraph::SceneGraphNode &node, const PosMap &po
 	voxel::RawVolumeWrapper wrapper(node.volume());
 	voxel::Palette palette;
 	const bool createPalette = core::Var::getSafe(cfg::VoxelCreatePalette)->boolVal();
-	if (!createPalette) {
+	if (createPalette) {
+		// similar colors are skipped when they are added to the palette - add the colors that are used by most
+		// voxels first to not depend on the iteration order of the map
+		core::FlatMap<uint32_t, int> colorCounts;
+		for (const auto &entry : posMap) {
+			const core::RGBA rgba = entry->value.avgColor(_flattenFactor);
+			auto iter = colorCounts.find(rgba.rgba);
+			if (iter == colorCounts.end()) {
+				colorCounts.put(rgba.rgba, 1);
+			} else {
+				++iter->value;
+			}
+		}
+		struct ColorCount {
+			core::RGBA rgba;
+			int count;
+		};
+		core::DynamicArray<ColorCount> colors;
+		colors.reserve(colorCounts.size());
+		for (const auto &entry : colorCounts) {
+			colors.push_back({core::RGBA(entry->key), entry->value});
+		}
+		core::sort(colors.begin(), colors.end(), [](const ColorCount &a, const ColorCount &b) {
+			if (a.count != b.count) {
+				return a.count > b.count;
+			}
+			return a.rgba.rgba < b.rgba.rgba;
+		});
+		for (const ColorCount &c : colors) {
+			palette.addColorToPalette(c.rgba, true);
+		}
+	} else {
 		palette = voxel::getPalette();
 	}
+	const voxel::PaletteKdTree paletteTree(palette);
 	for (const auto &entry : posMap) {
 		if (stopExecution()) {
 			return;
 		}
-		const PosSampling &pos = entry->second;
+		const PosSampling &pos = entry->value;
 		const core::RGBA rgba = pos.avgColor(_flattenFactor);
-		if (createPalette) {
-			palette.addColorToPalette(rgba, true);
-		}
-		const voxel::Voxel voxel = voxel::createVoxel(palette, palette.getClosestMatch(rgba));
-		wrapper.setVoxel(entry->first, voxel);
+		const voxel::Voxel voxel = voxel::createVoxel(palette, paletteTree.getClosestMatch(rgba));
+		wrapper.setVoxel(entry->key, voxel);
 	}
 	if (palette.colorCount() == 1) {
 		if (palette.colors()[0].a == 0) {
@@ -382,8 +486,59 @@ core::String MeshFormat::lookupTexture(const core::String &meshFilename, const c
 	return fullpath;
 }
 
+/**
+ * @brief The edge length of the regions that are extracted in parallel - big nodes are split into several
+ * extraction tasks to keep the thread pool busy
+ */
+static constexpr int ExtractChunkSize = 64;
+
+/**
+ * @brief Appends the vertices and indices of the given chunk to the target mesh
+ * @note The chunk must have been extracted with a translation that puts its vertices into the coordinate system
+ * of the target mesh. Only cubic meshes are supported - they don't have normals.
+ */
+static void mergeChunkMesh(voxel::ChunkMesh &target, const voxel::ChunkMesh &chunk) {
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh &source = chunk.mesh[i];
+		if (source.isEmpty()) {
+			continue;
+		}
+		voxel::Mesh &mesh = target.mesh[i];
+		const voxel::IndexType vertexOffset = (voxel::IndexType)mesh.getNoOfVertices();
+		mesh.getVertexVector().append(source.getRawVertexData(), source.getNoOfVertices());
+		voxel::IndexArray &indices = mesh.getIndexVector();
+		const size_t indexOffset = indices.size();
+		indices.append(source.getRawIndexData(), source.getNoOfIndices());
+		for (size_t n = indexOffset; n < indices.size(); ++n) {
+			indices[n] += vertexOffset;
+		}
+	}
+}
+
+bool MeshFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph,
+							const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream,
+							const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) {
+	core_assert_msg(supportsMeshStream(filename), "Formats without mesh stream support must implement saveMeshes()");
+	MeshStream meshStream(sceneGraph, filename, stream);
+	meshStream.scale = scale;
+	meshStream.quad = quad;
+	meshStream.withColor = withColor;
+	meshStream.withTexCoords = withTexCoords;
+	if (!beginMeshStream(meshStream)) {
+		return false;
+	}
+	for (const MeshExt &meshExt : meshes) {
+		if (!writeMeshChunk(meshStream, meshExt)) {
+			return false;
+		}
+		meshStream.nodeId = meshExt.nodeId;
+	}
+	return endMeshStream(meshStream);
+}
+
 bool MeshFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
 	const bool mergeQuads = core::Var::getSafe(cfg::VoxformatMergequads)->boolVal();
+	const bool greedyMerge = core::Var::getSafe(cfg::VoxformatGreedyMerge)->boolVal();
 	const bool reuseVertices = core::Var::getSafe(cfg::VoxformatReusevertices)->boolVal();
 	const bool ambientOcclusion = core::Var::getSafe(cfg::VoxformatAmbientocclusion)->boolVal();
 	const bool quads = core::Var::getSafe(cfg::VoxformatQuads)->boolVal();
@@ -393,37 +548,126 @@ bool MeshFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core
 	const bool marchingCubes = core::Var::getSafe(cfg::VoxformatMarchingCubes)->boolVal();
 
 	const glm::vec3 &scale = getScale();
-	const size_t models = sceneGraph.size();
-	core::ThreadPool& threadPool = app::App::getInstance()->threadPool();
-	Meshes meshes;
-	core::Map<int, int> meshIdxNodeMap;
-	core_trace_mutex(core::Lock, lock, "MeshFormat");
+
+	// every node is split into chunks - the chunk meshes of a node are extracted with a translation relative
+	// to the lower corner of the node region to be able to merge them into one mesh afterwards
+	struct ExtractTask {
+		const scenegraph::SceneGraphNode *node;
+		voxel::Region region;
+		glm::ivec3 translate;
+		voxel::ChunkMesh *mesh = nullptr;
+	};
+	core::DynamicArray<ExtractTask> tasks;
+	// the first task index of each node - the last entry marks the end of the tasks
+	core::DynamicArray<size_t> nodeTasks;
+	nodeTasks.reserve(sceneGraph.size() + 1);
 	for (const scenegraph::SceneGraphNode& node : sceneGraph) {
-		auto lambda = [&] () {
-			voxel::ChunkMesh *mesh = new voxel::ChunkMesh();
-			if (marchingCubes) {
-				voxel::Region region = node.region();
-				region.shrink(-1);
-				voxel::extractMarchingCubesMesh(node.volume(), node.palette(), region, mesh);
-			} else {
-				voxel::Region region = node.region();
-				region.shiftUpperCorner(1, 1, 1);
-				voxel::extractCubicMesh(node.volume(), region, mesh, glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
+		nodeTasks.push_back(tasks.size());
+		if (marchingCubes) {
+			voxel::Region region = node.region();
+			region.shrink(-1);
+			tasks.push_back({&node, region, glm::ivec3(0)});
+			continue;
+		}
+		// the extraction region is one voxel bigger than the node region to get the faces at the upper
+		// boundary - the last chunk on each axis includes this extra voxel
+		const glm::ivec3 &mins = node.region().getLowerCorner();
+		const glm::ivec3 maxs = node.region().getUpperCorner() + 1;
+		for (int z = mins.z; z < maxs.z; z += ExtractChunkSize) {
+			for (int y = mins.y; y < maxs.y; y += ExtractChunkSize) {
+				for (int x = mins.x; x < maxs.x; x += ExtractChunkSize) {
+					const glm::ivec3 lower(x, y, z);
+					glm::ivec3 upper = lower + (ExtractChunkSize - 1);
+					for (int i = 0; i < 3; ++i) {
+						if (upper[i] + 1 >= maxs[i]) {
+							upper[i] = maxs[i];
+						}
+					}
+					tasks.push_back({&node, voxel::Region(lower, upper), lower - mins});
+				}
 			}
-			core::ScopedLock scoped(lock);
-			meshes.emplace_back(mesh, node, applyTransform);
-		};
-		threadPool.enqueue(lambda);
-	}
-	for (;;) {
-		lock.lock();
-		const size_t size = meshes.size();
-		lock.unlock();
-		if (size < models) {
-			SDL_Delay(10);
+		}
+	}
+	nodeTasks.push_back(tasks.size());
+
+	auto extract = [&](size_t idx) {
+		ExtractTask &task = tasks[idx];
+		task.mesh = new voxel::ChunkMesh();
+		if (marchingCubes) {
+			voxel::extractMarchingCubesMesh(task.node->volume(), task.node->palette(), task.region, task.mesh);
 		} else {
-			break;
+			voxel::extractCubicMesh(task.node->volume(), task.region, task.mesh, task.translate, mergeQuads,
+									reuseVertices, ambientOcclusion, greedyMerge);
+		}
+	};
+	core::ThreadPool& threadPool = app::App::getInstance()->threadPool();
+	if (supportsMeshStream(filename)) {
+		MeshStream meshStream(sceneGraph, filename, stream);
+		meshStream.scale = scale;
+		meshStream.quad = marchingCubes ? false : quads;
+		meshStream.withColor = withColor;
+		meshStream.withTexCoords = withTexCoords;
+		if (!beginMeshStream(meshStream)) {
+			return false;
+		}
+		// only a window of chunks is extracted ahead of the writer - this bounds the memory that is needed for
+		// the meshes while the extraction of the next chunks overlaps with writing the current one
+		const bool async = !threadPool.isWorkerThread();
+		const size_t window = core_max((size_t)2, threadPool.size() * 2);
+		core::DynamicArray<std::future<void>> futures;
+		futures.resize(tasks.size());
+		size_t scheduled = 0;
+		int chunks = 0;
+		bool state = true;
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			for (; state && async && scheduled < tasks.size() && scheduled < i + window; ++scheduled) {
+				futures[scheduled] = threadPool.enqueue(extract, scheduled);
+			}
+			if (futures[i].valid()) {
+				futures[i].wait();
+			} else if (state) {
+				extract(i);
+			} else {
+				continue;
+			}
+			ExtractTask &task = tasks[i];
+			if (state && !task.mesh->isEmpty()) {
+				task.mesh->setOffset(task.region.getLowerCorner() - task.translate);
+				state = writeMeshChunk(meshStream, MeshExt(task.mesh, *task.node, applyTransform));
+				meshStream.nodeId = task.node->id();
+				++chunks;
+			}
+			delete task.mesh;
+			task.mesh = nullptr;
+		}
+		if (!state) {
+			return false;
+		}
+		if (chunks == 0) {
+			Log::warn("Empty scene can't get saved as mesh");
+			return false;
+		}
+		return endMeshStream(meshStream);
+	}
+	core::parallel_for(threadPool, 0, (int)tasks.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			extract(i);
+		}
+	});
+
+	Meshes meshes;
+	meshes.reserve(sceneGraph.size());
+	core::Map<int, int> meshIdxNodeMap;
+	for (size_t n = 0; n + 1 < nodeTasks.size(); ++n) {
+		const size_t first = nodeTasks[n];
+		const size_t last = nodeTasks[n + 1];
+		// the first chunk starts at the lower corner of the node region and thus defines the mesh offset
+		voxel::ChunkMesh *mesh = tasks[first].mesh;
+		for (size_t i = first + 1; i < last; ++i) {
+			mergeChunkMesh(*mesh, *tasks[i].mesh);
+			delete tasks[i].mesh;
 		}
+		meshes.emplace_back(mesh, *tasks[first].node, applyTransform);
 	}
 	Meshes nonEmptyMeshes;
 	nonEmptyMeshes.reserve(meshes.size());
@@ -7,6 +7,7 @@
 #include "Format.h"
 #include "private/Tri.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
 #include "core/collection/Map.h"
 #include "voxel/ChunkMesh.h"
 
@@ -24,10 +25,6 @@ public:
 	static constexpr const uint8_t FillColorIndex = 2;
 	using TriCollection = core::DynamicArray<Tri, 512>;
 
-	/**
-	 * Subdivide until we brought the triangles down to the size of 1 or smaller
-	 */
-	static void subdivideTri(const Tri &tri, TriCollection &tinyTris);
 	static bool calculateAABB(const TriCollection &tris, glm::vec3 &mins, glm::vec3 &maxs);
 	static bool isVoxelMesh(const TriCollection &tris);
 protected:
@@ -43,10 +40,75 @@ protected:
 		int nodeId = -1;
 	};
 	using Meshes = core::DynamicArray<MeshExt>;
+	/**
+	 * @brief Writes the meshes of the nodes. The default implementation feeds the meshes through the mesh stream
+	 * methods - formats that don't support streaming have to override this.
+	 * @sa supportsMeshStream()
+	 */
 	virtual bool saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
 							const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream,
 							const glm::vec3 &scale = glm::vec3(1.0f), bool quad = false, bool withColor = true,
-							bool withTexCoords = true) = 0;
+							bool withTexCoords = true);
+
+	/**
+	 * @brief The state of a chunk by chunk mesh export
+	 *
+	 * The chunks of a node are handed over one after another - the vertices are in the coordinate system of the
+	 * node like for the merged meshes in saveMeshes(). The mesh offset is the one of the merged mesh, too.
+	 */
+	struct MeshStream {
+		MeshStream(const scenegraph::SceneGraph &_sceneGraph, const core::String &_filename,
+				   io::SeekableWriteStream &_stream)
+			: sceneGraph(_sceneGraph), filename(_filename), stream(_stream) {
+		}
+		const scenegraph::SceneGraph &sceneGraph;
+		const core::String &filename;
+		io::SeekableWriteStream &stream;
+		glm::vec3 scale{1.0f};
+		bool quad = false;
+		bool withColor = true;
+		bool withTexCoords = true;
+		/**
+		 * the amount of vertices that were written so far - the base offset for the indices of the next chunk
+		 */
+		int vertexOffset = 0;
+		/**
+		 * the amount of faces that were written so far
+		 */
+		int faces = 0;
+		/**
+		 * the node of the last chunk that was written or @c -1
+		 */
+		int nodeId = -1;
+	};
+
+	/**
+	 * @brief Formats that return @c true here get the meshes chunk by chunk in saveGroups(). Only a few chunks are
+	 * extracted ahead of the writer and every chunk is freed once it is written - the meshes of the whole scene are
+	 * never resident at the same time.
+	 * @param filename The target file - some formats only support streaming for some of their extensions
+	 * @sa beginMeshStream()
+	 * @sa writeMeshChunk()
+	 * @sa endMeshStream()
+	 */
+	virtual bool supportsMeshStream(const core::String &filename) const {
+		return false;
+	}
+	virtual bool beginMeshStream(MeshStream &meshStream) {
+		return false;
+	}
+	/**
+	 * @note Empty chunks are not handed over
+	 */
+	virtual bool writeMeshChunk(MeshStream &meshStream, const MeshExt &chunk) {
+		return false;
+	}
+	/**
+	 * @brief Called after the last chunk - patch the header counts or write the data that depends on all chunks here
+	 */
+	virtual bool endMeshStream(MeshStream &meshStream) {
+		return false;
+	}
 
 	static MeshExt* getParent(const scenegraph::SceneGraph &sceneGraph, Meshes &meshes, int nodeId);
 	static glm::vec3 getScale();
@@ -74,17 +136,34 @@ protected:
 	};
 
 	struct PosSampling {
+		/**
+		 * The amount of samples that are taken into account for the color of a voxel
+		 */
+		static constexpr size_t MaxEntries = 4;
 		core::DynamicArray<PosSamplingEntry> entries;
 		inline PosSampling(float area, core::RGBA color) {
 			entries.emplace_back(area, color);
 		}
+		inline void add(float area, core::RGBA color) {
+			if (entries.size() < MaxEntries) {
+				entries.emplace_back(area, color);
+			}
+		}
 		core::RGBA avgColor(uint8_t flattenFactor) const;
 	};
 
-	typedef core::Map<glm::ivec3, PosSampling, 64, glm::hash<glm::ivec3>> PosMap;
+	typedef core::FlatMap<glm::ivec3, PosSampling, glm::hash<glm::ivec3>> PosMap;
 
 	void voxelizeTris(scenegraph::SceneGraphNode &node, const PosMap &posMap, bool hillHollow) const;
-	void transformTris(const TriCollection &subdivided, PosMap &posMap) const;
+	/**
+	 * @brief Rasterizes the triangles in the range [start, end) into the voxels they intersect
+	 */
+	static void transformTrisRange(const TriCollection &tris, size_t start, size_t end, PosMap &posMap);
+	/**
+	 * @brief Conservative voxelization of arbitrary triangles - every voxel that is touched by a triangle is set.
+	 * Big triangle collections are split into batches that are rasterized in parallel.
+	 */
+	void transformTris(const TriCollection &tris, PosMap &posMap) const;
 	void transformTrisAxisAligned(const TriCollection &tris, PosMap &posMap) const;
 
 public:
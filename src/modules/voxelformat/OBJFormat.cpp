@@ -54,173 +54,183 @@ bool OBJFormat::writeMtlFile(io::SeekableWriteStream &stream, const core::String
 	return true;
 }
 
-bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
-						   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
-						   bool quad, bool withColor, bool withTexCoords) {
+bool OBJFormat::beginMeshStream(MeshStream &meshStream) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	_texcoordOffset = 0;
+	_paletteNodes.clear();
+	_mtlname = core::string::replaceExtension(meshStream.filename, "mtl");
+	Log::debug("Use mtl file: %s", _mtlname.c_str());
 	stream.writeStringFormat(false, "# version " PROJECT_VERSION " github.com/mgerhardy/vengi\n");
 	wrapBool(stream.writeStringFormat(false, "\n"))
 	wrapBool(stream.writeStringFormat(false, "g Model\n"))
+	return true;
+}
 
-	Log::debug("Exporting %i layers", (int)meshes.size());
-
-	const core::String &mtlname = core::string::replaceExtension(filename, "mtl");
-	Log::debug("Use mtl file: %s", mtlname.c_str());
+bool OBJFormat::writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	const bool withColor = meshStream.withColor;
+	const bool withTexCoords = meshStream.withTexCoords;
+	const scenegraph::SceneGraphNode &graphNode = meshStream.sceneGraph.node(meshExt.nodeId);
+	scenegraph::KeyFrameIndex keyFrameIdx = 0;
+	const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
+	const voxel::Palette &palette = graphNode.palette();
+	const core::String hashId = core::String::format("%" PRIu64, palette.hash());
 
-	const io::FilePtr &file = io::filesystem()->open(mtlname, io::FileMode::SysWrite);
-	if (!file->validHandle()) {
-		Log::error("Failed to create mtl file at %s", file->name().c_str());
-		return false;
+	// the chunks of a node are written one after another into the same object
+	if (meshStream.nodeId != meshExt.nodeId) {
+		Log::debug("Exporting layer %s", meshExt.name.c_str());
+		const char *objectName = meshExt.name.c_str();
+		if (objectName[0] == '\0') {
+			objectName = "Noname";
+		}
+		stream.writeStringFormat(false, "o %s\n", objectName);
+		stream.writeStringFormat(false, "mtllib %s\n", core::string::extractFilenameWithExtension(_mtlname).c_str());
+		if (!stream.writeStringFormat(false, "usemtl %s\n", hashId.c_str())) {
+			Log::error("Failed to write obj usemtl %s\n", hashId.c_str());
+			return false;
+		}
+		if (!_paletteNodes.hasKey(palette.hash())) {
+			_paletteNodes.put(palette.hash(), meshExt.nodeId);
+		}
 	}
-	io::FileStream matlstream(file);
-	wrapBool(matlstream.writeString("# version " PROJECT_VERSION " github.com/mgerhardy/vengi\n", false))
-	wrapBool(matlstream.writeString("\n", false))
-
-	core::Map<uint64_t, int> paletteMaterialIndices((int)sceneGraph.size());
 
-	int idxOffset = 0;
-	int texcoordOffset = 0;
-	for (const auto &meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
-			if (mesh->isEmpty()) {
-				continue;
-			}
-			Log::debug("Exporting layer %s", meshExt.name.c_str());
-			const int nv = (int)mesh->getNoOfVertices();
-			const int ni = (int)mesh->getNoOfIndices();
-			if (ni % 3 != 0) {
-				Log::error("Unexpected indices amount");
-				return false;
-			}
-			const scenegraph::SceneGraphNode &graphNode = sceneGraph.node(meshExt.nodeId);
-			scenegraph::KeyFrameIndex keyFrameIdx = 0;
-			const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
-			const voxel::Palette &palette = graphNode.palette();
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
+		if (mesh->isEmpty()) {
+			continue;
+		}
+		const int nv = (int)mesh->getNoOfVertices();
+		const int ni = (int)mesh->getNoOfIndices();
+		if (ni % 3 != 0) {
+			Log::error("Unexpected indices amount");
+			return false;
+		}
+		const voxel::VertexArray &vertices = mesh->getVertexVector();
+		const voxel::IndexArray &indices = mesh->getIndexVector();
+		const voxel::NormalArray &normals = mesh->getNormalVector();
+		const bool withNormals = !normals.empty();
+		const int idxOffset = meshStream.vertexOffset;
+		const int texcoordOffset = _texcoordOffset;
 
-			const core::String hashId = core::String::format("%" PRIu64, palette.hash());
+		for (int i = 0; i < nv; ++i) {
+			const voxel::VoxelVertex &v = vertices[i];
 
-			const voxel::VertexArray &vertices = mesh->getVertexVector();
-			const voxel::IndexArray &indices = mesh->getIndexVector();
-			const voxel::NormalArray &normals = mesh->getNormalVector();
-			const bool withNormals = !normals.empty();
-			const char *objectName = meshExt.name.c_str();
-			if (objectName[0] == '\0') {
-				objectName = "Noname";
+			glm::vec3 pos;
+			if (meshExt.applyTransform) {
+				pos = transform.apply(v.position, meshExt.pivot * meshExt.size);
+			} else {
+				pos = v.position;
 			}
-			stream.writeStringFormat(false, "o %s\n", objectName);
-			stream.writeStringFormat(false, "mtllib %s\n", core::string::extractFilenameWithExtension(mtlname).c_str());
-			if (!stream.writeStringFormat(false, "usemtl %s\n", hashId.c_str())) {
-				Log::error("Failed to write obj usemtl %s\n", hashId.c_str());
-				return false;
+			pos *= meshStream.scale;
+			stream.writeStringFormat(false, "v %.04f %.04f %.04f", pos.x, pos.y, pos.z);
+			if (withColor) {
+				const glm::vec4& color = core::Color::fromRGBA(palette.color(v.colorIndex));
+				stream.writeStringFormat(false, " %.03f %.03f %.03f", color.r, color.g, color.b);
 			}
-
+			wrapBool(stream.writeStringFormat(false, "\n"))
+		}
+		if (withNormals) {
 			for (int i = 0; i < nv; ++i) {
-				const voxel::VoxelVertex &v = vertices[i];
-
-				glm::vec3 pos;
-				if (meshExt.applyTransform) {
-					pos = transform.apply(v.position, meshExt.pivot * meshExt.size);
-				} else {
-					pos = v.position;
-				}
-				pos *= scale;
-				stream.writeStringFormat(false, "v %.04f %.04f %.04f", pos.x, pos.y, pos.z);
-				if (withColor) {
-					const glm::vec4& color = core::Color::fromRGBA(palette.color(v.colorIndex));
-					stream.writeStringFormat(false, " %.03f %.03f %.03f", color.r, color.g, color.b);
-				}
-				wrapBool(stream.writeStringFormat(false, "\n"))
+				const glm::vec3 &norm = normals[i];
+				stream.writeStringFormat(false, "vn %.04f %.04f %.04f\n", norm.x, norm.y, norm.z);
 			}
-			if (withNormals) {
-				for (int i = 0; i < nv; ++i) {
-					const glm::vec3 &norm = normals[i];
-					stream.writeStringFormat(false, "vn %.04f %.04f %.04f\n", norm.x, norm.y, norm.z);
+		}
+		if (meshStream.quad) {
+			if (withTexCoords) {
+				for (int i = 0; i < ni; i += 6) {
+					const voxel::VoxelVertex &v = vertices[indices[i]];
+					const glm::vec2 &uv = paletteUV(v.colorIndex);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
 				}
 			}
 
-			if (quad) {
+			int uvi = texcoordOffset;
+			for (int i = 0; i < ni - 5; i += 6, uvi += 4) {
+				const uint32_t one = idxOffset + indices[i + 0] + 1;
+				const uint32_t two = idxOffset + indices[i + 1] + 1;
+				const uint32_t three = idxOffset + indices[i + 2] + 1;
+				const uint32_t four = idxOffset + indices[i + 5] + 1;
 				if (withTexCoords) {
-					for (int i = 0; i < ni; i += 6) {
-						const voxel::VoxelVertex &v = vertices[indices[i]];
-						const glm::vec2 &uv = paletteUV(v.colorIndex);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+					if (withNormals) {
+						stream.writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one, uvi + 1,(int)one,  (int)two, uvi + 2,
+												(int)two, (int)three, uvi + 3, (int)three, (int)four, uvi + 4, (int)four);
+					} else {
+						stream.writeStringFormat(false, "f %i/%i %i/%i %i/%i %i/%i\n", (int)one, uvi + 1, (int)two, uvi + 2,
+												(int)three, uvi + 3, (int)four, uvi + 4);
 					}
-				}
-
-				int uvi = texcoordOffset;
-				for (int i = 0; i < ni - 5; i += 6, uvi += 4) {
-					const uint32_t one = idxOffset + indices[i + 0] + 1;
-					const uint32_t two = idxOffset + indices[i + 1] + 1;
-					const uint32_t three = idxOffset + indices[i + 2] + 1;
-					const uint32_t four = idxOffset + indices[i + 5] + 1;
-					if (withTexCoords) {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one, uvi + 1,(int)one,  (int)two, uvi + 2,
-													(int)two, (int)three, uvi + 3, (int)three, (int)four, uvi + 4, (int)four);
-						} else {
-							stream.writeStringFormat(false, "f %i/%i %i/%i %i/%i %i/%i\n", (int)one, uvi + 1, (int)two, uvi + 2,
-													(int)three, uvi + 3, (int)four, uvi + 4);
-						}
+				} else {
+					if (withNormals) {
+						stream.writeStringFormat(false, "f %i//%i %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three, (int)four, (int)one, (int)two, (int)three, (int)four);
 					} else {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i//%i %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three, (int)four, (int)one, (int)two, (int)three, (int)four);
-						} else {
-							stream.writeStringFormat(false, "f %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
-						}
+						stream.writeStringFormat(false, "f %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
 					}
 				}
-				texcoordOffset += ni / 6 * 4;
-			} else {
-				if (withTexCoords) {
-					for (int i = 0; i < ni; i += 3) {
-						const voxel::VoxelVertex &v = vertices[indices[i]];
-						const glm::vec2 &uv = paletteUV(v.colorIndex);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-					}
+			}
+			_texcoordOffset += ni / 6 * 4;
+		} else {
+			if (withTexCoords) {
+				for (int i = 0; i < ni; i += 3) {
+					const voxel::VoxelVertex &v = vertices[indices[i]];
+					const glm::vec2 &uv = paletteUV(v.colorIndex);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+					stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
 				}
+			}
 
-				for (int i = 0; i < ni; i += 3) {
-					const uint32_t one = idxOffset + indices[i + 0] + 1;
-					const uint32_t two = idxOffset + indices[i + 1] + 1;
-					const uint32_t three = idxOffset + indices[i + 2] + 1;
-					if (withTexCoords) {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one, texcoordOffset + i + 1, (int)one, (int)two,
-													texcoordOffset + i + 2, (int)two, (int)three, texcoordOffset + i + 3, (int)three);
-						} else {
-							stream.writeStringFormat(false, "f %i/%i %i/%i %i/%i\n", (int)one, texcoordOffset + i + 1, (int)two,
-													texcoordOffset + i + 2, (int)three, texcoordOffset + i + 3);
-						}
+			for (int i = 0; i < ni; i += 3) {
+				const uint32_t one = idxOffset + indices[i + 0] + 1;
+				const uint32_t two = idxOffset + indices[i + 1] + 1;
+				const uint32_t three = idxOffset + indices[i + 2] + 1;
+				if (withTexCoords) {
+					if (withNormals) {
+						stream.writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one, texcoordOffset + i + 1, (int)one, (int)two,
+												texcoordOffset + i + 2, (int)two, (int)three, texcoordOffset + i + 3, (int)three);
+					} else {
+						stream.writeStringFormat(false, "f %i/%i %i/%i %i/%i\n", (int)one, texcoordOffset + i + 1, (int)two,
+												texcoordOffset + i + 2, (int)three, texcoordOffset + i + 3);
+					}
+				} else {
+					if (withNormals) {
+						stream.writeStringFormat(false, "f %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three, (int)one, (int)two, (int)three);
 					} else {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three, (int)one, (int)two, (int)three);
-						} else {
-							stream.writeStringFormat(false, "f %i %i %i\n", (int)one, (int)two, (int)three);
-						}
+						stream.writeStringFormat(false, "f %i %i %i\n", (int)one, (int)two, (int)three);
 					}
 				}
-				texcoordOffset += ni;
 			}
-			idxOffset += nv;
+			_texcoordOffset += ni;
+		}
+		meshStream.vertexOffset += nv;
+		meshStream.faces += meshStream.quad ? ni / 6 : ni / 3;
+	}
+	return true;
+}
 
-			if (paletteMaterialIndices.find(palette.hash()) == paletteMaterialIndices.end()) {
-				core::String palettename = core::string::stripExtension(filename);
-				palettename.append(hashId);
-				palettename.append(".png");
-				paletteMaterialIndices.put(palette.hash(), 1);
-				const core::String &mapKd = core::string::extractFilenameWithExtension(palettename);
-				if (!writeMtlFile(matlstream, hashId, mapKd)) {
-					return false;
-				}
-				if (!palette.save(palettename.c_str())) {
-					return false;
-				}
-			}
+bool OBJFormat::endMeshStream(MeshStream &meshStream) {
+	const io::FilePtr &file = io::filesystem()->open(_mtlname, io::FileMode::SysWrite);
+	if (!file->validHandle()) {
+		Log::error("Failed to create mtl file at %s", file->name().c_str());
+		return false;
+	}
+	io::FileStream matlstream(file);
+	wrapBool(matlstream.writeString("# version " PROJECT_VERSION " github.com/mgerhardy/vengi\n", false))
+	wrapBool(matlstream.writeString("\n", false))
+
+	for (const auto &entry : _paletteNodes) {
+		const voxel::Palette &palette = meshStream.sceneGraph.node(entry->second).palette();
+		const core::String hashId = core::String::format("%" PRIu64, palette.hash());
+		core::String palettename = core::string::stripExtension(meshStream.filename);
+		palettename.append(hashId);
+		palettename.append(".png");
+		const core::String &mapKd = core::string::extractFilenameWithExtension(palettename);
+		if (!writeMtlFile(matlstream, hashId, mapKd)) {
+			return false;
+		}
+		if (!palette.save(palettename.c_str())) {
+			return false;
 		}
 	}
 	return true;
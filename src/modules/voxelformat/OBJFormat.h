@@ -25,7 +25,23 @@ class OBJFormat : public MeshFormat {
 private:
 	bool writeMtlFile(io::SeekableWriteStream &stream, const core::String &mtlId, const core::String &mapKd) const;
 	bool voxelizeGroups(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx) override;
-public:
-	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes& meshes, const core::String &filename, io::SeekableWriteStream& stream, const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) override;
+
+	/**
+	 * the amount of texture coordinates that were written so far by the mesh stream
+	 */
+	int _texcoordOffset = 0;
+	/**
+	 * palette hash to the first node that uses the palette - the materials are written in endMeshStream()
+	 */
+	core::Map<uint64_t, int> _paletteNodes;
+	core::String _mtlname;
+
+protected:
+	bool supportsMeshStream(const core::String &) const override {
+		return true;
+	}
+	bool beginMeshStream(MeshStream &meshStream) override;
+	bool writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) override;
+	bool endMeshStream(MeshStream &meshStream) override;
 };
 }
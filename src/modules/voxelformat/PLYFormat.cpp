@@ -3,6 +3,7 @@
  */
 
 #include "PLYFormat.h"
+#include "app/App.h"
 #include "core/Color.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
@@ -10,6 +11,7 @@
 #include "engine-config.h"
 #include "io/File.h"
 #include "io/FileStream.h"
+#include "io/Filesystem.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Mesh.h"
 #include "voxel/VoxelVertex.h"
@@ -18,125 +20,196 @@
 
 namespace voxelformat {
 
-bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
-						   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
-						   bool quad, bool withColor, bool withTexCoords) {
-	int elements = 0;
-	int indices = 0;
-	for (const auto& meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
-			if (mesh.isEmpty()) {
-				continue;
-			}
-			elements += (int)mesh.getNoOfVertices();
-			indices += (int)mesh.getNoOfIndices();
-		}
+/**
+ * The counts are written with a fixed width to be able to patch them once all chunks are written
+ */
+#define PLY_COUNT_FORMAT "%10i"
+
+/**
+ * The size of the face lines that are kept in memory before they are appended to the spill file
+ */
+static constexpr int64_t FaceSpillSize = 4 * 1024 * 1024;
+
+PLYFormat::~PLYFormat() {
+	closeFaceFile();
+}
+
+void PLYFormat::closeFaceFile() {
+	if (_faceFile) {
+		_faceFile->close();
+		_faceFile = io::FilePtr();
+		io::filesystem()->removeFile(_faceFilename);
 	}
+	_faceFilename = "";
+	_faces.reset();
+}
 
-	if (elements == 0 || indices == 0) {
+bool PLYFormat::spillFaces() {
+	if (_faces.size() < FaceSpillSize || _faceFilename.empty()) {
+		return true;
+	}
+	if (!_faceFile) {
+		_faceFile = io::filesystem()->open(_faceFilename, io::FileMode::SysWrite);
+		if (!_faceFile->validHandle()) {
+			Log::warn("Failed to create %s for the ply faces - keep them in memory", _faceFilename.c_str());
+			_faceFile = io::FilePtr();
+			_faceFilename = "";
+			return true;
+		}
+	}
+	io::FileStream faceStream(_faceFile);
+	if (faceStream.write(_faces.getBuffer(), _faces.size()) == -1) {
 		return false;
 	}
+	_faces.reset();
+	return true;
+}
+
+bool PLYFormat::copyFaces(io::SeekableWriteStream &stream) {
+	if (_faceFile) {
+		_faceFile->close();
+		if (!_faceFile->open(io::FileMode::SysRead)) {
+			Log::error("Failed to read the ply faces from %s", _faceFilename.c_str());
+			return false;
+		}
+		io::FileStream faceStream(_faceFile);
+		uint8_t buf[64 * 1024];
+		for (;;) {
+			const int n = faceStream.read(buf, sizeof(buf));
+			if (n <= 0) {
+				break;
+			}
+			if (stream.write(buf, n) == -1) {
+				return false;
+			}
+		}
+	}
+	return stream.write(_faces.getBuffer(), _faces.size()) != -1;
+}
 
+bool PLYFormat::beginMeshStream(MeshStream &meshStream) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	closeFaceFile();
+	// the file is only created if the faces don't fit into the buffer
+	_faceFilename = meshStream.filename + ".faces";
 	const core::String paletteName = core::string::replaceExtension(voxel::getPalette().name(), "png");
 	stream.writeStringFormat(false, "ply\nformat ascii 1.0\n");
 	stream.writeStringFormat(false, "comment version " PROJECT_VERSION " github.com/mgerhardy/vengi\n");
 	stream.writeStringFormat(false, "comment TextureFile %s\n", paletteName.c_str());
 
-	stream.writeStringFormat(false, "element vertex %i\n", elements);
+	stream.writeStringFormat(false, "element vertex ");
+	_vertexCountPos = stream.pos();
+	stream.writeStringFormat(false, PLY_COUNT_FORMAT "\n", 0);
 	stream.writeStringFormat(false, "property float x\n");
 	stream.writeStringFormat(false, "property float z\n");
 	stream.writeStringFormat(false, "property float y\n");
-	if (withTexCoords) {
+	if (meshStream.withTexCoords) {
 		stream.writeStringFormat(false, "property float s\n");
 		stream.writeStringFormat(false, "property float t\n");
 	}
-	if (withColor) {
+	if (meshStream.withColor) {
 		stream.writeStringFormat(false, "property uchar red\n");
 		stream.writeStringFormat(false, "property uchar green\n");
 		stream.writeStringFormat(false, "property uchar blue\n");
 	}
 
-	int faces;
-	if (quad) {
-		faces = indices / 6;
-	} else {
-		faces = indices / 3;
-	}
-
-	stream.writeStringFormat(false, "element face %i\n", faces);
+	stream.writeStringFormat(false, "element face ");
+	_faceCountPos = stream.pos();
+	stream.writeStringFormat(false, PLY_COUNT_FORMAT "\n", 0);
 	stream.writeStringFormat(false, "property list uchar uint vertex_indices\n");
-	stream.writeStringFormat(false, "end_header\n");
+	return stream.writeStringFormat(false, "end_header\n");
+}
+
+bool PLYFormat::writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
+		if (mesh.isEmpty()) {
+			continue;
+		}
+		const int ni = (int)mesh.getNoOfIndices();
+		const int nv = (int)mesh.getNoOfVertices();
+		if (ni % 3 != 0) {
+			Log::error("Unexpected indices amount");
+			return false;
+		}
+		const voxel::VoxelVertex* vertices = mesh.getRawVertexData();
+		const scenegraph::SceneGraphNode &graphNode = meshStream.sceneGraph.node(meshExt.nodeId);
+		scenegraph::KeyFrameIndex keyFrameIdx = 0;
+		const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
+		const voxel::Palette &palette = graphNode.palette();
 
-	for (const auto& meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
-			if (mesh.isEmpty()) {
-				continue;
+		for (int i = 0; i < nv; ++i) {
+			const voxel::VoxelVertex& v = vertices[i];
+			glm::vec3 pos;
+			if (meshExt.applyTransform) {
+				pos = transform.apply(v.position, meshExt.pivot * meshExt.size);
+			} else {
+				pos = v.position;
+			}
+			pos *= meshStream.scale;
+			stream.writeStringFormat(false, "%f %f %f", pos.x, pos.y, pos.z);
+			if (meshStream.withTexCoords) {
+				const glm::vec2 &uv = paletteUV(v.colorIndex);
+				stream.writeStringFormat(false, " %f %f", uv.x, uv.y);
 			}
-			const int nv = (int)mesh.getNoOfVertices();
-			const voxel::VoxelVertex* vertices = mesh.getRawVertexData();
-			const scenegraph::SceneGraphNode &graphNode = sceneGraph.node(meshExt.nodeId);
-			scenegraph::KeyFrameIndex keyFrameIdx = 0;
-			const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
-			const voxel::Palette &palette = graphNode.palette();
-
-			for (int i = 0; i < nv; ++i) {
-				const voxel::VoxelVertex& v = vertices[i];
-				glm::vec3 pos;
-				if (meshExt.applyTransform) {
-					pos = transform.apply(v.position, meshExt.pivot * meshExt.size);
-				} else {
-					pos = v.position;
-				}
-				pos *= scale;
-				stream.writeStringFormat(false, "%f %f %f", pos.x, pos.y, pos.z);
-				if (withTexCoords) {
-					const glm::vec2 &uv = paletteUV(v.colorIndex);
-					stream.writeStringFormat(false, " %f %f", uv.x, uv.y);
-				}
-				if (withColor) {
-					const core::RGBA color = palette.color(v.colorIndex);
-					stream.writeStringFormat(false, " %u %u %u", color.r, color.g, color.b);
-				}
-				stream.writeStringFormat(false, "\n");
+			if (meshStream.withColor) {
+				const core::RGBA color = palette.color(v.colorIndex);
+				stream.writeStringFormat(false, " %u %u %u", color.r, color.g, color.b);
 			}
+			stream.writeStringFormat(false, "\n");
 		}
-	}
 
-	int idxOffset = 0;
-	for (const auto& meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
-			if (mesh.isEmpty()) {
-				continue;
-			}
-			const int ni = (int)mesh.getNoOfIndices();
-			const int nv = (int)mesh.getNoOfVertices();
-			if (ni % 3 != 0) {
-				Log::error("Unexpected indices amount");
-				return false;
+		// the faces follow all the vertices in the file - they are collected until the last chunk was written
+		const int idxOffset = meshStream.vertexOffset;
+		const voxel::IndexType* indices = mesh.getRawIndexData();
+		if (meshStream.quad) {
+			for (int i = 0; i < ni; i += 6) {
+				const uint32_t one   = idxOffset + indices[i + 0];
+				const uint32_t two   = idxOffset + indices[i + 1];
+				const uint32_t three = idxOffset + indices[i + 2];
+				const uint32_t four  = idxOffset + indices[i + 5];
+				_faces.writeStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
 			}
-			const voxel::IndexType* indices = mesh.getRawIndexData();
-			if (quad) {
-				for (int i = 0; i < ni; i += 6) {
-					const uint32_t one   = idxOffset + indices[i + 0];
-					const uint32_t two   = idxOffset + indices[i + 1];
-					const uint32_t three = idxOffset + indices[i + 2];
-					const uint32_t four  = idxOffset + indices[i + 5];
-					stream.writeStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
-				}
-			} else {
-				for (int i = 0; i < ni; i += 3) {
-					const uint32_t one   = idxOffset + indices[i + 0];
-					const uint32_t two   = idxOffset + indices[i + 1];
-					const uint32_t three = idxOffset + indices[i + 2];
-					stream.writeStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
-				}
+			meshStream.faces += ni / 6;
+		} else {
+			for (int i = 0; i < ni; i += 3) {
+				const uint32_t one   = idxOffset + indices[i + 0];
+				const uint32_t two   = idxOffset + indices[i + 1];
+				const uint32_t three = idxOffset + indices[i + 2];
+				_faces.writeStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
 			}
-			idxOffset += nv;
+			meshStream.faces += ni / 3;
+		}
+		if (!spillFaces()) {
+			Log::error("Failed to write the ply faces");
+			return false;
 		}
+		meshStream.vertexOffset += nv;
 	}
-	return sceneGraph.firstPalette().save(paletteName.c_str());
+	return true;
 }
+
+bool PLYFormat::endMeshStream(MeshStream &meshStream) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	if (!copyFaces(stream)) {
+		Log::error("Failed to write the ply faces");
+		closeFaceFile();
+		return false;
+	}
+	closeFaceFile();
+	const int64_t end = stream.pos();
+	stream.seek(_vertexCountPos);
+	stream.writeStringFormat(false, PLY_COUNT_FORMAT, meshStream.vertexOffset);
+	stream.seek(_faceCountPos);
+	stream.writeStringFormat(false, PLY_COUNT_FORMAT, meshStream.faces);
+	if (stream.seek(end) == -1) {
+		return false;
+	}
+	const core::String paletteName = core::string::replaceExtension(voxel::getPalette().name(), "png");
+	return meshStream.sceneGraph.firstPalette().save(paletteName.c_str());
+}
+
+#undef PLY_COUNT_FORMAT
+
 }
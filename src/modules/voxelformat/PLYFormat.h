@@ -5,6 +5,8 @@
 #pragma once
 
 #include "MeshFormat.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/File.h"
 
 namespace voxelformat {
 /**
@@ -13,9 +15,31 @@ namespace voxelformat {
  * @ingroup Formats
  */
 class PLYFormat : public MeshFormat {
+private:
+	/**
+	 * The faces of the chunks that were already written - they can only be added after all vertices. Once the
+	 * buffer gets too big, it is spilled into a file next to the target file to not keep the faces of the whole
+	 * scene in memory.
+	 */
+	io::BufferedReadWriteStream _faces;
+	io::FilePtr _faceFile;
+	core::String _faceFilename;
+	int64_t _vertexCountPos = 0;
+	int64_t _faceCountPos = 0;
+
+protected:
+	bool supportsMeshStream(const core::String &) const override {
+		return true;
+	}
+	bool beginMeshStream(MeshStream &meshStream) override;
+	bool writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) override;
+	bool endMeshStream(MeshStream &meshStream) override;
+
+	bool spillFaces();
+	bool copyFaces(io::SeekableWriteStream &stream);
+	void closeFaceFile();
+
 public:
-	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &meshes, const core::String &filename,
-					io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
-					bool withTexCoords) override;
+	~PLYFormat() override;
 };
 }
@@ -15,6 +15,7 @@
 #include "image/Image.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/BufferedZipReadStream.h"
+#include "io/FastReader.h"
 #include "io/Stream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
@@ -384,34 +385,50 @@ bool QBCLFormat::readMatrix(const core::String &filename, io::SeekableReadStream
 		return false;
 	}
 
-	io::ZipReadStream zipStream(stream, (int)compressedDataSize);
+	// the size of the rle encoded voxel data is unknown - inflate all of it before it is decoded
+	io::BufferedReadWriteStream voxelData((int64_t)compressedDataSize * 4);
+	{
+		io::ZipReadStream zipStream(stream, (int)compressedDataSize);
+		uint8_t buf[16 * 1024];
+		for (;;) {
+			const int n = zipStream.readSome(buf, sizeof(buf));
+			if (n < 0) {
+				Log::error("Failed to inflate the voxel data");
+				return false;
+			}
+			if (n == 0) {
+				break;
+			}
+			voxelData.write(buf, n);
+		}
+	}
+	voxelData.seek(0);
+	io::FastReader reader(voxelData);
 	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
 	uint32_t index = 0;
 
 	voxel::PaletteLookup palLookup(palette);
 
-	while (!zipStream.eos()) {
+	while (!reader.eos()) {
 		int y = 0;
 		uint16_t rleEntries;
-		wrap(zipStream.readUInt16(rleEntries))
+		wrap(reader.readUInt16(rleEntries))
 		for (int i = 0; i < (int)rleEntries; i++) {
-			uint8_t red;
-			uint8_t green;
-			uint8_t blue;
-			uint8_t mask;
-
-			wrap(zipStream.readUInt8(red))
-			wrap(zipStream.readUInt8(green))
-			wrap(zipStream.readUInt8(blue))
-			wrap(zipStream.readUInt8(mask))
+			const uint8_t *rgbm = reader.readDirect(4);
+			wrapBool(rgbm != nullptr)
+			uint8_t red = rgbm[0];
+			uint8_t green = rgbm[1];
+			uint8_t blue = rgbm[2];
+			const uint8_t mask = rgbm[3];
 
 			if (mask == qbcl::RLE_FLAG) {
-				uint8_t rleLength = red;
-				uint8_t alpha;
-				wrap(zipStream.readUInt8(red))
-				wrap(zipStream.readUInt8(green))
-				wrap(zipStream.readUInt8(blue))
-				wrap(zipStream.readUInt8(alpha))
+				const uint8_t rleLength = red;
+				const uint8_t *rgba = reader.readDirect(4);
+				wrapBool(rgba != nullptr)
+				red = rgba[0];
+				green = rgba[1];
+				blue = rgba[2];
+				const uint8_t alpha = rgba[3];
 
 				if (alpha == 0) {
 					y += rleLength;
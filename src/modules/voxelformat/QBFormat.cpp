@@ -9,6 +9,7 @@
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/Var.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
 #include "io/FileStream.h"
 #include "io/Stream.h"
@@ -196,30 +197,24 @@ bool QBFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::
 	return true;
 }
 
-voxel::Voxel QBFormat::getVoxel(State& state, io::SeekableReadStream& stream, voxel::PaletteLookup &palLookup) {
-	core::RGBA color(0);
-	if (!readColor(state, stream, color)) {
-		return voxel::Voxel();
-	}
+voxel::Voxel QBFormat::toVoxel(const core::RGBA &color, voxel::PaletteLookup &palLookup) const {
 	if (color.a == 0) {
 		return voxel::Voxel();
 	}
 	const uint8_t index = palLookup.findClosestIndex(flattenRGB(color.r, color.g, color.b));
-	voxel::Voxel v = voxel::createVoxel(palLookup.palette(), index);
-	return v;
+	return voxel::createVoxel(palLookup.palette(), index);
 }
 
-bool QBFormat::readColor(State& state, io::SeekableReadStream& stream, core::RGBA &color) {
-	if (state._colorFormat == ColorFormat::RGBA) {
-		wrap(stream.readUInt8(color.r))
-		wrap(stream.readUInt8(color.g))
-		wrap(stream.readUInt8(color.b))
-	} else {
-		wrap(stream.readUInt8(color.b))
-		wrap(stream.readUInt8(color.g))
-		wrap(stream.readUInt8(color.r))
+voxel::Voxel QBFormat::getVoxel(State& state, io::SeekableReadStream& stream, voxel::PaletteLookup &palLookup) {
+	core::RGBA color(0);
+	if (!readColor(state, stream, color)) {
+		return voxel::Voxel();
 	}
-	// the returned alpha value might also be the vis mask
+	return toVoxel(color, palLookup);
+}
+
+core::RGBA QBFormat::decodeColor(const State& state, const uint8_t *bytes) {
+	// the alpha value might also be the vis mask
 	// if (mask == 0) // voxel invisble
 	// if (mask && 2 == 2) // left side visible
 	// if (mask && 4 == 4) // right side visible
@@ -227,7 +222,19 @@ bool QBFormat::readColor(State& state, io::SeekableReadStream& stream, core::RGB
 	// if (mask && 16 == 16) // bottom side visible
 	// if (mask && 32 == 32) // front side visible
 	// if (mask && 64 == 64) // back side visible
-	wrap(stream.readUInt8(color.a))
+	if (state._colorFormat == ColorFormat::RGBA) {
+		return core::RGBA(bytes[0], bytes[1], bytes[2], bytes[3]);
+	}
+	return core::RGBA(bytes[2], bytes[1], bytes[0], bytes[3]);
+}
+
+bool QBFormat::readColor(State& state, io::SeekableReadStream& stream, core::RGBA &color) {
+	uint8_t bytes[4];
+	if (stream.read(bytes, sizeof(bytes)) != (int)sizeof(bytes)) {
+		Log::error("Could not load qb file: Not enough data in stream");
+		return false;
+	}
+	color = decodeColor(state, bytes);
 	return true;
 }
 
@@ -288,10 +295,27 @@ bool QBFormat::readMatrix(State& state, io::SeekableReadStream& stream, scenegra
 	core::ScopedPtr<voxel::RawVolume> v(new voxel::RawVolume(region));
 	if (state._compressed == Compression::None) {
 		Log::debug("qb matrix uncompressed");
+		const size_t bytes = (size_t)size.x * (size_t)size.y * (size_t)size.z * 4u;
+		// decode straight from memory if the stream supports it - otherwise read the matrix with one call
+		const uint8_t *colors = stream.readDirect(bytes);
+		core::DynamicArray<uint8_t> buffer;
+		if (colors == nullptr) {
+			buffer.resize(bytes);
+			const int read = stream.read(buffer.data(), bytes);
+			if (read != (int)bytes) {
+				Log::error("Could not load qb file: Not enough data in stream");
+				// missing voxels are air
+				for (size_t i = (size_t)core_max(read, 0); i < bytes; ++i) {
+					buffer[i] = 0u;
+				}
+			}
+			colors = buffer.data();
+		}
 		for (uint32_t z = 0; z < size.z; ++z) {
 			for (uint32_t y = 0; y < size.y; ++y) {
 				for (uint32_t x = 0; x < size.x; ++x) {
-					const voxel::Voxel& voxel = getVoxel(state, stream, palLookup);
+					const voxel::Voxel& voxel = toVoxel(decodeColor(state, colors), palLookup);
+					colors += 4;
 					if (state._zAxisOrientation == ZAxisOrientation::LeftHanded) {
 						v->setVoxel((int)x, (int)y, (int)z, voxel);
 					} else {
@@ -64,6 +64,11 @@ private:
 	};
 
 	bool readColor(State& state, io::SeekableReadStream& stream, core::RGBA &color);
+	/**
+	 * @brief Decodes the 4 bytes of a color in the color format of the file
+	 */
+	static core::RGBA decodeColor(const State& state, const uint8_t *bytes);
+	voxel::Voxel toVoxel(const core::RGBA &color, voxel::PaletteLookup &palLookup) const;
 	voxel::Voxel getVoxel(State& state, io::SeekableReadStream& stream, voxel::PaletteLookup &palLookup);
 	bool readMatrix(State& state, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, voxel::PaletteLookup &palLookup);
 	bool readPalette(State& state, io::SeekableReadStream& stream, voxel::Palette &palette);
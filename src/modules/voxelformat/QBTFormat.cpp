@@ -14,6 +14,7 @@
 #include "core/Var.h"
 #include "core/Zip.h"
 #include "io/BufferedZipReadStream.h"
+#include "io/FastReader.h"
 #include "io/FileStream.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
@@ -444,17 +445,18 @@ bool QBTFormat::loadMatrix(io::SeekableReadStream& stream, scenegraph::SceneGrap
 		return false;
 	}
 	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
+	io::FastReader reader(zipStream);
+	// a y column is read in one go - each voxel is red, green, blue and the visibility mask
+	uint32_t column[2048];
 	for (int32_t x = 0; x < (int)size.x; x++) {
 		for (int32_t z = 0; z < (int)size.z; z++) {
+			wrap(reader.readUInt32Array(column, size.y))
 			for (int32_t y = 0; y < (int)size.y; y++) {
-				uint8_t red;
-				wrap(zipStream.readUInt8(red))
-				uint8_t green;
-				wrap(zipStream.readUInt8(green))
-				uint8_t blue;
-				wrap(zipStream.readUInt8(blue))
-				uint8_t mask;
-				wrap(zipStream.readUInt8(mask))
+				const uint32_t rgbm = column[y];
+				const uint8_t red = (uint8_t)(rgbm & 0xFFu);
+				const uint8_t green = (uint8_t)((rgbm >> 8) & 0xFFu);
+				const uint8_t blue = (uint8_t)((rgbm >> 16) & 0xFFu);
+				const uint8_t mask = (uint8_t)(rgbm >> 24);
 				if (mask == 0u) {
 					continue;
 				}
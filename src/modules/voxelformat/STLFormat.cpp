@@ -160,83 +160,87 @@ bool STLFormat::writeVertex(io::SeekableWriteStream &stream, const MeshExt &mesh
 	return true;
 }
 
-bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
-						   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
-						   bool quad, bool withColor, bool withTexCoords) {
+bool STLFormat::beginMeshStream(MeshStream &meshStream) {
+	io::SeekableWriteStream &stream = meshStream.stream;
 	stream.writeStringFormat(false, "github.com/mgerhardy/vengi");
 	const size_t delta = priv::BinaryHeaderSize - stream.pos();
 	for (size_t i = 0; i < delta; ++i) {
 		stream.writeUInt8(0);
 	}
 	core_assert(stream.pos() == priv::BinaryHeaderSize);
+	// the face count is patched in endMeshStream()
+	return stream.writeUInt32(0);
+}
 
-	int faceCount = 0;
-	for (const auto &meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
-			if (mesh->isEmpty()) {
-				continue;
-			}
-			const int ni = (int)mesh->getNoOfIndices();
-			if (ni % 3 != 0) {
-				Log::error("Unexpected indices amount");
-				return false;
-			}
-			faceCount += ni / 3;
+bool STLFormat::writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
+		if (mesh->isEmpty()) {
+			continue;
 		}
-	}
-	stream.writeUInt32(faceCount);
-
-	for (const auto &meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
-			if (mesh->isEmpty()) {
-				continue;
-			}
-			Log::debug("Exporting layer %s", meshExt.name.c_str());
-			const int ni = (int)mesh->getNoOfIndices();
-			const scenegraph::SceneGraphNode &graphNode = sceneGraph.node(meshExt.nodeId);
-			scenegraph::KeyFrameIndex keyFrameIdx = 0;
-			const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
-			const voxel::VoxelVertex *vertices = mesh->getRawVertexData();
-			const voxel::IndexType *indices = mesh->getRawIndexData();
-
-			for (int i = 0; i < ni; i += 3) {
-				const uint32_t one = indices[i + 0];
-				const uint32_t two = indices[i + 1];
-				const uint32_t three = indices[i + 2];
-
-				const voxel::VoxelVertex &v1 = vertices[one];
-				const voxel::VoxelVertex &v2 = vertices[two];
-				const voxel::VoxelVertex &v3 = vertices[three];
-
-				// normal
-				const glm::vec3 edge1 = glm::vec3(v2.position - v1.position);
-				const glm::vec3 edge2 = glm::vec3(v3.position - v1.position);
-				const glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
-				for (int j = 0; j < 3; ++j) {
-					if (!stream.writeFloat(normal[j])) {
-						return false;
-					}
-				}
-
-				if (!writeVertex(stream, meshExt, v1, transform, scale)) {
+		Log::debug("Exporting layer %s", meshExt.name.c_str());
+		const int ni = (int)mesh->getNoOfIndices();
+		if (ni % 3 != 0) {
+			Log::error("Unexpected indices amount");
+			return false;
+		}
+		const scenegraph::SceneGraphNode &graphNode = meshStream.sceneGraph.node(meshExt.nodeId);
+		scenegraph::KeyFrameIndex keyFrameIdx = 0;
+		const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
+		const voxel::VoxelVertex *vertices = mesh->getRawVertexData();
+		const voxel::IndexType *indices = mesh->getRawIndexData();
+
+		for (int i = 0; i < ni; i += 3) {
+			const uint32_t one = indices[i + 0];
+			const uint32_t two = indices[i + 1];
+			const uint32_t three = indices[i + 2];
+
+			const voxel::VoxelVertex &v1 = vertices[one];
+			const voxel::VoxelVertex &v2 = vertices[two];
+			const voxel::VoxelVertex &v3 = vertices[three];
+
+			// normal
+			const glm::vec3 edge1 = glm::vec3(v2.position - v1.position);
+			const glm::vec3 edge2 = glm::vec3(v3.position - v1.position);
+			const glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+			for (int j = 0; j < 3; ++j) {
+				if (!stream.writeFloat(normal[j])) {
 					return false;
 				}
+			}
 
-				if (!writeVertex(stream, meshExt, v2, transform, scale)) {
-					return false;
-				}
+			if (!writeVertex(stream, meshExt, v1, transform, meshStream.scale)) {
+				return false;
+			}
 
-				if (!writeVertex(stream, meshExt, v3, transform, scale)) {
-					return false;
-				}
+			if (!writeVertex(stream, meshExt, v2, transform, meshStream.scale)) {
+				return false;
+			}
 
-				stream.writeUInt16(0);
+			if (!writeVertex(stream, meshExt, v3, transform, meshStream.scale)) {
+				return false;
 			}
+
+			stream.writeUInt16(0);
 		}
+		meshStream.faces += ni / 3;
+		meshStream.vertexOffset += (int)mesh->getNoOfVertices();
 	}
 	return true;
 }
 
+bool STLFormat::endMeshStream(MeshStream &meshStream) {
+	io::SeekableWriteStream &stream = meshStream.stream;
+	const int64_t end = stream.pos();
+	if (stream.seek(priv::BinaryHeaderSize) == -1) {
+		Log::error("Failed to seek to the stl face count");
+		return false;
+	}
+	if (!stream.writeUInt32(meshStream.faces)) {
+		return false;
+	}
+	return stream.seek(end) != -1;
+}
+
 } // namespace voxel
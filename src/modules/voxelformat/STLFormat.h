@@ -42,9 +42,12 @@ private:
 	bool parseAscii(io::SeekableReadStream &stream, TriCollection &tris);
 
 	bool voxelizeGroups(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) override;
-public:
-	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &meshes, const core::String &filename,
-					io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
-					bool withTexCoords) override;
+protected:
+	bool supportsMeshStream(const core::String &) const override {
+		return true;
+	}
+	bool beginMeshStream(MeshStream &meshStream) override;
+	bool writeMeshChunk(MeshStream &meshStream, const MeshExt &meshExt) override;
+	bool endMeshStream(MeshStream &meshStream) override;
 };
 } // namespace voxel
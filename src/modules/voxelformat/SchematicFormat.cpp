@@ -17,6 +17,7 @@
 #include "io/ZipWriteStream.h"
 #include "private/MinecraftPaletteMap.h"
 #include "private/NamedBinaryTag.h"
+#include "private/NamedBinaryTagReader.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
@@ -37,9 +38,12 @@ bool SchematicFormat::loadGroupsPalette(const core::String &filename, io::Seekab
 										scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const LoadContext &loadctx) {
 	palette.minecraft();
 	io::ZipReadStream zipStream(stream);
-	priv::NamedBinaryTagContext ctx;
-	ctx.stream = &zipStream;
-	const priv::NamedBinaryTag &schematic = priv::NamedBinaryTag::parse(ctx);
+	priv::NamedBinaryTagReader reader;
+	if (!reader.read(zipStream)) {
+		Log::error("Could not read the nbt data");
+		return false;
+	}
+	const priv::NamedBinaryTagView &schematic = reader.root();
 	if (!schematic.valid()) {
 		Log::error("Could not find 'Schematic' tag");
 		return false;
@@ -69,13 +73,17 @@ bool SchematicFormat::loadGroupsPalette(const core::String &filename, io::Seekab
 			return true;
 		}
 	}
-	schematic.print();
+	// only build the whole tree for the debug output
+	io::MemoryReadStream memStream(reader.buffer(), (uint32_t)reader.size());
+	priv::NamedBinaryTagContext ctx;
+	ctx.stream = &memStream;
+	priv::NamedBinaryTag::parse(ctx).print();
 	return false;
 }
 
-bool SchematicFormat::loadSponge1And2(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph,
+bool SchematicFormat::loadSponge1And2(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph,
 									  voxel::Palette &palette) {
-	const priv::NamedBinaryTag &blockData = schematic.get("BlockData");
+	const priv::NamedBinaryTagView &blockData = schematic.get("BlockData");
 	if (blockData.valid() && blockData.type() == priv::TagType::BYTE_ARRAY) {
 		return parseBlockData(schematic, sceneGraph, palette, blockData);
 	}
@@ -83,9 +91,9 @@ bool SchematicFormat::loadSponge1And2(const priv::NamedBinaryTag &schematic, sce
 	return false;
 }
 
-bool SchematicFormat::loadSponge3(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph,
+bool SchematicFormat::loadSponge3(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph,
 								  voxel::Palette &palette, int version) {
-	const priv::NamedBinaryTag &blocks = schematic.get("Blocks");
+	const priv::NamedBinaryTagView &blocks = schematic.get("Blocks");
 	if (blocks.valid() && blocks.type() == priv::TagType::BYTE_ARRAY) {
 		return parseBlocks(schematic, sceneGraph, palette, blocks, version);
 	}
@@ -93,25 +101,23 @@ bool SchematicFormat::loadSponge3(const priv::NamedBinaryTag &schematic, scenegr
 	return false;
 }
 
-bool SchematicFormat::loadNbt(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, int dataVersion) {
-	const priv::NamedBinaryTag &blocks = schematic.get("blocks");
+bool SchematicFormat::loadNbt(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, int dataVersion) {
+	const priv::NamedBinaryTagView &blocks = schematic.get("blocks");
 	if (blocks.valid() && blocks.type() == priv::TagType::LIST) {
-		const priv::NBTList &list = *blocks.list();
 		glm::ivec3 mins((std::numeric_limits<int32_t>::max)() / 2);
 		glm::ivec3 maxs((std::numeric_limits<int32_t>::min)() / 2);
-		for (const priv::NamedBinaryTag &compound : list) {
+		for (const priv::NamedBinaryTagView &compound : blocks) {
 			if (compound.type() != priv::TagType::COMPOUND) {
 				Log::error("Unexpected nbt type: %i", (int)compound.type());
 				return false;
 			}
-			const priv::NamedBinaryTag& pos = compound.get("pos");
+			const priv::NamedBinaryTagView &pos = compound.get("pos");
 			if (pos.type() != priv::TagType::LIST) {
 				Log::error("Unexpected nbt type for pos: %i", (int)pos.type());
 				return false;
 			}
-			const priv::NBTList &positions = *pos.list();
-			if (positions.size() != 3) {
-				Log::error("Unexpected nbt pos list entry count: %i", (int)positions.size());
+			if (pos.size() != 3) {
+				Log::error("Unexpected nbt pos list entry count: %i", (int)pos.size());
 				return false;
 			}
 			const int state = compound.get("state").int32(-1);
@@ -119,21 +125,21 @@ bool SchematicFormat::loadNbt(const priv::NamedBinaryTag &schematic, scenegraph:
 				Log::error("Unexpected state");
 				return false;
 			}
-			const int x = positions[0].int32(-1);
-			const int y = positions[1].int32(-1);
-			const int z = positions[2].int32(-1);
+			const int x = pos.at(0).int32(-1);
+			const int y = pos.at(1).int32(-1);
+			const int z = pos.at(2).int32(-1);
 			const glm::ivec3 v(x, y, z);
 			mins = (glm::min)(mins, v);
 			maxs = (glm::max)(maxs, v);
 		}
 		const voxel::Region region(mins, maxs);
 		voxel::RawVolume *volume = new voxel::RawVolume(region);
-		for (const priv::NamedBinaryTag &compound : list) {
+		for (const priv::NamedBinaryTagView &compound : blocks) {
 			const int state = compound.get("state").int32();
-			const priv::NBTList &positions = *compound.get("pos").list();
-			const int x = positions[0].int32(-1);
-			const int y = positions[1].int32(-1);
-			const int z = positions[2].int32(-1);
+			const priv::NamedBinaryTagView &pos = compound.get("pos");
+			const int x = pos.at(0).int32(-1);
+			const int y = pos.at(1).int32(-1);
+			const int z = pos.at(2).int32(-1);
 			const glm::ivec3 v(x, y, z);
 			volume->setVoxel(v, voxel::createVoxel(palette, state));
 		}
@@ -159,9 +165,9 @@ static glm::ivec3 voxelPosFromIndex(int width, int depth, int idx) {
 	return glm::ivec3(x, y, z);
 }
 
-bool SchematicFormat::parseBlockData(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph,
-									 voxel::Palette &palette, const priv::NamedBinaryTag &blockData) {
-	const core::DynamicArray<int8_t> *blocks = blockData.byteArray();
+bool SchematicFormat::parseBlockData(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph,
+									 voxel::Palette &palette, const priv::NamedBinaryTagView &blockData) {
+	const int8_t *blocks = blockData.byteArray();
 	if (blocks == nullptr) {
 		Log::error("Invalid BlockData - expected byte array");
 		return false;
@@ -180,7 +186,7 @@ bool SchematicFormat::parseBlockData(const priv::NamedBinaryTag &schematic, scen
 
 	voxel::PaletteLookup palLookup(palette);
 	voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, 0, 0, width - 1, height - 1, depth - 1));
-	SchematicIntReader reader(blocks);
+	SchematicIntReader reader(blocks, (int)blockData.size());
 	int index = 0;
 	int32_t palIdx = 0;
 	while (reader.readInt32(palIdx) != -1) {
@@ -215,8 +221,8 @@ bool SchematicFormat::parseBlockData(const priv::NamedBinaryTag &schematic, scen
 	return true;
 }
 
-bool SchematicFormat::parseBlocks(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph,
-								  voxel::Palette &palette, const priv::NamedBinaryTag &blocks, int version) {
+bool SchematicFormat::parseBlocks(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph,
+								  voxel::Palette &palette, const priv::NamedBinaryTagView &blocks, int version) {
 	core::Buffer<int> mcpal;
 	const int paletteEntry = parsePalette(schematic, mcpal);
 
@@ -235,7 +241,7 @@ bool SchematicFormat::parseBlocks(const priv::NamedBinaryTag &schematic, scenegr
 		for (int y = 0; y < height; ++y) {
 			for (int z = 0; z < depth; ++z) {
 				const int idx = (y * depth + z) * width + x;
-				const uint8_t palIdx = (*blocks.byteArray())[idx];
+				const uint8_t palIdx = (uint8_t)blocks.byteAt(idx);
 				if (palIdx != 0u) {
 					uint8_t currentPalIdx;
 					if (paletteEntry == 0 || palIdx > paletteEntry) {
@@ -265,37 +271,36 @@ bool SchematicFormat::parseBlocks(const priv::NamedBinaryTag &schematic, scenegr
 	return true;
 }
 
-int SchematicFormat::parsePalette(const priv::NamedBinaryTag &schematic, core::Buffer<int> &mcpal) const {
-	const priv::NamedBinaryTag &blockIds = schematic.get("BlockIDs"); // MCEdit2
+int SchematicFormat::parsePalette(const priv::NamedBinaryTagView &schematic, core::Buffer<int> &mcpal) const {
+	const priv::NamedBinaryTagView &blockIds = schematic.get("BlockIDs"); // MCEdit2
 	if (blockIds.valid()) {
 		mcpal.resize(voxel::PaletteMaxColors);
 		int paletteEntry = 0;
-		const int blockCnt = (int)blockIds.compound()->size();
+		const int blockCnt = (int)blockIds.size();
 		for (int i = 0; i < blockCnt; ++i) {
-			const priv::NamedBinaryTag &nbt = blockIds.get(core::String::format("%i", i));
-			const core::String *value = nbt.string();
-			if (value == nullptr) {
+			const priv::NamedBinaryTagView &nbt = blockIds.get(core::String::format("%i", i).c_str());
+			if (nbt.type() != priv::TagType::STRING) {
 				Log::warn("Empty string in BlockIDs for %i", i);
 				continue;
 			}
 			// map to stone on default
-			mcpal[i] = findPaletteIndex(*value, 1);
+			mcpal[i] = findPaletteIndex(nbt.string(), 1);
 			++paletteEntry;
 		}
 		return paletteEntry;
 	}
 	const int paletteMax = schematic.get("PaletteMax").int32(-1); // WorldEdit
 	if (paletteMax != -1) {
-		const priv::NamedBinaryTag &palette = schematic.get("Palette");
+		const priv::NamedBinaryTagView &palette = schematic.get("Palette");
 		if (palette.valid() && palette.type() == priv::TagType::COMPOUND) {
-			if ((int)palette.compound()->size() != paletteMax) {
+			if ((int)palette.size() != paletteMax) {
 				return -1;
 			}
 			mcpal.resize(paletteMax);
 			int paletteEntry = 0;
-			for (const auto &c : *palette.compound()) {
-				core::String key = c->key;
-				const int palIdx = c->second.int32(-1);
+			for (const priv::NamedBinaryTagView &c : palette) {
+				const core::String &key = c.name();
+				const int palIdx = c.int32(-1);
 				if (palIdx == -1) {
 					Log::warn("Failed to get int value for %s", key.c_str());
 					continue;
@@ -310,15 +315,17 @@ int SchematicFormat::parsePalette(const priv::NamedBinaryTag &schematic, core::B
 	return -1;
 }
 
-void SchematicFormat::parseMetadata(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph,
+void SchematicFormat::parseMetadata(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph,
 									scenegraph::SceneGraphNode &node) {
-	const priv::NamedBinaryTag &metadata = schematic.get("Metadata");
+	const priv::NamedBinaryTagView &metadata = schematic.get("Metadata");
 	if (metadata.valid()) {
-		if (const core::String *str = metadata.get("Name").string()) {
-			node.setName(*str);
+		const priv::NamedBinaryTagView &name = metadata.get("Name");
+		if (name.type() == priv::TagType::STRING) {
+			node.setName(name.string());
 		}
-		if (const core::String *str = metadata.get("Author").string()) {
-			node.setProperty("Author", *str);
+		const priv::NamedBinaryTagView &author = metadata.get("Author");
+		if (author.type() == priv::TagType::STRING) {
+			node.setProperty("Author", author.string());
 		}
 	}
 	const int version = schematic.get("Version").int32(-1);
@@ -326,20 +333,20 @@ void SchematicFormat::parseMetadata(const priv::NamedBinaryTag &schematic, scene
 		node.setProperty("Version", core::string::toString(version));
 	}
 	core_assert_msg(node.id() != -1, "The node should already be part of the scene graph");
-	for (const auto &e : *schematic.compound()) {
-		addMetadata_r(e->key, e->value, sceneGraph, node);
+	for (const priv::NamedBinaryTagView &e : schematic) {
+		addMetadata_r(e.name(), e, sceneGraph, node);
 	}
 }
 
-void SchematicFormat::addMetadata_r(const core::String &key, const priv::NamedBinaryTag &nbt, scenegraph::SceneGraph &sceneGraph,
+void SchematicFormat::addMetadata_r(const core::String &key, const priv::NamedBinaryTagView &nbt, scenegraph::SceneGraph &sceneGraph,
 									scenegraph::SceneGraphNode &node) {
 	switch (nbt.type()) {
 	case priv::TagType::COMPOUND: {
 		scenegraph::SceneGraphNode compoundNode(scenegraph::SceneGraphNodeType::Group);
 		compoundNode.setName(key);
 		int nodeId = sceneGraph.emplace(core::move(compoundNode), node.id());
-		for (const auto &e : *nbt.compound()) {
-			addMetadata_r(e->key, e->value, sceneGraph, sceneGraph.node(nodeId));
+		for (const priv::NamedBinaryTagView &e : nbt) {
+			addMetadata_r(e.name(), e, sceneGraph, sceneGraph.node(nodeId));
 		}
 		break;
 	}
@@ -366,11 +373,10 @@ void SchematicFormat::addMetadata_r(const core::String &key, const priv::NamedBi
 		node.setProperty(key, nbt.string());
 		break;
 	case priv::TagType::LIST: {
-		const priv::NBTList &list = *nbt.list();
 		scenegraph::SceneGraphNode listNode(scenegraph::SceneGraphNodeType::Group);
-		listNode.setName(core::string::format("%s: %i", key.c_str(), (int)list.size()));
+		listNode.setName(core::string::format("%s: %i", key.c_str(), (int)nbt.size()));
 		int nodeId = sceneGraph.emplace(core::move(listNode), node.id());
-		for (const priv::NamedBinaryTag &e : list) {
+		for (const priv::NamedBinaryTagView &e : nbt) {
 			addMetadata_r(key, e, sceneGraph, sceneGraph.node(nodeId));
 		}
 		break;
@@ -15,7 +15,7 @@ class ZipReadStream;
 namespace voxelformat {
 
 namespace priv {
-class NamedBinaryTag;
+class NamedBinaryTagView;
 }
 
 /**
@@ -26,17 +26,17 @@ class NamedBinaryTag;
  */
 class SchematicFormat : public PaletteFormat {
 protected:
-	bool loadSponge1And2(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette);
-	bool parseBlockData(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const priv::NamedBinaryTag &blocks);
+	bool loadSponge1And2(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette);
+	bool parseBlockData(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const priv::NamedBinaryTagView &blocks);
 
-	bool loadNbt(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, int dataVersion);
+	bool loadNbt(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, int dataVersion);
 
-	bool loadSponge3(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, int version);
-	bool parseBlocks(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const priv::NamedBinaryTag &blocks, int version);
+	bool loadSponge3(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, int version);
+	bool parseBlocks(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const priv::NamedBinaryTagView &blocks, int version);
 
-	void addMetadata_r(const core::String &key, const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node);
-	void parseMetadata(const priv::NamedBinaryTag &schematic, scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node);
-	int parsePalette(const priv::NamedBinaryTag &schematic, core::Buffer<int> &mcpal) const;
+	void addMetadata_r(const core::String &key, const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node);
+	void parseMetadata(const priv::NamedBinaryTagView &schematic, scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node);
+	int parsePalette(const priv::NamedBinaryTagView &schematic, core::Buffer<int> &mcpal) const;
 	bool loadGroupsPalette(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const LoadContext &ctx) override;
 	bool saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) override;
 };
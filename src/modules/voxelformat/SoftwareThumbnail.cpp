@@ -0,0 +1,354 @@
+/**
+ * @file
+ */
+
+#include "SoftwareThumbnail.h"
+#include "app/App.h"
+#include "core/Color.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ParallelFor.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "scenegraph/SceneGraph.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include <float.h>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace voxelformat {
+
+namespace {
+
+// the same values as the voxel shader uses for the ambient occlusion of the vertices
+static const float AmbientOcclusionValues[] = {0.15f, 0.6f, 0.8f, 1.0f};
+static const float FieldOfView = glm::radians(45.0f);
+static const int RowsPerTask = 8;
+
+struct RenderNode {
+	const voxel::RawVolume *volume;
+	const voxel::Palette *palette;
+	glm::ivec3 translation;
+	// the bricks of the volume that contain voxels - in volume coordinates
+	voxel::Region bounds;
+	// the world coordinates of the bounds
+	glm::vec3 mins;
+	glm::vec3 maxs;
+};
+
+struct Hit {
+	float t = FLT_MAX;
+	const RenderNode *node = nullptr;
+	glm::ivec3 pos{0};
+	// the axis and the direction of the face normal
+	int axis = 1;
+	int sign = 1;
+};
+
+struct Camera {
+	glm::vec3 eye;
+	glm::vec3 forward;
+	glm::vec3 right;
+	glm::vec3 up;
+	float tanHalfFov;
+	float aspect;
+};
+
+bool intersectBox(const glm::vec3 &origin, const glm::vec3 &dir, const glm::vec3 &mins, const glm::vec3 &maxs,
+				  float &tEnter, float &tExit, int &enterAxis) {
+	tEnter = -FLT_MAX;
+	tExit = FLT_MAX;
+	enterAxis = 1;
+	for (int i = 0; i < 3; ++i) {
+		if (dir[i] == 0.0f) {
+			if (origin[i] < mins[i] || origin[i] > maxs[i]) {
+				return false;
+			}
+			continue;
+		}
+		const float inv = 1.0f / dir[i];
+		float t0 = (mins[i] - origin[i]) * inv;
+		float t1 = (maxs[i] - origin[i]) * inv;
+		if (t0 > t1) {
+			core::exchange(t0, t1);
+		}
+		if (t0 > tEnter) {
+			tEnter = t0;
+			enterAxis = i;
+		}
+		tExit = core_min(tExit, t1);
+	}
+	return tEnter <= tExit && tExit > 0.0f;
+}
+
+inline bool isSolid(const voxel::RawVolume *volume, const glm::ivec3 &pos) {
+	if (!volume->region().containsPoint(pos)) {
+		return false;
+	}
+	const voxel::VoxelType material = volume->voxel(pos).getMaterial();
+	return !voxel::isAir(material) && !voxel::isTransparent(material);
+}
+
+/**
+ * @brief The region of the non empty bricks - this keeps the rays from walking through the air around the model
+ */
+voxel::Region solidBounds(const voxel::RawVolume *volume) {
+	const voxel::Region &region = volume->region();
+	const int brickSize = voxel::RawVolume::BrickSize;
+	glm::ivec3 mins = region.getUpperCorner();
+	glm::ivec3 maxs = region.getLowerCorner();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); z += brickSize) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); y += brickSize) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); x += brickSize) {
+				const glm::ivec3 lower(x, y, z);
+				const glm::ivec3 upper = glm::min(lower + (brickSize - 1), region.getUpperCorner());
+				if (volume->isEmpty(voxel::Region(lower, upper))) {
+					continue;
+				}
+				mins = glm::min(mins, lower);
+				maxs = glm::max(maxs, upper);
+			}
+		}
+	}
+	return voxel::Region(mins, maxs);
+}
+
+/**
+ * @brief Walks the voxels of the node along the ray (Amanatides and Woo) and updates the hit if a solid voxel is
+ * found that is closer than the current one
+ */
+void traceNode(const RenderNode &node, const glm::vec3 &origin, const glm::vec3 &dir, Hit &hit) {
+	float tEnter;
+	float tExit;
+	int axis;
+	if (!intersectBox(origin, dir, node.mins, node.maxs, tEnter, tExit, axis)) {
+		return;
+	}
+	float t = core_max(tEnter, 0.0f);
+	if (t >= hit.t) {
+		return;
+	}
+	const voxel::Region &region = node.bounds;
+	const glm::vec3 local = origin + dir * t - glm::vec3(node.translation);
+	glm::ivec3 pos = glm::clamp(glm::ivec3(glm::floor(local)), region.getLowerCorner(), region.getUpperCorner());
+	glm::ivec3 step;
+	glm::vec3 tMax;
+	glm::vec3 tDelta;
+	for (int i = 0; i < 3; ++i) {
+		if (dir[i] > 0.0f) {
+			step[i] = 1;
+			tMax[i] = t + ((float)(pos[i] + 1) - local[i]) / dir[i];
+			tDelta[i] = 1.0f / dir[i];
+		} else if (dir[i] < 0.0f) {
+			step[i] = -1;
+			tMax[i] = t + ((float)pos[i] - local[i]) / dir[i];
+			tDelta[i] = -1.0f / dir[i];
+		} else {
+			step[i] = 0;
+			tMax[i] = FLT_MAX;
+			tDelta[i] = FLT_MAX;
+		}
+	}
+	int normalSign = step[axis] == 0 ? 1 : -step[axis];
+	for (;;) {
+		const voxel::Voxel &voxel = node.volume->voxel(pos);
+		if (!voxel::isAir(voxel.getMaterial())) {
+			hit.t = t;
+			hit.node = &node;
+			hit.pos = pos;
+			hit.axis = axis;
+			hit.sign = normalSign;
+			return;
+		}
+		axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+		t = tMax[axis];
+		if (t > tExit || t >= hit.t) {
+			return;
+		}
+		pos[axis] += step[axis];
+		if (pos[axis] < region.getLowerCorner()[axis] || pos[axis] > region.getUpperCorner()[axis]) {
+			return;
+		}
+		tMax[axis] += tDelta[axis];
+		normalSign = -step[axis];
+	}
+}
+
+/**
+ * @brief Interpolates the ambient occlusion of the four corners of the face at the hit point - the corners are
+ * computed in the same way as the cubic surface extractor does it for the vertices
+ */
+float ambientOcclusion(const Hit &hit, const glm::vec3 &local) {
+	const voxel::RawVolume *volume = hit.node->volume;
+	glm::ivec3 front = hit.pos;
+	front[hit.axis] += hit.sign;
+	const int uAxis = (hit.axis + 1) % 3;
+	const int vAxis = (hit.axis + 2) % 3;
+	const float fu = glm::clamp(local[uAxis] - (float)hit.pos[uAxis], 0.0f, 1.0f);
+	const float fv = glm::clamp(local[vAxis] - (float)hit.pos[vAxis], 0.0f, 1.0f);
+	float corners[2][2];
+	for (int cu = 0; cu < 2; ++cu) {
+		for (int cv = 0; cv < 2; ++cv) {
+			glm::ivec3 side1 = front;
+			side1[uAxis] += cu ? 1 : -1;
+			glm::ivec3 side2 = front;
+			side2[vAxis] += cv ? 1 : -1;
+			glm::ivec3 corner = side1;
+			corner[vAxis] += cv ? 1 : -1;
+			const bool s1 = isSolid(volume, side1);
+			const bool s2 = isSolid(volume, side2);
+			const int ao = (s1 && s2) ? 0 : 3 - ((int)s1 + (int)s2 + (int)isSolid(volume, corner));
+			corners[cu][cv] = AmbientOcclusionValues[ao];
+		}
+	}
+	const float bottom = glm::mix(corners[0][0], corners[1][0], fu);
+	const float top = glm::mix(corners[0][1], corners[1][1], fu);
+	return glm::mix(bottom, top, fv);
+}
+
+core::RGBA shade(const Hit &hit, const glm::vec3 &origin, const glm::vec3 &dir) {
+	const glm::vec3 local = origin + dir * hit.t - glm::vec3(hit.node->translation);
+	const voxel::Voxel &voxel = hit.node->volume->voxel(hit.pos);
+	const glm::vec4 color = core::Color::fromRGBA(hit.node->palette->color(voxel.getColor()));
+	// fixed light per face direction to make the shape visible without a light setup
+	float light;
+	if (hit.axis == 1) {
+		light = hit.sign > 0 ? 1.0f : 0.55f;
+	} else if (hit.axis == 0) {
+		light = 0.85f;
+	} else {
+		light = 0.7f;
+	}
+	light *= ambientOcclusion(hit, local);
+	return core::Color::getRGBA(glm::vec4(glm::vec3(color) * light, 1.0f));
+}
+
+void renderRows(const core::DynamicArray<RenderNode> &nodes, const Camera &camera, const glm::ivec2 &size,
+				core::RGBA clearColor, int startRow, int endRow, core::RGBA *pixels) {
+	for (int y = startRow; y < endRow; ++y) {
+		const float ndcY = 1.0f - 2.0f * ((float)y + 0.5f) / (float)size.y;
+		for (int x = 0; x < size.x; ++x) {
+			const float ndcX = 2.0f * ((float)x + 0.5f) / (float)size.x - 1.0f;
+			const glm::vec3 dir = glm::normalize(camera.forward +
+												 camera.right * (ndcX * camera.tanHalfFov * camera.aspect) +
+												 camera.up * (ndcY * camera.tanHalfFov));
+			Hit hit;
+			for (const RenderNode &node : nodes) {
+				traceNode(node, camera.eye, dir, hit);
+			}
+			pixels[y * size.x + x] = hit.node == nullptr ? clearColor : shade(hit, camera.eye, dir);
+		}
+	}
+}
+
+Camera createCamera(const glm::vec3 &mins, const glm::vec3 &maxs, const ThumbnailContext &ctx) {
+	Camera camera;
+	camera.aspect = (float)ctx.outputSize.x / (float)ctx.outputSize.y;
+	camera.tanHalfFov = glm::tan(FieldOfView * 0.5f);
+
+	// the voxelrender thumbnail camera is placed at -x, +y, -z of the scene
+	const float azimuth = glm::pi<float>() * -0.75f + ctx.yaw;
+	const float elevation = glm::clamp(glm::atan(glm::one_over_root_two<float>()) + ctx.pitch,
+									   -glm::radians(89.0f), glm::radians(89.0f));
+	const glm::vec3 toEye(glm::cos(elevation) * glm::sin(azimuth), glm::sin(elevation),
+						  glm::cos(elevation) * glm::cos(azimuth));
+	const glm::vec3 center = (mins + maxs) * 0.5f;
+	float distance = ctx.distance;
+	if (distance <= 0.01f) {
+		const float radius = glm::length(maxs - mins) * 0.5f;
+		const float halfFov = glm::atan(camera.tanHalfFov * core_min(1.0f, camera.aspect));
+		distance = radius / glm::sin(halfFov);
+	}
+	camera.eye = center + toEye * distance;
+	camera.forward = -toEye;
+	camera.right = glm::normalize(glm::cross(camera.forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+	camera.up = glm::cross(camera.right, camera.forward);
+	if (ctx.roll != 0.0f) {
+		const glm::vec3 right = camera.right;
+		const float c = glm::cos(ctx.roll);
+		const float s = glm::sin(ctx.roll);
+		camera.right = right * c + camera.up * s;
+		camera.up = camera.up * c - right * s;
+	}
+	return camera;
+}
+
+} // namespace
+
+image::ImagePtr softwareThumbnail(const scenegraph::SceneGraph &sceneGraph, const ThumbnailContext &ctx) {
+	core_trace_scoped(SoftwareThumbnail);
+	const glm::ivec2 size = ctx.outputSize;
+	if (size.x <= 0 || size.y <= 0) {
+		return image::ImagePtr();
+	}
+	core::DynamicArray<RenderNode> nodes;
+	glm::vec3 mins(FLT_MAX);
+	glm::vec3 maxs(-FLT_MAX);
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		const voxel::RawVolume *volume = node.volume();
+		if (!node.visible() || volume == nullptr || volume->isEmpty()) {
+			continue;
+		}
+		const glm::ivec3 translation(glm::round(node.transform(0).worldTranslation()));
+		const voxel::Region &bounds = solidBounds(volume);
+		RenderNode renderNode{volume, &node.palette(), translation, bounds,
+							  glm::vec3(bounds.getLowerCorner() + translation),
+							  glm::vec3(bounds.getUpperCorner() + translation + 1)};
+		mins = glm::min(mins, renderNode.mins);
+		maxs = glm::max(maxs, renderNode.maxs);
+		nodes.push_back(renderNode);
+	}
+
+	const core::RGBA clearColor = core::Color::getRGBA(ctx.clearColor);
+	core::RGBA *pixels = (core::RGBA *)core_malloc(size.x * size.y * sizeof(core::RGBA));
+	if (nodes.empty()) {
+		for (int i = 0; i < size.x * size.y; ++i) {
+			pixels[i] = clearColor;
+		}
+	} else {
+		const Camera camera = createCamera(mins, maxs, ctx);
+		core::parallel_for(app::App::getInstance()->threadPool(), 0, size.y, RowsPerTask, [&](int startRow, int endRow) {
+			renderRows(nodes, camera, size, clearColor, startRow, endRow, pixels);
+		});
+	}
+
+	image::ImagePtr image = image::createEmptyImage("thumbnail");
+	const bool loaded = image->loadRGBA((const uint8_t *)pixels, size.x, size.y);
+	core_free(pixels);
+	if (!loaded) {
+		Log::error("Failed to create the thumbnail image");
+		return image::ImagePtr();
+	}
+	return image;
+}
+
+bool softwareTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, ThumbnailContext ctx,
+					   int loops) {
+	const core::String ext = core::string::extractExtension(imageFile);
+	const core::String baseFilePath = core::string::stripExtension(imageFile);
+	const float startYaw = ctx.yaw;
+	for (int i = 0; i < loops; ++i) {
+		const core::String &filepath = core::string::format("%s_%i.%s", baseFilePath.c_str(), i, ext.c_str());
+		ctx.yaw = startYaw + glm::two_pi<float>() * (float)i / (float)loops;
+		const image::ImagePtr &image = softwareThumbnail(sceneGraph, ctx);
+		if (!image) {
+			Log::error("Failed to create thumbnail for %s", imageFile.c_str());
+			return false;
+		}
+		const io::FilePtr &outfile = io::filesystem()->open(filepath, io::FileMode::SysWrite);
+		io::FileStream outStream(outfile);
+		if (!image->writePng(outStream)) {
+			Log::error("Failed to write image %s", filepath.c_str());
+			return false;
+		}
+		Log::info("Write image %s", filepath.c_str());
+	}
+	return true;
+}
+
+} // namespace voxelformat
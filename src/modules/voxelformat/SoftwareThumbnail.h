@@ -0,0 +1,37 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "voxelformat/FormatThumbnail.h"
+
+namespace scenegraph {
+class SceneGraph;
+}
+
+namespace voxelformat {
+
+/**
+ * @brief Creates a thumbnail of the scene graph without a gpu by casting a ray per pixel into the volumes
+ *
+ * The model nodes are placed at their world translation (like SceneGraph::merge() does) and shaded with their
+ * palette colors and per face ambient occlusion. The pixel rows are traced in parallel on the app thread pool.
+ *
+ * The camera looks at the center of the scene from the same direction as the voxelrender thumbnails. The angles of
+ * the context are in radians and relative to that direction. If no distance is given, the camera is moved back until
+ * the whole scene fits into the image.
+ *
+ * @note Matches the ThumbnailCreator signature and can be used for SaveContext::thumbnailCreator
+ */
+image::ImagePtr softwareThumbnail(const scenegraph::SceneGraph &sceneGraph, const ThumbnailContext &ctx);
+
+/**
+ * @brief Writes @c loops images that rotate around the scene to @c <imageFile>_<loop>.<ext>
+ * @sa softwareThumbnail()
+ */
+bool softwareTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, ThumbnailContext ctx,
+					   int loops);
+
+} // namespace voxelformat
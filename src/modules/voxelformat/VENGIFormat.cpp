@@ -3,11 +3,16 @@
  */
 
 #include "VENGIFormat.h"
+#include "app/App.h"
 #include "core/ArrayLength.h"
 #include "core/Enum.h"
 #include "core/FourCC.h"
+#include "core/GameConfig.h"
 #include "core/Log.h"
+#include "core/Var.h"
 #include "glm/gtc/type_ptr.hpp"
+#include "io/ParallelZipReadStream.h"
+#include "io/ParallelZipWriteStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
 #include "voxel/Palette.h"
@@ -376,35 +381,38 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 	return false;
 }
 
+bool VENGIFormat::saveScene(const scenegraph::SceneGraph &sceneGraph, io::WriteStream &stream) {
+	wrapBool(stream.writeUInt32(3))
+	return saveNode(sceneGraph, stream, sceneGraph.root());
+}
+
 bool VENGIFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
 	wrapBool(stream.writeUInt32(FourCC('V','E','N','G')))
-	io::ZipWriteStream zipStream(stream);
-	wrapBool(zipStream.writeUInt32(3))
-	if (!saveNode(sceneGraph, zipStream, sceneGraph.root())) {
-		return false;
+	if (core::Var::getSafe(cfg::VoxformatVENGIParallelZip)->boolVal()) {
+		// independent deflate blocks instead of one zlib stream
+		wrapBool(stream.writeUInt32(FourCC('B','L','K','Z')))
+		io::ParallelZipWriteStream zipStream(stream, app::App::getInstance()->threadPool());
+		if (!saveScene(sceneGraph, zipStream)) {
+			return false;
+		}
+		return zipStream.flush();
 	}
-	return true;
+	io::ZipWriteStream zipStream(stream);
+	return saveScene(sceneGraph, zipStream);
 }
 
-bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx) {
-	uint32_t magic;
-	wrap(stream.readUInt32(magic))
-	if (magic != FourCC('V','E','N','G')) {
-		Log::error("Invalid magic");
-		return false;
-	}
-	io::ZipReadStream zipStream(stream);
+bool VENGIFormat::loadScene(scenegraph::SceneGraph &sceneGraph, io::ReadStream &stream) {
 	uint32_t version;
-	wrap(zipStream.readUInt32(version))
+	wrap(stream.readUInt32(version))
 	if (version > 3) {
 		Log::error("Unsupported version %u", version);
 		return false;
 	}
 	uint32_t chunkMagic;
-	wrap(zipStream.readUInt32(chunkMagic))
+	wrap(stream.readUInt32(chunkMagic))
 	NodeMapping nodeMapping;
 	if (chunkMagic == FourCC('N','O','D','E')) {
-		if (!loadNode(sceneGraph, sceneGraph.root().id(), version, zipStream, nodeMapping)) {
+		if (!loadNode(sceneGraph, sceneGraph.root().id(), version, stream, nodeMapping)) {
 			return false;
 		}
 		for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end(); ++iter) {
@@ -424,6 +432,24 @@ bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStrea
 	return false;
 }
 
+bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx) {
+	uint32_t magic;
+	wrap(stream.readUInt32(magic))
+	if (magic != FourCC('V','E','N','G')) {
+		Log::error("Invalid magic");
+		return false;
+	}
+	uint32_t container;
+	wrap(stream.peekUInt32(container))
+	if (container == FourCC('B','L','K','Z')) {
+		stream.skip(sizeof(container));
+		io::ParallelZipReadStream zipStream(stream, app::App::getInstance()->threadPool());
+		return loadScene(sceneGraph, zipStream);
+	}
+	io::ZipReadStream zipStream(stream);
+	return loadScene(sceneGraph, zipStream);
+}
+
 #undef wrap
 #undef wrapBool
 
@@ -36,6 +36,9 @@ private:
 	bool loadNodePaletteIdentifier(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint32_t version, io::ReadStream &stream, NodeMapping &nodeMapping);
 
+	bool saveScene(const scenegraph::SceneGraph &sceneGraph, io::WriteStream &stream);
+	bool loadScene(scenegraph::SceneGraph &sceneGraph, io::ReadStream &stream);
+
 protected:
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename, io::SeekableWriteStream &stream,
 					const SaveContext &ctx) override;
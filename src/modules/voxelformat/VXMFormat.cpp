@@ -4,6 +4,7 @@
 
 #include "VXMFormat.h"
 #include "app/App.h"
+#include "io/FastReader.h"
 #include "io/Filesystem.h"
 #include "io/FileStream.h"
 #include "core/Common.h"
@@ -472,26 +473,28 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		wrap(stream.readUInt8(maxLayers));
 	}
 
+	// the rle data of the layers is decoded without going through the stream for every byte
+	io::FastReader reader(stream);
 	for (uint8_t layer = 0; layer < maxLayers; ++layer) {
 		int idx = 0;
 		bool visible = true;
 		char layerName[1024];
 		if (version >= 12) {
-			wrapBool(stream.readString(sizeof(layerName), layerName, true))
-			visible = stream.readBool();
+			wrapBool(reader.readString(sizeof(layerName), layerName, true))
+			visible = reader.readBool();
 		} else {
 			core::string::formatBuf(layerName, sizeof(layerName), "Layer %i", layer);
 		}
 		voxel::RawVolume* volume = new voxel::RawVolume(region);
 		for (;;) {
 			uint8_t length;
-			wrapDelete(stream.readUInt8(length), volume);
+			wrapDelete(reader.readUInt8(length), volume);
 			if (length == 0u) {
 				break;
 			}
 
 			uint8_t matIdx;
-			wrapDelete(stream.readUInt8(matIdx), volume);
+			wrapDelete(reader.readUInt8(matIdx), volume);
 			if (matIdx == EMPTY_PALETTE) {
 				idx += length;
 				continue;
@@ -525,6 +528,7 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		node.setTransform(keyFrameIdx, transform);
 		sceneGraph.emplace(core::move(node));
 	}
+	stream.skip((int64_t)reader.pos());
 
 	if (version >= 10) {
 		uint8_t surface;
@@ -0,0 +1,93 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/FormatConfig.h"
+#include "voxelformat/QBCLFormat.h"
+#include "voxelformat/QBFormat.h"
+#include "voxelformat/QBTFormat.h"
+#include "voxelformat/VXMFormat.h"
+
+/**
+ * @brief Measures the decoding speed of the formats that read a value per voxel. The scene is saved once into
+ * memory and loaded from there - the reported bytes per second are relative to the file size.
+ */
+class FormatLoadBenchmark : public app::AbstractBenchmark {
+protected:
+	bool onInitApp() override {
+		return voxelformat::FormatConfig::init();
+	}
+
+	// terrain like surface with a few colors and some noise to not end up with one huge rle run
+	static voxel::RawVolume *createVolume(int size) {
+		voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		for (int x = 0; x < size; ++x) {
+			for (int z = 0; z < size; ++z) {
+				const int height = size / 2 + (x / 8 + z / 8) % 4;
+				for (int y = 0; y < height; ++y) {
+					const int color = 1 + (y / 4) % 3 + ((x * 7 + z * 13 + y) % 11 == 0 ? 4 : 0);
+					volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+		return volume;
+	}
+
+	void load(benchmark::State &state, voxelformat::Format &format, const core::String &filename) {
+		core::ScopedPtr<voxel::RawVolume> volume(createVolume((int)state.range(0)));
+		io::BufferedReadWriteStream stream;
+		{
+			scenegraph::SceneGraph sceneGraph;
+			scenegraph::SceneGraphNode node;
+			node.setVolume(volume, false);
+			sceneGraph.emplace(core::move(node));
+			voxelformat::SaveContext saveCtx;
+			if (!format.save(sceneGraph, filename, stream, saveCtx)) {
+				state.SkipWithError("Failed to save the scene");
+				return;
+			}
+		}
+		voxelformat::LoadContext loadCtx;
+		for (auto _ : state) {
+			io::MemoryReadStream memStream(stream.getBuffer(), (uint32_t)stream.size());
+			scenegraph::SceneGraph sceneGraph;
+			if (!format.load(filename, memStream, sceneGraph, loadCtx)) {
+				state.SkipWithError("Failed to load the scene");
+				break;
+			}
+		}
+		state.SetBytesProcessed((int64_t)state.iterations() * stream.size());
+	}
+};
+
+BENCHMARK_DEFINE_F(FormatLoadBenchmark, QBCL)(benchmark::State &state) {
+	voxelformat::QBCLFormat format;
+	load(state, format, "benchmark.qbcl");
+}
+
+BENCHMARK_DEFINE_F(FormatLoadBenchmark, QBT)(benchmark::State &state) {
+	voxelformat::QBTFormat format;
+	load(state, format, "benchmark.qbt");
+}
+
+BENCHMARK_DEFINE_F(FormatLoadBenchmark, QB)(benchmark::State &state) {
+	voxelformat::QBFormat format;
+	load(state, format, "benchmark.qb");
+}
+
+BENCHMARK_DEFINE_F(FormatLoadBenchmark, VXM)(benchmark::State &state) {
+	voxelformat::VXMFormat format;
+	load(state, format, "benchmark.vxm");
+}
+
+BENCHMARK_REGISTER_F(FormatLoadBenchmark, QBCL)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FormatLoadBenchmark, QBT)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FormatLoadBenchmark, QB)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FormatLoadBenchmark, VXM)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/DynamicArray.h"
+#include "io/BufferedReadWriteStream.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/FormatConfig.h"
+#include "voxelformat/STLFormat.h"
+
+/**
+ * @brief Measures the mesh export like it is done by voxconvert - the mesh extraction of the nodes is spread over the
+ * thread pool. The binary stl format is used because it doesn't write any additional files.
+ */
+class MeshExportBenchmark : public app::AbstractBenchmark {
+protected:
+	core::DynamicArray<voxel::RawVolume *> _volumes;
+	scenegraph::SceneGraph _sceneGraph;
+
+	bool onInitApp() override {
+		return voxelformat::FormatConfig::init();
+	}
+
+	// terrain like surface with a few colors
+	static voxel::RawVolume *createVolume(const glm::ivec3 &mins, int size) {
+		voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(mins, mins + size - 1));
+		for (int x = 0; x < size; ++x) {
+			for (int z = 0; z < size; ++z) {
+				const int height = size / 2 + (x / 8 + z / 8) % 4;
+				for (int y = 0; y < height; ++y) {
+					volume->setVoxel(mins.x + x, mins.y + y, mins.z + z,
+									 voxel::createVoxel(voxel::VoxelType::Generic, 1 + (y / 4) % 3));
+				}
+			}
+		}
+		return volume;
+	}
+
+	void addNode(voxel::RawVolume *volume) {
+		_volumes.push_back(volume);
+		scenegraph::SceneGraphNode node;
+		node.setVolume(volume, false);
+		_sceneGraph.emplace(core::move(node));
+	}
+
+	void exportMesh(benchmark::State &state) {
+		voxelformat::STLFormat format;
+		voxelformat::SaveContext ctx;
+		int64_t bytes = 0;
+		for (auto _ : state) {
+			io::BufferedReadWriteStream stream;
+			if (!format.save(_sceneGraph, "benchmark.stl", stream, ctx)) {
+				state.SkipWithError("Failed to export the mesh");
+				break;
+			}
+			bytes = stream.size();
+		}
+		state.counters["bytes"] = (double)bytes;
+	}
+
+public:
+	void TearDown(::benchmark::State &state) override {
+		_sceneGraph.clear();
+		for (voxel::RawVolume *volume : _volumes) {
+			delete volume;
+		}
+		_volumes.clear();
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(MeshExportBenchmark, ManySmallNodes)(benchmark::State &state) {
+	const int nodes = (int)state.range(0);
+	for (int i = 0; i < nodes; ++i) {
+		addNode(createVolume(glm::ivec3(i * 16, 0, 0), 16));
+	}
+	exportMesh(state);
+}
+
+BENCHMARK_DEFINE_F(MeshExportBenchmark, OneHugeNode)(benchmark::State &state) {
+	addNode(createVolume(glm::ivec3(0), (int)state.range(0)));
+	exportMesh(state);
+}
+
+BENCHMARK_REGISTER_F(MeshExportBenchmark, ManySmallNodes)->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(MeshExportBenchmark, OneHugeNode)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
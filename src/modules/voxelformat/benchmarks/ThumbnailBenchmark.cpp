@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/SoftwareThumbnail.h"
+
+/**
+ * @brief Measures the thumbnails that are created on the cpu for voxconvert and the thumbnailer
+ */
+class ThumbnailBenchmark : public app::AbstractBenchmark {
+protected:
+	core::ScopedPtr<voxel::RawVolume> _volume;
+	scenegraph::SceneGraph _sceneGraph;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int size = (int)state.range(0);
+		_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		for (int x = 0; x < size; ++x) {
+			for (int z = 0; z < size; ++z) {
+				const int height = size / 4 + (x / 8 + z / 8) % 8;
+				for (int y = 0; y < height; ++y) {
+					_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + (y / 4) % 3));
+				}
+			}
+		}
+		scenegraph::SceneGraphNode node;
+		node.setVolume(_volume, false);
+		_sceneGraph.emplace(core::move(node));
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		_sceneGraph.clear();
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(ThumbnailBenchmark, Software)(benchmark::State &state) {
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(128);
+	for (auto _ : state) {
+		const image::ImagePtr &image = voxelformat::softwareThumbnail(_sceneGraph, ctx);
+		benchmark::DoNotOptimize(image);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(ThumbnailBenchmark, Software)->RangeMultiplier(2)->Range(32, 256)->Unit(benchmark::kMillisecond);
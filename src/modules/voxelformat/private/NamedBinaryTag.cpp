@@ -260,7 +260,7 @@ bool NamedBinaryTag::writeType(io::WriteStream &stream, const NamedBinaryTag &ta
 			return false;
 		}
 		for (size_t i = 0; i < length; i++) {
-			if (!stream.writeInt32((*tag.intArray())[i])) {
+			if (!stream.writeInt32BE((*tag.intArray())[i])) {
 				return false;
 			}
 		}
@@ -272,7 +272,7 @@ bool NamedBinaryTag::writeType(io::WriteStream &stream, const NamedBinaryTag &ta
 			return false;
 		}
 		for (size_t i = 0; i < length; i++) {
-			if (!stream.writeInt64((*tag.longArray())[i])) {
+			if (!stream.writeInt64BE((*tag.longArray())[i])) {
 				return false;
 			}
 		}
@@ -406,7 +406,7 @@ NamedBinaryTag NamedBinaryTag::parseType(TagType type, NamedBinaryTagContext &ct
 		bool error = false;
 		array.append(length, [&ctx, &error] (int i) {
 			int32_t val;
-			if (ctx.stream->readInt32(val) != 0) {
+			if (ctx.stream->readInt32BE(val) != 0) {
 				error = true;
 			}
 			return val;
@@ -423,7 +423,7 @@ NamedBinaryTag NamedBinaryTag::parseType(TagType type, NamedBinaryTagContext &ct
 		bool error = false;
 		array.append(length, [&ctx, &error] (int i) {
 			int64_t val;
-			if (ctx.stream->readInt64(val) != 0) {
+			if (ctx.stream->readInt64BE(val) != 0) {
 				error = true;
 			}
 			return val;
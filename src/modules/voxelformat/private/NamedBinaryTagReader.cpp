@@ -0,0 +1,456 @@
+/**
+ * @file
+ */
+
+#include "NamedBinaryTagReader.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "io/ZipReadStream.h"
+#include <SDL_endian.h>
+
+namespace voxelformat {
+
+namespace priv {
+
+static constexpr int MaxLevel = 512;
+
+static inline uint16_t readBE16(const uint8_t *data) {
+	uint16_t val;
+	core_memcpy(&val, data, sizeof(val));
+	return SDL_SwapBE16(val);
+}
+
+static inline uint32_t readBE32(const uint8_t *data) {
+	uint32_t val;
+	core_memcpy(&val, data, sizeof(val));
+	return SDL_SwapBE32(val);
+}
+
+static inline uint64_t readBE64(const uint8_t *data) {
+	uint64_t val;
+	core_memcpy(&val, data, sizeof(val));
+	return SDL_SwapBE64(val);
+}
+
+/**
+ * @return The size of the payload for primitive types or @c 0 for types with variable size
+ */
+static inline size_t fixedSize(TagType type) {
+	switch (type) {
+	case TagType::BYTE:
+		return 1u;
+	case TagType::SHORT:
+		return 2u;
+	case TagType::INT:
+	case TagType::FLOAT:
+		return 4u;
+	case TagType::LONG:
+	case TagType::DOUBLE:
+		return 8u;
+	default:
+		return 0u;
+	}
+}
+
+static inline size_t arrayElementSize(TagType type) {
+	switch (type) {
+	case TagType::BYTE_ARRAY:
+		return 1u;
+	case TagType::INT_ARRAY:
+		return 4u;
+	case TagType::LONG_ARRAY:
+		return 8u;
+	default:
+		return 0u;
+	}
+}
+
+NamedBinaryTagView::NamedBinaryTagView(TagType type, const uint8_t *data, const uint8_t *end, const char *name,
+									   uint16_t nameLength)
+	: _data(data), _end(end), _name(name), _nameLength(nameLength), _tagType(type) {
+}
+
+const uint8_t *NamedBinaryTagView::skip(TagType type, const uint8_t *data, const uint8_t *end, int level) {
+	if (data == nullptr || data > end || level > MaxLevel) {
+		return nullptr;
+	}
+	const size_t available = (size_t)(end - data);
+	const size_t size = fixedSize(type);
+	if (size > 0u) {
+		return available >= size ? data + size : nullptr;
+	}
+	switch (type) {
+	case TagType::BYTE_ARRAY:
+	case TagType::INT_ARRAY:
+	case TagType::LONG_ARRAY: {
+		if (available < 4u) {
+			return nullptr;
+		}
+		const uint64_t bytes = 4u + (uint64_t)readBE32(data) * arrayElementSize(type);
+		return bytes <= available ? data + bytes : nullptr;
+	}
+	case TagType::STRING: {
+		if (available < 2u) {
+			return nullptr;
+		}
+		const size_t bytes = 2u + readBE16(data);
+		return bytes <= available ? data + bytes : nullptr;
+	}
+	case TagType::LIST: {
+		if (available < 5u) {
+			return nullptr;
+		}
+		const TagType listType = (TagType)data[0];
+		const uint32_t entries = readBE32(data + 1);
+		const uint8_t *pos = data + 5;
+		if (entries == 0u) {
+			return pos;
+		}
+		const size_t entrySize = fixedSize(listType);
+		if (entrySize > 0u) {
+			const uint64_t bytes = (uint64_t)entries * entrySize;
+			return bytes <= (uint64_t)(end - pos) ? pos + bytes : nullptr;
+		}
+		if (listType == TagType::END || listType >= TagType::MAX) {
+			return nullptr;
+		}
+		for (uint32_t i = 0u; i < entries; ++i) {
+			pos = skip(listType, pos, end, level + 1);
+			if (pos == nullptr) {
+				return nullptr;
+			}
+		}
+		return pos;
+	}
+	case TagType::COMPOUND: {
+		const uint8_t *pos = data;
+		for (;;) {
+			if (pos >= end) {
+				return nullptr;
+			}
+			const TagType memberType = (TagType)*pos++;
+			if (memberType == TagType::END) {
+				return pos;
+			}
+			if (memberType >= TagType::MAX || end - pos < 2) {
+				return nullptr;
+			}
+			const uint16_t nameLength = readBE16(pos);
+			pos += 2;
+			if ((size_t)(end - pos) < nameLength) {
+				return nullptr;
+			}
+			pos = skip(memberType, pos + nameLength, end, level + 1);
+			if (pos == nullptr) {
+				return nullptr;
+			}
+		}
+	}
+	default:
+		return nullptr;
+	}
+}
+
+uint32_t NamedBinaryTagView::arrayLength() const {
+	return readBE32(_data);
+}
+
+core::String NamedBinaryTagView::name() const {
+	if (_name == nullptr) {
+		return "";
+	}
+	return core::String(_name, _nameLength);
+}
+
+bool NamedBinaryTagView::isName(const char *name) const {
+	const size_t length = SDL_strlen(name);
+	if (length != _nameLength) {
+		return false;
+	}
+	return length == 0u || core_memcmp(_name, name, length) == 0;
+}
+
+int8_t NamedBinaryTagView::int8(int8_t defaultVal) const {
+	if (_tagType != TagType::BYTE) {
+		return defaultVal;
+	}
+	return (int8_t)_data[0];
+}
+
+int16_t NamedBinaryTagView::int16(int16_t defaultVal) const {
+	if (_tagType != TagType::SHORT) {
+		return defaultVal;
+	}
+	return (int16_t)readBE16(_data);
+}
+
+int32_t NamedBinaryTagView::int32(int32_t defaultVal) const {
+	if (_tagType != TagType::INT) {
+		return defaultVal;
+	}
+	return (int32_t)readBE32(_data);
+}
+
+int64_t NamedBinaryTagView::int64(int64_t defaultVal) const {
+	if (_tagType != TagType::LONG) {
+		return defaultVal;
+	}
+	return (int64_t)readBE64(_data);
+}
+
+float NamedBinaryTagView::float32(float defaultVal) const {
+	if (_tagType != TagType::FLOAT) {
+		return defaultVal;
+	}
+	const uint32_t bits = readBE32(_data);
+	float val;
+	core_memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+double NamedBinaryTagView::float64(double defaultVal) const {
+	if (_tagType != TagType::DOUBLE) {
+		return defaultVal;
+	}
+	const uint64_t bits = readBE64(_data);
+	double val;
+	core_memcpy(&val, &bits, sizeof(val));
+	return val;
+}
+
+core::String NamedBinaryTagView::string() const {
+	if (_tagType != TagType::STRING) {
+		return "";
+	}
+	return core::String((const char *)_data + 2, readBE16(_data));
+}
+
+uint32_t NamedBinaryTagView::size() const {
+	switch (_tagType) {
+	case TagType::BYTE_ARRAY:
+	case TagType::INT_ARRAY:
+	case TagType::LONG_ARRAY:
+		return arrayLength();
+	case TagType::LIST:
+		return readBE32(_data + 1);
+	case TagType::STRING:
+		return readBE16(_data);
+	case TagType::COMPOUND: {
+		uint32_t n = 0u;
+		for (Iterator iter = begin(); iter != end(); ++iter) {
+			++n;
+		}
+		return n;
+	}
+	default:
+		return 0u;
+	}
+}
+
+const int8_t *NamedBinaryTagView::byteArray() const {
+	if (_tagType != TagType::BYTE_ARRAY) {
+		return nullptr;
+	}
+	return (const int8_t *)(_data + 4);
+}
+
+int8_t NamedBinaryTagView::byteAt(uint32_t idx) const {
+	if (_tagType != TagType::BYTE_ARRAY || idx >= arrayLength()) {
+		return 0;
+	}
+	return (int8_t)_data[4 + idx];
+}
+
+int32_t NamedBinaryTagView::intAt(uint32_t idx) const {
+	if (_tagType != TagType::INT_ARRAY || idx >= arrayLength()) {
+		return 0;
+	}
+	return (int32_t)readBE32(_data + 4 + (size_t)idx * 4u);
+}
+
+int64_t NamedBinaryTagView::longAt(uint32_t idx) const {
+	if (_tagType != TagType::LONG_ARRAY || idx >= arrayLength()) {
+		return 0;
+	}
+	return (int64_t)readBE64(_data + 4 + (size_t)idx * 8u);
+}
+
+TagType NamedBinaryTagView::listType() const {
+	if (_tagType != TagType::LIST) {
+		return TagType::MAX;
+	}
+	return (TagType)_data[0];
+}
+
+NamedBinaryTagView NamedBinaryTagView::at(uint32_t idx) const {
+	if (_tagType != TagType::LIST || idx >= size()) {
+		return NamedBinaryTagView();
+	}
+	const TagType type = listType();
+	const size_t entrySize = fixedSize(type);
+	if (entrySize > 0u) {
+		const uint8_t *data = _data + 5 + (size_t)idx * entrySize;
+		return NamedBinaryTagView(type, data, data + entrySize);
+	}
+	Iterator iter = begin();
+	for (uint32_t i = 0u; i < idx && iter != end(); ++i) {
+		++iter;
+	}
+	if (iter == end()) {
+		return NamedBinaryTagView();
+	}
+	return *iter;
+}
+
+NamedBinaryTagView NamedBinaryTagView::get(const char *name) const {
+	if (_tagType != TagType::COMPOUND) {
+		return NamedBinaryTagView();
+	}
+	for (const NamedBinaryTagView &member : *this) {
+		if (member.isName(name)) {
+			return member;
+		}
+	}
+	return NamedBinaryTagView();
+}
+
+NamedBinaryTagView::Iterator NamedBinaryTagView::begin() const {
+	if (_tagType == TagType::COMPOUND) {
+		return Iterator(_data, _end, TagType::MAX, 0u);
+	}
+	if (_tagType == TagType::LIST) {
+		return Iterator(_data + 5, _end, listType(), size());
+	}
+	return end();
+}
+
+NamedBinaryTagView::Iterator NamedBinaryTagView::end() const {
+	return Iterator();
+}
+
+NamedBinaryTagView::Iterator::Iterator(const uint8_t *pos, const uint8_t *end, TagType listType, uint32_t entries)
+	: _pos(pos), _end(end), _listType(listType), _remaining(entries) {
+	load();
+}
+
+void NamedBinaryTagView::Iterator::load() {
+	if (_pos == nullptr || _pos >= _end) {
+		_pos = nullptr;
+		return;
+	}
+	if (_listType != TagType::MAX) {
+		if (_remaining == 0u) {
+			_pos = nullptr;
+			return;
+		}
+		_next = skip(_listType, _pos, _end);
+		if (_next == nullptr) {
+			_pos = nullptr;
+			return;
+		}
+		_current = NamedBinaryTagView(_listType, _pos, _next);
+		return;
+	}
+
+	const TagType type = (TagType)_pos[0];
+	if (type == TagType::END || type >= TagType::MAX || _end - _pos < 3) {
+		_pos = nullptr;
+		return;
+	}
+	const uint16_t nameLength = readBE16(_pos + 1);
+	const char *name = (const char *)_pos + 3;
+	const uint8_t *payload = _pos + 3 + nameLength;
+	_next = skip(type, payload, _end);
+	if (_next == nullptr) {
+		_pos = nullptr;
+		return;
+	}
+	_current = NamedBinaryTagView(type, payload, _next, name, nameLength);
+}
+
+NamedBinaryTagView::Iterator &NamedBinaryTagView::Iterator::operator++() {
+	if (_pos == nullptr) {
+		return *this;
+	}
+	if (_listType != TagType::MAX) {
+		--_remaining;
+	}
+	_pos = _next;
+	load();
+	return *this;
+}
+
+NamedBinaryTagReader::~NamedBinaryTagReader() {
+	core_free(_buffer);
+}
+
+bool NamedBinaryTagReader::read(io::ZipReadStream &stream) {
+	core_free(_buffer);
+	_buffer = nullptr;
+	_size = 0u;
+	size_t capacity = 0u;
+	for (;;) {
+		if (_size == capacity) {
+			capacity = core_max(capacity * 2u, (size_t)64u * 1024u);
+			uint8_t *buffer = (uint8_t *)core_realloc(_buffer, capacity);
+			if (buffer == nullptr) {
+				Log::error("Failed to allocate %i bytes for the nbt data", (int)capacity);
+				return false;
+			}
+			_buffer = buffer;
+		}
+		const size_t requested = capacity - _size;
+		const int n = stream.readSome(_buffer + _size, requested);
+		if (n < 0) {
+			Log::error("Failed to read the nbt data");
+			return false;
+		}
+		_size += (size_t)n;
+		if ((size_t)n < requested || stream.eos()) {
+			break;
+		}
+	}
+	return true;
+}
+
+bool NamedBinaryTagReader::read(io::SeekableReadStream &stream) {
+	core_free(_buffer);
+	_buffer = nullptr;
+	_size = 0u;
+	const int64_t remaining = stream.remaining();
+	if (remaining <= 0) {
+		return true;
+	}
+	_buffer = (uint8_t *)core_malloc((size_t)remaining);
+	if (_buffer == nullptr) {
+		Log::error("Failed to allocate %i bytes for the nbt data", (int)remaining);
+		return false;
+	}
+	if (stream.read(_buffer, (size_t)remaining) != (int)remaining) {
+		Log::error("Failed to read the nbt data");
+		return false;
+	}
+	_size = (size_t)remaining;
+	return true;
+}
+
+NamedBinaryTagView NamedBinaryTagReader::root() const {
+	if (_size < 3u || (TagType)_buffer[0] != TagType::COMPOUND) {
+		return NamedBinaryTagView();
+	}
+	const uint16_t nameLength = readBE16(_buffer + 1);
+	if (3u + (size_t)nameLength > _size) {
+		return NamedBinaryTagView();
+	}
+	const uint8_t *payload = _buffer + 3 + nameLength;
+	const uint8_t *end = NamedBinaryTagView::skip(TagType::COMPOUND, payload, _buffer + _size);
+	if (end == nullptr) {
+		Log::error("Invalid nbt structure");
+		return NamedBinaryTagView();
+	}
+	return NamedBinaryTagView(TagType::COMPOUND, payload, end, (const char *)_buffer + 3, nameLength);
+}
+
+} // namespace priv
+} // namespace voxelformat
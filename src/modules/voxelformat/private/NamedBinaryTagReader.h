@@ -0,0 +1,193 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NamedBinaryTag.h"
+#include "core/String.h"
+#include "io/Stream.h"
+#include <stdint.h>
+
+namespace io {
+class ZipReadStream;
+}
+
+namespace voxelformat {
+
+namespace priv {
+
+/**
+ * @brief Read only access to a tag in the uncompressed nbt data of a @c NamedBinaryTagReader
+ *
+ * Nothing is copied or allocated. Strings and arrays are views into the buffer and the big endian values are
+ * converted on access. Compound members and list entries are found by skipping over the payload of the tags in
+ * front of them - subtrees that are never asked for are never materialized.
+ *
+ * @note A view is only valid as long as the @c NamedBinaryTagReader that owns the buffer is alive
+ * @sa NamedBinaryTag for building and writing nbt data
+ */
+class NamedBinaryTagView {
+private:
+	const uint8_t *_data = nullptr;
+	const uint8_t *_end = nullptr;
+	const char *_name = nullptr;
+	uint16_t _nameLength = 0u;
+	TagType _tagType = TagType::MAX;
+
+	uint32_t arrayLength() const;
+
+public:
+	class Iterator;
+
+	NamedBinaryTagView() {
+	}
+	NamedBinaryTagView(TagType type, const uint8_t *data, const uint8_t *end, const char *name = nullptr,
+					   uint16_t nameLength = 0u);
+
+	/**
+	 * @return Pointer behind the payload of the given tag or @c nullptr if the data is invalid or exceeds @c end
+	 */
+	static const uint8_t *skip(TagType type, const uint8_t *data, const uint8_t *end, int level = 0);
+
+	inline bool valid() const {
+		return _tagType != TagType::MAX;
+	}
+
+	inline TagType type() const {
+		return _tagType;
+	}
+
+	/**
+	 * @return The name of the tag if it is a compound member - an empty string otherwise
+	 */
+	core::String name() const;
+	bool isName(const char *name) const;
+
+	int8_t int8(int8_t defaultVal = 0) const;
+	int16_t int16(int16_t defaultVal = 0) const;
+	int32_t int32(int32_t defaultVal = 0) const;
+	int64_t int64(int64_t defaultVal = 0) const;
+	float float32(float defaultVal = 0.0f) const;
+	double float64(double defaultVal = 0.0) const;
+
+	/**
+	 * @return A copy of the string - or an empty string if the tag is no string
+	 */
+	core::String string() const;
+
+	/**
+	 * @return The amount of entries for lists and arrays, the amount of members for compounds and the
+	 * length of strings
+	 */
+	uint32_t size() const;
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	/**
+	 * @return The raw bytes of a byte array or @c nullptr
+	 */
+	const int8_t *byteArray() const;
+	int8_t byteAt(uint32_t idx) const;
+	int32_t intAt(uint32_t idx) const;
+	int64_t longAt(uint32_t idx) const;
+
+	/**
+	 * @return The type of the list entries or @c TagType::MAX if this is no list
+	 */
+	TagType listType() const;
+	/**
+	 * @return The list entry at the given index
+	 */
+	NamedBinaryTagView at(uint32_t idx) const;
+	/**
+	 * @return The member of the compound with the given name - the returned tag is invalid if no such member exists
+	 */
+	NamedBinaryTagView get(const char *name) const;
+
+	Iterator begin() const;
+	Iterator end() const;
+};
+
+/**
+ * @brief Iterates the members of a compound or the entries of a list
+ */
+class NamedBinaryTagView::Iterator {
+private:
+	const uint8_t *_pos = nullptr;
+	const uint8_t *_next = nullptr;
+	const uint8_t *_end = nullptr;
+	// TagType::MAX for the members of a compound
+	TagType _listType = TagType::MAX;
+	uint32_t _remaining = 0u;
+	NamedBinaryTagView _current;
+
+	void load();
+
+public:
+	Iterator() {
+	}
+	Iterator(const uint8_t *pos, const uint8_t *end, TagType listType, uint32_t entries);
+
+	inline const NamedBinaryTagView &operator*() const {
+		return _current;
+	}
+
+	inline const NamedBinaryTagView *operator->() const {
+		return &_current;
+	}
+
+	Iterator &operator++();
+
+	inline bool operator==(const Iterator &rhs) const {
+		return _pos == rhs._pos;
+	}
+
+	inline bool operator!=(const Iterator &rhs) const {
+		return _pos != rhs._pos;
+	}
+};
+
+/**
+ * @brief Reads the whole uncompressed nbt data into one buffer that all @c NamedBinaryTagView instances point into
+ *
+ * This is the only allocation that is needed to access the nbt data - no tree is built.
+ */
+class NamedBinaryTagReader {
+private:
+	uint8_t *_buffer = nullptr;
+	size_t _size = 0u;
+
+public:
+	NamedBinaryTagReader() {
+	}
+	~NamedBinaryTagReader();
+	NamedBinaryTagReader(const NamedBinaryTagReader &) = delete;
+	NamedBinaryTagReader &operator=(const NamedBinaryTagReader &) = delete;
+
+	/**
+	 * @brief Inflates the given stream until its end
+	 */
+	bool read(io::ZipReadStream &stream);
+	/**
+	 * @brief Reads the remaining uncompressed data of the given stream
+	 */
+	bool read(io::SeekableReadStream &stream);
+
+	/**
+	 * @return The root compound tag - invalid if the data is not a valid nbt structure
+	 */
+	NamedBinaryTagView root() const;
+
+	inline const uint8_t *buffer() const {
+		return _buffer;
+	}
+
+	inline size_t size() const {
+		return _size;
+	}
+};
+
+} // namespace priv
+} // namespace voxelformat
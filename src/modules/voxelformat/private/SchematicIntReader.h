@@ -4,21 +4,22 @@
 
 #pragma once
 
-#include "core/collection/DynamicArray.h"
+#include <stdint.h>
 
 namespace voxelformat {
 
 class SchematicIntReader {
 private:
-	const core::DynamicArray<int8_t> *_blocks;
+	const int8_t *_blocks;
+	const int _size;
 	int _index = 0;
 
 public:
-	SchematicIntReader(const core::DynamicArray<int8_t> *blocks) : _blocks(blocks) {
+	SchematicIntReader(const int8_t *blocks, int size) : _blocks(blocks), _size(size) {
 	}
 
 	bool eos() const {
-		if (_index >= (int)_blocks->size()) {
+		if (_index >= _size) {
 			return true;
 		}
 		return false;
@@ -30,10 +31,10 @@ public:
 		}
 		int value = 0;
 		for (int bitsRead = 0;; bitsRead += 7) {
-			if (_index >= (int)_blocks->size()) {
+			if (_index >= _size) {
 				return -1;
 			}
-			uint8_t next = (*_blocks)[_index];
+			uint8_t next = (uint8_t)_blocks[_index];
 			_index++;
 			value |= (next & 0x7F) << bitsRead;
 			if (bitsRead > 7 * 5) {
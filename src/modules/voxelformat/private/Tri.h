@@ -37,6 +37,20 @@ struct Tri {
 	glm::ivec3 roundedMins() const;
 	glm::ivec3 roundedMaxs() const;
 	core::RGBA colorAt(const glm::vec2 &uv) const;
+	/**
+	 * @return The color at the given barycentric coordinates. For textured triangles the uv coordinates are
+	 * interpolated, the vertex colors otherwise.
+	 */
+	core::RGBA colorAtBarycentric(const glm::vec3 &barycentric) const;
+	/**
+	 * @return The barycentric coordinates of the point on the triangle that is closest to the given position
+	 */
+	glm::vec3 closestPointBarycentric(const glm::vec3 &pos) const;
+	/**
+	 * @brief Separating axis test (Akenine-Möller) of the triangle against an axis aligned box
+	 * @note Touching boxes are counted as intersecting
+	 */
+	bool intersectsBox(const glm::vec3 &center, const glm::vec3 &halfSize) const;
 
 	// Sierpinski gasket with keeping the middle
 	void subdivide(Tri out[4]) const;
@@ -5,8 +5,12 @@
 #include "voxelformat/GLTFFormat.h"
 #include "AbstractVoxFormatTest.h"
 #include "io/File.h"
-#include "voxelformat/QBFormat.h"
 #include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/QBFormat.h"
 
 namespace voxelformat {
 
@@ -29,6 +33,43 @@ TEST_F(GLTFFormatTest, testExportMesh) {
 	EXPECT_TRUE(f.saveGroups(sceneGraph, outFilename, outStream, testSaveCtx));
 }
 
+TEST_F(GLTFFormatTest, testExportMeshStreamed) {
+	// several extraction chunks - they end up as primitives of the same mesh in the external buffer
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 99, 3, 69));
+	const voxel::Region &region = volume.region();
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			volume.setVoxel(x, (x + z) % 4, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	{
+		scenegraph::SceneGraphNode node;
+		node.setVolume(&volume, false);
+		sceneGraph.emplace(core::move(node));
+	}
+	// the glb file is written from the merged meshes
+	voxel::Region regions[2];
+	const char *filenames[] = {"exportstreamed.gltf", "exportstreamed.glb"};
+	for (int i = 0; i < 2; ++i) {
+		GLTFFormat f;
+		const core::String filename = filenames[i];
+		{
+			const io::FilePtr &outFile = open(filename, io::FileMode::SysWrite);
+			io::FileStream outStream(outFile);
+			ASSERT_TRUE(f.saveGroups(sceneGraph, filename, outStream, testSaveCtx));
+		}
+		const io::FilePtr &file = open(filename, io::FileMode::SysRead);
+		io::FileStream stream(file);
+		scenegraph::SceneGraph loadedSceneGraph;
+		ASSERT_TRUE(f.loadGroups(filename, stream, loadedSceneGraph, testLoadCtx));
+		ASSERT_EQ(1u, loadedSceneGraph.size());
+		regions[i] = (*loadedSceneGraph.begin(scenegraph::SceneGraphNodeType::Model)).region();
+	}
+	EXPECT_TRUE(io::filesystem()->exists("exportstreamed.bin"));
+	EXPECT_EQ(regions[1], regions[0]);
+}
+
 TEST_F(GLTFFormatTest, testImportAnimation) {
 	GLTFFormat f;
 	const core::String filename = "glTF/BoxAnimated.glb";
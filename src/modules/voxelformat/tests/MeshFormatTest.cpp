@@ -4,9 +4,14 @@
 
 #include "voxelformat/MeshFormat.h"
 #include "core/Color.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
 #include "core/tests/TestColorHelper.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/File.h"
 #include "video/ShapeBuilder.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraph.h"
@@ -18,16 +23,6 @@ namespace voxelformat {
 
 class MeshFormatTest : public AbstractVoxFormatTest {};
 
-TEST_F(MeshFormatTest, testSubdivide) {
-	MeshFormat::TriCollection tinyTris;
-	Tri tri;
-	tri.vertices[0] = glm::vec3(-8.77272797, -11.43335, -0.154544264);
-	tri.vertices[1] = glm::vec3(-8.77272701, 11.1000004, -0.154543981);
-	tri.vertices[2] = glm::vec3(8.77272701, 11.1000004, -0.154543981);
-	MeshFormat::subdivideTri(tri, tinyTris);
-	EXPECT_EQ(1024u, tinyTris.size());
-}
-
 TEST_F(MeshFormatTest, testLookupTexture) {
 	EXPECT_NE(MeshFormat::lookupTexture("glTF/cube/chr_knight.gox", "glTF/cube/Cube_BaseColor.png"), "");
 	EXPECT_NE(MeshFormat::lookupTexture("glTF/cube/chr_knight.gox", "Cube_BaseColor.png"), "");
@@ -151,4 +146,216 @@ TEST_F(MeshFormatTest, testVoxelizeColor) {
 	EXPECT_COLOR_NEAR(nipponGreen, paletteColors[v->voxel(size, size, size).getColor()], 0.00065f);
 }
 
+TEST_F(MeshFormatTest, testVoxelizeTilted) {
+	class TestMesh : public MeshFormat {
+	public:
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &, const core::String &,
+						io::SeekableWriteStream &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+		int voxelize(scenegraph::SceneGraph &sceneGraph, const MeshFormat::TriCollection &tris) {
+			return voxelizeNode("test", sceneGraph, tris, 0, false);
+		}
+	};
+
+	// enough triangles to be rasterized in several batches - a tilted quad strip along the x axis
+	MeshFormat::TriCollection tris;
+	const int segments = 10000;
+	const float segmentSize = 0.004f;
+	for (int i = 0; i < segments; ++i) {
+		const float x0 = (float)i * segmentSize;
+		const float x1 = (float)(i + 1) * segmentSize;
+		const glm::vec3 bottom0(x0, x0 * 0.5f, 0.0f);
+		const glm::vec3 bottom1(x1, x1 * 0.5f, 0.0f);
+		const glm::vec3 up(0.0f, 20.0f, 20.0f);
+		Tri tri;
+		tri.color[0] = tri.color[1] = tri.color[2] = core::RGBA(255, 0, 0);
+		tri.vertices[0] = bottom0;
+		tri.vertices[1] = bottom1;
+		tri.vertices[2] = bottom1 + up;
+		tris.push_back(tri);
+		tri.vertices[1] = bottom1 + up;
+		tri.vertices[2] = bottom0 + up;
+		tris.push_back(tri);
+	}
+	ASSERT_FALSE(MeshFormat::isVoxelMesh(tris));
+
+	TestMesh mesh;
+	scenegraph::SceneGraph sceneGraph;
+	const int nodeId = mesh.voxelize(sceneGraph, tris);
+	ASSERT_NE(InvalidNodeId, nodeId);
+	const voxel::RawVolume *v = sceneGraph.node(nodeId).volume();
+	ASSERT_NE(nullptr, v);
+
+	// the voxels must touch the plane of the strip
+	const glm::vec3 normal = glm::normalize(tris[0].normal());
+	const voxel::Region &region = v->region();
+	int voxels = 0;
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				if (voxel::isAir(v->voxel(x, y, z).getMaterial())) {
+					continue;
+				}
+				const float distance = glm::abs(glm::dot(glm::vec3(x, y, z) - tris[0].vertices[0], normal));
+				EXPECT_LE(distance, 0.87f) << x << ":" << y << ":" << z;
+				++voxels;
+			}
+		}
+	}
+	EXPECT_GT(voxels, 0);
+
+	// no holes - every voxel center inside the strip is set
+	for (int x = 1; x < (int)(segments * segmentSize); ++x) {
+		for (int z = 1; z < 20; ++z) {
+			const int y = (int)glm::round((float)x * 0.5f + (float)z);
+			EXPECT_FALSE(voxel::isAir(v->voxel(x, y, z).getMaterial())) << x << ":" << y << ":" << z;
+		}
+	}
+}
+
+TEST_F(MeshFormatTest, testSaveGroupsChunked) {
+	// sums up the vertex positions and counts the triangles of the opaque meshes
+	class TestMesh : public MeshFormat {
+	public:
+		glm::dvec4 sum{0.0};
+		int meshes = 0;
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &meshExts,
+						const core::String &, io::SeekableWriteStream &, const glm::vec3 &, bool, bool, bool) override {
+			for (const MeshExt &meshExt : meshExts) {
+				sum += sumMesh(meshExt.mesh->mesh[0]);
+				++meshes;
+			}
+			return true;
+		}
+		static glm::dvec4 sumMesh(const voxel::Mesh &mesh) {
+			glm::dvec4 s(0.0);
+			const glm::dvec3 offset(mesh.getOffset());
+			for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+				for (size_t j = i; j < i + 3; ++j) {
+					s += glm::dvec4(glm::dvec3(mesh.getVertex(mesh.getIndex(j)).position) + offset, 0.0);
+				}
+				s.w += 1.0;
+			}
+			return s;
+		}
+	};
+
+	core::Var::getSafe(cfg::VoxformatMergequads)->setVal(false);
+	core::Var::getSafe(cfg::VoxformatMarchingCubes)->setVal(false);
+
+	// big enough to get split into several extraction chunks
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-3, 0, 1), glm::ivec3(96, 9, 70)));
+	const voxel::Region &region = volume.region();
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				if ((x * 7 + y * 13 + z * 3) % 5 != 0) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + (x + z) % 3));
+				}
+			}
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node;
+	node.setVolume(&volume, false);
+	sceneGraph.emplace(core::move(node));
+
+	TestMesh mesh;
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(mesh.saveGroups(sceneGraph, "test", stream, testSaveCtx));
+	EXPECT_EQ(1, mesh.meshes);
+
+	voxel::Region extractRegion = region;
+	extractRegion.shiftUpperCorner(1, 1, 1);
+	voxel::ChunkMesh expected;
+	voxel::extractCubicMesh(&volume, extractRegion, &expected, glm::ivec3(0), false, true, true, false);
+	const glm::dvec4 expectedSum = TestMesh::sumMesh(expected.mesh[0]);
+	EXPECT_GT(expectedSum.w, 0.0);
+	EXPECT_EQ(expectedSum, mesh.sum);
+}
+
+TEST_F(MeshFormatTest, testSaveGroupsStreamed) {
+	// sums up the vertex positions and counts the triangles of the opaque meshes of every chunk
+	class TestMesh : public MeshFormat {
+	public:
+		glm::dvec4 sum{0.0};
+		glm::dvec3 offset{0.0};
+		int begin = 0;
+		int chunks = 0;
+		int end = 0;
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &,
+						const core::String &, io::SeekableWriteStream &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+		bool supportsMeshStream(const core::String &) const override {
+			return true;
+		}
+		bool beginMeshStream(MeshStream &) override {
+			++begin;
+			return true;
+		}
+		bool writeMeshChunk(MeshStream &meshStream, const MeshExt &chunk) override {
+			const voxel::Mesh &mesh = chunk.mesh->mesh[0];
+			for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+				for (size_t j = i; j < i + 3; ++j) {
+					sum += glm::dvec4(glm::dvec3(mesh.getVertex(mesh.getIndex(j)).position) + offset, 0.0);
+				}
+				sum.w += 1.0;
+			}
+			meshStream.vertexOffset += (int)mesh.getNoOfVertices();
+			++chunks;
+			return true;
+		}
+		bool endMeshStream(MeshStream &) override {
+			++end;
+			return true;
+		}
+	};
+
+	core::Var::getSafe(cfg::VoxformatMergequads)->setVal(false);
+	core::Var::getSafe(cfg::VoxformatMarchingCubes)->setVal(false);
+
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-3, 0, 1), glm::ivec3(96, 9, 70)));
+	const voxel::Region &region = volume.region();
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				if ((x * 7 + y * 13 + z * 3) % 5 != 0) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + (x + z) % 3));
+				}
+			}
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node;
+	node.setVolume(&volume, false);
+	sceneGraph.emplace(core::move(node));
+
+	TestMesh mesh;
+	// the chunk vertices are relative to the lower corner of the node region
+	mesh.offset = glm::dvec3(region.getLowerCorner());
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(mesh.saveGroups(sceneGraph, "test", stream, testSaveCtx));
+	EXPECT_EQ(1, mesh.begin);
+	EXPECT_EQ(1, mesh.end);
+	EXPECT_EQ(4, mesh.chunks);
+
+	voxel::Region extractRegion = region;
+	extractRegion.shiftUpperCorner(1, 1, 1);
+	voxel::ChunkMesh expected;
+	voxel::extractCubicMesh(&volume, extractRegion, &expected, glm::ivec3(0), false, true, true, false);
+	const voxel::Mesh &expectedMesh = expected.mesh[0];
+	glm::dvec4 expectedSum(0.0);
+	const glm::dvec3 expectedOffset(expectedMesh.getOffset());
+	for (size_t i = 0; i < expectedMesh.getNoOfIndices(); i += 3) {
+		for (size_t j = i; j < i + 3; ++j) {
+			expectedSum += glm::dvec4(glm::dvec3(expectedMesh.getVertex(expectedMesh.getIndex(j)).position) + expectedOffset, 0.0);
+		}
+		expectedSum.w += 1.0;
+	}
+	EXPECT_GT(expectedSum.w, 0.0);
+	EXPECT_EQ(expectedSum, mesh.sum);
+}
+
 } // namespace voxelformat
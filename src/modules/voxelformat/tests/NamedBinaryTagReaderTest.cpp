@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/private/NamedBinaryTagReader.h"
+#include "app/tests/AbstractTest.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/ZipReadStream.h"
+#include "io/ZipWriteStream.h"
+
+namespace voxelformat {
+
+class NamedBinaryTagReaderTest : public app::AbstractTest {
+protected:
+	void writeTestData(io::WriteStream &stream) {
+		priv::NBTCompound section;
+		section.put("Y", priv::NamedBinaryTag((int8_t)-4));
+		section.put("Name", priv::NamedBinaryTag(core::String("minecraft:stone")));
+		core::DynamicArray<int64_t> blockStates;
+		blockStates.push_back(0x0123456789abcdefll);
+		blockStates.push_back(-2);
+		section.put("BlockStates", priv::NamedBinaryTag(core::move(blockStates)));
+
+		priv::NBTList sections;
+		sections.emplace_back(core::move(section));
+		priv::NBTCompound emptySection;
+		emptySection.put("Y", priv::NamedBinaryTag((int8_t)5));
+		sections.emplace_back(core::move(emptySection));
+
+		priv::NBTList positions;
+		positions.emplace_back(priv::NamedBinaryTag(1));
+		positions.emplace_back(priv::NamedBinaryTag(-2));
+		positions.emplace_back(priv::NamedBinaryTag(3));
+
+		priv::NBTCompound root;
+		root.put("DataVersion", priv::NamedBinaryTag(2844));
+		root.put("Scale", priv::NamedBinaryTag(0.5f));
+		root.put("sections", priv::NamedBinaryTag(core::move(sections)));
+		root.put("pos", priv::NamedBinaryTag(core::move(positions)));
+		const priv::NamedBinaryTag tag(core::move(root));
+		ASSERT_TRUE(priv::NamedBinaryTag::write(tag, "root", stream));
+	}
+};
+
+TEST_F(NamedBinaryTagReaderTest, testRead) {
+	io::BufferedReadWriteStream stream;
+	{
+		io::ZipWriteStream zipStream(stream);
+		writeTestData(zipStream);
+		ASSERT_TRUE(zipStream.flush());
+	}
+	stream.seek(0);
+	io::ZipReadStream zipStream(stream, (int)stream.size());
+	priv::NamedBinaryTagReader reader;
+	ASSERT_TRUE(reader.read(zipStream));
+	const priv::NamedBinaryTagView &root = reader.root();
+	ASSERT_TRUE(root.valid());
+	EXPECT_EQ("root", root.name());
+	EXPECT_EQ(4u, root.size());
+	EXPECT_EQ(2844, root.get("DataVersion").int32());
+	EXPECT_FLOAT_EQ(0.5f, root.get("Scale").float32());
+	EXPECT_FALSE(root.get("Missing").valid());
+	EXPECT_EQ(-1, root.get("DataVersion").int16(-1)) << "Expected the default value for a type mismatch";
+
+	const priv::NamedBinaryTagView &pos = root.get("pos");
+	ASSERT_EQ(priv::TagType::LIST, pos.type());
+	ASSERT_EQ(3u, pos.size());
+	EXPECT_EQ(1, pos.at(0).int32());
+	EXPECT_EQ(-2, pos.at(1).int32());
+	EXPECT_EQ(3, pos.at(2).int32());
+	EXPECT_FALSE(pos.at(3).valid());
+
+	const priv::NamedBinaryTagView &sections = root.get("sections");
+	ASSERT_EQ(priv::TagType::LIST, sections.type());
+	ASSERT_EQ(priv::TagType::COMPOUND, sections.listType());
+	ASSERT_EQ(2u, sections.size());
+	int n = 0;
+	for (const priv::NamedBinaryTagView &section : sections) {
+		ASSERT_EQ(priv::TagType::COMPOUND, section.type());
+		if (n == 0) {
+			EXPECT_EQ(-4, section.get("Y").int8());
+			EXPECT_EQ("minecraft:stone", section.get("Name").string());
+			const priv::NamedBinaryTagView &blockStates = section.get("BlockStates");
+			ASSERT_EQ(2u, blockStates.size());
+			EXPECT_EQ(0x0123456789abcdefll, blockStates.longAt(0));
+			EXPECT_EQ(-2, blockStates.longAt(1));
+			EXPECT_EQ(0, blockStates.longAt(2));
+		} else {
+			EXPECT_EQ(5, section.get("Y").int8());
+			EXPECT_FALSE(section.get("BlockStates").valid());
+		}
+		++n;
+	}
+	EXPECT_EQ(2, n);
+	EXPECT_EQ(5, sections.at(1).get("Y").int8());
+}
+
+TEST_F(NamedBinaryTagReaderTest, testTruncated) {
+	io::BufferedReadWriteStream stream;
+	writeTestData(stream);
+	// cut off the end tag of the root compound
+	const uint32_t size = (uint32_t)stream.size() - 1u;
+	stream.seek(0);
+	io::BufferedReadWriteStream truncated(stream, size);
+	truncated.seek(0);
+	priv::NamedBinaryTagReader reader;
+	ASSERT_TRUE(reader.read(truncated));
+	EXPECT_FALSE(reader.root().valid());
+}
+
+} // namespace voxelformat
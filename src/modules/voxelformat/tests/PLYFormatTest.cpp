@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/PLYFormat.h"
+#include "AbstractVoxFormatTest.h"
+#include "core/StringUtil.h"
+#include "core/collection/DynamicArray.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/Filesystem.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelformat {
+
+class PLYFormatTest : public AbstractVoxFormatTest {
+protected:
+	void testSaveCounts(int width, int depth, const core::String &filename) {
+		voxel::RawVolume volume(voxel::Region(0, 0, 0, width - 1, 3, depth - 1));
+		const voxel::Region &region = volume.region();
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				volume.setVoxel(x, (x + z) % 4, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+			}
+		}
+		scenegraph::SceneGraph sceneGraph;
+		scenegraph::SceneGraphNode node;
+		node.setVolume(&volume, false);
+		sceneGraph.emplace(core::move(node));
+
+		PLYFormat f;
+		io::BufferedReadWriteStream stream;
+		ASSERT_TRUE(f.saveGroups(sceneGraph, filename, stream, testSaveCtx));
+		const core::String content((const char *)stream.getBuffer(), (size_t)stream.size());
+		core::DynamicArray<core::String> lines;
+		core::string::splitString(content, lines, "\n");
+
+		int vertices = -1;
+		int faces = -1;
+		size_t body = 0;
+		for (size_t i = 0; i < lines.size(); ++i) {
+			if (core::string::startsWith(lines[i], "element vertex ")) {
+				vertices = core::string::toInt(lines[i].substr(15));
+			} else if (core::string::startsWith(lines[i], "element face ")) {
+				faces = core::string::toInt(lines[i].substr(13));
+			} else if (lines[i] == "end_header") {
+				body = i + 1;
+				break;
+			}
+		}
+		ASSERT_GT(vertices, 0);
+		ASSERT_GT(faces, 0);
+		ASSERT_EQ(body + (size_t)vertices + (size_t)faces, lines.size());
+		for (int i = 0; i < faces; ++i) {
+			const core::String &face = lines[body + vertices + i];
+			ASSERT_TRUE(core::string::startsWith(face, "3 ") || core::string::startsWith(face, "4 ")) << face.c_str();
+		}
+	}
+};
+
+TEST_F(PLYFormatTest, testSaveCounts) {
+	// several extraction chunks - the faces of all chunks follow the vertices
+	testSaveCounts(100, 70, "test.ply");
+}
+
+TEST_F(PLYFormatTest, testSaveCountsSpill) {
+	// enough faces to spill them into a file next to the target file
+	const core::String filename = "test-spill.ply";
+	testSaveCounts(256, 256, filename);
+	EXPECT_FALSE(io::filesystem()->exists(filename + ".faces"));
+}
+
+} // namespace voxelformat
@@ -3,18 +3,87 @@
  */
 
 #include "AbstractVoxFormatTest.h"
+#include "io/BufferedReadWriteStream.h"
+#include "voxel/RawVolume.h"
 #include "voxelformat/QBFormat.h"
 #include "voxelformat/VolumeFormat.h"
 
 namespace voxelformat {
 
 class QBFormatTest: public AbstractVoxFormatTest {
+protected:
+	// a 2x2x2 matrix without rle compression with two visible voxels
+	void writeUncompressed(io::SeekableWriteStream &stream) {
+		stream.writeUInt32(257);
+		stream.writeUInt32(0); // rgba
+		stream.writeUInt32(0); // left handed
+		stream.writeUInt32(0); // uncompressed
+		stream.writeUInt32(0);
+		stream.writeUInt32(1);
+		stream.writeUInt8(6);
+		stream.writeString("matrix", false);
+		for (int i = 0; i < 3; ++i) {
+			stream.writeUInt32(2);
+		}
+		for (int i = 0; i < 3; ++i) {
+			stream.writeInt32(0);
+		}
+		for (int i = 0; i < 8; ++i) {
+			const bool visible = i == 0 || i == 7;
+			stream.writeUInt8(i == 0 ? 255 : 0);
+			stream.writeUInt8(i == 7 ? 255 : 0);
+			stream.writeUInt8(0);
+			stream.writeUInt8(visible ? 255 : 0);
+		}
+	}
+
+	void checkUncompressed(const scenegraph::SceneGraph &sceneGraph) {
+		const scenegraph::SceneGraphNode *node = sceneGraph[0];
+		ASSERT_NE(nullptr, node);
+		const voxel::RawVolume *volume = node->volume();
+		ASSERT_EQ(voxel::Region(0, 1), volume->region());
+		EXPECT_FALSE(voxel::isAir(volume->voxel(0, 0, 0).getMaterial()));
+		EXPECT_FALSE(voxel::isAir(volume->voxel(1, 1, 1).getMaterial()));
+		EXPECT_TRUE(voxel::isAir(volume->voxel(1, 0, 0).getMaterial()));
+		EXPECT_TRUE(voxel::isAir(volume->voxel(0, 1, 1).getMaterial()));
+		const voxel::Palette &palette = node->palette();
+		EXPECT_EQ(core::RGBA(255, 0, 0), palette.color(volume->voxel(0, 0, 0).getColor()));
+		EXPECT_EQ(core::RGBA(0, 255, 0), palette.color(volume->voxel(1, 1, 1).getColor()));
+	}
+};
+
+// a stream that must be read with read() calls
+class NoDirectAccessStream : public io::BufferedReadWriteStream {
+public:
+	const uint8_t *data() const override {
+		return nullptr;
+	}
 };
 
 TEST_F(QBFormatTest, testLoad) {
 	canLoad("qubicle.qb", 10);
 }
 
+TEST_F(QBFormatTest, testLoadUncompressed) {
+	QBFormat f;
+	io::BufferedReadWriteStream stream;
+	writeUncompressed(stream);
+	stream.seek(0);
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(f.load("uncompressed.qb", stream, sceneGraph, testLoadCtx));
+	checkUncompressed(sceneGraph);
+}
+
+TEST_F(QBFormatTest, testLoadUncompressedNoDirectAccess) {
+	QBFormat f;
+	NoDirectAccessStream stream;
+	writeUncompressed(stream);
+	stream.seek(0);
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(f.load("uncompressed.qb", stream, sceneGraph, testLoadCtx));
+	checkUncompressed(sceneGraph);
+}
+
 TEST_F(QBFormatTest, testLoadRGB) {
 	testRGB("rgb.qb");
 }
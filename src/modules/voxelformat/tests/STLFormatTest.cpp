@@ -4,8 +4,12 @@
 
 #include "voxelformat/STLFormat.h"
 #include "AbstractVoxFormatTest.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/File.h"
 #include "io/FileStream.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
 
 namespace voxelformat {
 
@@ -31,4 +35,30 @@ TEST_F(STLFormatTest, testVoxelizeCube) {
 	EXPECT_TRUE(sceneGraph.size() > 0);
 }
 
+TEST_F(STLFormatTest, testSaveFaceCount) {
+	// several extraction chunks - the face count in the header is patched after the last chunk
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 99, 3, 69));
+	const voxel::Region &region = volume.region();
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			volume.setVoxel(x, (x + z) % 4, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node;
+	node.setVolume(&volume, false);
+	sceneGraph.emplace(core::move(node));
+
+	STLFormat f;
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(f.saveGroups(sceneGraph, "test.stl", stream, testSaveCtx));
+	// 80 bytes header, the face count and 50 bytes per face
+	ASSERT_GT(stream.size(), 84);
+	stream.seek(80);
+	uint32_t faces = 0;
+	ASSERT_EQ(0, stream.readUInt32(faces));
+	EXPECT_GT(faces, 0u);
+	EXPECT_EQ((int64_t)faces * 50 + 84, stream.size());
+}
+
 } // namespace voxel
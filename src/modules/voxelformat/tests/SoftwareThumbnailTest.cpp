@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/SoftwareThumbnail.h"
+#include "AbstractVoxFormatTest.h"
+#include "core/Color.h"
+#include "io/File.h"
+#include "io/FileStream.h"
+#include "voxelformat/VolumeFormat.h"
+
+namespace voxelformat {
+
+class SoftwareThumbnailTest : public AbstractVoxFormatTest {};
+
+TEST_F(SoftwareThumbnailTest, testEmptySceneGraph) {
+	scenegraph::SceneGraph sceneGraph;
+	ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(16, 8);
+	ctx.clearColor = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+	const image::ImagePtr &image = softwareThumbnail(sceneGraph, ctx);
+	ASSERT_TRUE(image);
+	EXPECT_EQ(16, image->width());
+	EXPECT_EQ(8, image->height());
+	EXPECT_EQ(core::RGBA(255, 0, 0, 255), image->colorAt(5, 5));
+}
+
+TEST_F(SoftwareThumbnailTest, testCube) {
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int z = 0; z < 8; ++z) {
+		for (int y = 0; y < 8; ++y) {
+			for (int x = 0; x < 8; ++x) {
+				volume.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node;
+	node.setVolume(&volume, false);
+	sceneGraph.emplace(core::move(node));
+
+	ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(64, 64);
+	ctx.clearColor = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f);
+	const image::ImagePtr &image = softwareThumbnail(sceneGraph, ctx);
+	ASSERT_TRUE(image);
+	const core::RGBA clearColor(255, 0, 255, 255);
+	EXPECT_EQ(clearColor, image->colorAt(0, 0));
+	EXPECT_EQ(clearColor, image->colorAt(63, 63));
+	// the top face in the upper half is lit brighter than the side faces in the lower half
+	const core::RGBA top = image->colorAt(32, 20);
+	const core::RGBA side = image->colorAt(24, 44);
+	EXPECT_NE(clearColor, top);
+	EXPECT_NE(clearColor, side);
+	EXPECT_GT((int)top.r + top.g + top.b, (int)side.r + side.g + side.b);
+}
+
+TEST_F(SoftwareThumbnailTest, testLoadedScene) {
+	io::FilePtr file = open("rgb.vox");
+	ASSERT_TRUE(file->validHandle());
+	io::FileStream stream(file);
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(loadFormat(file->name(), stream, sceneGraph, testLoadCtx));
+
+	ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(128, 128);
+	const image::ImagePtr &image = softwareThumbnail(sceneGraph, ctx);
+	ASSERT_TRUE(image);
+	// the model contains the letters R, G and B in their colors
+	int red = 0;
+	int green = 0;
+	int blue = 0;
+	for (int y = 0; y < image->height(); ++y) {
+		for (int x = 0; x < image->width(); ++x) {
+			const core::RGBA rgba = image->colorAt(x, y);
+			if (rgba.r > rgba.g + 32 && rgba.r > rgba.b + 32) {
+				++red;
+			} else if (rgba.g > rgba.r + 32 && rgba.g > rgba.b + 32) {
+				++green;
+			} else if (rgba.b > rgba.r + 32 && rgba.b > rgba.g + 32) {
+				++blue;
+			}
+		}
+	}
+	EXPECT_GT(red, 0);
+	EXPECT_GT(green, 0);
+	EXPECT_GT(blue, 0);
+}
+
+} // namespace voxelformat
@@ -39,6 +39,43 @@ TEST_F(TriTest, testFlat) {
 	EXPECT_FALSE(tri.flat()) << tri.normal().x << ":" << tri.normal().y << ":" << tri.normal().z;
 }
 
+TEST_F(TriTest, testIntersectsBox) {
+	Tri tri;
+	tri.vertices[0] = glm::vec3(0, 0, 0);
+	tri.vertices[1] = glm::vec3(10, 5, 0);
+	tri.vertices[2] = glm::vec3(0, 5, 10);
+	const glm::vec3 halfSize(0.5f);
+	EXPECT_TRUE(tri.intersectsBox(glm::vec3(0, 0, 0), halfSize));
+	EXPECT_TRUE(tri.intersectsBox(glm::vec3(2, 2, 2), halfSize));
+	// inside the aabb of the triangle - but above the plane
+	EXPECT_FALSE(tri.intersectsBox(glm::vec3(2, 4, 2), halfSize));
+	// close to the plane - but beyond the hypotenuse
+	EXPECT_FALSE(tri.intersectsBox(glm::vec3(8, 5, 8), halfSize));
+	EXPECT_FALSE(tri.intersectsBox(glm::vec3(-2, 0, 0), halfSize));
+}
+
+TEST_F(TriTest, testClosestPointBarycentric) {
+	Tri tri;
+	tri.vertices[0] = glm::vec3(0, 0, 0);
+	tri.vertices[1] = glm::vec3(10, 0, 0);
+	tri.vertices[2] = glm::vec3(0, 0, 10);
+	const glm::vec3 &v0 = tri.closestPointBarycentric(glm::vec3(-5, 3, -5));
+	EXPECT_FLOAT_EQ(1.0f, v0.x);
+	const glm::vec3 &inside = tri.closestPointBarycentric(glm::vec3(2, 3, 4));
+	EXPECT_FLOAT_EQ(0.4f, inside.x);
+	EXPECT_FLOAT_EQ(0.2f, inside.y);
+	EXPECT_FLOAT_EQ(0.4f, inside.z);
+	const glm::vec3 &edge = tri.closestPointBarycentric(glm::vec3(5, 0, -5));
+	EXPECT_FLOAT_EQ(0.5f, edge.x);
+	EXPECT_FLOAT_EQ(0.5f, edge.y);
+	EXPECT_FLOAT_EQ(0.0f, edge.z);
+
+	tri.color[0] = core::RGBA(255, 0, 0);
+	tri.color[1] = core::RGBA(0, 255, 0);
+	tri.color[2] = core::RGBA(0, 0, 255);
+	EXPECT_EQ(tri.color[1], tri.colorAtBarycentric(glm::vec3(0, 1, 0)));
+}
+
 TEST_F(TriTest, testColorAt) {
 	const image::ImagePtr &texture = image::loadImage("palette-nippon.png");
 	ASSERT_TRUE(texture);
@@ -3,11 +3,22 @@
  */
 
 #include "AbstractVoxFormatTest.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
 #include "voxelformat/VENGIFormat.h"
 
 namespace voxelformat {
 
-class VENGIFormatTest : public AbstractVoxFormatTest {};
+class VENGIFormatTest : public AbstractVoxFormatTest {
+protected:
+	using Super = AbstractVoxFormatTest;
+
+	void TearDown() override {
+		// also reset the cvar if one of the assertions of a test failed
+		core::Var::getSafe(cfg::VoxformatVENGIParallelZip)->setVal(false);
+		Super::TearDown();
+	}
+};
 
 TEST_F(VENGIFormatTest, testSaveSmallVolume) {
 	VENGIFormat f;
@@ -19,4 +30,11 @@ TEST_F(VENGIFormatTest, testSaveLoadVoxel) {
 	testSaveLoadVoxel("testSaveLoadVoxel.vengi", &f);
 }
 
+TEST_F(VENGIFormatTest, testSaveLoadVoxelParallelZip) {
+	VENGIFormat f;
+	core::Var::getSafe(cfg::VoxformatVENGIParallelZip)->setVal(true);
+	testSaveLoadVoxel("testSaveLoadVoxelParallelZip.vengi", &f);
+	testSaveSmallVolume("testSaveSmallVolumeParallelZip.vengi", &f);
+}
+
 } // namespace voxelformat
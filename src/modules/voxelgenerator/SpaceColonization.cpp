@@ -3,8 +3,10 @@
  */
 
 #include "SpaceColonization.h"
+#include "app/App.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/concurrent/ParallelFor.h"
 
 namespace voxelgenerator {
 namespace tree {
@@ -31,7 +33,8 @@ SpaceColonization::SpaceColonization(const glm::ivec3& position, int branchLengt
 		_position(position), _attractionPointCount(attractionPointCount), _attractionPointWidth(attractionPointWidth),
 		_attractionPointDepth(attractionPointDepth), _attractionPointHeight(attractionPointHeight),
 		_minDistance2(minDistance * minDistance), _maxDistance2(maxDistance * maxDistance),
-		_branchLength(branchLength), _branchSize(branchSize), _random(seed) {
+		_branchLength(branchLength), _branchSize(branchSize),
+		_branches(core_max(4096, attractionPointCount * 8)), _random(seed) {
 	_root = new Branch(nullptr, _position, glm::up, _branchSize);
 	_branches.put(_root->_position, _root);
 
@@ -80,6 +83,91 @@ void SpaceColonization::grow() {
 	}
 }
 
+void SpaceColonization::BranchGrid::build(const Branches &allBranches, const Branch *exclude, int size) {
+	// keep the amount of cells bounded for widely spread branches
+	static constexpr int MaxCells = 1 << 20;
+	cellSize = core_max(1, size);
+	glm::ivec3 maxs;
+	for (;;) {
+		mins = glm::ivec3(INT32_MAX);
+		maxs = glm::ivec3(INT32_MIN);
+		for (auto e : allBranches) {
+			const glm::ivec3 cell(glm::floor(e->value->_position / (float)cellSize));
+			mins = glm::min(mins, cell);
+			maxs = glm::max(maxs, cell);
+		}
+		dimensions = maxs - mins + 1;
+		if ((int64_t)dimensions.x * dimensions.y * dimensions.z <= MaxCells) {
+			break;
+		}
+		cellSize *= 2;
+	}
+
+	const int cells = dimensions.x * dimensions.y * dimensions.z;
+	cellStart.resize(cells + 1);
+	for (int i = 0; i <= cells; ++i) {
+		cellStart[i] = 0;
+	}
+	for (auto e : allBranches) {
+		if (e->value == exclude) {
+			continue;
+		}
+		const glm::ivec3 cell = glm::ivec3(glm::floor(e->value->_position / (float)cellSize)) - mins;
+		++cellStart[cellIndex(cell.x, cell.y, cell.z) + 1];
+	}
+	for (int i = 0; i < cells; ++i) {
+		cellStart[i + 1] += cellStart[i];
+	}
+	branches.resize(cellStart[cells]);
+	core::DynamicArray<int> fill;
+	fill.resize(cells);
+	for (int i = 0; i < cells; ++i) {
+		fill[i] = cellStart[i];
+	}
+	for (auto e : allBranches) {
+		if (e->value == exclude) {
+			continue;
+		}
+		const glm::ivec3 cell = glm::ivec3(glm::floor(e->value->_position / (float)cellSize)) - mins;
+		branches[fill[cellIndex(cell.x, cell.y, cell.z)]++] = e->value;
+	}
+}
+
+Branch *SpaceColonization::findClosestBranch(const glm::vec3 &position, Branch *firstBranch) const {
+	Branch *closest = firstBranch;
+	float closestDistance2 = glm::distance2(firstBranch->_position, position);
+
+	// the distances are rounded before they are compared
+	const float radius = glm::sqrt((float)core_max(_minDistance2, _maxDistance2) + 1.0f);
+	const float cellSize = (float)_branchGrid.cellSize;
+	const glm::ivec3 lower =
+		glm::max(glm::ivec3(glm::floor((position - radius) / cellSize)) - _branchGrid.mins, glm::ivec3(0));
+	const glm::ivec3 upper = glm::min(glm::ivec3(glm::floor((position + radius) / cellSize)) - _branchGrid.mins,
+									  _branchGrid.dimensions - 1);
+	for (int z = lower.z; z <= upper.z; ++z) {
+		for (int y = lower.y; y <= upper.y; ++y) {
+			for (int x = lower.x; x <= upper.x; ++x) {
+				const int cell = _branchGrid.cellIndex(x, y, z);
+				for (int i = _branchGrid.cellStart[cell]; i < _branchGrid.cellStart[cell + 1]; ++i) {
+					Branch *branch = _branchGrid.branches[i];
+					const float distance2 = glm::distance2(branch->_position, position);
+					const float length2 = (float)glm::round(distance2);
+					// Min attraction point distance reached, we remove it
+					if (length2 <= _minDistance2) {
+						return nullptr;
+					}
+					// branch in range, determine if it is the nearest
+					if (length2 <= _maxDistance2 && distance2 < closestDistance2) {
+						closest = branch;
+						closestDistance2 = distance2;
+					}
+				}
+			}
+		}
+	}
+	return closest;
+}
+
 bool SpaceColonization::step() {
 	if (_doneGrowing) {
 		return false;
@@ -91,49 +179,39 @@ bool SpaceColonization::step() {
 		return false;
 	}
 
-	// process the attraction points
-	for (auto pi = _attractionPoints.begin(); pi != _attractionPoints.end();) {
-		bool attractionPointRemoved = false;
-		AttractionPoint& attractionPoint = *pi;
-
-		attractionPoint._closestBranch = nullptr;
+	Branch *firstBranch = _branches.begin()->second;
+	const int cellSize = (int)glm::ceil(glm::sqrt((float)core_max(_minDistance2, _maxDistance2) + 1.0f));
+	_branchGrid.build(_branches, firstBranch, cellSize);
 
-		// Find the nearest branch for this attraction point
-		for (auto bi = _branches.begin(); bi != _branches.end(); ++bi) {
-			Branch* branch = bi->second;
-			const float length2 = (float) glm::round(glm::distance2(branch->_position, attractionPoint._position));
-
-			// Min attraction point distance reached, we remove it
-			if (attractionPoint._closestBranch == nullptr) {
-				attractionPoint._closestBranch = branch;
-			} else if (length2 <= _minDistance2) {
-				pi = _attractionPoints.erase(pi);
-				attractionPointRemoved = true;
-				break;
-			} else if (length2 <= _maxDistance2) {
-				// branch in range, determine if it is the nearest
-				if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
-					attractionPoint._closestBranch = branch;
-				}
-			}
+	// Find the nearest branch for every attraction point
+	const int pointCount = (int)_attractionPoints.size();
+	core::DynamicArray<Branch *> closestBranches;
+	closestBranches.resize(pointCount);
+	core::parallel_for(app::App::getInstance()->threadPool(), 0, pointCount, 256, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			closestBranches[i] = findClosestBranch(_attractionPoints[i]._position, firstBranch);
 		}
+	});
 
-		// if the attraction point was removed, skip
-		if (attractionPointRemoved) {
+	// process the attraction points in their order to get the same grow directions for every run
+	size_t remaining = 0;
+	for (int i = 0; i < pointCount; ++i) {
+		Branch *closestBranch = closestBranches[i];
+		// a branch reached the attraction point, we remove it
+		if (closestBranch == nullptr) {
 			continue;
 		}
+		AttractionPoint &attractionPoint = _attractionPoints[remaining++];
+		attractionPoint._position = _attractionPoints[i]._position;
+		attractionPoint._closestBranch = closestBranch;
 
-		++pi;
-
-		// Set the grow parameters on all the closest branches that are in range
-		if (attractionPoint._closestBranch == nullptr) {
-			continue;
-		}
-		const glm::vec3& dir = glm::normalize(attractionPoint._position - attractionPoint._closestBranch->_position);
+		// Set the grow parameters on the closest branch
+		const glm::vec3& dir = glm::normalize(attractionPoint._position - closestBranch->_position);
 		// add to grow direction of branch
-		attractionPoint._closestBranch->_growDirection += dir;
-		++attractionPoint._closestBranch->_attractionPointInfluence;
+		closestBranch->_growDirection += dir;
+		++closestBranch->_attractionPointInfluence;
 	}
+	_attractionPoints.erase(_attractionPoints.begin() + remaining, _attractionPoints.end());
 
 	// Generate the new branches
 	core::DynamicArray<Branch*> newBranches;
@@ -162,7 +240,9 @@ bool SpaceColonization::step() {
 		// Check if branch already exists. These cases seem to
 		// happen when attraction point is in specific areas
 		auto i = _branches.find(branch->_position);
-		if (i != _branches.end()) {
+		// the map has a fixed capacity - the tree stops growing once it is full
+		const bool full = _branches.size() >= _branches.capacity();
+		if (full || i != _branches.end()) {
 			auto& c = branch->_parent->_children;
 			for (size_t i = 0; i < c.size(); ++i) {
 				if (c[i] == branch) {
@@ -68,10 +68,38 @@ protected:
 		}
 	};
 
-	using Branches = core::Map<glm::vec3, Branch*, 64, glm::hash<glm::vec3>, EqualCompare>;
+	using Branches = core::Map<glm::vec3, Branch*, 1024, glm::hash<glm::vec3>, EqualCompare>;
 	Branches _branches;
 	math::Random _random;
 
+	/**
+	 * @brief Uniform grid over the branch positions - an attraction point only has to look at the branches of the
+	 * cells around it. The grid is rebuilt in every step as subclasses put their branches into the map directly.
+	 */
+	struct BranchGrid {
+		glm::ivec3 mins{0};
+		glm::ivec3 dimensions{0};
+		int cellSize = 1;
+		/**
+		 * the offset of the first branch of a cell in @c branches - the last entry is the amount of branches
+		 */
+		core::DynamicArray<int> cellStart;
+		core::DynamicArray<Branch *> branches;
+
+		void build(const Branches &allBranches, const Branch *exclude, int size);
+		inline int cellIndex(int x, int y, int z) const {
+			return (z * dimensions.y + y) * dimensions.x + x;
+		}
+	};
+	BranchGrid _branchGrid;
+
+	/**
+	 * @return The branch the attraction point at the given position is pulling or @c nullptr if a branch reached it
+	 * and the point should get removed. The first branch of the map is always taken into account - the others only
+	 * if they are within the max distance.
+	 */
+	Branch *findClosestBranch(const glm::vec3 &position, Branch *firstBranch) const;
+
 	/**
 	 * Generate the attraction points for the crown
 	 */
@@ -0,0 +1,26 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxelgenerator/SpaceColonization.h"
+
+/**
+ * @brief The range argument is the amount of attraction points - the crown grows with it to keep the density
+ */
+class SpaceColonizationBenchmark : public app::AbstractBenchmark {};
+
+BENCHMARK_DEFINE_F(SpaceColonizationBenchmark, Grow)(benchmark::State &state) {
+	const int attractionPoints = (int)state.range(0);
+	const int crownSize = (int)(glm::pow((float)attractionPoints, 1.0f / 3.0f) * 8.0f);
+	for (auto _ : state) {
+		voxelgenerator::tree::SpaceColonization tree(glm::ivec3(0), 4, crownSize, crownSize, crownSize, 4.0f, 1u, 6,
+													 10, attractionPoints);
+		tree.grow();
+	}
+	state.SetItemsProcessed(state.iterations() * attractionPoints);
+}
+
+BENCHMARK_REGISTER_F(SpaceColonizationBenchmark, Grow)->RangeMultiplier(4)->Range(400, 25600);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelgenerator/TreeGenerator.h"
+
+namespace voxelgenerator {
+namespace tree {
+
+class SpaceColonizationTest : public app::AbstractTest {
+protected:
+	class TestTree : public Tree {
+	public:
+		TestTree(unsigned int seed, int attractionPoints)
+			: Tree(glm::ivec3(0), 20, 4, 60, 40, 60, 4.0f, seed, 0.8f) {
+			_attractionPointCount = attractionPoints;
+			_attractionPoints.clear();
+			fillAttractionPoints();
+		}
+
+		// tests every branch like the grid lookup does
+		Branch *bruteForceClosestBranch(const glm::vec3 &position, Branch *firstBranch) const {
+			Branch *closest = firstBranch;
+			for (auto e : _branches) {
+				Branch *branch = e->value;
+				if (branch == firstBranch) {
+					continue;
+				}
+				const float length2 = (float)glm::round(glm::distance2(branch->_position, position));
+				if (length2 <= _minDistance2) {
+					return nullptr;
+				}
+				if (length2 <= _maxDistance2 && glm::distance2(branch->_position, position) < glm::distance2(closest->_position, position)) {
+					closest = branch;
+				}
+			}
+			return closest;
+		}
+
+		void verifyGridLookup() {
+			Branch *firstBranch = _branches.begin()->second;
+			const int cellSize = (int)glm::ceil(glm::sqrt((float)core_max(_minDistance2, _maxDistance2) + 1.0f));
+			_branchGrid.build(_branches, firstBranch, cellSize);
+			for (const AttractionPoint &p : _attractionPoints) {
+				const Branch *expected = bruteForceClosestBranch(p._position, firstBranch);
+				const Branch *closest = findClosestBranch(p._position, firstBranch);
+				if (expected == nullptr) {
+					ASSERT_EQ(nullptr, closest);
+					continue;
+				}
+				ASSERT_NE(nullptr, closest);
+				// equally distant branches might be found in a different order
+				EXPECT_FLOAT_EQ(glm::distance2(expected->_position, p._position),
+								glm::distance2(closest->_position, p._position));
+			}
+		}
+
+		int branches() const {
+			return (int)_branches.size();
+		}
+
+		int attractionPoints() const {
+			return (int)_attractionPoints.size();
+		}
+	};
+};
+
+TEST_F(SpaceColonizationTest, testGridLookup) {
+	TestTree tree(42u, 2000);
+	for (int i = 0; i < 20; ++i) {
+		tree.verifyGridLookup();
+		if (!tree.step()) {
+			break;
+		}
+	}
+}
+
+TEST_F(SpaceColonizationTest, testGrowDeterministic) {
+	TestTree tree1(1u, 1000);
+	TestTree tree2(1u, 1000);
+	const int initialBranches = tree1.branches();
+	const int initialAttractionPoints = tree1.attractionPoints();
+	tree1.grow();
+	tree2.grow();
+	EXPECT_GT(tree1.branches(), initialBranches);
+	EXPECT_LT(tree1.attractionPoints(), initialAttractionPoints);
+	EXPECT_EQ(tree1.branches(), tree2.branches());
+	EXPECT_EQ(tree1.attractionPoints(), tree2.attractionPoints());
+}
+
+}
+}
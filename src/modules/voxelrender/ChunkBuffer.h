@@ -0,0 +1,274 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/FlatMap.h"
+#include "core/GLM.h"
+#include "voxel/Mesh.h"
+#include "voxel/VoxelVertex.h"
+
+namespace voxelrender {
+
+/**
+ * @brief Sub-allocates the vertex and index buffer of a volume into one slice per chunk mesh.
+ *
+ * A re-extracted chunk only uploads its own slice as long as the new mesh fits into the capacity of the
+ * slice. Otherwise the slice is moved to the end of the buffer and the old one is turned into degenerated
+ * triangles. Only if the buffer runs out of space, all slices are compacted and uploaded again.
+ *
+ * The whole index range up to @c indices() can be rendered with one draw call, because the unused indices
+ * of a slice are degenerated triangles.
+ *
+ * @tparam BUFFER The gpu buffer - usually @c video::Buffer. Needs @c update() and @c updateSubData().
+ * @sa RawVolumeRenderer
+ */
+template<class BUFFER>
+class ChunkBuffer {
+private:
+	struct Slice {
+		const voxel::Mesh *mesh = nullptr;
+		uint32_t vertexOffset = 0u;
+		uint32_t vertexCapacity = 0u;
+		uint32_t indexOffset = 0u;
+		uint32_t indexCapacity = 0u;
+	};
+	using Slices = core::FlatMap<glm::ivec3, Slice, glm::hash<glm::ivec3>>;
+	Slices _slices;
+
+	BUFFER *_buffer = nullptr;
+	int32_t _vertexBufferIndex = -1;
+	int32_t _indexBufferIndex = -1;
+
+	/** allocated elements on the gpu */
+	uint32_t _vertexCapacity = 0u;
+	uint32_t _indexCapacity = 0u;
+	/** the end of the last slice - new slices are appended here */
+	uint32_t _vertexEnd = 0u;
+	uint32_t _indexEnd = 0u;
+	/** the sum of all slice capacities */
+	uint32_t _usedVertices = 0u;
+	uint32_t _usedIndices = 0u;
+
+	size_t _uploadedBytes = 0u;
+
+	/**
+	 * @brief Leave some room for the mesh to grow - an edit most of the time only adds a few faces
+	 */
+	static inline uint32_t capacity(uint32_t elements) {
+		return elements + elements / 2u + 6u;
+	}
+
+	/**
+	 * @brief Slices must start at a triangle boundary to keep the degenerated triangles aligned
+	 */
+	static inline uint32_t indexCapacity(uint32_t indices) {
+		const uint32_t n = capacity(indices);
+		return n + (3u - n % 3u) % 3u;
+	}
+
+	bool updateSubData(int32_t idx, size_t offset, const void *data, size_t size) {
+		_uploadedBytes += size;
+		return _buffer->updateSubData(idx, offset, data, size);
+	}
+
+	/**
+	 * @brief Write the rebased indices of the slice mesh - the remaining capacity is filled with degenerated triangles
+	 */
+	void fillIndices(const Slice &slice, voxel::IndexType *target) const {
+		uint32_t n = 0u;
+		if (slice.mesh != nullptr) {
+			const voxel::IndexArray &indices = slice.mesh->getIndexVector();
+			n = (uint32_t)indices.size();
+			for (uint32_t i = 0u; i < n; ++i) {
+				target[i] = indices[i] + slice.vertexOffset;
+			}
+		}
+		core_memset(target + n, 0, (slice.indexCapacity - n) * sizeof(voxel::IndexType));
+	}
+
+	bool uploadSlice(const Slice &slice) {
+		const voxel::VertexArray &vertices = slice.mesh->getVertexVector();
+		if (!updateSubData(_vertexBufferIndex, slice.vertexOffset * sizeof(voxel::VoxelVertex), vertices.data(),
+						   vertices.size() * sizeof(voxel::VoxelVertex))) {
+			Log::error("Failed to update the vertex buffer slice");
+			return false;
+		}
+		core::DynamicArray<voxel::IndexType> indices;
+		indices.resize(slice.indexCapacity);
+		fillIndices(slice, indices.data());
+		if (!updateSubData(_indexBufferIndex, slice.indexOffset * sizeof(voxel::IndexType), indices.data(),
+						   indices.size() * sizeof(voxel::IndexType))) {
+			Log::error("Failed to update the index buffer slice");
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Turns the indices of the slice into degenerated triangles and gives the space back if it is at the end
+	 */
+	bool releaseSlice(const Slice &slice) {
+		_usedVertices -= slice.vertexCapacity;
+		_usedIndices -= slice.indexCapacity;
+		if (slice.indexOffset + slice.indexCapacity == _indexEnd) {
+			_indexEnd = slice.indexOffset;
+		} else {
+			core::DynamicArray<voxel::IndexType> indices;
+			indices.resize(slice.indexCapacity);
+			core_memset(indices.data(), 0, indices.size() * sizeof(voxel::IndexType));
+			if (!updateSubData(_indexBufferIndex, slice.indexOffset * sizeof(voxel::IndexType), indices.data(),
+							   indices.size() * sizeof(voxel::IndexType))) {
+				Log::error("Failed to release the index buffer slice");
+				return false;
+			}
+		}
+		if (slice.vertexOffset + slice.vertexCapacity == _vertexEnd) {
+			_vertexEnd = slice.vertexOffset;
+		}
+		if (_slices.empty()) {
+			_vertexEnd = _indexEnd = 0u;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Compacts all slices and uploads the complete buffers with enough capacity for further slices
+	 */
+	bool rebuild() {
+		_vertexCapacity = core_max(capacity(_usedVertices) * 2u, 1024u);
+		_indexCapacity = core_max(capacity(_usedIndices) * 2u, 1536u);
+		core::DynamicArray<voxel::VoxelVertex> vertices;
+		vertices.resize(_vertexCapacity);
+		core::DynamicArray<voxel::IndexType> indices;
+		indices.resize(_indexCapacity);
+		_vertexEnd = _indexEnd = 0u;
+		for (const auto &entry : _slices) {
+			Slice &slice = entry->value;
+			slice.vertexOffset = _vertexEnd;
+			slice.indexOffset = _indexEnd;
+			const voxel::VertexArray &meshVertices = slice.mesh->getVertexVector();
+			core_memcpy(&vertices[slice.vertexOffset], meshVertices.data(), meshVertices.size() * sizeof(voxel::VoxelVertex));
+			fillIndices(slice, &indices[slice.indexOffset]);
+			_vertexEnd += slice.vertexCapacity;
+			_indexEnd += slice.indexCapacity;
+		}
+		_uploadedBytes += vertices.size() * sizeof(voxel::VoxelVertex) + indices.size() * sizeof(voxel::IndexType);
+		if (!_buffer->update(_vertexBufferIndex, vertices.data(), vertices.size() * sizeof(voxel::VoxelVertex))) {
+			Log::error("Failed to update the vertex buffer");
+			return false;
+		}
+		if (!_buffer->update(_indexBufferIndex, indices.data(), indices.size() * sizeof(voxel::IndexType))) {
+			Log::error("Failed to update the index buffer");
+			return false;
+		}
+		return true;
+	}
+
+public:
+	void init(BUFFER *buffer, int32_t vertexBufferIndex, int32_t indexBufferIndex) {
+		_buffer = buffer;
+		_vertexBufferIndex = vertexBufferIndex;
+		_indexBufferIndex = indexBufferIndex;
+		shutdown();
+	}
+
+	/**
+	 * @brief Replaces the mesh of the given chunk - an empty mesh removes the chunk
+	 * @note The mesh pointer must stay valid until it is replaced or the chunk is removed.
+	 */
+	bool update(const glm::ivec3 &chunk, const voxel::Mesh *mesh) {
+		if (mesh == nullptr || mesh->getNoOfIndices() == 0 || mesh->getNoOfVertices() == 0) {
+			return remove(chunk);
+		}
+		const uint32_t vertices = (uint32_t)mesh->getNoOfVertices();
+		const uint32_t indices = (uint32_t)mesh->getNoOfIndices();
+		auto iter = _slices.find(chunk);
+		if (iter != _slices.end()) {
+			Slice &slice = iter->value;
+			slice.mesh = mesh;
+			if (vertices <= slice.vertexCapacity && indices <= slice.indexCapacity) {
+				return uploadSlice(slice);
+			}
+			const Slice old = slice;
+			_slices.erase(iter);
+			if (!releaseSlice(old)) {
+				return false;
+			}
+		}
+
+		Slice slice;
+		slice.mesh = mesh;
+		slice.vertexCapacity = capacity(vertices);
+		slice.indexCapacity = indexCapacity(indices);
+		slice.vertexOffset = _vertexEnd;
+		slice.indexOffset = _indexEnd;
+		_usedVertices += slice.vertexCapacity;
+		_usedIndices += slice.indexCapacity;
+		_slices.put(chunk, slice);
+		if (_vertexEnd + slice.vertexCapacity > _vertexCapacity || _indexEnd + slice.indexCapacity > _indexCapacity) {
+			return rebuild();
+		}
+		_vertexEnd += slice.vertexCapacity;
+		_indexEnd += slice.indexCapacity;
+		return uploadSlice(slice);
+	}
+
+	bool remove(const glm::ivec3 &chunk) {
+		auto iter = _slices.find(chunk);
+		if (iter == _slices.end()) {
+			return true;
+		}
+		const Slice old = iter->value;
+		_slices.erase(iter);
+		return releaseSlice(old);
+	}
+
+	/**
+	 * @brief Removes all chunks - the gpu memory is kept for the next chunks
+	 */
+	void clear() {
+		_slices.clear();
+		_vertexEnd = _indexEnd = 0u;
+		_usedVertices = _usedIndices = 0u;
+	}
+
+	/**
+	 * @brief Removes all chunks and forgets about the gpu memory
+	 */
+	void shutdown() {
+		clear();
+		_vertexCapacity = _indexCapacity = 0u;
+		_uploadedBytes = 0u;
+	}
+
+	/**
+	 * @return The amount of indices to render - including the degenerated triangles of unused slice capacity
+	 */
+	inline uint32_t indices() const {
+		return _indexEnd;
+	}
+
+	inline size_t chunks() const {
+		return _slices.size();
+	}
+
+	/**
+	 * @return The amount of bytes that were uploaded to the gpu since the last @c resetUploadedBytes() call
+	 */
+	inline size_t uploadedBytes() const {
+		return _uploadedBytes;
+	}
+
+	inline void resetUploadedBytes() {
+		_uploadedBytes = 0u;
+	}
+};
+
+} // namespace voxelrender
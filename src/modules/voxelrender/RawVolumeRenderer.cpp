@@ -129,6 +129,10 @@ bool RawVolumeRenderer::init() {
 				Log::error("Could not create the vertex buffer object for the indices");
 				return false;
 			}
+			// the chunks are updating parts of the buffers
+			state._vertexBuffer[i].setMode(state._vertexBufferIndex[i], video::BufferMode::Dynamic);
+			state._vertexBuffer[i].setMode(state._indexBufferIndex[i], video::BufferMode::Dynamic);
+			state._chunkBuffer[i].init(&state._vertexBuffer[i], state._vertexBufferIndex[i], state._indexBufferIndex[i]);
 		}
 	}
 
@@ -186,10 +190,10 @@ bool RawVolumeRenderer::scheduleExtractions(size_t maxExtraction) {
 			continue;
 		}
 		const voxel::Region& finalRegion = _extractRegions[i].region;
-		bool onlyAir = true;
-		voxel::RawVolume copy(v, voxel::Region(finalRegion.getLowerCorner() - 2, finalRegion.getUpperCorner() + 2), &onlyAir);
+		const voxel::Region copyRegion(finalRegion.getLowerCorner() - 2, finalRegion.getUpperCorner() + 2);
 		const glm::ivec3& mins = finalRegion.getLowerCorner();
-		if (!onlyAir) {
+		if (!v->isEmpty(copyRegion)) {
+			voxel::RawVolume copy(*v, copyRegion);
 			_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, finalRegion, this] () {
 				++_runningExtractorTasks;
 				voxel::ChunkMesh mesh(65536, 65536, true);
@@ -214,26 +218,27 @@ bool RawVolumeRenderer::scheduleExtractions(size_t maxExtraction) {
 }
 
 void RawVolumeRenderer::update() {
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		for (int i = 0; i < MeshType_Max; ++i) {
+			_state[idx]._chunkBuffer[i].resetUploadedBytes();
+		}
+	}
 	scheduleExtractions();
 	ExtractionCtx result;
 	int cnt = 0;
 	while (_pendingQueue.pop(result)) {
-		Meshes& meshes = _meshes[MeshType_Opaque][result.mins];
-		if (meshes[result.idx] != nullptr) {
-			delete meshes[result.idx];
-		}
-		meshes[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[MeshType_Opaque]));
-		if (!updateBufferForVolume(result.idx, MeshType_Opaque)) {
-			Log::error("Failed to update the mesh at index %i", result.idx);
-		}
-
-		Meshes& meshesT = _meshes[MeshType_Transparency][result.mins];
-		if (meshesT[result.idx] != nullptr) {
-			delete meshesT[result.idx];
+		if (result.idx < 0 || result.idx >= MAX_VOLUMES) {
+			continue;
 		}
-		meshesT[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[MeshType_Transparency]));
-		if (!updateBufferForVolume(result.idx, MeshType_Transparency)) {
-			Log::error("Failed to update the mesh at index %i", result.idx);
+		State &state = _state[result.idx];
+		for (int i = 0; i < MeshType_Max; ++i) {
+			Meshes& meshes = _meshes[i][result.mins];
+			delete meshes[result.idx];
+			meshes[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[i]));
+			// only the slice of this chunk is uploaded
+			if (!state._chunkBuffer[i].update(result.mins, meshes[result.idx])) {
+				Log::error("Failed to update the mesh at index %i", result.idx);
+			}
 		}
 		++cnt;
 	}
@@ -242,76 +247,43 @@ void RawVolumeRenderer::update() {
 	}
 }
 
+size_t RawVolumeRenderer::uploadedBytes() const {
+	size_t bytes = 0u;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		for (int i = 0; i < MeshType_Max; ++i) {
+			bytes += _state[idx]._chunkBuffer[i].uploadedBytes();
+		}
+	}
+	return bytes;
+}
+
 bool RawVolumeRenderer::updateBufferForVolume(int idx, MeshType type) {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return false;
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
 
-	size_t vertCount = 0u;
-	size_t indCount = 0u;
+	ChunkBuffer<video::Buffer> &chunkBuffer = _state[idx]._chunkBuffer[type];
+	chunkBuffer.clear();
+	bool success = true;
 	for (auto& i : _meshes[type]) {
 		const Meshes& meshes = i.second;
-		const voxel::Mesh* mesh = meshes[idx];
-		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
-			continue;
+		if (!chunkBuffer.update(i.first, meshes[idx])) {
+			success = false;
 		}
-		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
-		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		vertCount += vertexVector.size();
-		indCount += indexVector.size();
 	}
+	return success;
+}
 
+void RawVolumeRenderer::deleteMeshes(int idx) {
 	State& state = _state[idx];
-	if (indCount == 0u || vertCount == 0u) {
-		state._vertexBuffer[type].update(state._vertexBufferIndex[type], nullptr, 0);
-		state._vertexBuffer[type].update(state._indexBufferIndex[type], nullptr, 0);
-		return true;
-	}
-
-	const size_t verticesBufSize = vertCount * sizeof(voxel::VoxelVertex);
-	voxel::VoxelVertex* verticesBuf = (voxel::VoxelVertex*)core_malloc(verticesBufSize);
-	const size_t indicesBufSize = indCount * sizeof(voxel::IndexType);
-	voxel::IndexType* indicesBuf = (voxel::IndexType*)core_malloc(indicesBufSize);
-
-	voxel::VoxelVertex* verticesPos = verticesBuf;
-	voxel::IndexType* indicesPos = indicesBuf;
-
-	voxel::IndexType offset = (voxel::IndexType)0;
-	for (auto& i : _meshes[type]) {
-		const Meshes& meshes = i.second;
-		const voxel::Mesh* mesh = meshes[idx];
-		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
-			continue;
-		}
-		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
-		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
-		core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
-
-		for (size_t i = 0; i < indexVector.size(); ++i) {
-			*indicesPos++ += offset;
+	for (int i = 0; i < MeshType_Max; ++i) {
+		state._chunkBuffer[i].clear();
+		for (auto& iter : _meshes[i]) {
+			delete iter.second[idx];
+			iter.second[idx] = nullptr;
 		}
-
-		verticesPos += vertexVector.size();
-		offset += vertexVector.size();
-	}
-
-	if (!state._vertexBuffer[type].update(state._vertexBufferIndex[type], verticesBuf, verticesBufSize)) {
-		Log::error("Failed to update the vertex buffer");
-		core_free(indicesBuf);
-		core_free(verticesBuf);
-		return false;
-	}
-	core_free(verticesBuf);
-
-	if (!state._vertexBuffer[type].update(state._indexBufferIndex[type], indicesBuf, indicesBufSize)) {
-		Log::error("Failed to update the index buffer");
-		core_free(indicesBuf);
-		return false;
 	}
-	core_free(indicesBuf);
-	return true;
 }
 
 void RawVolumeRenderer::setAmbientColor(const glm::vec3& color) {
@@ -373,11 +345,9 @@ bool RawVolumeRenderer::extractRegion(int idx, const voxel::Region& region) {
 					for (int i = 0; i < MeshType_Max; ++i) {
 						auto iter = _meshes[i].find(mins);
 						if (iter != _meshes[i].end()) {
+							_state[idx]._chunkBuffer[i].remove(mins);
 							delete iter->second[idx];
 							iter->second[idx] = nullptr;
-							State& state = _state[idx];
-							state._vertexBuffer[i].update(state._vertexBufferIndex[i], nullptr, 0);
-							state._vertexBuffer[i].update(state._indexBufferIndex[i], nullptr, 0);
 						}
 					}
 					continue;
@@ -475,14 +445,18 @@ void RawVolumeRenderer::render(RenderContext &renderContext, const video::Camera
 	}
 	for (auto& i : _meshes[MeshType_Transparency]) {
 		for (int idx = 0; idx < (int)i.second.size(); ++idx) {
-			const State& state = _state[idx];
+			State& state = _state[idx];
 			if (state._hidden) {
 				continue;
 			}
+			voxel::Mesh *mesh = i.second[idx];
+			if (mesh == nullptr) {
+				continue;
+			}
 			// TODO: transform - vertices are in object space - eye in world space
 			// inverse of state._model - but take pivot into account
-			if (i.second[idx]->sort(camera.eye())) {
-				updateBufferForVolume(idx, MeshType_Transparency);
+			if (mesh->sort(camera.eye())) {
+				state._chunkBuffer[MeshType_Transparency].update(i.first, mesh);
 			}
 		}
 	}
@@ -688,15 +662,7 @@ voxel::RawVolume* RawVolumeRenderer::setVolume(int idx, voxel::RawVolume* volume
 	core_trace_scoped(RawVolumeRendererSetVolume);
 	state._rawVolume = volume;
 	if (deleteMesh) {
-		for (int i = 0; i < MeshType_Max; ++i) {
-			for (auto& iter : _meshes[i]) {
-				delete iter.second[idx];
-				iter.second[idx] = nullptr;
-				State& state = _state[idx];
-				state._vertexBuffer[i].update(state._vertexBufferIndex[i], nullptr, 0);
-				state._vertexBuffer[i].update(state._indexBufferIndex[i], nullptr, 0);
-			}
-		}
+		deleteMeshes(idx);
 	}
 	const size_t n = _extractRegions.size();
 	for (size_t i = 0; i < n; ++i) {
@@ -730,6 +696,7 @@ core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 		State& state = _state[idx];
 		for (int i = 0; i < MeshType_Max; ++i) {
+			state._chunkBuffer[i].shutdown();
 			state._vertexBuffer[i].shutdown();
 			state._vertexBufferIndex[i] = -1;
 			state._indexBufferIndex[i] = -1;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ShadowmapData.h"
+#include "ChunkBuffer.h"
 #include "core/NonCopyable.h"
 #include "core/Optional.h"
 #include "core/collection/ConcurrentPriorityQueue.h"
@@ -75,12 +76,13 @@ protected:
 		glm::mat4 _model;
 		glm::vec3 _pivot;
 		video::Buffer _vertexBuffer[MeshType_Max];
+		ChunkBuffer<video::Buffer> _chunkBuffer[MeshType_Max];
 		int _reference = -1;
 		voxel::RawVolume* _rawVolume = nullptr;
 		core::Optional<voxel::Palette> _palette;
 
 		uint32_t indices(MeshType type) const {
-			return _vertexBuffer[type].elements(_indexBufferIndex[type], 1, sizeof(voxel::IndexType));
+			return _chunkBuffer[type].indices();
 		}
 
 		bool hasData() const {
@@ -136,6 +138,7 @@ protected:
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const;
 	void updatePalette(int idx);
 	bool updateBufferForVolume(int idx, MeshType type);
+	void deleteMeshes(int idx);
 
 public:
 	RawVolumeRenderer();
@@ -158,7 +161,8 @@ public:
 	}
 
 	/**
-	 * @brief Updates the vertex buffers manually
+	 * @brief Uploads the meshes of all chunks of the volume again
+	 * @note Finished chunk extractions only update their own part of the vertex buffers in @c update()
 	 * @sa extract()
 	 */
 	bool updateBufferForVolume(int idx) {
@@ -214,6 +218,10 @@ public:
 
 	bool scheduleExtractions(size_t maxExtraction = 1);
 	void update();
+	/**
+	 * @return The amount of bytes that were uploaded to the vertex and index buffers since the last @c update() call
+	 */
+	size_t uploadedBytes() const;
 
 	/**
 	 * @return the managed voxel::RawVolume instance pointer, or @c nullptr if there is none set.
@@ -0,0 +1,181 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/ChunkBuffer.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ArrayLength.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Mesh.h"
+
+namespace voxelrender {
+
+/**
+ * @brief Keeps the uploaded data in memory to be able to validate the buffers without a gl context
+ */
+class BufferMock {
+public:
+	core::DynamicArray<uint8_t> data[2];
+	int updates = 0;
+	int subDataUpdates = 0;
+
+	bool update(int32_t idx, const void *buf, size_t size) {
+		++updates;
+		data[idx].resize(size);
+		if (buf != nullptr) {
+			core_memcpy(data[idx].data(), buf, size);
+		}
+		return true;
+	}
+
+	bool updateSubData(int32_t idx, size_t offset, const void *buf, size_t size) {
+		++subDataUpdates;
+		if (offset + size > data[idx].size()) {
+			return false;
+		}
+		core_memcpy(data[idx].data() + offset, buf, size);
+		return true;
+	}
+};
+
+class ChunkBufferTest : public app::AbstractTest {
+protected:
+	static constexpr int32_t VertexIdx = 0;
+	static constexpr int32_t IndexIdx = 1;
+	BufferMock _buffer;
+	ChunkBuffer<BufferMock> _chunkBuffer;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_chunkBuffer.init(&_buffer, VertexIdx, IndexIdx);
+	}
+
+	static void createMesh(voxel::Mesh &mesh, int quads, float x) {
+		mesh.clear();
+		for (int q = 0; q < quads; ++q) {
+			voxel::VoxelVertex vertex{};
+			vertex.position = glm::vec3(x + (float)q, 0.0f, 0.0f);
+			const voxel::IndexType i0 = mesh.addVertex(vertex);
+			vertex.position.y = 1.0f;
+			const voxel::IndexType i1 = mesh.addVertex(vertex);
+			vertex.position.z = 1.0f;
+			const voxel::IndexType i2 = mesh.addVertex(vertex);
+			vertex.position.y = 0.0f;
+			const voxel::IndexType i3 = mesh.addVertex(vertex);
+			mesh.addTriangle(i0, i1, i2);
+			mesh.addTriangle(i0, i2, i3);
+		}
+	}
+
+	/**
+	 * @brief Sums up the vertex positions of all non degenerated triangles
+	 */
+	static glm::vec4 sum(const voxel::VoxelVertex *vertices, const voxel::IndexType *indices, uint32_t n) {
+		glm::vec4 s(0.0f);
+		for (uint32_t i = 0u; i < n; i += 3u) {
+			if (indices[i] == indices[i + 1] && indices[i] == indices[i + 2]) {
+				continue;
+			}
+			for (uint32_t j = i; j < i + 3u; ++j) {
+				s += glm::vec4(vertices[indices[j]].position, 0.0f);
+			}
+			s.w += 1.0f;
+		}
+		return s;
+	}
+
+	static glm::vec4 sum(const voxel::Mesh &mesh) {
+		return sum(mesh.getRawVertexData(), mesh.getRawIndexData(), (uint32_t)mesh.getNoOfIndices());
+	}
+
+	glm::vec4 sum() const {
+		EXPECT_EQ(0u, _chunkBuffer.indices() % 3u);
+		EXPECT_LE(_chunkBuffer.indices() * sizeof(voxel::IndexType), _buffer.data[IndexIdx].size());
+		return sum((const voxel::VoxelVertex *)_buffer.data[VertexIdx].data(),
+				   (const voxel::IndexType *)_buffer.data[IndexIdx].data(), _chunkBuffer.indices());
+	}
+};
+
+TEST_F(ChunkBufferTest, testUpdate) {
+	voxel::Mesh mesh1;
+	voxel::Mesh mesh2;
+	createMesh(mesh1, 10, 0.0f);
+	createMesh(mesh2, 5, 100.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(1), &mesh2));
+	EXPECT_EQ(2u, _chunkBuffer.chunks());
+	EXPECT_EQ(sum(mesh1) + sum(mesh2), sum());
+}
+
+TEST_F(ChunkBufferTest, testUpdateInPlace) {
+	voxel::Mesh mesh1;
+	voxel::Mesh mesh2;
+	createMesh(mesh1, 10, 0.0f);
+	createMesh(mesh2, 20, 100.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(1), &mesh2));
+	const int updates = _buffer.updates;
+	const size_t bufferSize = _buffer.data[VertexIdx].size() + _buffer.data[IndexIdx].size();
+	_chunkBuffer.resetUploadedBytes();
+
+	createMesh(mesh1, 12, 0.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	EXPECT_EQ(updates, _buffer.updates) << "The buffers should not get reallocated";
+	EXPECT_GT(_chunkBuffer.uploadedBytes(), 0u);
+	EXPECT_LT(_chunkBuffer.uploadedBytes(), bufferSize / 4);
+	EXPECT_EQ(sum(mesh1) + sum(mesh2), sum());
+
+	createMesh(mesh1, 1, 0.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	EXPECT_EQ(sum(mesh1) + sum(mesh2), sum());
+}
+
+TEST_F(ChunkBufferTest, testGrowSlice) {
+	voxel::Mesh mesh1;
+	voxel::Mesh mesh2;
+	createMesh(mesh1, 2, 0.0f);
+	createMesh(mesh2, 2, 100.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(1), &mesh2));
+	const uint32_t indices = _chunkBuffer.indices();
+
+	// doesn't fit into the old slice anymore
+	createMesh(mesh1, 8, 0.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	EXPECT_GT(_chunkBuffer.indices(), indices);
+	EXPECT_EQ(sum(mesh1) + sum(mesh2), sum());
+}
+
+TEST_F(ChunkBufferTest, testRebuild) {
+	voxel::Mesh meshes[32];
+	glm::vec4 expected(0.0f);
+	for (int i = 0; i < lengthof(meshes); ++i) {
+		createMesh(meshes[i], 10 + i, (float)i * 100.0f);
+		ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(i), &meshes[i]));
+		expected += sum(meshes[i]);
+		ASSERT_EQ(expected, sum()) << "chunk " << i;
+	}
+	EXPECT_GT(_buffer.updates, 2) << "Expected the buffers to grow";
+}
+
+TEST_F(ChunkBufferTest, testRemove) {
+	voxel::Mesh mesh1;
+	voxel::Mesh mesh2;
+	voxel::Mesh mesh3;
+	createMesh(mesh1, 10, 0.0f);
+	createMesh(mesh2, 5, 100.0f);
+	createMesh(mesh3, 7, 200.0f);
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(0), &mesh1));
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(1), &mesh2));
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(2), &mesh3));
+	ASSERT_TRUE(_chunkBuffer.remove(glm::ivec3(1)));
+	EXPECT_EQ(sum(mesh1) + sum(mesh3), sum());
+	voxel::Mesh empty;
+	ASSERT_TRUE(_chunkBuffer.update(glm::ivec3(2), &empty));
+	EXPECT_EQ(sum(mesh1), sum());
+	ASSERT_TRUE(_chunkBuffer.remove(glm::ivec3(0)));
+	EXPECT_EQ(0u, _chunkBuffer.chunks());
+	EXPECT_EQ(0u, _chunkBuffer.indices());
+}
+
+} // namespace voxelrender
@@ -10,6 +10,7 @@
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "voxel/Palette.h"
+#include "voxel/PaletteKdTree.h"
 #include "voxel/RawVolume.h"
 #include "core/Assert.h"
 #include "core/Color.h"
@@ -165,6 +166,7 @@ voxel::RawVolume* importAsPlane(const image::ImagePtr& image, uint8_t thickness)
 	Log::info("Import image as plane: w(%i), h(%i), d(%i)", imageWidth, imageHeight, thickness);
 	const voxel::Region region(0, 0, 0, imageWidth - 1, imageHeight - 1, thickness - 1);
 	const voxel::Palette &palette = voxel::getPalette();
+	const voxel::PaletteKdTree paletteTree(palette);
 	voxel::RawVolume* volume = new voxel::RawVolume(region);
 	for (int x = 0; x < imageWidth; ++x) {
 		for (int y = 0; y < imageHeight; ++y) {
@@ -172,7 +174,7 @@ voxel::RawVolume* importAsPlane(const image::ImagePtr& image, uint8_t thickness)
 			if (data.a == 0) {
 				continue;
 			}
-			const uint8_t index = palette.getClosestMatch(data);
+			const uint8_t index = paletteTree.getClosestMatch(data);
 			const voxel::Voxel voxel = voxel::createVoxel(palette, index);
 			for (int z = 0; z < thickness; ++z) {
 				volume->setVoxel(x, (imageHeight - 1) - y, z, voxel);
@@ -0,0 +1,139 @@
+/**
+ * @file
+ */
+
+#include "LodPyramid.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "voxelutil/VolumeVisitor.h"
+
+namespace voxelutil {
+
+namespace {
+
+/**
+ * @brief Writes into the not yet wrapped voxel buffer of a level - RawVolume::setVoxel() updates the counters of
+ * the volume and can't be used from several threads
+ */
+struct LevelBuffer {
+	voxel::Voxel *data;
+	const voxel::Region &region;
+
+	void setVoxel(const glm::ivec3 &pos, const voxel::Voxel &voxel) {
+		const glm::ivec3 local = pos - region.getLowerCorner();
+		const int width = region.getWidthInVoxels();
+		const int height = region.getHeightInVoxels();
+		data[local.x + local.y * width + local.z * width * height] = voxel;
+	}
+};
+
+struct ColorUpdate {
+	glm::ivec3 pos;
+	voxel::Voxel voxel;
+};
+
+voxel::RawVolume *halveVolume(const voxel::RawVolume &source, const voxel::Palette &palette,
+							  const core::DynamicArray<glm::vec4> &materialColors) {
+	core_trace_scoped(HalveVolume);
+	const voxel::Region &sourceRegion = source.region();
+	const glm::ivec3 &lower = sourceRegion.getLowerCorner();
+	const voxel::Region destRegion(lower, lower + sourceRegion.getDimensionsInVoxels() / 2 - 1);
+	const size_t size = (size_t)destRegion.voxels() * sizeof(voxel::Voxel);
+	LevelBuffer buffer{(voxel::Voxel *)core_malloc(size), destRegion};
+
+	const int slabs = priv::parallelVisitSlabs(destRegion);
+	priv::visitSlabsParallel(destRegion, slabs, [&](int, const voxel::Region &slabRegion) {
+		priv::rescaleVolumeSolids(source, palette, materialColors, sourceRegion, buffer, destRegion, slabRegion);
+	});
+	voxel::RawVolume *dest = voxel::RawVolume::createRaw(buffer.data, destRegion);
+
+	// the boundary pass reads the materials of the neighbours - the colors are only written after all slabs are done
+	core::DynamicArray<core::DynamicArray<ColorUpdate>> updates;
+	updates.resize(slabs);
+	priv::visitSlabsParallel(destRegion, slabs, [&](int slab, const voxel::Region &slabRegion) {
+		core::DynamicArray<ColorUpdate> &slabUpdates = updates[slab];
+		priv::rescaleVolumeBoundaries(source, palette, materialColors, sourceRegion, *dest, destRegion, slabRegion,
+									  [&slabUpdates](const glm::ivec3 &pos, const voxel::Voxel &voxel) {
+										  slabUpdates.push_back({pos, voxel});
+									  });
+	});
+	for (const core::DynamicArray<ColorUpdate> &slabUpdates : updates) {
+		for (const ColorUpdate &update : slabUpdates) {
+			dest->setVoxel(update.pos, update.voxel);
+		}
+	}
+	return dest;
+}
+
+} // namespace
+
+LodPyramid::~LodPyramid() {
+	shutdown();
+}
+
+void LodPyramid::shutdown() {
+	for (size_t i = 1; i < _volumes.size(); ++i) {
+		delete _volumes[i];
+	}
+	_volumes.clear();
+	for (voxel::ChunkMesh *mesh : _meshes) {
+		delete mesh;
+	}
+	_meshes.clear();
+}
+
+int LodPyramid::build(const voxel::RawVolume *volume, const voxel::Palette &palette, int maxLevels) {
+	core_trace_scoped(BuildLodPyramid);
+	shutdown();
+	if (volume == nullptr) {
+		return 0;
+	}
+	_volumes.push_back(volume);
+
+	core::DynamicArray<glm::vec4> materialColors;
+	palette.toVec4f(materialColors);
+	while (maxLevels < 0 || levels() < maxLevels) {
+		const voxel::RawVolume *source = _volumes.back();
+		const glm::ivec3 &dim = source->region().getDimensionsInVoxels();
+		if (dim.x < 2 || dim.y < 2 || dim.z < 2) {
+			break;
+		}
+		_volumes.push_back(halveVolume(*source, palette, materialColors));
+	}
+	_meshes.resize(_volumes.size());
+	for (size_t i = 0; i < _meshes.size(); ++i) {
+		_meshes[i] = nullptr;
+	}
+	return levels();
+}
+
+const voxel::RawVolume *LodPyramid::volume(int level) const {
+	if (level < 0 || level >= levels()) {
+		return nullptr;
+	}
+	return _volumes[level];
+}
+
+const voxel::ChunkMesh *LodPyramid::mesh(int level) {
+	const voxel::RawVolume *v = volume(level);
+	if (v == nullptr) {
+		return nullptr;
+	}
+	if (_meshes[level] == nullptr) {
+		core_trace_scoped(ExtractLodMesh);
+		voxel::ChunkMesh *mesh = new voxel::ChunkMesh();
+		// the faces on the upper boundary are only created while visiting the cells beyond it
+		voxel::Region region = v->region();
+		region.shiftUpperCorner(1, 1, 1);
+		voxel::extractCubicMesh(v, region, mesh, glm::ivec3(0));
+		_meshes[level] = mesh;
+	}
+	return _meshes[level];
+}
+
+} // namespace voxelutil
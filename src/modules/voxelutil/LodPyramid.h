@@ -0,0 +1,62 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+
+namespace voxel {
+class RawVolume;
+class Palette;
+struct ChunkMesh;
+} // namespace voxel
+
+namespace voxelutil {
+
+/**
+ * @brief Builds all levels of detail of a volume by repeatedly halving it with the algorithm of rescaleVolume()
+ *
+ * Level @c 0 is the source volume, each following level has half of the size of the previous one. The levels are
+ * computed in parallel on the app thread pool and the palette lookup table is only created once for all of them.
+ * The meshes of the levels are extracted on demand and cached.
+ *
+ * @note The source volume is not owned and must stay valid as long as the pyramid is used.
+ * @sa rescaleVolume()
+ */
+class LodPyramid : public core::NonCopyable {
+private:
+	core::DynamicArray<const voxel::RawVolume *> _volumes;
+	core::DynamicArray<voxel::ChunkMesh *> _meshes;
+
+public:
+	~LodPyramid();
+
+	/**
+	 * @param maxLevels The maximum amount of levels including the source volume. @c -1 means that levels are
+	 * created until one of the dimensions can't get halved anymore.
+	 * @return The amount of levels
+	 */
+	int build(const voxel::RawVolume *volume, const voxel::Palette &palette, int maxLevels = -1);
+	void shutdown();
+
+	int levels() const;
+	/**
+	 * @return The volume of the given level or @c nullptr if the level doesn't exist
+	 */
+	const voxel::RawVolume *volume(int level) const;
+	/**
+	 * @brief The cubic mesh of the given level - it's extracted on the first call
+	 * @note The vertices are in the coordinates of the level volume - scale them by @c 1 << level to match the
+	 * source volume.
+	 * @return The mesh or @c nullptr if the level doesn't exist
+	 */
+	const voxel::ChunkMesh *mesh(int level);
+};
+
+inline int LodPyramid::levels() const {
+	return (int)_volumes.size();
+}
+
+} // namespace voxelutil
@@ -7,6 +7,7 @@
 #include "voxel/RawVolume.h"
 #include "VolumeMerger.h"
 #include "core/Common.h"
+#include <type_traits>
 
 namespace voxelutil {
 
@@ -44,25 +45,47 @@ voxel::RawVolume* cropVolume(const voxel::RawVolume* volume, CropSkipCondition c
 	const glm::ivec3& maxs = volume->maxs();
 	glm::ivec3 newMins((std::numeric_limits<int>::max)() / 2);
 	glm::ivec3 newMaxs((std::numeric_limits<int>::min)() / 2);
-	voxel::RawVolume::Sampler volumeSampler(volume);
-	for (int32_t z = mins.z; z <= maxs.z; ++z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			volumeSampler.setPosition(mins.x, y, z);
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				const voxel::Voxel& voxel = volumeSampler.voxel();
-				volumeSampler.movePositiveX();
-				if (condition(voxel)) {
-					continue;
-				}
-				newMins.x = core_min(newMins.x, x);
-				newMins.y = core_min(newMins.y, y);
-				newMins.z = core_min(newMins.z, z);
+	auto cropRegion = [&] (const glm::ivec3 &regionMins, const glm::ivec3 &regionMaxs) {
+		voxel::RawVolume::Sampler volumeSampler(volume);
+		for (int32_t z = regionMins.z; z <= regionMaxs.z; ++z) {
+			for (int32_t y = regionMins.y; y <= regionMaxs.y; ++y) {
+				volumeSampler.setPosition(regionMins.x, y, z);
+				for (int32_t x = regionMins.x; x <= regionMaxs.x; ++x) {
+					const voxel::Voxel& voxel = volumeSampler.voxel();
+					volumeSampler.movePositiveX();
+					if (condition(voxel)) {
+						continue;
+					}
+					newMins.x = core_min(newMins.x, x);
+					newMins.y = core_min(newMins.y, y);
+					newMins.z = core_min(newMins.z, z);
 
-				newMaxs.x = core_max(newMaxs.x, x);
-				newMaxs.y = core_max(newMaxs.y, y);
-				newMaxs.z = core_max(newMaxs.z, z);
+					newMaxs.x = core_max(newMaxs.x, x);
+					newMaxs.y = core_max(newMaxs.y, y);
+					newMaxs.z = core_max(newMaxs.z, z);
+				}
+			}
+		}
+	};
+	if constexpr (std::is_same<CropSkipCondition, CropSkipEmpty>::value) {
+		// only look at the voxels of the bricks that contain solid voxels
+		const glm::ivec3& lowerCorner = volume->region().getLowerCorner();
+		const int brickSize = voxel::RawVolume::BrickSize;
+		for (int32_t bz = (mins.z - lowerCorner.z) / brickSize; bz <= (maxs.z - lowerCorner.z) / brickSize; ++bz) {
+			for (int32_t by = (mins.y - lowerCorner.y) / brickSize; by <= (maxs.y - lowerCorner.y) / brickSize; ++by) {
+				for (int32_t bx = (mins.x - lowerCorner.x) / brickSize; bx <= (maxs.x - lowerCorner.x) / brickSize; ++bx) {
+					const glm::ivec3 brickMins = lowerCorner + glm::ivec3(bx, by, bz) * brickSize;
+					const glm::ivec3 regionMins = (glm::max)(brickMins, mins);
+					const glm::ivec3 regionMaxs = (glm::min)(brickMins + (brickSize - 1), maxs);
+					if (volume->isEmpty(voxel::Region(regionMins, regionMaxs))) {
+						continue;
+					}
+					cropRegion(regionMins, regionMaxs);
+				}
 			}
 		}
+	} else {
+		cropRegion(mins, maxs);
 	}
 	if (newMaxs.z == (std::numeric_limits<int>::min)() / 2) {
 		return nullptr;
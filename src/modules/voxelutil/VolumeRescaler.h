@@ -6,6 +6,7 @@
 #include "core/Common.h"
 #include "core/Trace.h"
 #include "core/Color.h"
+#include "core/collection/DynamicArray.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "voxel/Voxel.h"
@@ -35,28 +36,23 @@ static bool isHidden(Sampler &srcSampler) {
 	return true;
 }
 
+namespace priv {
+
 /**
- * @brief Rescales a volume by sampling two voxels to produce one output voxel.
- * @param[in] sourceVolume The source volume to resample
- * @param[in] destVolume The destination volume to resample into
- * @param[in] sourceRegion The region of the source volume to resample
- * @param[in] destRegion The region of the destination volume to resample into. Usually this should
- * be exactly half of the size of the sourceRegion.
+ * @brief The first rescale pass - the solid voxels of the given slab of the destination region are computed
+ * @param destSlab The part of the @c destRegion that is computed - the other parts are not touched
  */
 template<typename SourceVolume, typename DestVolume>
-void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palette, const voxel::Region& sourceRegion, DestVolume& destVolume, const voxel::Region& destRegion) {
-	core_trace_scoped(RescaleVolume);
+void rescaleVolumeSolids(const SourceVolume& sourceVolume, const voxel::Palette &palette, const core::DynamicArray<glm::vec4> &materialColors,
+		const voxel::Region& sourceRegion, DestVolume& destVolume, const voxel::Region& destRegion, const voxel::Region& destSlab) {
 	typename SourceVolume::Sampler srcSampler(sourceVolume);
-
-	core::DynamicArray<glm::vec4> materialColors;
-	palette.toVec4f(materialColors);
-
-	const int32_t depth = destRegion.getDepthInVoxels();
+	const int32_t zStart = destSlab.getLowerZ() - destRegion.getLowerZ();
+	const int32_t zEnd = destSlab.getUpperZ() - destRegion.getLowerZ();
 	const int32_t height = destRegion.getHeightInVoxels();
 	const int32_t width = destRegion.getWidthInVoxels();
 	// First of all we iterate over all destination voxels and compute their color as the
 	// avg of the colors of the eight corresponding voxels in the higher resolution version.
-	for (int32_t z = 0; z < depth; ++z) {
+	for (int32_t z = zStart; z <= zEnd; ++z) {
 		for (int32_t y = 0; y < height; ++y) {
 			for (int32_t x = 0; x < width; ++x) {
 				const glm::ivec3 curPos(x, y, z);
@@ -115,15 +111,28 @@ void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palet
 			}
 		}
 	}
+}
 
+/**
+ * @brief The second rescale pass - recomputes the colors of the voxels of the given slab that are on a material-air boundary
+ *
+ * Only the colors are changed - the materials of the destination voxels that are read here stay the same. The new voxels are
+ * handed to @c setVoxel(pos, voxel) - so this can get executed for several slabs in parallel.
+ */
+template<typename SourceVolume, typename DestVolume, typename SetVoxel>
+void rescaleVolumeBoundaries(const SourceVolume& sourceVolume, const voxel::Palette &palette, const core::DynamicArray<glm::vec4> &materialColors,
+		const voxel::Region& sourceRegion, const DestVolume& destVolume, const voxel::Region& destRegion, const voxel::Region& destSlab, SetVoxel &&setVoxel) {
 	// At this point the results are usable, but we have a problem with thin structures disappearing.
 	// For example, if we have a solid blue sphere with a one voxel thick layer of red voxels on it,
 	// then we don't care that the shape changes then the red voxels are lost but we do care that the
 	// color changes, as this is very noticable. Our solution is to process again only those voxels
 	// which lie on a material-air boundary, and to recompute their color using a larger naighbourhood
 	// while also accounting for how visible the child voxels are.
+	typename SourceVolume::Sampler srcSampler(sourceVolume);
 	typename DestVolume::Sampler dstSampler(destVolume);
-	for (int32_t z = 0; z < destRegion.getDepthInVoxels(); ++z) {
+	const int32_t zStart = destSlab.getLowerZ() - destRegion.getLowerZ();
+	const int32_t zEnd = destSlab.getUpperZ() - destRegion.getLowerZ();
+	for (int32_t z = zStart; z <= zEnd; ++z) {
 		for (int32_t y = 0; y < destRegion.getHeightInVoxels(); ++y) {
 			for (int32_t x = 0; x < destRegion.getWidthInVoxels(); ++x) {
 				const glm::ivec3 curPos(x, y, z);
@@ -198,13 +207,33 @@ void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palet
 
 				const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
 				const int index = core::Color::getClosestMatch(avgColor, materialColors);
-				const voxel::Voxel voxel = voxel::createVoxel(palette, index);
-				destVolume.setVoxel(dstPos, voxel);
+				setVoxel(dstPos, voxel::createVoxel(palette, index));
 			}
 		}
 	}
 }
 
+} // namespace priv
+
+/**
+ * @brief Rescales a volume by sampling two voxels to produce one output voxel.
+ * @param[in] sourceVolume The source volume to resample
+ * @param[in] destVolume The destination volume to resample into
+ * @param[in] sourceRegion The region of the source volume to resample
+ * @param[in] destRegion The region of the destination volume to resample into. Usually this should
+ * be exactly half of the size of the sourceRegion.
+ * @sa LodPyramid
+ */
+template<typename SourceVolume, typename DestVolume>
+void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palette, const voxel::Region& sourceRegion, DestVolume& destVolume, const voxel::Region& destRegion) {
+	core_trace_scoped(RescaleVolume);
+	core::DynamicArray<glm::vec4> materialColors;
+	palette.toVec4f(materialColors);
+	priv::rescaleVolumeSolids(sourceVolume, palette, materialColors, sourceRegion, destVolume, destRegion, destRegion);
+	priv::rescaleVolumeBoundaries(sourceVolume, palette, materialColors, sourceRegion, destVolume, destRegion, destRegion,
+		[&destVolume](const glm::ivec3 &pos, const voxel::Voxel &voxel) { destVolume.setVoxel(pos, voxel); });
+}
+
 template<typename SourceVolume, typename DestVolume>
 void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palette, DestVolume& destVolume) {
 	rescaleVolume(sourceVolume, palette, sourceVolume.region(), destVolume, destVolume.region());
@@ -4,10 +4,15 @@
 
 #pragma once
 
+#include "app/App.h"
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ParallelFor.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/Face.h"
 #include "voxel/RawVolume.h"
+#include <type_traits>
 
 namespace voxelutil {
 
@@ -45,6 +50,15 @@ struct VisitAll {
 	}
 };
 
+namespace priv {
+/**
+ * @brief The raw volume knows about its empty bricks - all air voxels are skipped anyway for this condition
+ */
+template <class Volume, typename Condition>
+constexpr bool CanSkipEmptyRows =
+	std::is_same<Volume, voxel::RawVolume>::value && std::is_same<Condition, SkipEmpty>::value;
+} // namespace priv
+
 template <class Volume, class Visitor, typename Condition = SkipEmpty>
 int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int yOff, int zOff, Visitor &&visitor,
 				Condition condition = Condition(), VisitorOrder order = VisitorOrder::ZYX) {
@@ -77,8 +91,22 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::ZYX:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
+			if constexpr (priv::CanSkipEmptyRows<Volume, Condition>) {
+				// slices and rows without any solid voxel don't have anything to visit
+				if (volume.isEmpty(voxel::Region(region.getLowerX(), region.getLowerY(), z, region.getUpperX(),
+												 region.getUpperY(), z))) {
+					sampler.movePositiveZ(zOff);
+					continue;
+				}
+			}
 			typename Volume::Sampler sampler2 = sampler;
 			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
+				if constexpr (priv::CanSkipEmptyRows<Volume, Condition>) {
+					if (volume.isEmpty(voxel::Region(region.getLowerX(), y, z, region.getUpperX(), y, z))) {
+						sampler2.movePositiveY(yOff);
+						continue;
+					}
+				}
 				typename Volume::Sampler sampler3 = sampler2;
 				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
@@ -378,6 +406,120 @@ int visitVolume(const Volume &volume, const voxel::Region &region, Visitor &&vis
 	return visitVolume(volume, region, 1, 1, 1, visitor, condition, order);
 }
 
+namespace priv {
+
+/**
+ * @brief Regions with less voxels than this are visited in the calling thread
+ */
+static constexpr int MinParallelVisitVoxels = 32 * 32 * 32;
+
+/**
+ * @return The amount of slabs the region is split into for visiting it in parallel - @c 1 if the region should be
+ * visited in the calling thread
+ */
+inline int parallelVisitSlabs(const voxel::Region &region) {
+	const core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	if (region.voxels() < MinParallelVisitVoxels || threadPool.isWorkerThread()) {
+		return 1;
+	}
+	const int depth = region.getDepthInVoxels();
+	const int slabs = core_max(1, core_min(depth, (int)threadPool.size() * 4));
+	const int slabDepth = (depth + slabs - 1) / slabs;
+	return (depth + slabDepth - 1) / slabDepth;
+}
+
+/**
+ * @brief Splits the region into slabs along the z axis and executes @c slabFunc(slabIndex, slabRegion) for each of
+ * them on the app thread pool
+ * @param slabs The amount of slabs as returned by @c parallelVisitSlabs()
+ */
+template <class SlabFunc>
+void visitSlabsParallel(const voxel::Region &region, int slabs, SlabFunc &&slabFunc) {
+	if (slabs <= 1) {
+		slabFunc(0, region);
+		return;
+	}
+	const int depth = region.getDepthInVoxels();
+	const int slabDepth = (depth + slabs - 1) / slabs;
+	auto visitSlab = [&region, &slabFunc, slabDepth](int slab) {
+		voxel::Region slabRegion = region;
+		slabRegion.setLowerZ(region.getLowerZ() + slab * slabDepth);
+		slabRegion.setUpperZ(core_min(region.getUpperZ(), slabRegion.getLowerZ() + slabDepth - 1));
+		slabFunc(slab, slabRegion);
+	};
+	core::parallel_for(app::App::getInstance()->threadPool(), 0, slabs, 1, [&visitSlab](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			visitSlab(i);
+		}
+	});
+}
+
+} // namespace priv
+
+/**
+ * @brief Visits the voxels of the region on the app thread pool
+ *
+ * The region is split into slabs along the z axis - each slab is visited in @c VisitorOrder::ZYX order.
+ * @note The visitor is called concurrently from several threads. It must only read shared data or write to the
+ * positions it was called for.
+ * @return The amount of visited voxels
+ */
+template <class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(const Volume &volume, const voxel::Region &region, Visitor &&visitor,
+						Condition condition = Condition()) {
+	core_trace_scoped(VisitVolumeParallel);
+	const int slabs = priv::parallelVisitSlabs(region);
+	core::DynamicArray<int> counts;
+	counts.resize(slabs);
+	priv::visitSlabsParallel(region, slabs, [&](int slab, const voxel::Region &slabRegion) {
+		counts[slab] = visitVolume(volume, slabRegion, 1, 1, 1, visitor, condition, VisitorOrder::ZYX);
+	});
+	int cnt = 0;
+	for (int i = 0; i < slabs; ++i) {
+		cnt += counts[i];
+	}
+	return cnt;
+}
+
+template <class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(const Volume &volume, Visitor &&visitor, Condition condition = Condition()) {
+	return visitVolumeParallel(volume, volume.region(), visitor, condition);
+}
+
+/**
+ * @brief Visits the voxels of the region on the app thread pool and collects the results in a state per slab
+ *
+ * The @c visitor is called as @c visitor(slabState, x, y, z, voxel) with a value initialized @c State for each
+ * slab. When all slabs are done, @c reducer(state, slabState) is called in the calling thread in the order of the
+ * slabs.
+ * @return The amount of visited voxels
+ */
+template <class Volume, class State, class Visitor, class Reducer, typename Condition = SkipEmpty>
+int visitVolumeParallel(const Volume &volume, const voxel::Region &region, State &state, Visitor &&visitor,
+						Reducer &&reducer, Condition condition = Condition()) {
+	core_trace_scoped(VisitVolumeParallel);
+	const int slabs = priv::parallelVisitSlabs(region);
+	core::DynamicArray<State> slabStates;
+	slabStates.resize(slabs);
+	core::DynamicArray<int> counts;
+	counts.resize(slabs);
+	priv::visitSlabsParallel(region, slabs, [&](int slab, const voxel::Region &slabRegion) {
+		State &slabState = slabStates[slab];
+		counts[slab] = visitVolume(
+			volume, slabRegion, 1, 1, 1,
+			[&slabState, &visitor](int x, int y, int z, const voxel::Voxel &voxel) {
+				visitor(slabState, x, y, z, voxel);
+			},
+			condition, VisitorOrder::ZYX);
+	});
+	int cnt = 0;
+	for (int i = 0; i < slabs; ++i) {
+		reducer(state, slabStates[i]);
+		cnt += counts[i];
+	}
+	return cnt;
+}
+
 template <class Volume, class Visitor>
 int visitSurfaceVolume(const Volume &volume, Visitor &&visitor, VisitorOrder order = VisitorOrder::ZYX) {
 	int cnt = 0;
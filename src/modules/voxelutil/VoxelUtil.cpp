@@ -5,10 +5,8 @@
 #include "VoxelUtil.h"
 #include "core/ArrayLength.h"
 #include "core/GLM.h"
-#include "core/collection/Array3DView.h"
-#include "core/collection/Buffer.h"
+#include "core/collection/BitSet.h"
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Set.h"
 #include "voxel/Face.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
@@ -61,19 +59,7 @@ bool isTouching(const voxel::RawVolume *volume, const glm::ivec3& pos) {
 }
 
 bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
-	voxel::RawVolume::Sampler sampler(v);
-	for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += 1) {
-		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += 1) {
-			sampler.setPosition(x, y, region.getLowerZ());
-			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += 1) {
-				if (voxel::isBlocked(sampler.voxel().getMaterial())) {
-					return false;
-				}
-				sampler.movePositiveZ();
-			}
-		}
-	}
-	return true;
+	return v.isEmpty(region);
 }
 
 bool copy(const voxel::RawVolume &in, const voxel::Region &inRegion, voxel::RawVolume &out,
@@ -100,110 +86,172 @@ bool copyIntoRegion(const voxel::RawVolume &in, voxel::RawVolume &out, const vox
 	return copy(in, in.region(), out, targetRegion);
 }
 
-static void fillRegion(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel) {
-	const voxel::Region &region = in.region();
-	const int width = region.getWidthInVoxels();
-	const int height = region.getHeightInVoxels();
-	const int depth = region.getDepthInVoxels();
-	const int size = width * height * depth;
-	const glm::ivec3 mins = in.region().getLowerCorner();
-	core::DynamicArray<glm::ivec3> positions;
-	positions.reserve(size);
-	core::Buffer<bool> visitedData(size);
-	core::Array3DView<bool> visited(visitedData.data(), width, height, depth);
+/**
+ * @brief Scanline flood fill for planes and regions
+ *
+ * The spans are filled along the longest axis of the region. The rows next to a span are scanned for new spans.
+ * The state is kept in bitsets and the seeds are kept in an explicit stack - so the stack depth is constant and
+ * the memory usage doesn't depend on the shape of the filled area.
+ *
+ * The callback is executed exactly once for each position that is reached - if it returns @c true the position
+ * is part of the filled area and the fill continues at the neighbours.
+ */
+class SpanFill {
+private:
+	const voxel::Region _region;
+	const glm::ivec3 _mins;
+	const glm::ivec3 _maxs;
+	const glm::ivec3 _dim;
+	/** the axis the spans are filled along and the axes of the neighbour rows */
+	int _axis;
+	int _rowAxis1;
+	int _rowAxis2;
+	core::BitSet _evaluated;
+	core::BitSet _passed;
+	core::BitSet _filled;
+	core::DynamicArray<glm::ivec3> _seeds;
 
-	visitVolume(
-		in, region, 1, 1, 1,
-		[&](int x, int y, int z, const voxel::Voxel &) { visited.set(x - mins.x, y - mins.y, z - mins.z, true); },
-		SkipEmpty());
+	inline size_t index(const glm::ivec3 &pos) const {
+		const glm::ivec3 l = pos - _mins;
+		return (size_t)l.x + (size_t)l.y * _dim.x + (size_t)l.z * _dim.x * _dim.y;
+	}
 
-	for (int x = 0; x < width; ++x) {
-		for (int z = 1; z < depth - 1; ++z) {
-			const glm::ivec3 v1(x, 0, z);
-			const voxel::VoxelType m1 = in.voxel(v1 + mins).getMaterial();
-			if (voxel::isAir(m1) || voxel::isTransparent(m1)) {
-				positions.push_back(v1);
-				visited.set(v1, true);
-			}
-			const glm::ivec3 v2(x, height - 1, z);
-			const voxel::VoxelType m2 = in.voxel(v2 + mins).getMaterial();
-			if (voxel::isAir(m2) || voxel::isTransparent(m2)) {
-				positions.push_back(v2);
-				visited.set(v2, true);
-			}
+	template<class PASS>
+	inline bool evaluate(const glm::ivec3 &pos, size_t idx, PASS &pass) {
+		if (_evaluated[idx]) {
+			return _passed[idx];
 		}
-		for (int y = 0; y < height; ++y) {
-			const glm::ivec3 v1(x, y, 0);
-			const voxel::VoxelType m1 = in.voxel(v1 + mins).getMaterial();
-			if (voxel::isAir(m1) || voxel::isTransparent(m1)) {
-				positions.push_back(v1);
-				visited.set(v1, true);
-			}
-			const glm::ivec3 v2(x, y, depth - 1);
-			const voxel::VoxelType m2 = in.voxel(v2 + mins).getMaterial();
-			if (voxel::isAir(m2) || voxel::isTransparent(m2)) {
-				positions.push_back(v2);
-				visited.set(v2, true);
+		_evaluated.set(idx, true);
+		const bool p = pass(pos);
+		_passed.set(idx, p);
+		return p;
+	}
+
+	template<class PASS>
+	void scanRow(const glm::ivec3 &lo, int spanEnd, int rowAxis, int offset, PASS &pass) {
+		glm::ivec3 pos = lo;
+		pos[rowAxis] += offset;
+		if (pos[rowAxis] < _mins[rowAxis] || pos[rowAxis] > _maxs[rowAxis]) {
+			return;
+		}
+		bool inRun = false;
+		for (; pos[_axis] <= spanEnd; ++pos[_axis]) {
+			const size_t idx = index(pos);
+			if (!_filled[idx] && evaluate(pos, idx, pass)) {
+				// one seed per run - the span of the seed covers the rest of the run
+				if (!inRun) {
+					_seeds.push_back(pos);
+				}
+				inRun = true;
+			} else {
+				inRun = false;
 			}
 		}
 	}
-	for (int y = 1; y < height - 1; ++y) {
-		for (int z = 1; z < depth - 1; ++z) {
-			const glm::ivec3 v1(0, y, z);
-			const voxel::VoxelType m1 = in.voxel(v1 + mins).getMaterial();
-			if (voxel::isAir(m1) || voxel::isTransparent(m1)) {
-				positions.push_back(v1);
-				visited.set(v1, true);
-			}
-			const glm::ivec3 v2(width - 1, y, z);
-			const voxel::VoxelType m2 = in.voxel(v2 + mins).getMaterial();
-			if (voxel::isAir(m2) || voxel::isTransparent(m2)) {
-				positions.push_back(v2);
-				visited.set(v2, true);
+
+public:
+	SpanFill(const voxel::Region &region)
+		: _region(region), _mins(region.getLowerCorner()), _maxs(region.getUpperCorner()),
+		  _dim(region.getDimensionsInVoxels()), _evaluated(_dim.x * _dim.y * _dim.z),
+		  _passed(_dim.x * _dim.y * _dim.z), _filled(_dim.x * _dim.y * _dim.z) {
+		_axis = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (_dim[i] > _dim[_axis]) {
+				_axis = i;
 			}
 		}
+		_rowAxis1 = (_axis + 1) % 3;
+		_rowAxis2 = (_axis + 2) % 3;
 	}
 
-	while (!positions.empty()) {
-		const glm::ivec3 v = positions.back();
-		positions.erase(positions.size() - 1);
+	inline bool filled(const glm::ivec3 &pos) const {
+		return _filled[index(pos)];
+	}
 
-		if (v.z > 0 && !visited.get(v.x, v.y, v.z - 1)) {
-			const glm::ivec3 v1(v.x, v.y, v.z - 1);
-			visited.set(v1, true);
-			positions.push_back(v1);
+	/**
+	 * @return The amount of positions that were filled
+	 */
+	template<class PASS>
+	int fill(const glm::ivec3 &start, PASS &&pass) {
+		if (!_region.containsPoint(start)) {
+			return 0;
 		}
-		if (v.y > 0 && !visited.get(v.x, v.y - 1, v.z)) {
-			const glm::ivec3 v1(v.x, v.y - 1, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
+		const size_t startIdx = index(start);
+		if (_filled[startIdx] || !evaluate(start, startIdx, pass)) {
+			return 0;
 		}
-		if (v.x > 0 && !visited.get(v.x - 1, v.y, v.z)) {
-			const glm::ivec3 v1(v.x - 1, v.y, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
-		}
-		if (v.z < depth - 1 && !visited.get(v.x, v.y, v.z + 1)) {
-			const glm::ivec3 v1(v.x, v.y, v.z + 1);
-			visited.set(v1, true);
-			positions.push_back(v1);
+		int n = 0;
+		_seeds.push_back(start);
+		while (!_seeds.empty()) {
+			const glm::ivec3 seed = _seeds.back();
+			_seeds.erase(_seeds.size() - 1);
+			if (_filled[index(seed)]) {
+				continue;
+			}
+			glm::ivec3 lo = seed;
+			while (lo[_axis] > _mins[_axis]) {
+				glm::ivec3 prev = lo;
+				--prev[_axis];
+				const size_t idx = index(prev);
+				if (_filled[idx] || !evaluate(prev, idx, pass)) {
+					break;
+				}
+				lo = prev;
+			}
+			glm::ivec3 hi = seed;
+			while (hi[_axis] < _maxs[_axis]) {
+				glm::ivec3 next = hi;
+				++next[_axis];
+				const size_t idx = index(next);
+				if (_filled[idx] || !evaluate(next, idx, pass)) {
+					break;
+				}
+				hi = next;
+			}
+			for (glm::ivec3 pos = lo; pos[_axis] <= hi[_axis]; ++pos[_axis]) {
+				_filled.set(index(pos), true);
+			}
+			n += hi[_axis] - lo[_axis] + 1;
+			scanRow(lo, hi[_axis], _rowAxis1, -1, pass);
+			scanRow(lo, hi[_axis], _rowAxis1, 1, pass);
+			scanRow(lo, hi[_axis], _rowAxis2, -1, pass);
+			scanRow(lo, hi[_axis], _rowAxis2, 1, pass);
 		}
-		if (v.y < height - 1 && !visited.get(v.x, v.y + 1, v.z)) {
-			const glm::ivec3 v1(v.x, v.y + 1, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
+		return n;
+	}
+};
+
+static void fillRegion(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel) {
+	const voxel::Region &region = in.region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	// everything that is reachable from the border through air is outside - transparent voxels on the border
+	// are also walked through
+	auto outside = [&](const glm::ivec3 &pos) {
+		const voxel::VoxelType m = in.voxel(pos).getMaterial();
+		if (voxel::isAir(m)) {
+			return true;
 		}
-		if (v.x < width - 1 && !visited.get(v.x + 1, v.y, v.z)) {
-			const glm::ivec3 v1(v.x + 1, v.y, v.z);
-			visited.set(v1, true);
-			positions.push_back(v1);
+		return voxel::isTransparent(m) && (region.isOnBorderX(pos.x) || region.isOnBorderY(pos.y) || region.isOnBorderZ(pos.z));
+	};
+	SpanFill spanFill(region);
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			if (z == mins.z || z == maxs.z || y == mins.y || y == maxs.y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					spanFill.fill(glm::ivec3(x, y, z), outside);
+				}
+			} else {
+				spanFill.fill(glm::ivec3(mins.x, y, z), outside);
+				spanFill.fill(glm::ivec3(maxs.x, y, z), outside);
+			}
 		}
 	}
 
 	visitVolume(
 		in, region, 1, 1, 1,
-		[&](int x, int y, int z, const voxel::Voxel &) {
-			if (!visited.get(x - mins.x, y - mins.y, z - mins.z)) {
+		[&](int x, int y, int z, const voxel::Voxel &v) {
+			if (voxel::isAir(v.getMaterial()) && !spanFill.filled(glm::ivec3(x, y, z))) {
 				in.setVoxel(x, y, z, voxel);
 			}
 		},
@@ -214,53 +262,6 @@ void fillHollow(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel) {
 	fillRegion(in, voxel);
 }
 
-using IVec3Set = core::Set<glm::ivec3, 11, glm::hash<glm::ivec3>>;
-
-static int walkPlane_r(IVec3Set &visited, voxel::RawVolumeWrapper &in, const voxel::Region &region,
-					   const WalkCheckCallback &check, const WalkExecCallback &exec, const glm::ivec3 &position,
-					   const glm::ivec3 &checkOffset, voxel::FaceNames face) {
-	const glm::ivec3 checkPosition = position + checkOffset;
-	if (visited.has(checkPosition)) {
-		return 0;
-	}
-	visited.insert(checkPosition);
-	if (!region.containsPoint(position)) {
-		return 0;
-	}
-	if (!check(in, checkPosition)) {
-		return 0;
-	}
-	if (!exec(in, position)) {
-		return 0;
-	}
-	int n = 1;
-	if (region.containsPoint(position.x + 1, position.y, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x + 1, position.y, position.z), checkOffset,
-						 face);
-	}
-	if (region.containsPoint(position.x - 1, position.y, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x - 1, position.y, position.z), checkOffset,
-						 face);
-	}
-	if (region.containsPoint(position.x, position.y + 1, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y + 1, position.z), checkOffset,
-						 face);
-	}
-	if (region.containsPoint(position.x, position.y - 1, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y - 1, position.z), checkOffset,
-						 face);
-	}
-	if (region.containsPoint(position.x, position.y, position.z + 1)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y, position.z + 1), checkOffset,
-						 face);
-	}
-	if (region.containsPoint(position.x, position.y, position.z - 1)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y, position.z - 1), checkOffset,
-						 face);
-	}
-	return n;
-}
-
 static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, voxel::FaceNames face, int checkOffset,
 					 const WalkCheckCallback &check, const WalkExecCallback &exec) {
 	const voxel::Region &region = in.region();
@@ -317,11 +318,10 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 	if (!walkRegion.isValid()) {
 		return 0;
 	}
-	const glm::ivec3 &dim = walkRegion.getDimensionsInVoxels();
-	const int maxSize = dim.x * dim.y * dim.z;
-	core_assert_msg(maxSize > 0, "max size is 0 even though the region was valid");
-	IVec3Set visited(maxSize);
-	return walkPlane_r(visited, in, walkRegion, check, exec, position, checkOffsetV, face);
+	SpanFill spanFill(walkRegion);
+	return spanFill.fill(position, [&](const glm::ivec3 &pos) {
+		return check(in, pos + checkOffsetV) && exec(in, pos);
+	});
 }
 
 static glm::vec2 calcUV(const glm::ivec3 &pos, const voxel::Region &region, voxel::FaceNames face) {
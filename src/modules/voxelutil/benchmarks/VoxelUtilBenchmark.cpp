@@ -0,0 +1,121 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxelutil/LodPyramid.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "voxelutil/VoxelUtil.h"
+
+class VoxelUtilBenchmark : public app::AbstractBenchmark {
+protected:
+	core::ScopedPtr<voxel::RawVolume> _volume;
+	const voxel::Voxel _voxel1 = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Voxel _voxel2 = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+
+	void fillNoise(int size) {
+		_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		for (int z = 0; z < size; ++z) {
+			for (int y = 0; y < size; ++y) {
+				for (int x = 0; x < size; ++x) {
+					// a solid lower half with a jagged surface
+					if (y < size / 2 + ((x * 7 + z * 13) & 7)) {
+						_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1 + ((x ^ z) & 15)));
+					}
+				}
+			}
+		}
+	}
+
+public:
+	void TearDown(::benchmark::State &state) override {
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, PaintPlane)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	_volume = new voxel::RawVolume(voxel::Region(0, 0, 0, size - 1, 0, size - 1));
+	voxel::RawVolumeWrapper wrapper(_volume);
+	for (int z = 0; z < size; ++z) {
+		for (int x = 0; x < size; ++x) {
+			_volume->setVoxel(x, 0, z, _voxel1);
+		}
+	}
+	bool flip = false;
+	for (auto _ : state) {
+		const voxel::Voxel &search = flip ? _voxel2 : _voxel1;
+		const voxel::Voxel &replace = flip ? _voxel1 : _voxel2;
+		const int n = voxelutil::paintPlane(wrapper, glm::ivec3(size / 2, 0, size / 2), voxel::FaceNames::PositiveY,
+											search, replace);
+		benchmark::DoNotOptimize(n);
+		flip = !flip;
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, FillHollow)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+	voxel::RawVolumeWrapper wrapper(_volume);
+	for (int i = 0; i < size; ++i) {
+		for (int j = 0; j < size; ++j) {
+			_volume->setVoxel(0, i, j, _voxel1);
+			_volume->setVoxel(size - 1, i, j, _voxel1);
+			_volume->setVoxel(i, 0, j, _voxel1);
+			_volume->setVoxel(i, size - 1, j, _voxel1);
+			_volume->setVoxel(i, j, 0, _voxel1);
+			_volume->setVoxel(i, j, size - 1, _voxel1);
+		}
+	}
+	// keep the box open - otherwise the first iteration would fill it
+	_volume->setVoxel(0, size / 2, size / 2, voxel::Voxel());
+	for (auto _ : state) {
+		voxelutil::fillHollow(wrapper, _voxel2);
+	}
+	state.SetItemsProcessed(state.iterations() * size * size * size);
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, RescaleVolume)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	fillNoise(size);
+	voxel::Palette palette;
+	palette.nippon();
+	for (auto _ : state) {
+		// the same levels as the pyramid - but one rescaleVolume() call after another
+		core::DynamicArray<voxel::RawVolume *> levels;
+		const voxel::RawVolume *source = _volume;
+		while (source->region().getDepthInVoxels() >= 2) {
+			const glm::ivec3 &dim = source->region().getDimensionsInVoxels();
+			voxel::RawVolume *dest = new voxel::RawVolume(voxel::Region(glm::ivec3(0), dim / 2 - 1));
+			voxelutil::rescaleVolume(*source, palette, *dest);
+			levels.push_back(dest);
+			source = dest;
+		}
+		for (voxel::RawVolume *v : levels) {
+			delete v;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * size * size * size);
+}
+
+BENCHMARK_DEFINE_F(VoxelUtilBenchmark, LodPyramid)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	fillNoise(size);
+	voxel::Palette palette;
+	palette.nippon();
+	for (auto _ : state) {
+		voxelutil::LodPyramid pyramid;
+		benchmark::DoNotOptimize(pyramid.build(_volume, palette));
+	}
+	state.SetItemsProcessed(state.iterations() * size * size * size);
+}
+
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, PaintPlane)->RangeMultiplier(2)->Range(128, 512)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, FillHollow)->RangeMultiplier(2)->Range(32, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, RescaleVolume)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelUtilBenchmark, LodPyramid)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
@@ -3,6 +3,10 @@
  */
 
 #include "app/benchmark/AbstractBenchmark.h"
+#include "core/ScopedPtr.h"
+#include "core/collection/Array.h"
+#include "voxel/Palette.h"
+#include "voxelutil/VolumeCropper.h"
 #include "voxelutil/VolumeVisitor.h"
 
 class VoxelVisitorBenchmark : public app::AbstractBenchmark {
@@ -37,6 +41,112 @@ BENCHMARK_DEFINE_F(VoxelVisitorBenchmark, Visit)(benchmark::State &state) {
 	}
 }
 
+class VoxelVisitorLargeBenchmark : public app::AbstractBenchmark {
+protected:
+	core::ScopedPtr<voxel::RawVolume> _volume;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int size = (int)state.range(0);
+		_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		// half of the volume is filled - with a few colors
+		for (int z = 0; z < size; ++z) {
+			for (int y = 0; y < size / 2; ++y) {
+				for (int x = 0; x < size; ++x) {
+					_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x + z) % 16));
+				}
+			}
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+using UsedColors = core::Array<bool, voxel::PaletteMaxColors>;
+
+BENCHMARK_DEFINE_F(VoxelVisitorLargeBenchmark, UsedColors)(benchmark::State &state) {
+	for (auto _ : state) {
+		UsedColors used;
+		used.fill(false);
+		const int n = voxelutil::visitVolume(*_volume, [&used](int, int, int, const voxel::Voxel &voxel) {
+			used[voxel.getColor()] = true;
+		});
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelVisitorLargeBenchmark, UsedColorsParallel)(benchmark::State &state) {
+	auto visitor = [](UsedColors &slabUsed, int, int, int, const voxel::Voxel &voxel) {
+		slabUsed[voxel.getColor()] = true;
+	};
+	auto reducer = [](UsedColors &used, const UsedColors &slabUsed) {
+		for (size_t i = 0; i < used.size(); ++i) {
+			used[i] |= slabUsed[i];
+		}
+	};
+	for (auto _ : state) {
+		UsedColors used;
+		used.fill(false);
+		const int n = voxelutil::visitVolumeParallel(*_volume, _volume->region(), used, visitor, reducer);
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+class VoxelSparseBenchmark : public app::AbstractBenchmark {
+protected:
+	core::ScopedPtr<voxel::RawVolume> _volume;
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int size = (int)state.range(0);
+		_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		// a small model in the center of a huge volume
+		const int center = size / 2;
+		for (int i = -4; i <= 4; ++i) {
+			_volume->setVoxel(center + i, center, center, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+			_volume->setVoxel(center, center + i, center, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+			_volume->setVoxel(center, center, center + i, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelSparseBenchmark, Crop)(benchmark::State &state) {
+	for (auto _ : state) {
+		core::ScopedPtr<voxel::RawVolume> cropped(voxelutil::cropVolume(_volume));
+		benchmark::DoNotOptimize(cropped->region());
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelSparseBenchmark, IsEmpty)(benchmark::State &state) {
+	const int size = (int)state.range(0);
+	const voxel::Region region(0, 0, 0, size - 1, size - 1, size / 2 - 8);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(_volume->isEmpty(region));
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelSparseBenchmark, Visit)(benchmark::State &state) {
+	for (auto _ : state) {
+		const int n = voxelutil::visitVolume(*_volume, [](int, int, int, const voxel::Voxel &) {});
+		benchmark::DoNotOptimize(n);
+	}
+}
+
 BENCHMARK_REGISTER_F(VoxelVisitorBenchmark, Visit)->DenseRange(0, (int)(voxelutil::VisitorOrder::Max)-1);
+BENCHMARK_REGISTER_F(VoxelVisitorLargeBenchmark, UsedColors)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_REGISTER_F(VoxelVisitorLargeBenchmark, UsedColorsParallel)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_REGISTER_F(VoxelSparseBenchmark, Crop)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelSparseBenchmark, IsEmpty)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VoxelSparseBenchmark, Visit)->RangeMultiplier(2)->Range(64, 256)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,141 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxel/tests/VoxelPrinter.h"
+#include "voxelutil/LodPyramid.h"
+#include "voxelutil/VolumeRescaler.h"
+#include <glm/geometric.hpp>
+
+namespace voxelutil {
+
+class LodPyramidTest : public app::AbstractTest {
+protected:
+	// a sphere with a thin shell of another color to also hit the boundary color pass
+	void fillSphere(voxel::RawVolume &volume) {
+		const voxel::Region &region = volume.region();
+		const glm::ivec3 center = region.getCenter();
+		const float radius = (float)region.getWidthInVoxels() / 2.0f - 2.0f;
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const float distance = glm::distance(glm::vec3(x, y, z), glm::vec3(center));
+					if (distance > radius) {
+						continue;
+					}
+					const uint8_t color = distance > radius - 1.0f ? 37 : (uint8_t)(1 + (x & 3) + (z & 7));
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+};
+
+TEST_F(LodPyramidTest, testLevels) {
+	voxel::RawVolume volume(voxel::Region(0, 0, 0, 31, 15, 7));
+	fillSphere(volume);
+	voxel::Palette palette;
+	palette.nippon();
+	LodPyramid pyramid;
+	EXPECT_EQ(4, pyramid.build(&volume, palette));
+	EXPECT_EQ(&volume, pyramid.volume(0));
+	EXPECT_EQ(voxel::Region(0, 0, 0, 3, 1, 0), pyramid.volume(3)->region());
+	EXPECT_EQ(nullptr, pyramid.volume(4));
+
+	EXPECT_EQ(2, pyramid.build(&volume, palette, 2));
+	EXPECT_EQ(voxel::Region(0, 0, 0, 15, 7, 3), pyramid.volume(1)->region());
+}
+
+TEST_F(LodPyramidTest, testMatchesRescaleVolume) {
+	voxel::RawVolume volume(voxel::Region(-10, 85));
+	fillSphere(volume);
+	voxel::Palette palette;
+	palette.nippon();
+
+	LodPyramid pyramid;
+	ASSERT_EQ(3, pyramid.build(&volume, palette, 3));
+
+	const voxel::RawVolume *source = &volume;
+	for (int level = 1; level < pyramid.levels(); ++level) {
+		const voxel::Region &sourceRegion = source->region();
+		const glm::ivec3 &lower = sourceRegion.getLowerCorner();
+		const voxel::Region destRegion(lower, lower + sourceRegion.getDimensionsInVoxels() / 2 - 1);
+		voxel::RawVolume expected(destRegion);
+		rescaleVolume(*source, palette, sourceRegion, expected, destRegion);
+
+		const voxel::RawVolume *lod = pyramid.volume(level);
+		ASSERT_EQ(destRegion, lod->region());
+		EXPECT_FALSE(lod->isEmpty());
+		for (int z = destRegion.getLowerZ(); z <= destRegion.getUpperZ(); ++z) {
+			for (int y = destRegion.getLowerY(); y <= destRegion.getUpperY(); ++y) {
+				for (int x = destRegion.getLowerX(); x <= destRegion.getUpperX(); ++x) {
+					ASSERT_EQ(expected.voxel(x, y, z), lod->voxel(x, y, z))
+						<< "level " << level << " differs at " << x << ":" << y << ":" << z;
+				}
+			}
+		}
+		EXPECT_EQ(expected.solidVoxels(), lod->solidVoxels());
+		source = lod;
+	}
+}
+
+TEST_F(LodPyramidTest, testMeshCached) {
+	voxel::RawVolume volume(voxel::Region(0, 31));
+	fillSphere(volume);
+	voxel::Palette palette;
+	palette.nippon();
+	LodPyramid pyramid;
+	pyramid.build(&volume, palette, 2);
+	const voxel::ChunkMesh *mesh0 = pyramid.mesh(0);
+	const voxel::ChunkMesh *mesh1 = pyramid.mesh(1);
+	ASSERT_NE(nullptr, mesh0);
+	ASSERT_NE(nullptr, mesh1);
+	EXPECT_EQ(mesh1, pyramid.mesh(1));
+	EXPECT_GT(mesh1->mesh[0].getNoOfIndices(), 0u);
+	EXPECT_LT(mesh1->mesh[0].getNoOfIndices(), mesh0->mesh[0].getNoOfIndices());
+	EXPECT_EQ(nullptr, pyramid.mesh(2));
+}
+
+TEST_F(LodPyramidTest, testMeshClosed) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	for (int z = 0; z < 16; ++z) {
+		for (int y = 0; y < 16; ++y) {
+			for (int x = 0; x < 16; ++x) {
+				volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+			}
+		}
+	}
+	voxel::Palette palette;
+	palette.nippon();
+	LodPyramid pyramid;
+	pyramid.build(&volume, palette, 2);
+	const voxel::ChunkMesh *mesh = pyramid.mesh(1);
+	ASSERT_NE(nullptr, mesh);
+
+	// count the triangles per face direction - a solid cube must be closed on all six sides
+	int sides[6]{};
+	const voxel::Mesh &opaque = mesh->mesh[0];
+	const voxel::IndexArray &indices = opaque.getIndexVector();
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const glm::vec3 &p0 = opaque.getVertex(indices[i + 0]).position;
+		const glm::vec3 &p1 = opaque.getVertex(indices[i + 1]).position;
+		const glm::vec3 &p2 = opaque.getVertex(indices[i + 2]).position;
+		const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		for (int axis = 0; axis < 3; ++axis) {
+			if (normal[axis] > 0.0f) {
+				++sides[axis * 2];
+			} else if (normal[axis] < 0.0f) {
+				++sides[axis * 2 + 1];
+			}
+		}
+	}
+	for (int i = 0; i < 6; ++i) {
+		EXPECT_GT(sides[i], 0) << "no faces for side " << i;
+	}
+}
+
+} // namespace voxelutil
@@ -27,6 +27,31 @@ TEST_F(VolumeVisitorTest, testVisitSurface) {
 	EXPECT_EQ(26, cnt);
 }
 
+TEST_F(VolumeVisitorTest, testVisitParallel) {
+	// big enough to get split into slabs
+	const voxel::Region region(glm::ivec3(-10, 0, 3), glm::ivec3(53, 40, 90));
+	voxel::RawVolume volume(region);
+	for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				if ((x + y * 3 + z * 7) % 4 == 0) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (x + z) % 5));
+				}
+			}
+		}
+	}
+	int64_t expectedSum = 0;
+	const int expected = visitVolume(volume, [&](int x, int y, int z, const voxel::Voxel &) { expectedSum += x + y + z; });
+	ASSERT_GT(expected, 0);
+	EXPECT_EQ(expected, visitVolumeParallel(volume, [](int, int, int, const voxel::Voxel &) {}));
+
+	int64_t sum = 0;
+	auto visitor = [](int64_t &slabSum, int x, int y, int z, const voxel::Voxel &) { slabSum += x + y + z; };
+	auto reducer = [](int64_t &target, int64_t slabSum) { target += slabSum; };
+	EXPECT_EQ(expected, visitVolumeParallel(volume, region, sum, visitor, reducer));
+	EXPECT_EQ(expectedSum, sum);
+}
+
 TEST_F(VolumeVisitorTest, testVisitSurfaceCorners) {
 	const voxel::Region region(0, 2);
 	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
@@ -64,6 +64,64 @@ TEST_F(VoxelUtilTest, testFillHollowLeak) {
 	EXPECT_EQ(0, v.voxel(region.getCenter()).getColor());
 }
 
+TEST_F(VoxelUtilTest, testFillHollowIsland) {
+	voxel::Region region(0, 31);
+	voxel::RawVolume v(region);
+	const voxel::Voxel borderVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	// a hollow box with a solid island in the center and an open pocket at the lower x side
+	voxelutil::visitVolume(
+		v,
+		[&](int x, int y, int z, const voxel::Voxel &) {
+			const bool shell = x == 0 || y == 0 || z == 0 || x == 31 || y == 31 || z == 31;
+			const bool island = x >= 12 && x <= 19 && y >= 12 && y <= 19 && z >= 12 && z <= 19;
+			if (shell || island) {
+				v.setVoxel(x, y, z, borderVoxel);
+			}
+		},
+		VisitAll());
+	v.setVoxel(0, 5, 5, voxel::Voxel());
+
+	const voxel::Voxel fillVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	voxel::RawVolumeWrapper wrapper(&v);
+	voxelutil::fillHollow(wrapper, fillVoxel);
+	// the pocket leaks - nothing is filled
+	EXPECT_EQ(0, voxelutil::visitVolume(v, [](int, int, int, const voxel::Voxel &) {}, [](const voxel::Voxel &voxel) {
+		return voxel.getColor() == 2;
+	}));
+
+	v.setVoxel(0, 5, 5, borderVoxel);
+	voxelutil::fillHollow(wrapper, fillVoxel);
+	EXPECT_EQ(30 * 30 * 30 - 8 * 8 * 8, voxelutil::visitVolume(v, [](int, int, int, const voxel::Voxel &) {}, [](const voxel::Voxel &voxel) {
+		return voxel.getColor() == 2;
+	}));
+}
+
+TEST_F(VoxelUtilTest, testPaintPlaneSerpentine) {
+	// the plane is split by walls into a serpentine - a recursive walk would need one stack frame per voxel
+	const int size = 256;
+	voxel::Region region(0, 0, 0, size - 1, 0, size - 1);
+	voxel::RawVolume v(region);
+	const voxel::Voxel fillVoxel1 = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	const voxel::Voxel fillVoxel2 = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	const voxel::Voxel wallVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 4);
+	int expected = 0;
+	for (int z = 0; z < size; ++z) {
+		for (int x = 0; x < size; ++x) {
+			const bool wall = x % 4 == 2 && (x % 8 == 2 ? z != size - 1 : z != 0);
+			v.setVoxel(x, 0, z, wall ? wallVoxel : fillVoxel1);
+			if (!wall) {
+				++expected;
+			}
+		}
+	}
+	voxel::RawVolumeWrapper wrapper(&v);
+	EXPECT_EQ(expected, voxelutil::paintPlane(wrapper, glm::ivec3(0, 0, 0), voxel::FaceNames::PositiveY, fillVoxel1, fillVoxel2));
+	EXPECT_EQ(0, voxelutil::visitVolume(v, [](int, int, int, const voxel::Voxel &) {}, [&](const voxel::Voxel &voxel) {
+		return voxel.isSame(fillVoxel1);
+	}));
+	EXPECT_EQ(0, voxelutil::paintPlane(wrapper, glm::ivec3(0, 0, 0), voxel::FaceNames::PositiveY, fillVoxel1, fillVoxel2));
+}
+
 TEST_F(VoxelUtilTest, testExtrudePlanePositiveY) {
 	voxel::Region region(0, 2);
 	voxel::RawVolume v(region);
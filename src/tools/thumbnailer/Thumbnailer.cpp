@@ -8,11 +8,13 @@
 #include "core/StringUtil.h"
 #include "glm/gtc/constants.hpp"
 #include "io/FileStream.h"
+#include "io/MappedFileReadStream.h"
 #include "io/Filesystem.h"
 #include "core/TimeProvider.h"
 #include "core/Var.h"
 #include "voxel/MaterialColor.h"
 #include "voxelformat/FormatConfig.h"
+#include "voxelformat/SoftwareThumbnail.h"
 #include "voxelformat/VolumeFormat.h"
 #include "voxelrender/ImageGenerator.h"
 #include "core/Log.h"
@@ -32,12 +34,14 @@ app::AppState Thumbnailer::onConstruct() {
 
 	registerArg("--size").setShort("-s").setDescription("Size of the thumbnail in pixels").setDefaultValue("128").setMandatory();
 	registerArg("--turntable").setShort("-t").setDescription("Render in different angles");
+	registerArg("--software").setDescription("Render on the cpu - no gpu or display is needed");
 
 	return state;
 }
 
 app::AppState Thumbnailer::onInit() {
-	const app::AppState state = Super::onInit();
+	_software = hasArg("--software");
+	const app::AppState state = _software ? app::App::onInit() : Super::onInit();
 	if (state != app::AppState::Running) {
 		return state;
 	}
@@ -65,7 +69,7 @@ app::AppState Thumbnailer::onInit() {
 	return state;
 }
 
-static image::ImagePtr volumeThumbnail(const core::String &fileName, io::SeekableReadStream &stream, const voxelformat::ThumbnailContext &ctx) {
+static image::ImagePtr volumeThumbnail(const core::String &fileName, io::SeekableReadStream &stream, const voxelformat::ThumbnailContext &ctx, bool software) {
 	voxelformat::LoadContext loadctx;
 	image::ImagePtr image = voxelformat::loadScreenshot(fileName, stream, loadctx);
 	if (image && image->isLoaded()) {
@@ -78,12 +82,15 @@ static image::ImagePtr volumeThumbnail(const core::String &fileName, io::Seekabl
 		Log::error("Failed to load given input file: %s", fileName.c_str());
 		return image::ImagePtr();
 	}
+	if (software) {
+		return voxelformat::softwareThumbnail(sceneGraph, ctx);
+	}
 	return voxelrender::volumeThumbnail(sceneGraph, ctx);
 }
 
-static bool volumeTurntable(const core::String &modelFile, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops) {
+static bool volumeTurntable(const core::String &modelFile, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops, bool software) {
 	scenegraph::SceneGraph sceneGraph;
-	io::FileStream stream(io::filesystem()->open(modelFile, io::FileMode::SysRead));
+	io::MappedFileReadStream stream(io::filesystem()->open(modelFile, io::FileMode::SysRead));
 	stream.seek(0);
 	voxelformat::LoadContext loadctx;
 	if (!voxelformat::loadFormat(modelFile, stream, sceneGraph, loadctx)) {
@@ -91,14 +98,23 @@ static bool volumeTurntable(const core::String &modelFile, const core::String &i
 		return false;
 	}
 
+	if (software) {
+		return voxelformat::softwareTurntable(sceneGraph, imageFile, ctx, loops);
+	}
 	return voxelrender::volumeTurntable(sceneGraph, imageFile, ctx, loops);
 }
 
 
 app::AppState Thumbnailer::onRunning() {
-	app::AppState state = Super::onRunning();
-	if (state != app::AppState::Running) {
-		return state;
+	app::AppState state = app::AppState::Running;
+	if (_software) {
+		// there is no frame to render - only the per frame work of the app is executed
+		app::App::onRunning();
+	} else {
+		state = Super::onRunning();
+		if (state != app::AppState::Running) {
+			return state;
+		}
 	}
 
 	const int outputSize = core::string::toInt(getArgVal("--size"));
@@ -107,10 +123,10 @@ app::AppState Thumbnailer::onRunning() {
 	ctx.outputSize = glm::ivec2(outputSize);
 	const bool renderTurntable = hasArg("--turntable");
 	if (renderTurntable) {
-		volumeTurntable(_infile->name(), _outfile, ctx, 16);
+		volumeTurntable(_infile->name(), _outfile, ctx, 16, _software);
 	} else {
-		io::FileStream stream(_infile);
-		const image::ImagePtr &image = volumeThumbnail(_infile->name(), stream, ctx);
+		io::MappedFileReadStream stream(_infile);
+		const image::ImagePtr &image = volumeThumbnail(_infile->name(), stream, ctx, _software);
 		saveImage(image);
 	}
 
@@ -134,6 +150,9 @@ bool Thumbnailer::saveImage(const image::ImagePtr &image) {
 }
 
 app::AppState Thumbnailer::onCleanup() {
+	if (_software) {
+		return app::App::onCleanup();
+	}
 	return Super::onCleanup();
 }
 
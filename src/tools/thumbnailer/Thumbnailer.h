@@ -19,6 +19,11 @@ private:
 
 	io::FilePtr _infile;
 	core::String _outfile;
+	/**
+	 * the thumbnails are rendered on the cpu - the video subsystem of the windowed app is not initialized, so this
+	 * works without a gpu or display
+	 */
+	bool _software = false;
 
 protected:
 	virtual bool saveImage(const image::ImagePtr &image);
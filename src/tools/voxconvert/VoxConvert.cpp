@@ -12,9 +12,12 @@
 #include "command/Command.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Set.h"
+#include "core/collection/StringSet.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Concurrency.h"
 #include "image/Image.h"
 #include "io/FileStream.h"
+#include "io/MappedFileReadStream.h"
 #include "io/Filesystem.h"
 #include "core/TimeProvider.h"
 #include "io/FormatDescription.h"
@@ -25,6 +28,7 @@
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxelformat/FormatConfig.h"
+#include "voxelformat/SoftwareThumbnail.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "scenegraph/SceneGraphUtil.h"
 #include "voxelformat/VolumeFormat.h"
@@ -52,8 +56,11 @@ VoxConvert::VoxConvert(const io::FilesystemPtr& filesystem, const core::TimeProv
 
 app::AppState VoxConvert::onConstruct() {
 	const app::AppState state = Super::onConstruct();
+	registerArg("--batch").setDescription("Convert each input file on its own into the output pattern - e.g. 'outdir/*.gltf'");
+	registerArg("--batch-jobs").setDefaultValue("0").setDescription("Max amount of files that are converted in parallel in batch mode - 0 uses all cores");
 	registerArg("--crop").setDescription("Reduce the volumes to their real voxel sizes");
 	registerArg("--dump").setDescription("Dump the scene graph of the input file");
+	registerArg("--embed-thumbnail").setDescription("Render the preview image that some formats embed into the output file - no gpu is needed");
 	registerArg("--export-layers").setDescription("Export all the layers of a scene into single files");
 	registerArg("--export-palette").setDescription("Export the used palette data into an image");
 	registerArg("--filter").setDescription("Layer filter. For example '1-4,6'");
@@ -74,6 +81,8 @@ app::AppState VoxConvert::onConstruct() {
 	registerArg("--script").setDefaultValue("script.lua").setDescription("Apply the given lua script to the output volume");
 	registerArg("--scriptcolor").setDefaultValue("1").setDescription("Set the palette index that is given to the script parameters");
 	registerArg("--split").setDescription("Slices the volumes into pieces of the given size <x:y:z>");
+	registerArg("--thumbnail").setDescription("Render a png preview image of the scene into the output file - no gpu is needed");
+	registerArg("--thumbnail-size").setDefaultValue("128").setDescription("Size of the preview image in pixels");
 	registerArg("--translate").setShort("-t").setDescription("Translate the volumes by x (right), y (up), z (back)");
 
 	voxelformat::FormatConfig::init();
@@ -147,6 +156,7 @@ app::AppState VoxConvert::onInit() {
 	}
 
 	const bool hasScript = hasArg("--script");
+	const bool batchMode = hasArg("--batch");
 
 	core::String infilesstr;
 	core::DynamicArray<core::String> infiles;
@@ -189,6 +199,9 @@ app::AppState VoxConvert::onInit() {
 	_splitVolumes     = hasArg("--split");
 	_dumpSceneGraph   = hasArg("--dump");
 	_resizeVolumes    = hasArg("--resize");
+	_thumbnail        = hasArg("--thumbnail");
+	_thumbnailSize    = core::string::toInt(getArgVal("--thumbnail-size"));
+	_embedThumbnail   = hasArg("--embed-thumbnail");
 
 	Log::info("Options");
 	if (inputIsMesh || voxelformat::isMeshFormat(outfile)) {
@@ -212,7 +225,7 @@ app::AppState VoxConvert::onInit() {
 		Log::info("* output files:      - %s", outfile.c_str());
 	}
 
-	if (io::isA(outfile, io::format::palettes()) && infiles.size() == 1) {
+	if (!batchMode && !_thumbnail && io::isA(outfile, io::format::palettes()) && infiles.size() == 1) {
 		voxel::Palette palette;
 		if (!voxelformat::importPalette(infiles[0], palette)) {
 			Log::error("Failed to import the palette from %s", infiles[0].c_str());
@@ -245,6 +258,18 @@ app::AppState VoxConvert::onInit() {
 	Log::info("* export palette:    - %s", (_exportPalette    ? "true" : "false"));
 	Log::info("* export layers:     - %s", (_exportLayers     ? "true" : "false"));
 	Log::info("* resize volumes:    - %s", (_resizeVolumes    ? "true" : "false"));
+	Log::info("* thumbnail:         - %s", (_thumbnail        ? "true" : "false"));
+	if (_thumbnail) {
+		Log::info("* thumbnail size:    - %i", _thumbnailSize);
+	}
+	Log::info("* embed thumbnail:   - %s", (_embedThumbnail   ? "true" : "false"));
+
+	if (batchMode) {
+		if (!convertBatch(infiles, outfile, scriptParameters)) {
+			return app::AppState::InitFailure;
+		}
+		return state;
+	}
 
 	voxel::Palette palette = voxel::getPalette();
 
@@ -289,6 +314,11 @@ app::AppState VoxConvert::onInit() {
 				return app::AppState::InitFailure;
 			}
 		} else {
+			if (!filesystem()->exists(infile)) {
+				Log::error("Given input file '%s' does not exist", infile.c_str());
+				_exitCode = 127;
+				return app::AppState::InitFailure;
+			}
 			if (!handleInputFile(infile, sceneGraph, infiles.size() > 1)) {
 				return app::AppState::InitFailure;
 			}
@@ -307,6 +337,181 @@ app::AppState VoxConvert::onInit() {
 		return app::AppState::InitFailure;
 	}
 
+	if (!applyOperations(sceneGraph, infiles, infilesstr, scriptParameters)) {
+		return app::AppState::InitFailure;
+	}
+
+	if (outputFile) {
+		Log::debug("Save %i volumes", (int)sceneGraph.size());
+		if (!saveOutput(outputFile, sceneGraph)) {
+			Log::error("Failed to write to output file '%s'", outfile.c_str());
+			return app::AppState::InitFailure;
+		}
+		Log::info("Wrote output file %s", outputFile->name().c_str());
+	}
+	return state;
+}
+
+int VoxConvert::collectBatchJobs(const core::DynamicArray<core::String> &infiles, const core::String &outpattern,
+								 core::DynamicArray<BatchJob> &jobs) {
+	core::StringSet outfiles;
+	int failures = 0;
+	for (const core::String &infile : infiles) {
+		core::DynamicArray<io::FilesystemEntry> entities;
+		if (filesystem()->isReadableDir(infile)) {
+			filesystem()->list(infile, entities);
+		} else if (infile.contains("*") || infile.contains("?")) {
+			core::String dir = core::string::extractPath(infile);
+			if (dir.empty()) {
+				dir = ".";
+			}
+			filesystem()->list(dir, entities, core::string::extractFilenameWithExtension(infile));
+		} else {
+			const io::FilePtr &file = filesystem()->open(infile, io::FileMode::SysRead);
+			if (!file->exists()) {
+				Log::error("Given input file '%s' does not exist", infile.c_str());
+				++failures;
+				continue;
+			}
+			io::FilesystemEntry entry;
+			entry.name = core::string::extractFilenameWithExtension(infile);
+			entry.fullPath = infile;
+			entry.type = io::FilesystemEntry::Type::file;
+			entry.size = file->length();
+			entities.push_back(entry);
+		}
+		for (const io::FilesystemEntry &entry : entities) {
+			if (!entry.isFile()) {
+				continue;
+			}
+			BatchJob job;
+			job.infile = entry.fullPath;
+			job.outfile = core::string::replaceAll(outpattern, "*", core::string::extractFilename(entry.name));
+			job.size = entry.size;
+			if (!outfiles.insert(job.outfile)) {
+				Log::error("Output file '%s' for '%s' was already used by another input file", job.outfile.c_str(),
+						   job.infile.c_str());
+				++failures;
+				continue;
+			}
+			if (!hasArg("--force") && filesystem()->exists(job.outfile)) {
+				Log::error("Given output file '%s' already exists", job.outfile.c_str());
+				++failures;
+				continue;
+			}
+			jobs.push_back(job);
+		}
+	}
+	return failures;
+}
+
+bool VoxConvert::saveOutput(const io::FilePtr &outputFile, scenegraph::SceneGraph &sceneGraph) {
+	if (_thumbnail) {
+		voxelformat::ThumbnailContext ctx;
+		ctx.outputSize = glm::ivec2(_thumbnailSize);
+		const image::ImagePtr &image = voxelformat::softwareThumbnail(sceneGraph, ctx);
+		if (!image) {
+			return false;
+		}
+		io::FileStream stream(outputFile);
+		return image->writePng(stream);
+	}
+	voxelformat::SaveContext saveCtx;
+	if (_embedThumbnail) {
+		saveCtx.thumbnailCreator = voxelformat::softwareThumbnail;
+	}
+	return voxelformat::saveFormat(outputFile, nullptr, sceneGraph, saveCtx);
+}
+
+bool VoxConvert::convertFile(const BatchJob &job, const core::String &scriptParameters) {
+	scenegraph::SceneGraph sceneGraph;
+	if (!handleInputFile(job.infile, sceneGraph, false) || sceneGraph.empty()) {
+		Log::error("Failed to load input file '%s'", job.infile.c_str());
+		return false;
+	}
+	const core::DynamicArray<core::String> infiles{job.infile};
+	if (!applyOperations(sceneGraph, infiles, job.infile, scriptParameters)) {
+		return false;
+	}
+	const io::FilePtr &outputFile = filesystem()->open(job.outfile, io::FileMode::SysWrite);
+	if (!outputFile->validHandle()) {
+		Log::error("Could not open target file: %s", job.outfile.c_str());
+		return false;
+	}
+	if (!saveOutput(outputFile, sceneGraph)) {
+		Log::error("Failed to write to output file '%s'", job.outfile.c_str());
+		return false;
+	}
+	Log::info("Wrote output file %s", job.outfile.c_str());
+	return true;
+}
+
+bool VoxConvert::convertBatch(const core::DynamicArray<core::String> &infiles, const core::String &outpattern,
+							  const core::String &scriptParameters) {
+	if (!outpattern.contains("*")) {
+		Log::error("Batch mode needs an output pattern like 'outdir/*.gltf' - got '%s'", outpattern.c_str());
+		return false;
+	}
+	core::DynamicArray<BatchJob> jobs;
+	int failures = collectBatchJobs(infiles, outpattern, jobs);
+	if (jobs.empty()) {
+		Log::error("Could not find any input file for the batch conversion");
+		return false;
+	}
+	const core::String &outdir = core::string::extractPath(outpattern);
+	if (!outdir.empty() && !filesystem()->createDir(outdir)) {
+		Log::error("Failed to create the output directory %s", outdir.c_str());
+		return false;
+	}
+
+	// every file in flight keeps its scene graph in memory - so only allow a limited amount of conversions to be
+	// queued at the same time
+	core::ThreadPool &pool = threadPool();
+	int maxInFlight = core::string::toInt(getArgVal("--batch-jobs"));
+	if (maxInFlight <= 0) {
+		maxInFlight = (int)pool.size();
+	}
+	maxInFlight = core_max(1, maxInFlight);
+	Log::info("Convert %i files with %i files in flight", (int)jobs.size(), maxInFlight);
+
+	const uint64_t startTime = core::TimeProvider::highResTime();
+	uint64_t bytes = 0u;
+	int converted = 0;
+	core::DynamicArray<std::future<bool>> futures;
+	futures.reserve(jobs.size());
+	auto waitFor = [&](size_t idx) {
+		if (futures[idx].get()) {
+			bytes += jobs[idx].size;
+			++converted;
+		} else {
+			++failures;
+		}
+	};
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		if (i >= (size_t)maxInFlight) {
+			waitFor(i - maxInFlight);
+		}
+		futures.emplace_back(pool.enqueue([this, &jobs, &scriptParameters, i]() {
+			return convertFile(jobs[i], scriptParameters);
+		}));
+	}
+	for (size_t i = jobs.size() > (size_t)maxInFlight ? jobs.size() - maxInFlight : 0; i < jobs.size(); ++i) {
+		waitFor(i);
+	}
+
+	const double seconds =
+		(double)(core::TimeProvider::highResTime() - startTime) / (double)core::TimeProvider::highResTimeResolution();
+	const double megabytes = (double)bytes / (1024.0 * 1024.0);
+	const double safeSeconds = core_max(seconds, 0.000001);
+	Log::info("Batch conversion done in %.2fs", seconds);
+	Log::info("* converted:         - %i files (%.2f files/s)", converted, (double)converted / safeSeconds);
+	Log::info("* input data:        - %.2f MB (%.2f MB/s)", megabytes, megabytes / safeSeconds);
+	Log::info("* failures:          - %i", failures);
+	return failures == 0;
+}
+
+bool VoxConvert::applyOperations(scenegraph::SceneGraph &sceneGraph, const core::DynamicArray<core::String> &infiles,
+								 const core::String &infilesstr, const core::String &scriptParameters) {
 	const bool applyFilter = hasArg("--filter");
 	if (applyFilter) {
 		if (infiles.size() == 1u) {
@@ -328,7 +533,7 @@ app::AppState VoxConvert::onInit() {
 		const scenegraph::SceneGraph::MergedVolumePalette &merged = sceneGraph.merge();
 		if (merged.first == nullptr) {
 			Log::error("Failed to merge volumes");
-			return app::AppState::InitFailure;
+			return false;
 		}
 		sceneGraph.clear();
 		scenegraph::SceneGraphNode node;
@@ -370,17 +575,7 @@ app::AppState VoxConvert::onInit() {
 	if (_splitVolumes) {
 		split(getArgIvec3("--split"), sceneGraph);
 	}
-
-	if (outputFile) {
-		Log::debug("Save %i volumes", (int)sceneGraph.size());
-		voxelformat::SaveContext saveCtx;
-		if (!voxelformat::saveFormat(outputFile, nullptr, sceneGraph, saveCtx)) {
-			Log::error("Failed to write to output file '%s'", outfile.c_str());
-			return app::AppState::InitFailure;
-		}
-		Log::info("Wrote output file %s", outputFile->name().c_str());
-	}
-	return state;
+	return true;
 }
 
 core::String VoxConvert::getFilenameForLayerName(const core::String &inputfile, const core::String &layerName, int id) {
@@ -402,8 +597,8 @@ bool VoxConvert::handleInputFile(const core::String &infile, scenegraph::SceneGr
 	Log::info("-- current input file: %s", infile.c_str());
 	const io::FilePtr inputFile = filesystem()->open(infile, io::FileMode::SysRead);
 	if (!inputFile->exists()) {
+		// this is also called from the workers of the batch mode - so don't touch the exit code here
 		Log::error("Given input file '%s' does not exist", infile.c_str());
-		_exitCode = 127;
 		return false;
 	}
 	const bool inputIsImage = inputFile->isAnyOf(io::format::images());
@@ -468,7 +663,7 @@ bool VoxConvert::handleInputFile(const core::String &infile, scenegraph::SceneGr
 			pal.convertImageToPalettePng(image, filename.c_str());
 		}
 	} else {
-		io::FileStream inputFileStream(inputFile);
+		io::MappedFileReadStream inputFileStream(inputFile);
 		scenegraph::SceneGraph newSceneGraph;
 		voxelformat::LoadContext loadCtx;
 		loadCtx.monitor = printProgress;
@@ -500,6 +695,9 @@ void VoxConvert::exportLayersIntoSingleObjects(scenegraph::SceneGraph& sceneGrap
 	Log::info("Export layers into single objects");
 	int n = 0;
 	voxelformat::SaveContext saveCtx;
+	if (_embedThumbnail) {
+		saveCtx.thumbnailCreator = voxelformat::softwareThumbnail;
+	}
 	for (scenegraph::SceneGraphNode& node : sceneGraph) {
 		scenegraph::SceneGraph newSceneGraph;
 		scenegraph::SceneGraphNode newNode;
@@ -551,7 +749,7 @@ int VoxConvert::dumpNode_r(const scenegraph::SceneGraph& sceneGraph, int nodeId,
 		voxel::RawVolume *v = node.volume();
 		Log::info("%*s  |- volume: %s", indent, " ", v != nullptr ? v->region().toString().c_str() : "no volume");
 		if (v) {
-			voxelutil::visitVolume(*v, [&](int, int, int, const voxel::Voxel &) { ++voxels; });
+			voxels = voxelutil::visitVolumeParallel(*v, [](int, int, int, const voxel::Voxel &) {});
 		}
 		Log::info("%*s  |- voxels: %i", indent, " ", voxels);
 	} else if (type == scenegraph::SceneGraphNodeType::Camera) {
@@ -37,11 +37,41 @@ private:
 	bool _splitVolumes = false;
 	bool _dumpSceneGraph = false;
 	bool _resizeVolumes = false;
+	bool _thumbnail = false;
+	int _thumbnailSize = 128;
+	bool _embedThumbnail = false;
+
+	struct BatchJob {
+		core::String infile;
+		core::String outfile;
+		uint64_t size = 0u; /**< size of the input file in bytes */
+	};
 
 protected:
 	glm::ivec3 getArgIvec3(const core::String &name);
 	core::String getFilenameForLayerName(const core::String& inputfile, const core::String &layerName, int id);
 	bool handleInputFile(const core::String &infile, scenegraph::SceneGraph &sceneGraph, bool multipleInputs);
+	bool applyOperations(scenegraph::SceneGraph &sceneGraph, const core::DynamicArray<core::String> &infiles,
+						 const core::String &infilesstr, const core::String &scriptParameters);
+	/**
+	 * @brief Collects the input files of directories and wildcards and maps them onto the output pattern. The @c *
+	 * in the output pattern is replaced by the input file name without extension.
+	 * @return The amount of input files that can't get converted
+	 */
+	int collectBatchJobs(const core::DynamicArray<core::String> &infiles, const core::String &outpattern,
+						 core::DynamicArray<BatchJob> &jobs);
+	/**
+	 * @brief Writes the scene graph in the format of the file extension - or as png thumbnail if @c --thumbnail is
+	 * given
+	 */
+	bool saveOutput(const io::FilePtr &outputFile, scenegraph::SceneGraph &sceneGraph);
+	bool convertFile(const BatchJob &job, const core::String &scriptParameters);
+	/**
+	 * @brief Converts each input file on its own into its own output file. The conversions are executed in
+	 * the thread pool.
+	 */
+	bool convertBatch(const core::DynamicArray<core::String> &infiles, const core::String &outpattern,
+					  const core::String &scriptParameters);
 
 	void usage() const override;
 	void mirror(const core::String& axisStr, scenegraph::SceneGraph& sceneGraph);
@@ -11,6 +11,7 @@
 #include "io/MemoryReadStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
+#include "voxel/PagedVolume.h"
 #include "voxel/Palette.h"
 #include "voxel/Voxel.h"
 #include "voxel/RawVolume.h"
@@ -48,6 +49,12 @@ MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &_reg
 	}
 }
 
+MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &_region, const voxel::Region &_partialRegion)
+	: MementoData(buf, bufSize, _region) {
+	this->_partialRegion = _partialRegion;
+	_partial = true;
+}
+
 MementoData::MementoData(const uint8_t* buf, size_t bufSize,
 		const voxel::Region& _region) :
 		_compressedSize(bufSize), _region(_region) {
@@ -63,7 +70,9 @@ MementoData::MementoData(const uint8_t* buf, size_t bufSize,
 MementoData::MementoData(MementoData&& o) noexcept :
 		_compressedSize(o._compressedSize),
 		_buffer(o._buffer),
-		_region(o._region) {
+		_region(o._region),
+		_partialRegion(o._partialRegion),
+		_partial(o._partial) {
 	o._compressedSize = 0;
 	o._buffer = nullptr;
 }
@@ -77,7 +86,9 @@ MementoData::~MementoData() {
 
 MementoData::MementoData(const MementoData& o) :
 		_compressedSize(o._compressedSize),
-		_region(o._region) {
+		_region(o._region),
+		_partialRegion(o._partialRegion),
+		_partial(o._partial) {
 	if (o._buffer != nullptr) {
 		core_assert(_compressedSize > 0);
 		_buffer = (uint8_t*)core_malloc(_compressedSize);
@@ -97,6 +108,8 @@ MementoData& MementoData::operator=(MementoData &&o) noexcept {
 		_buffer = o._buffer;
 		o._buffer = nullptr;
 		_region = o._region;
+		_partialRegion = o._partialRegion;
+		_partial = o._partial;
 	}
 	return *this;
 }
@@ -126,6 +139,42 @@ MementoData MementoData::fromVolume(const voxel::RawVolume* volume, const voxel:
 	return {outStream.release(), size, mementoRegion};
 }
 
+MementoData MementoData::fromRegion(const voxel::RawVolume &voxels, const voxel::Region &volumeRegion) {
+	const voxel::Region &region = voxels.region();
+	const int allVoxels = region.voxels();
+	const uint32_t compressedBufferSize = core::zip::compressBound(allVoxels * sizeof(voxel::Voxel));
+	io::BufferedReadWriteStream outStream(compressedBufferSize);
+	io::ZipWriteStream stream(outStream);
+	stream.write(voxels.data(), allVoxels * sizeof(voxel::Voxel));
+	stream.flush();
+	const size_t size = (size_t)outStream.size();
+	return {outStream.release(), size, volumeRegion, region};
+}
+
+static uint8_t *uncompressVolumeData(const voxel::Region &region, const uint8_t *buffer, size_t compressedSize) {
+	const size_t uncompressedBufferSize = region.voxels() * sizeof(voxel::Voxel);
+	io::MemoryReadStream dataStream(buffer, compressedSize);
+	io::ZipReadStream stream(dataStream, (int)dataStream.size());
+	uint8_t *uncompressedBuf = (uint8_t*)core_malloc(uncompressedBufferSize);
+	if (stream.read(uncompressedBuf, uncompressedBufferSize) != (int)uncompressedBufferSize) {
+		core_free(uncompressedBuf);
+		return nullptr;
+	}
+	return uncompressedBuf;
+}
+
+voxel::RawVolume *MementoData::uncompress(const MementoData &mementoData) {
+	if (mementoData._buffer == nullptr) {
+		return nullptr;
+	}
+	const voxel::Region &region = mementoData.modifiedRegion();
+	uint8_t *uncompressedBuf = uncompressVolumeData(region, mementoData._buffer, mementoData._compressedSize);
+	if (uncompressedBuf == nullptr) {
+		return nullptr;
+	}
+	return voxel::RawVolume::createRaw((voxel::Voxel *)uncompressedBuf, region);
+}
+
 bool MementoData::toVolume(voxel::RawVolume* volume, const MementoData& mementoData) {
 	if (mementoData._buffer == nullptr) {
 		return false;
@@ -134,16 +183,13 @@ bool MementoData::toVolume(voxel::RawVolume* volume, const MementoData& mementoD
 	if (volume == nullptr) {
 		return false;
 	}
-	const size_t uncompressedBufferSize = mementoData.region().voxels() * sizeof(voxel::Voxel);
-	io::MemoryReadStream dataStream(mementoData._buffer, mementoData._compressedSize);
-	io::ZipReadStream stream(dataStream, (int)dataStream.size());
-	uint8_t *uncompressedBuf = (uint8_t*)core_malloc(uncompressedBufferSize);
-	if (stream.read(uncompressedBuf, uncompressedBufferSize) == -1) {
-		core_free(uncompressedBuf);
+	core_assert_msg(!mementoData.isPartial() || volume->region() == mementoData.region(),
+					"Partial mementos must be applied to a volume with the same region");
+	core::ScopedPtr<voxel::RawVolume> v(uncompress(mementoData));
+	if (!v) {
 		return false;
 	}
-	core::ScopedPtr<voxel::RawVolume> v(voxel::RawVolume::createRaw((voxel::Voxel*)uncompressedBuf, mementoData.region()));
-	voxelutil::copyIntoRegion(*v, *volume, mementoData.region());
+	voxelutil::copyIntoRegion(*v, *volume, mementoData.modifiedRegion());
 	return true;
 }
 
@@ -151,6 +197,7 @@ MementoHandler::MementoHandler() {
 }
 
 MementoHandler::~MementoHandler() {
+	clearShadows();
 }
 
 bool MementoHandler::init() {
@@ -194,7 +241,7 @@ void MementoHandler::printState(const MementoState &state) const {
 		palHash = core::string::toString(state.palette.value()->hash());
 	}
 	Log::info("%s: node id: %i (parent: %i) (frame %i) - %s (%s) [mins(%i:%i:%i)/maxs(%i:%i:%i)] (size: %ib) (palette: %s [hash: %s])",
-			typeToString(state.type), state.nodeId, state.parentId, state.keyFrameIdx, state.name.c_str(), state.data._buffer == nullptr ? "empty" : "volume",
+			typeToString(state.type), state.nodeId, state.parentId, state.keyFrameIdx, state.name.c_str(), state.data._buffer == nullptr ? "empty" : (state.data.isPartial() ? "partial" : "volume"),
 					mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z, (int)state.data.size(), state.palette.hasValue() ? "true" : "false", palHash.c_str());
 
 }
@@ -214,22 +261,29 @@ void MementoHandler::construct() {
 }
 
 void MementoHandler::clearStates() {
+	clearShadows();
 	_states.clear();
 	_statePosition = 0u;
 }
 
 MementoState MementoHandler::undoModification(const MementoState &s) {
 	core_assert(s.hasVolumeData());
+	if (s.hasUndoData()) {
+		updateShadow(s.nodeId, s.undoData);
+		return MementoState{s.type,		s.undoData, s.parentId, s.nodeId,	   s.referenceId, s.name,
+							s.nodeType, s.region,	s.pivot,	s.worldMatrix, s.keyFrameIdx};
+	}
 	for (int i = _statePosition; i >= 0; --i) {
 		MementoState &prevS = _states[i];
 		if ((prevS.type == MementoType::Modification || prevS.type == MementoType::SceneNodeAdded) &&
-			prevS.nodeId == s.nodeId) {
+			prevS.nodeId == s.nodeId && !prevS.data.isPartial()) {
 			core_assert(prevS.hasVolumeData());
 			voxel::logRegion("Undo current", s.region);
 			voxel::logRegion("Undo previous", prevS.region);
 			voxel::logRegion("Undo current data", s.data.region());
 			voxel::logRegion("Undo previous data", prevS.data.region());
 			// use the region from the current state - but the volume from the previous state of this node
+			updateShadow(s.nodeId, prevS.data);
 			return MementoState{s.type,		prevS.data, s.parentId, s.nodeId,	   s.referenceId, s.name,
 								s.nodeType, s.region,	s.pivot,	s.worldMatrix, s.keyFrameIdx};
 		}
@@ -324,10 +378,24 @@ MementoState MementoHandler::redo() {
 	}
 	++_statePosition;
 	Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
-	return state();
+	const MementoState &s = state();
+	if (s.type == MementoType::Modification && s.hasVolumeData()) {
+		updateShadow(s.nodeId, s.data);
+	}
+	return s;
 }
 
 void MementoHandler::updateNodeId(int nodeId, int newNodeId) {
+	auto iter = _shadowVolumes.find(nodeId);
+	if (iter != _shadowVolumes.end()) {
+		voxel::PagedVolume *shadow = iter->value;
+		_shadowVolumes.erase(iter);
+		voxel::PagedVolume *replaced = nullptr;
+		if (_shadowVolumes.get(newNodeId, replaced)) {
+			delete replaced;
+		}
+		_shadowVolumes.put(newNodeId, shadow);
+	}
 	for (MementoState& state : _states) {
 		if (state.nodeId == nodeId) {
 			state.nodeId = newNodeId;
@@ -484,8 +552,20 @@ void MementoHandler::markUndo(int parentId, int nodeId, int referenceId, const c
 	}
 	Log::debug("New undo state for node %i with name %s (memento state index: %i)", nodeId, name.c_str(), (int)_states.size());
 	voxel::logRegion("MarkUndo", region);
-	const MementoData& data = MementoData::fromVolume(volume, region);
+	MementoData data;
+	MementoData undoData;
+	if (type == MementoType::Modification) {
+		modificationData(nodeId, volume, region, data, undoData);
+	} else {
+		data = MementoData::fromVolume(volume, region);
+		if (type == MementoType::SceneNodeAdded) {
+			updateShadow(nodeId, volume, voxel::Region::InvalidRegion);
+		} else if (type == MementoType::SceneNodePaletteChanged && volume != nullptr) {
+			updateShadow(nodeId, volume, region);
+		}
+	}
 	MementoState state(type, data, parentId, nodeId, referenceId, name, nodeType, region, pivot, worldMatrix, keyFrameIdx, palette);
+	state.undoData = core::move(undoData);
 	addState(core::move(state));
 }
 
@@ -500,12 +580,95 @@ void MementoHandler::markUndoKeyFrames(int parentId, int nodeId, int referenceId
 	Log::debug("New undo state for node %i with name %s (memento state index: %i)", nodeId, name.c_str(), (int)_states.size());
 	voxel::logRegion("MarkUndo", region);
 	const MementoData& data = MementoData::fromVolume(volume, region);
+	if (type == MementoType::Modification || type == MementoType::SceneNodeAdded) {
+		// the initial state of the node
+		updateShadow(nodeId, volume, voxel::Region::InvalidRegion);
+	}
 	core::Optional<scenegraph::SceneGraphKeyFramesMap> kf;
 	kf.setValue(keyFrames);
 	MementoState state(type, data, parentId, nodeId, referenceId, name, nodeType, region, pivot, kf, palette, properties);
 	addState(core::move(state));
 }
 
+voxel::PagedVolume *MementoHandler::shadowVolume(int nodeId) const {
+	voxel::PagedVolume *shadow = nullptr;
+	_shadowVolumes.get(nodeId, shadow);
+	return shadow;
+}
+
+void MementoHandler::clearShadows() {
+	for (const auto &entry : _shadowVolumes) {
+		delete entry->value;
+	}
+	_shadowVolumes.clear();
+}
+
+void MementoHandler::updateShadow(int nodeId, const voxel::RawVolume *volume, const voxel::Region &region) {
+	if (volume == nullptr) {
+		return;
+	}
+	voxel::PagedVolume *shadow = shadowVolume(nodeId);
+	if (shadow == nullptr || shadow->region() != volume->region()) {
+		delete shadow;
+		shadow = new voxel::PagedVolume(volume->region());
+		shadow->setCompression(true, ShadowHotChunks);
+		_shadowVolumes.put(nodeId, shadow);
+		shadow->copyFrom(*volume, volume->region());
+		return;
+	}
+	shadow->copyFrom(*volume, region.isValid() ? region : volume->region());
+}
+
+void MementoHandler::updateShadow(int nodeId, const MementoData &data) {
+	core::ScopedPtr<voxel::RawVolume> v(MementoData::uncompress(data));
+	if (!v) {
+		return;
+	}
+	if (data.isPartial()) {
+		voxel::PagedVolume *shadow = shadowVolume(nodeId);
+		if (shadow == nullptr || shadow->region() != data.region()) {
+			// partial data can't be applied - the next modification of the node is recorded completely
+			_shadowVolumes.remove(nodeId);
+			delete shadow;
+			return;
+		}
+		shadow->copyFrom(*v, v->region());
+		return;
+	}
+	updateShadow(nodeId, v, voxel::Region::InvalidRegion);
+}
+
+void MementoHandler::modificationData(int nodeId, const voxel::RawVolume *volume, const voxel::Region &region,
+									  MementoData &data, MementoData &undoData) {
+	if (volume == nullptr) {
+		return;
+	}
+	voxel::PagedVolume *shadow = shadowVolume(nodeId);
+	if (shadow == nullptr) {
+		// the first recorded state of the node - there is no previous state to return to
+		data = MementoData::fromVolume(volume, region);
+		updateShadow(nodeId, volume, voxel::Region::InvalidRegion);
+		return;
+	}
+	voxel::Region modifiedRegion = region;
+	modifiedRegion.cropTo(volume->region());
+	if (!region.isValid() || !modifiedRegion.isValid() || shadow->region() != volume->region()) {
+		voxel::RawVolume previous(shadow->region());
+		shadow->copyInto(previous);
+		undoData = MementoData::fromVolume(&previous, voxel::Region::InvalidRegion);
+		data = MementoData::fromVolume(volume, region);
+		updateShadow(nodeId, volume, voxel::Region::InvalidRegion);
+		return;
+	}
+	// only record the modified region - before and after the modification
+	voxel::RawVolume previous(modifiedRegion);
+	shadow->copyInto(previous);
+	undoData = MementoData::fromRegion(previous, volume->region());
+	const voxel::RawVolume current(*volume, modifiedRegion);
+	data = MementoData::fromRegion(current, volume->region());
+	shadow->copyFrom(*volume, modifiedRegion);
+}
+
 void MementoHandler::addState(MementoState &&state) {
 	_states.emplace_back(state);
 	_statePosition = stateSize() - 1;
@@ -9,6 +9,7 @@
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "scenegraph/SceneGraphNode.h"
+#include "core/collection/Map.h"
 #include "core/collection/RingBuffer.h"
 #include "core/String.h"
 #include <stdint.h>
@@ -16,6 +17,7 @@
 
 namespace voxel {
 class RawVolume;
+class PagedVolume;
 }
 
 namespace voxedit {
@@ -42,7 +44,8 @@ enum class MementoType {
 /**
  * @brief Holds the data of a memento state
  *
- * The given buffer is owned by this class and represents a compressed volume
+ * The given buffer is owned by this class and represents a compressed volume - or for partial mementos
+ * only the compressed voxels of the modified part of the volume.
  */
 class MementoData {
 	friend struct MementoState;
@@ -60,9 +63,21 @@ private:
 	 * The region the given volume data is for
 	 */
 	voxel::Region _region {};
+	/**
+	 * The part of the volume that is covered by the data - only used if @c _partial is @c true
+	 */
+	voxel::Region _partialRegion {};
+	bool _partial = false;
 
 	MementoData(const uint8_t* buf, size_t bufSize, const voxel::Region& _region);
 	MementoData(uint8_t* buf, size_t bufSize, const voxel::Region& _region);
+	MementoData(uint8_t* buf, size_t bufSize, const voxel::Region& _region, const voxel::Region& _partialRegion);
+
+	/**
+	 * @brief Uncompresses the voxels of the covered region
+	 * @note It's the callers responsibility to free the returned volume
+	 */
+	static voxel::RawVolume *uncompress(const MementoData& mementoData);
 public:
 	constexpr MementoData() {}
 	MementoData(MementoData&& o) noexcept;
@@ -77,6 +92,21 @@ public:
 		return _region;
 	}
 
+	/**
+	 * @brief Partial mementos only contain the voxels of the modified part of the volume. They are applied on top
+	 * of the volume in its previous state.
+	 */
+	inline bool isPartial() const {
+		return _partial;
+	}
+
+	/**
+	 * @return The region of the volume that is covered by the data
+	 */
+	inline const voxel::Region& modifiedRegion() const {
+		return isPartial() ? _partialRegion : _region;
+	}
+
 	/**
 	 * @brief Converts the given @c mementoData back into a voxels
 	 * @note Inserts the voxels from the memento data into the given volume at the given region.
@@ -89,11 +119,22 @@ public:
 	 * the whole volume is going to added to the memento data.
 	 */
 	static MementoData fromVolume(const voxel::RawVolume* volume, const voxel::Region &region);
+	/**
+	 * @brief Creates a partial memento that only contains the given voxels
+	 * @param[in] voxels The voxels of the modified part of the volume
+	 * @param[in] volumeRegion The region of the whole volume the voxels belong to
+	 */
+	static MementoData fromRegion(const voxel::RawVolume& voxels, const voxel::Region &volumeRegion);
 };
 
 struct MementoState {
 	MementoType type;
 	MementoData data;
+	/**
+	 * The voxels of the volume before the modification - only set for modifications of a node whose
+	 * previous state is known. @c data contains the voxels after the modification for redo.
+	 */
+	MementoData undoData;
 	int parentId = InvalidNodeId;
 	int nodeId = InvalidNodeId;
 	int referenceId = InvalidNodeId;
@@ -164,6 +205,10 @@ struct MementoState {
 		return data._buffer != nullptr;
 	}
 
+	inline bool hasUndoData() const {
+		return undoData._buffer != nullptr;
+	}
+
 	inline const voxel::Region& dataRegion() const {
 		return data._region;
 	}
@@ -175,12 +220,35 @@ using MementoStates = core::RingBuffer<MementoState, 64u>;
  */
 class MementoHandler : public core::IComponent {
 private:
+	/**
+	 * @brief The amount of chunks of a shadow volume that are kept uncompressed
+	 */
+	static constexpr int ShadowHotChunks = 4;
+
+	/**
+	 * @brief Run length compressed copy of the last recorded volume state of each node. Modifications only
+	 * record the modified region - the voxels this region had before the modification are taken from here.
+	 */
+	core::Map<int, voxel::PagedVolume *> _shadowVolumes;
 	MementoStates _states;
 	uint8_t _statePosition = 0u;
 	int _locked = 0;
 
 	void addState(MementoState &&state);
 	bool markUndoPreamble(int nodeId);
+	void modificationData(int nodeId, const voxel::RawVolume *volume, const voxel::Region &region, MementoData &data,
+						  MementoData &undoData);
+	voxel::PagedVolume *shadowVolume(int nodeId) const;
+	/**
+	 * @brief Records the given region of the volume as the current state of the node - the shadow volume is
+	 * created again if the region of the volume changed.
+	 */
+	void updateShadow(int nodeId, const voxel::RawVolume *volume, const voxel::Region &region);
+	/**
+	 * @brief Applies the memento data that is handed out for an undo or redo step to the shadow volume
+	 */
+	void updateShadow(int nodeId, const MementoData &data);
+	void clearShadows();
 
 	MementoState undoRename(const MementoState &s);
 	MementoState undoPaletteChange(const MementoState &s);
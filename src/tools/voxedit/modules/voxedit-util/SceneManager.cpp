@@ -17,7 +17,7 @@
 #include "core/UTF8.h"
 #include "core/collection/DynamicArray.h"
 #include "io/File.h"
-#include "io/FileStream.h"
+#include "io/MappedFileReadStream.h"
 #include "io/Filesystem.h"
 #include "io/FormatDescription.h"
 #include "io/MemoryReadStream.h"
@@ -372,7 +372,7 @@ bool SceneManager::import(const core::String& file) {
 		return false;
 	}
 	scenegraph::SceneGraph newSceneGraph;
-	io::FileStream stream(filePtr);
+	io::MappedFileReadStream stream(filePtr);
 	voxelformat::LoadContext loadCtx;
 	if (!voxelformat::loadFormat(filePtr->name(), stream, newSceneGraph, loadCtx)) {
 		Log::error("Failed to load %s", file.c_str());
@@ -412,7 +412,7 @@ bool SceneManager::importDirectory(const core::String& directory, const io::Form
 		}
 		scenegraph::SceneGraph newSceneGraph;
 		io::FilePtr filePtr = io::filesystem()->open(e.fullPath, io::FileMode::SysRead);
-		io::FileStream stream(filePtr);
+		io::MappedFileReadStream stream(filePtr);
 		voxelformat::LoadContext loadCtx;
 		if (!voxelformat::loadFormat(filePtr->name(), stream, newSceneGraph, loadCtx)) {
 			Log::error("Failed to load %s", e.fullPath.c_str());
@@ -443,7 +443,7 @@ bool SceneManager::load(const io::FileDescription& file) {
 	core::ThreadPool& threadPool = app::App::getInstance()->threadPool();
 	_loadingFuture = threadPool.enqueue([filePtr] () {
 		scenegraph::SceneGraph newSceneGraph;
-		io::FileStream stream(filePtr);
+		io::MappedFileReadStream stream(filePtr);
 		voxelformat::LoadContext loadCtx;
 		voxelformat::loadFormat(filePtr->name(), stream, newSceneGraph, loadCtx);
 		mergeIfNeeded(newSceneGraph);
@@ -737,7 +737,7 @@ bool SceneManager::mementoModification(const MementoState& s) {
 		if (s.palette.hasValue()) {
 			node->setPalette(*s.palette.value());
 		}
-		modified(node->id(), s.data.region(), false);
+		modified(node->id(), s.data.modifiedRegion(), false);
 		return true;
 	}
 	Log::warn("Failed to handle memento state - node id %i not found (%s)", s.nodeId, s.name.c_str());
@@ -1963,14 +1963,20 @@ void SceneManager::removeUnusedColors(int nodeId) {
 	if (v == nullptr) {
 		return;
 	}
-	core::Array<bool, voxel::PaletteMaxColors> usedColors;
+	using UsedColors = core::Array<bool, voxel::PaletteMaxColors>;
+	UsedColors usedColors;
 	usedColors.fill(false);
 
 	voxel::Palette &pal = node.palette();
-	voxelutil::visitVolume(*v, [&usedColors] (int x, int y, int z, const voxel::Voxel& voxel) {
-		usedColors[voxel.getColor()] = true;
-		return true;
-	});
+	auto visitor = [](UsedColors &slabUsed, int x, int y, int z, const voxel::Voxel &voxel) {
+		slabUsed[voxel.getColor()] = true;
+	};
+	auto reducer = [](UsedColors &used, const UsedColors &slabUsed) {
+		for (size_t i = 0; i < used.size(); ++i) {
+			used[i] |= slabUsed[i];
+		}
+	};
+	voxelutil::visitVolumeParallel(*v, v->region(), usedColors, visitor, reducer);
 	int unused = 0;
 	for (size_t i = 0; i < usedColors.size(); ++i) {
 		if (!usedColors[i]) {
@@ -6,6 +6,7 @@
 #include "app/tests/AbstractTest.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
+#include "voxel/Voxel.h"
 
 namespace voxedit {
 
@@ -545,6 +546,53 @@ TEST_F(MementoHandlerTest, testAddNewNodeEdit) {
 	}
 }
 
+TEST_F(MementoHandlerTest, testPartialModification) {
+	core::SharedPtr<voxel::RawVolume> volume = create(16);
+	auto strokePos = [](int i) { return glm::ivec3(i % 16, (i / 16) % 16, 3); };
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), 0);
+	const size_t fullSize = mementoHandler.state().data.size();
+	// more modifications than states fit into the buffer
+	const int n = 80;
+	for (int i = 0; i < n; ++i) {
+		const glm::ivec3 pos = strokePos(i);
+		volume->setVoxel(pos, voxel::createVoxel(voxel::VoxelType::Generic, i + 1));
+		mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region(pos, pos), glm::vec3(0.0f), glm::mat4(1.0f), 0);
+	}
+	const MementoState &last = mementoHandler.state();
+	ASSERT_TRUE(last.data.isPartial());
+	ASSERT_TRUE(last.hasUndoData());
+	EXPECT_EQ(voxel::Region(strokePos(n - 1), strokePos(n - 1)), last.data.modifiedRegion());
+	EXPECT_EQ(volume->region(), last.data.region());
+	EXPECT_LT(last.data.size() + last.undoData.size(), fullSize);
+
+	// the states are applied to the volume like the SceneManager does it
+	int i = n - 1;
+	for (; mementoHandler.canUndo(); --i) {
+		const MementoState &state = mementoHandler.undo();
+		ASSERT_TRUE(state.hasVolumeData());
+		ASSERT_TRUE(state.data.isPartial());
+		ASSERT_TRUE(MementoData::toVolume(volume.get(), state.data));
+		EXPECT_TRUE(voxel::isAir(volume->voxel(strokePos(i)).getMaterial())) << "undo of modification " << i;
+		EXPECT_EQ(i, volume->voxel(strokePos(i - 1)).getColor()) << "undo of modification " << i;
+	}
+	for (++i; mementoHandler.canRedo(); ++i) {
+		const MementoState &state = mementoHandler.redo();
+		ASSERT_TRUE(state.hasVolumeData());
+		ASSERT_TRUE(MementoData::toVolume(volume.get(), state.data));
+		EXPECT_EQ(i + 1, volume->voxel(strokePos(i)).getColor()) << "redo of modification " << i;
+	}
+	EXPECT_EQ(n, i);
+
+	// a modification after undo and redo is recorded against the restored state
+	mementoHandler.undo();
+	const glm::ivec3 pos = strokePos(n - 1);
+	volume->setVoxel(pos, voxel::createVoxel(voxel::VoxelType::Generic, 200));
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region(pos, pos), glm::vec3(0.0f), glm::mat4(1.0f), 0);
+	const MementoState &state = mementoHandler.undo();
+	ASSERT_TRUE(MementoData::toVolume(volume.get(), state.data));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(pos).getMaterial()));
+}
+
 #if 0
 // TODO
 TEST_F(MementoHandlerTest, testSceneNodeRenamed) {